@@ -83,6 +83,8 @@ static GFINLINE void usage(const char * progname)
 					"\t-ttl=N                 specifies Time-To-Live for multicast. Default is 1.\n"
 					"\t-ifce=IPIFCE           specifies default IP interface to use. Default is IF_ANY.\n"
 					"\tDST : Destinations, at least one is mandatory\n"
+					"\t                        * can be used several times, the multiplex is done once and sent to all destinations\n"
+					"\t                        * -nb-pack and -segment-* options apply to the destination they follow, or to all destinations when set before any\n"
 					"\t  -dst-udp             UDP_address:port (multicast or unicast)\n"
 					"\t  -dst-rtp             RTP_address:port\n"
 					"\t  -dst-file            Supports the following arguments:\n"
@@ -192,6 +194,39 @@ enum
 #endif
 };
 
+#define MAX_MUX_DST	16
+/*one output of the multiplex - all destinations share the same gf_m2ts_mux_process run*/
+typedef struct
+{
+	/*one of GF_MP42TS_FILE, GF_MP42TS_UDP, GF_MP42TS_RTP*/
+	u32 type;
+	/*file name or IP address*/
+	char *dst;
+	u16 port;
+
+	FILE *file;
+	Bool is_stdout;
+	GF_Socket *udp_sk;
+#ifndef GPAC_DISABLE_STREAMING
+	GF_RTPChannel *rtp;
+	GF_RTPHeader hdr;
+#endif
+
+	/*packing of TS packets before writing/sending*/
+	u32 nb_pck_pack, nb_pck_in_pack;
+	char *pack_buffer;
+	/*number of failed UDP/RTP sends*/
+	u32 nb_send_errors;
+
+	/*HLS segmentation of file output*/
+	u32 segment_duration, segment_index, segment_number;
+	char *segment_dir, *segment_manifest, *segment_http_prefix;
+	char segment_prefix[GF_MAX_PATH];
+	char segment_name[GF_MAX_PATH];
+	char segment_manifest_default[GF_MAX_PATH];
+	GF_M2TS_Time prev_seg_time;
+} M2TSSink;
+
 static GF_Err mp4_input_ctrl(GF_ESInterface *ifce, u32 act_type, void *param)
 {
 	GF_ESIMP4 *priv = (GF_ESIMP4 *)ifce->input_udta;
@@ -226,59 +261,66 @@ static GF_Err mp4_input_ctrl(GF_ESInterface *ifce, u32 act_type, void *param)
 
 #ifndef USE_ISOBMF_REWRITE
 		if (priv->nalu_size) {
-			Bool nalu_delim_sent = 0;
-			u32 remain = priv->sample->dataLength;
-			char *ptr = priv->sample->data;
-			u32 v, size;
-			char sc[10];
-
-
-			/*send nalus*/
-			sc[0] = sc[1] = sc[2] = 0; sc[3] = 1;
-			while (remain) {
+			u32 remain, v, size, au_size, dsi_size;
+			char *ptr, *au, *dst;
+
+			/*compute the AU size once NALU lengths are replaced by start codes*/
+			dsi_size = (priv->sample->IsRAP && priv->dsi) ? priv->dsi_size : 0;
+			au_size = 0;
+			remain = priv->sample->dataLength;
+			ptr = priv->sample->data;
+			while (remain >= priv->nalu_size) {
 				size = 0;
-				v = priv->nalu_size;
-				while (v) {
-					size |= (u8) *ptr;
-					ptr++;
-					remain--;
-					v-=1;
-					if (v) size<<=8;
-				}
-				remain -= size;
-
-				if (!nalu_delim_sent) {
-					nalu_delim_sent = 1;
-					/*send a NALU delim: copy over NAL ref idc*/
-					sc[4] = (ptr[0] & 0x60) | GF_AVC_NALU_ACCESS_UNIT;
-					sc[5] = 0xF0 /*7 "all supported NALUs" (=111) + rbsp trailing (10000)*/;
-
-					pck.data = sc;
-					pck.data_len = 6;
-					ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
-					pck.flags &= ~GF_ESI_DATA_AU_START;
-
-					/*and send SPD / PPS if RAP - it is not clear in the specs whether SPS/PPS should be inserted after
-					the AU delimiter NALU*/
-					if (priv->sample->IsRAP && priv->dsi && priv->dsi_size) {
-						pck.data = priv->dsi;
-						pck.data_len = priv->dsi_size;
-						ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
-						pck.flags &= ~GF_ESI_DATA_AU_START;
-					}
+				for (v=0; v<priv->nalu_size; v++) {
+					size = (size<<8) | (u8) ptr[v];
 				}
+				if (size > remain - priv->nalu_size) break;
+				ptr += priv->nalu_size + size;
+				remain -= priv->nalu_size + size;
+				au_size += 4 + size;
+			}
 
-				pck.data = sc;
-				pck.data_len = 4;
-				ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
+			/*build the complete AU and give it to the muxer, so that data is not copied again*/
+			if (au_size) {
+				au = (char*)gf_malloc(sizeof(char) * (6 + dsi_size + au_size));
+				dst = au;
+				ptr = priv->sample->data;
+				/*send a NALU delim: copy over NAL ref idc*/
+				dst[0] = dst[1] = dst[2] = 0; dst[3] = 1;
+				dst[4] = (ptr[priv->nalu_size] & 0x60) | GF_AVC_NALU_ACCESS_UNIT;
+				dst[5] = (char) 0xF0 /*7 "all supported NALUs" (=111) + rbsp trailing (10000)*/;
+				dst += 6;
+
+				/*and send SPD / PPS if RAP - it is not clear in the specs whether SPS/PPS should be inserted after
+				the AU delimiter NALU*/
+				if (dsi_size) {
+					memcpy(dst, priv->dsi, dsi_size);
+					dst += dsi_size;
+				}
 
-				if (!remain) pck.flags |= GF_ESI_DATA_AU_END;
-				pck.flags &= ~GF_ESI_DATA_AU_START;
+				remain = au_size;
+				while (remain) {
+					size = 0;
+					for (v=0; v<priv->nalu_size; v++) {
+						size = (size<<8) | (u8) ptr[v];
+					}
+					ptr += priv->nalu_size;
+					dst[0] = dst[1] = dst[2] = 0; dst[3] = 1;
+					memcpy(dst+4, ptr, size);
+					dst += 4 + size;
+					ptr += size;
+					remain -= 4 + size;
+				}
 
-				pck.data = ptr;
-				pck.data_len = size;
-				ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
-				ptr += size;
+				pck.flags |= GF_ESI_DATA_AU_END;
+				pck.data = au;
+				pck.data_len = 6 + dsi_size + au_size;
+				pck.release_data = NULL;
+				/*muxer queue is full, keep the sample for the next flush*/
+				if (ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_TRANSFER, &pck) == GF_BUFFER_TOO_SMALL) {
+					gf_free(au);
+					return GF_OK;
+				}
 			}
 
 		} else 
@@ -289,14 +331,20 @@ static GF_Err mp4_input_ctrl(GF_ESInterface *ifce, u32 act_type, void *param)
 			if (priv->sample->IsRAP && priv->dsi && priv->dsi_size) {
 				pck.data = priv->dsi;
 				pck.data_len = priv->dsi_size;
-				ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
+				if (ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck) == GF_BUFFER_TOO_SMALL)
+					return GF_OK;
 				pck.flags &= ~GF_ESI_DATA_AU_START;
 			}
 
 			pck.flags |= GF_ESI_DATA_AU_END;
 			pck.data = priv->sample->data;
 			pck.data_len = priv->sample->dataLength;
-			ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
+			pck.release_data = NULL;
+			if (ifce->output_ctrl(ifce, GF_ESI_OUTPUT_DATA_TRANSFER, &pck) == GF_BUFFER_TOO_SMALL)
+				return GF_OK;
+			/*sample data now belongs to the muxer*/
+			priv->sample->data = NULL;
+			priv->sample->dataLength = 0;
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MPEG-2 TS Muxer] Track %d: sample %d CTS %d\n", priv->track, priv->sample_number+1, pck.cts));
 		}
 
@@ -515,6 +563,9 @@ typedef struct
 
 	Bool use_carousel;
 	u32 au_sn;
+	/*set when a part of the current AU was rejected by the muxer, the rest of the AU is dropped*/
+	Bool drop_au;
+	u32 nb_dropped_au;
 
 	s64 ts_offset;
 	Bool rtcp_init;
@@ -631,6 +682,10 @@ static void rtp_sl_packet_cbk(void *udta, char *payload, u32 size, GF_SLHeader *
 		rtp->au_sn = hdr->AU_sequenceNumber;
 	}
 
+	/*live source, we cannot hold the data until the muxer is ready: once a part of an AU is rejected, the whole AU is dropped*/
+	if (hdr->accessUnitStartFlag) rtp->drop_au = 0;
+	else if (rtp->drop_au) return;
+
 	if (rtp->is_264) {
 		if (!payload) return;
 
@@ -644,7 +699,8 @@ static void rtp_sl_packet_cbk(void *udta, char *payload, u32 size, GF_SLHeader *
 
 			rtp->pck.data = sc;
 			rtp->pck.data_len = 6;
-			rtp->ifce->output_ctrl(rtp->ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &rtp->pck);
+			e = rtp->ifce->output_ctrl(rtp->ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &rtp->pck);
+			if (e) goto drop;
 
 			rtp->pck.flags &= ~GF_ESI_DATA_AU_START;
 
@@ -653,14 +709,15 @@ static void rtp_sl_packet_cbk(void *udta, char *payload, u32 size, GF_SLHeader *
 				rtp->pck.data = rtp->dsi_and_rap;
 				rtp->pck.data_len = rtp->avc_dsi_size;
 
-				rtp->ifce->output_ctrl(rtp->ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &rtp->pck);
+				e = rtp->ifce->output_ctrl(rtp->ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &rtp->pck);
+				if (e) goto drop;
 			}
 
 			rtp->pck.data = payload;
 			rtp->pck.data_len = size;
 		}
 
-		rtp->ifce->output_ctrl(rtp->ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &rtp->pck);
+		e = rtp->ifce->output_ctrl(rtp->ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &rtp->pck);
 	} else {
 		if (rtp->cat_dsi && hdr->randomAccessPointFlag && hdr->accessUnitStartFlag) {
 			if (rtp->dsi_and_rap) gf_free(rtp->dsi_and_rap);
@@ -670,8 +727,15 @@ static void rtp_sl_packet_cbk(void *udta, char *payload, u32 size, GF_SLHeader *
 			memcpy((char *) rtp->dsi_and_rap + rtp->depacketizer->sl_map.configSize, payload, size);
 			rtp->pck.data = rtp->dsi_and_rap;
 		}
-		rtp->ifce->output_ctrl(rtp->ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &rtp->pck);
+		e = rtp->ifce->output_ctrl(rtp->ifce, GF_ESI_OUTPUT_DATA_DISPATCH, &rtp->pck);
 	}
+	if (!e) return;
+
+drop:
+	/*the muxer discarded the parts of the AU already dispatched*/
+	rtp->drop_au = 1;
+	rtp->nb_dropped_au++;
+	GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MPEG-2 TS Muxer] Stream %d: muxer queue full, dropping RTP AU (%d AUs dropped)\n", rtp->ifce->stream_id, rtp->nb_dropped_au));
 }
 
 static void fill_rtp_es_ifce(GF_ESInterface *ifce, GF_SDPMedia *media, GF_SDPInfo *sdp, M2TSProgram *prog)
@@ -800,6 +864,8 @@ static GF_Err void_input_ctrl(GF_ESInterface *ifce, u32 act_type, void *param)
 	return GF_OK;
 }
 
+static volatile Bool run = 1;
+
 /*AAC import features*/
 #ifndef GPAC_DISABLE_PLAYER
 
@@ -964,7 +1030,10 @@ static void SampleCallBack(void *calling_object, u16 ESID, char *data, u32 size,
 					if (ESID != AUDIO_DATA_ESID && ESID != VIDEO_DATA_ESID)	/*don't log A/V inputs*/
 						fprintf(stderr, "Update from scene engine sent: ESID=%d - size=%d - ts="LLD"\n", ESID, size, ts); 
 				}
-				prog->streams[i].output_ctrl(&prog->streams[i], GF_ESI_OUTPUT_DATA_DISPATCH, &pck);
+				/*wait for the muxer to consume pending AUs*/
+				while ((prog->streams[i].output_ctrl(&prog->streams[i], GF_ESI_OUTPUT_DATA_DISPATCH, &pck) == GF_BUFFER_TOO_SMALL) && run) {
+					gf_sleep(1);
+				}
 				return;
 			}
 		i++;
@@ -976,8 +1045,6 @@ static void SampleCallBack(void *calling_object, u16 ESID, char *data, u32 size,
 //static gf_seng_callback * SampleCallBack = &mySampleCallBack;
 
 
-static volatile Bool run = 1;
-
 #ifndef GPAC_DISABLE_SENG
 static GF_ESIStream * set_broadcast_params(M2TSProgram *prog, u16 esid, u32 period, u32 ts_delta, u16 aggregate_on_stream, Bool adjust_carousel_time, Bool force_rap, Bool aggregate_au, Bool discard_pending, Bool signal_rap, Bool signal_critical, Bool version_inc)
 {
@@ -1632,12 +1699,12 @@ static GFINLINE GF_Err parse_args(int argc, char **argv, u32 *mux_rate, u32 *car
 								  M2TSProgram *progs, u32 *nb_progs, char **src_name, 
 								  Bool *real_time, u32 *run_time, char **video_buffer, u32 *video_buffer_size,
 								  u32 *audio_input_type, char **audio_input_ip, u16 *audio_input_port,
-								  u32 *output_type, char **ts_out, char **udp_out, char **rtp_out, u16 *output_port, 
-								  char** segment_dir, u32 *segment_duration, char **segment_manifest, u32 *segment_number, char **segment_http_prefix, Bool *split_rap, u32 *nb_pck_pack, u32 *ttl, const char **ip_ifce)
+								  M2TSSink *sinks, u32 *nb_sinks, M2TSSink *def_sink, Bool *split_rap, u32 *ttl, const char **ip_ifce)
 {
 	Bool rate_found=0, mpeg4_carousel_found=0, time_found=0, src_found=0, dst_found=0, audio_input_found=0, video_input_found=0, 
 		 seg_dur_found=0, seg_dir_found=0, seg_manifest_found=0, seg_number_found=0, seg_http_found = 0, real_time_found=0;
 	char *prog_name, *arg = NULL, *error_msg = "no argument found";
+	M2TSSink *sink = def_sink, *file_sink = def_sink;
 	u32 mpeg4_signaling = GF_M2TS_MPEG4_SIGNALING_NONE; 
 	Bool force_real_time = 0;
 	s32 i;
@@ -1805,32 +1872,32 @@ static GFINLINE GF_Err parse_args(int argc, char **argv, u32 *mux_rate, u32 *car
 					goto error;
 				}
 				seg_dir_found = 1;
-				*segment_dir = arg+13;
+				file_sink->segment_dir = arg+13;
 				/* TODO: add the path separation char, if missing */
 			} else if (!strnicmp(arg, "-segment-duration=", 18)) {
 				if (seg_dur_found) {
 					goto error;
 				}
 				seg_dur_found = 1;
-				*segment_duration = atoi(arg+18);
+				file_sink->segment_duration = atoi(arg+18);
 			} else if (!strnicmp(arg, "-segment-manifest=", 18)) {
 				if (seg_manifest_found) {
 					goto error;
 				}
 				seg_manifest_found = 1;
-				*segment_manifest = arg+18;
+				file_sink->segment_manifest = arg+18;
 			} else if (!strnicmp(arg, "-segment-http-prefix=", 21)) {
 				if (seg_http_found) {
 					goto error;
 				}
 				seg_http_found = 1;
-				*segment_http_prefix = arg+21;
+				file_sink->segment_http_prefix = arg+21;
 			} else if (!strnicmp(arg, "-segment-number=", 16)) {
 				if (seg_number_found) {
 					goto error;
 				}
 				seg_number_found = 1;
-				*segment_number = atoi(arg+16);
+				file_sink->segment_number = atoi(arg+16);
 			} 
 			else if (!strnicmp(arg, "-src=", 5)) {
 				if (src_found) {
@@ -1842,39 +1909,40 @@ static GFINLINE GF_Err parse_args(int argc, char **argv, u32 *mux_rate, u32 *car
 				*src_name = arg+5;
 			}
 			else if (!strnicmp(arg, "-nb-pack=", 9)) {
-				*nb_pck_pack = atoi(arg+9);
+				sink->nb_pck_pack = atoi(arg+9);
 			} else if (!strnicmp(arg, "-ttl=", 5)) {
 				*ttl = atoi(arg+5);
 			} else if (!strnicmp(arg, "-ifce=", 6)) {
 				*ip_ifce = arg+6;
-			} else if (!strnicmp(arg, "-dst-file=", 10)) {
-				dst_found = 1;
-				*ts_out = gf_strdup(arg+10);
-			}
-			else if (!strnicmp(arg, "-dst-udp=", 9)) {
-				char *sep = strchr(arg+9, ':');
-				dst_found = 1;
-				*real_time=1;
-				if (sep) {
-					*output_port = atoi(sep+1);
-					sep[0]=0;
-					*udp_out = gf_strdup(arg+9);
-					sep[0]=':';
-				} else {
-					*udp_out = gf_strdup(arg+9);
+			} else if (!strnicmp(arg, "-dst-file=", 10) || !strnicmp(arg, "-dst-udp=", 9) || !strnicmp(arg, "-dst-rtp=", 9)) {
+				if (*nb_sinks == MAX_MUX_DST) {
+					error_msg = "too many destinations";
+					goto error;
 				}
-			}
-			else if (!strnicmp(arg, "-dst-rtp=", 9)) {
-				char *sep = strchr(arg+9, ':');
 				dst_found = 1;
-				*real_time=1;
-				if (sep) {
-					*output_port = atoi(sep+1);
-					sep[0]=0;
-					*rtp_out = gf_strdup(arg+9);
-					sep[0]=':';
+				sink = &sinks[*nb_sinks];
+				(*nb_sinks)++;
+				/*options given before the first destination apply to all destinations*/
+				memcpy(sink, def_sink, sizeof(M2TSSink));
+
+				if (!strnicmp(arg, "-dst-file=", 10)) {
+					sink->type = GF_MP42TS_FILE;
+					sink->dst = gf_strdup(arg+10);
+					/*segment options may be given again for this destination*/
+					file_sink = sink;
+					seg_dur_found = seg_dir_found = seg_manifest_found = seg_number_found = seg_http_found = 0;
 				} else {
-					*rtp_out = gf_strdup(arg+9);
+					char *sep = strchr(arg+9, ':');
+					sink->type = !strnicmp(arg, "-dst-udp=", 9) ? GF_MP42TS_UDP : GF_MP42TS_RTP;
+					*real_time=1;
+					if (sep) {
+						sink->port = atoi(sep+1);
+						sep[0]=0;
+						sink->dst = gf_strdup(arg+9);
+						sep[0]=':';
+					} else {
+						sink->dst = gf_strdup(arg+9);
+					}
 				}
 			}
 			else if (!strnicmp(arg, "-audio=", 7) || !strnicmp(arg, "-video=", 7) || !strnicmp(arg, "-mpeg4", 6))
@@ -1981,42 +2049,251 @@ static GF_Err write_manifest(char *manifest, char *segment_dir, u32 segment_dura
 	}
 }
 
+static GF_Err get_segment_name(M2TSSink *sink, u32 index, char *name, u32 name_size)
+{
+	s32 res;
+	if (sink->segment_dir) {
+		if (strchr("\\/", sink->segment_dir[strlen(sink->segment_dir)-1])) {
+			res = snprintf(name, name_size, "%s%s_%d.ts", sink->segment_dir, sink->segment_prefix, index);
+		} else {
+			res = snprintf(name, name_size, "%s/%s_%d.ts", sink->segment_dir, sink->segment_prefix, index);
+		}
+	} else {
+		res = snprintf(name, name_size, "%s_%d.ts", sink->segment_prefix, index);
+	}
+	if ((res < 0) || ((u32) res >= name_size)) {
+		fprintf(stderr, "Segment name for %s too long\n", sink->segment_prefix);
+		name[0] = 0;
+		return GF_BAD_PARAM;
+	}
+	return GF_OK;
+}
+
+static GF_Err sink_open(M2TSSink *sink, u32 ttl, const char *ip_ifce)
+{
+	GF_Err e;
+	char *name;
+
+	if (sink->nb_pck_pack>1) {
+		sink->pack_buffer = gf_malloc(sizeof(char) * 188 * sink->nb_pck_pack);
+	}
+
+	switch (sink->type) {
+	case GF_MP42TS_FILE:
+		name = sink->dst;
+		if (sink->segment_duration) {
+			char *dot;
+			strcpy(sink->segment_prefix, sink->dst);
+			dot = strrchr(sink->segment_prefix, '.');
+			if (dot) dot[0] = 0;
+			e = get_segment_name(sink, sink->segment_index, sink->segment_name, GF_MAX_PATH);
+			if (e) return e;
+			name = sink->segment_name;
+			if (!sink->segment_manifest) { 
+				sprintf(sink->segment_manifest_default, "%s.m3u8", sink->segment_prefix);
+				sink->segment_manifest = sink->segment_manifest_default;
+			}
+		} 
+		if (!strcmp(name, "stdout") || !strcmp(name, "-") ) {
+			sink->file = stdout;
+			sink->is_stdout = GF_TRUE;
+		} else {
+			sink->file = fopen(name, "wb");
+			sink->is_stdout = GF_FALSE;
+		}
+		if (!sink->file) {
+			fprintf(stderr, "Error opening %s\n", name);
+			return GF_IO_ERR;
+		}
+		break;
+	case GF_MP42TS_UDP:
+		sink->udp_sk = gf_sk_new(GF_SOCK_TYPE_UDP);
+		if (gf_sk_is_multicast_address(sink->dst)) {
+			e = gf_sk_setup_multicast(sink->udp_sk, sink->dst, sink->port, ttl, 0, (char *) ip_ifce);
+		} else {
+			e = gf_sk_bind(sink->udp_sk, ip_ifce, sink->port, sink->dst, sink->port, GF_SOCK_REUSE_PORT);
+		}
+		if (e) {
+			fprintf(stderr, "Error initializing UDP socket: %s\n", gf_error_to_string(e));
+			return e;
+		}
+		break;
+#ifndef GPAC_DISABLE_STREAMING
+	case GF_MP42TS_RTP:
+	{
+		GF_RTSPTransport tr;
+		sink->rtp = gf_rtp_new();
+		gf_rtp_set_ports(sink->rtp, sink->port);
+		memset(&tr, 0, sizeof(GF_RTSPTransport));
+		tr.IsUnicast = gf_sk_is_multicast_address(sink->dst) ? 0 : 1;
+		tr.Profile="RTP/AVP";
+		tr.destination = sink->dst;
+		tr.source = "0.0.0.0";
+		tr.IsRecord = 0;
+		tr.Append = 0;
+		tr.SSRC = rand();
+		tr.port_first = sink->port;
+		tr.port_last = sink->port+1;
+		if (tr.IsUnicast) {
+			tr.client_port_first = sink->port;
+			tr.client_port_last = sink->port+1;
+		} else {
+			tr.source = sink->dst;
+			tr.TTL = ttl;
+		}
+		e = gf_rtp_setup_transport(sink->rtp, &tr, sink->dst);
+		if (e != GF_OK) {
+			fprintf(stderr, "Cannot setup RTP transport info : %s\n", gf_error_to_string(e));
+			return e;
+		}
+		e = gf_rtp_initialize(sink->rtp, 0, 1, 1500, 0, 0, (char *) ip_ifce);
+		if (e != GF_OK) {
+			fprintf(stderr, "Cannot initialize RTP sockets : %s\n", gf_error_to_string(e));
+			return e;
+		}
+		memset(&sink->hdr, 0, sizeof(GF_RTPHeader));
+		sink->hdr.Version = 2;
+		sink->hdr.PayloadType = 33;	/*MP2T*/
+		sink->hdr.SSRC = tr.SSRC;
+		sink->hdr.Marker = 0;
+	}
+		break;
+#endif /*GPAC_DISABLE_STREAMING*/
+	default:
+		return GF_NOT_SUPPORTED;
+	}
+	return GF_OK;
+}
+
+/*writes/sends nb_pck TS packets to the destination*/
+static GF_Err sink_write(M2TSSink *sink, const char *data, u32 nb_pck, GF_M2TS_Mux *muxer)
+{
+	GF_Err e;
+
+	switch (sink->type) {
+	case GF_MP42TS_FILE:
+		if (gf_fwrite(data, 1, 188 * nb_pck, sink->file) != 188 * nb_pck) {
+			fprintf(stderr, "Error writing to %s\n", sink->segment_name[0] ? sink->segment_name : sink->dst);
+			return GF_IO_ERR;
+		}
+		if (sink->segment_duration && (muxer->time.sec > sink->prev_seg_time.sec + sink->segment_duration)) {
+			sink->prev_seg_time = muxer->time;
+			fclose(sink->file);
+			sink->segment_index++;
+			sink->file = NULL;
+			e = get_segment_name(sink, sink->segment_index, sink->segment_name, GF_MAX_PATH);
+			if (e) return e;
+			sink->file = fopen(sink->segment_name, "wb");
+			if (!sink->file) {
+				fprintf(stderr, "Error opening %s\n", sink->segment_name);
+				return GF_IO_ERR;
+			}
+			/* delete the oldest segment */
+			if (sink->segment_number && ((s32) (sink->segment_index - sink->segment_number - 1) >= 0)){
+				char old_segment_name[GF_MAX_PATH];
+				if (get_segment_name(sink, sink->segment_index - sink->segment_number - 1, old_segment_name, GF_MAX_PATH) == GF_OK)
+					gf_delete_file(old_segment_name);
+			}
+			write_manifest(sink->segment_manifest, sink->segment_dir, sink->segment_duration, sink->segment_prefix, sink->segment_http_prefix, 
+						   ( (sink->segment_index > sink->segment_number ) ? sink->segment_index - sink->segment_number : 0), sink->segment_index >1 ? sink->segment_index-1 : 0, 0);
+		} 
+		break;
+	case GF_MP42TS_UDP:
+		e = gf_sk_send(sink->udp_sk, (char*)data, 188 * nb_pck); 
+		if (e) {
+			sink->nb_send_errors++;
+			fprintf(stderr, "Error %s sending UDP packet to %s:%d\n", gf_error_to_string(e), sink->dst, sink->port);
+			return e;
+		}
+		break;
+#ifndef GPAC_DISABLE_STREAMING
+	case GF_MP42TS_RTP:
+	{
+		u32 ts;
+		sink->hdr.SequenceNumber++;
+		/*muxer clock at 90k*/
+		ts = muxer->time.sec*90000 + muxer->time.nanosec*9/100000;
+		/*FIXME - better discontinuity check*/
+		sink->hdr.Marker = (ts < sink->hdr.TimeStamp) ? 1 : 0;
+		sink->hdr.TimeStamp = ts;
+		e = gf_rtp_send_packet(sink->rtp, &sink->hdr, (char*)data, 188 * nb_pck, 0);
+		if (e) {
+			sink->nb_send_errors++;
+			fprintf(stderr, "Error %s sending RTP packet to %s:%d\n", gf_error_to_string(e), sink->dst, sink->port);
+			return e;
+		}
+	}
+		break;
+#endif
+	}
+	return GF_OK;
+}
+
+/*packs the TS packet with the previous ones if requested by the destination, and writes the pack when complete*/
+static GF_Err sink_send(M2TSSink *sink, const char *ts_pck, GF_M2TS_Mux *muxer)
+{
+	if (!sink->pack_buffer) return sink_write(sink, ts_pck, 1, muxer);
+
+	memcpy(sink->pack_buffer + 188 * sink->nb_pck_in_pack, ts_pck, 188);
+	sink->nb_pck_in_pack++;
+	if (sink->nb_pck_in_pack < sink->nb_pck_pack) return GF_OK;
+
+	sink->nb_pck_in_pack = 0;
+	return sink_write(sink, sink->pack_buffer, sink->nb_pck_pack, muxer);
+}
+
+/*sends pending packets of an incomplete pack*/
+static GF_Err sink_flush(M2TSSink *sink, GF_M2TS_Mux *muxer)
+{
+	u32 nb_pck = sink->nb_pck_in_pack;
+	if (!nb_pck) return GF_OK;
+	sink->nb_pck_in_pack = 0;
+	return sink_write(sink, sink->pack_buffer, nb_pck, muxer);
+}
+
+static void sink_close(M2TSSink *sink)
+{
+	if (sink->nb_send_errors) {
+		fprintf(stderr, "%d packets could not be sent to %s:%d\n", sink->nb_send_errors, sink->dst, sink->port);
+	}
+	if (sink->segment_duration && sink->segment_prefix[0]) {
+		write_manifest(sink->segment_manifest, sink->segment_dir, sink->segment_duration, sink->segment_prefix, sink->segment_http_prefix, sink->segment_index - sink->segment_number, sink->segment_index, 1);
+	}
+	if (sink->file && !sink->is_stdout) fclose(sink->file);
+	if (sink->udp_sk) gf_sk_del(sink->udp_sk);
+#ifndef GPAC_DISABLE_STREAMING
+	if (sink->rtp) gf_rtp_del(sink->rtp);
+#endif
+	if (sink->pack_buffer) gf_free(sink->pack_buffer);
+	if (sink->dst) gf_free(sink->dst);
+}
+
 int main(int argc, char **argv)
 {
 	/********************/
 	/*   declarations   */
 	/********************/
 	const char *ts_pck;
-	char *ts_pack_buffer = NULL;
 	GF_Err e;
 	u32 run_time;
-	Bool real_time, single_au_pes, split_rap, is_stdout;
+	Bool real_time, single_au_pes, split_rap;
 	u64 pcr_init_val=0;
 	u32 usec_till_next, ttl;
-	u32 i, j, mux_rate, nb_progs, cur_pid, carrousel_rate, last_print_time, last_video_time, bifs_use_pes, psi_refresh_rate, nb_pck_pack, nb_pck_in_pack;
-	char *ts_out = NULL, *udp_out = NULL, *rtp_out = NULL, *audio_input_ip = NULL;
-	FILE *ts_output_file = NULL;
-	GF_Socket *ts_output_udp_sk = NULL, *audio_input_udp_sk = NULL;
-#ifndef GPAC_DISABLE_STREAMING
-	GF_RTPChannel *ts_output_rtp = NULL;
-	GF_RTSPTransport tr;
-	GF_RTPHeader hdr;
-#endif
+	u32 i, j, mux_rate, nb_progs, cur_pid, carrousel_rate, last_print_time, last_video_time, bifs_use_pes, psi_refresh_rate;
+	char *audio_input_ip = NULL;
+	GF_Socket *audio_input_udp_sk = NULL;
 	char *video_buffer;
 	u32 video_buffer_size;
-	u16 output_port = 0, audio_input_port = 0;
-	u32 output_type, audio_input_type, pcr_offset;
+	u16 audio_input_port = 0;
+	u32 audio_input_type, pcr_offset;
 	char *audio_input_buffer = NULL;
 	u32 audio_input_buffer_length=65536;
 	char *src_name;
 	M2TSProgram progs[MAX_MUX_SRC_PROG];
-	u32 segment_duration, segment_index, segment_number;
-	char segment_manifest_default[GF_MAX_PATH];
-	char *segment_manifest, *segment_http_prefix, *segment_dir;
-	char segment_prefix[GF_MAX_PATH];
-	char segment_name[GF_MAX_PATH];
+	M2TSSink sinks[MAX_MUX_DST];
+	M2TSSink def_sink;
+	u32 nb_sinks;
 	const char *ip_ifce = NULL;
-	GF_M2TS_Time prev_seg_time;
 	GF_M2TS_Mux *muxer;
 	
 	/*****************/
@@ -2029,34 +2306,20 @@ int main(int argc, char **argv)
 	/*   initialisations   */
 	/***********************/
 	real_time = 0;	
-	is_stdout = 0;
-	ts_output_file = NULL;
 	video_buffer = NULL;
 	last_video_time = 0;
 	audio_input_type = 0;
-	ts_output_udp_sk = NULL;
-	udp_out = NULL;
-#ifndef GPAC_DISABLE_STREAMING
-	ts_output_rtp = NULL;
-	rtp_out = NULL;
-#endif
-	ts_out = NULL;
 	src_name = NULL;
 	nb_progs = 0;
+	nb_sinks = 0;
 	mux_rate = 0;
 	run_time = 0;
 	carrousel_rate = 500;
-	output_port = 1234;
-	segment_duration = 0;
-	segment_number = 10; /* by default, we keep the 10 previous segments */
-	segment_index = 0;
-	segment_manifest = NULL;
-	segment_http_prefix = NULL;
-	segment_dir = NULL;
-	prev_seg_time.sec = 0;
-	prev_seg_time.nanosec = 0;
+	memset(&def_sink, 0, sizeof(M2TSSink));
+	def_sink.port = 1234;
+	def_sink.segment_number = 10; /* by default, we keep the 10 previous segments */
+	def_sink.nb_pck_pack = 1;
 	video_buffer_size = 0;
-	nb_pck_pack = 1;
 #ifndef GPAC_DISABLE_PLAYER
 	aac_reader = AAC_Reader_new();
 #endif
@@ -2074,8 +2337,7 @@ int main(int argc, char **argv)
 	if (GF_OK != parse_args(argc, argv, &mux_rate, &carrousel_rate, &pcr_init_val, &pcr_offset, &psi_refresh_rate, &single_au_pes, &bifs_use_pes, progs, &nb_progs, &src_name, 
 							&real_time, &run_time, &video_buffer, &video_buffer_size,
 							&audio_input_type, &audio_input_ip, &audio_input_port,
-							&output_type, &ts_out, &udp_out, &rtp_out, &output_port, 
-							&segment_dir, &segment_duration, &segment_manifest, &segment_number, &segment_http_prefix, &split_rap, &nb_pck_pack, &ttl, &ip_ifce)) {
+							sinks, &nb_sinks, &def_sink, &split_rap, &ttl, &ip_ifce)) {
 		goto exit;
 	}
 	
@@ -2091,90 +2353,10 @@ int main(int argc, char **argv)
 	if (muxer) gf_m2ts_mux_use_single_au_pes_mode(muxer, single_au_pes);
 	if (pcr_init_val) gf_m2ts_mux_set_initial_pcr(muxer, pcr_init_val);
 
-	if (ts_out != NULL) {
-		if (segment_duration) {
-			char *dot;
-			strcpy(segment_prefix, ts_out);
-			dot = strrchr(segment_prefix, '.');
-			dot[0] = 0;
-			if (segment_dir) {
-				if (strchr("\\/", segment_name[strlen(segment_name)-1])) {
-					sprintf(segment_name, "%s%s_%d.ts", segment_dir, segment_prefix, segment_index);
-				} else {
-					sprintf(segment_name, "%s/%s_%d.ts", segment_dir, segment_prefix, segment_index);
-				}
-			} else {
-				sprintf(segment_name, "%s_%d.ts", segment_prefix, segment_index);
-			}
-			ts_out = gf_strdup(segment_name);
-			if (!segment_manifest) { 
-				sprintf(segment_manifest_default, "%s.m3u8", segment_prefix);
-				segment_manifest = segment_manifest_default;
-			}
-			//write_manifest(segment_manifest, segment_dir, segment_duration, segment_prefix, segment_http_prefix, segment_index, 0, 0);
-		} 
-		if (!strcmp(ts_out, "stdout") || !strcmp(ts_out, "-") ) {
-			ts_output_file = stdout;
-			is_stdout = GF_TRUE;
-		} else {
-			ts_output_file = fopen(ts_out, "wb");
-			is_stdout = GF_FALSE;
-		}
-		if (!ts_output_file) {
-			fprintf(stderr, "Error opening %s\n", ts_out);
-			goto exit;
-		}
-	}
-	if (udp_out != NULL) {
-		ts_output_udp_sk = gf_sk_new(GF_SOCK_TYPE_UDP);
-		if (gf_sk_is_multicast_address((char *)udp_out)) {
-			e = gf_sk_setup_multicast(ts_output_udp_sk, (char *)udp_out, output_port, ttl, 0, (char *) ip_ifce);
-		} else {
-			e = gf_sk_bind(ts_output_udp_sk, ip_ifce, output_port, (char *)udp_out, output_port, GF_SOCK_REUSE_PORT);
-		}
-		if (e) {
-			fprintf(stderr, "Error initializing UDP socket: %s\n", gf_error_to_string(e));
-			goto exit;
-		}
+	/*open all destinations*/
+	for (i=0; i<nb_sinks; i++) {
+		if (sink_open(&sinks[i], ttl, ip_ifce) != GF_OK) goto exit;
 	}
-#ifndef GPAC_DISABLE_STREAMING
-	if (rtp_out != NULL) {
-		ts_output_rtp = gf_rtp_new();
-		gf_rtp_set_ports(ts_output_rtp, output_port);
-		memset(&tr, 0, sizeof(GF_RTSPTransport));
-		tr.IsUnicast = gf_sk_is_multicast_address((char *)rtp_out) ? 0 : 1;
-		tr.Profile="RTP/AVP";
-		tr.destination = (char *)rtp_out;
-		tr.source = "0.0.0.0";
-		tr.IsRecord = 0;
-		tr.Append = 0;
-		tr.SSRC = rand();
-		tr.port_first = output_port;
-		tr.port_last = output_port+1;
-		if (tr.IsUnicast) {
-			tr.client_port_first = output_port;
-			tr.client_port_last = output_port+1;
-		} else {
-			tr.source = (char *)rtp_out;
-			tr.TTL = ttl;
-		}
-		e = gf_rtp_setup_transport(ts_output_rtp, &tr, (char *)ts_out);
-		if (e != GF_OK) {
-			fprintf(stderr, "Cannot setup RTP transport info : %s\n", gf_error_to_string(e));
-			goto exit;
-		}
-		e = gf_rtp_initialize(ts_output_rtp, 0, 1, 1500, 0, 0, (char *) ip_ifce);
-		if (e != GF_OK) {
-			fprintf(stderr, "Cannot initialize RTP sockets : %s\n", gf_error_to_string(e));
-			goto exit;
-		}
-		memset(&hdr, 0, sizeof(GF_RTPHeader));
-		hdr.Version = 2;
-		hdr.PayloadType = 33;	/*MP2T*/
-		hdr.SSRC = tr.SSRC;
-		hdr.Marker = 0;
-	}
-#endif /*GPAC_DISABLE_STREAMING*/
 
 	/************************************/
 	/*   create streaming audio input   */
@@ -2250,10 +2432,6 @@ int main(int argc, char **argv)
 	}
 
 	gf_m2ts_mux_update_config(muxer, 1);
-	
-	if (nb_pck_pack>1) {
-		ts_pack_buffer = gf_malloc(sizeof(char) * 188 * nb_pck_pack);
-	}
 
 	/*****************/
 	/*   main loop   */
@@ -2296,86 +2474,13 @@ int main(int argc, char **argv)
 		}
 
 		/*flush all packets*/
-		nb_pck_in_pack=0;
 		while ((ts_pck = gf_m2ts_mux_process(muxer, &status, &usec_till_next)) != NULL) {
-
-do_flush:
-			if (ts_pack_buffer ) {
-				memcpy(ts_pack_buffer + 188 * nb_pck_in_pack, ts_pck, 188);
-				nb_pck_in_pack++;
-
-				if (nb_pck_in_pack < nb_pck_pack)
-					continue;
-
-				ts_pck = (const char *) ts_pack_buffer;
-			} else {
-				nb_pck_in_pack = 1;
+			/*the multiplex is done once for all destinations*/
+			for (i=0; i<nb_sinks; i++) {
+				e = sink_send(&sinks[i], ts_pck, muxer);
+				/*network errors are usually transient, keep multiplexing for the other packets and destinations*/
+				if (e && (sinks[i].type == GF_MP42TS_FILE)) goto exit;
 			}
-
-			if (ts_output_file != NULL) {
-				gf_fwrite(ts_pck, 1, 188 * nb_pck_in_pack, ts_output_file); 
-				if (segment_duration && (muxer->time.sec > prev_seg_time.sec + segment_duration)) {
-					prev_seg_time = muxer->time;
-					fclose(ts_output_file);
-					segment_index++;
-					if (segment_dir) {
-						if (strchr("\\/", segment_name[strlen(segment_name)-1])) {
-							sprintf(segment_name, "%s%s_%d.ts", segment_dir, segment_prefix, segment_index);
-						} else {
-							sprintf(segment_name, "%s/%s_%d.ts", segment_dir, segment_prefix, segment_index);
-						}
-					} else {
-						sprintf(segment_name, "%s_%d.ts", segment_prefix, segment_index);
-					}
-					ts_output_file = fopen(segment_name, "wb");
-					if (!ts_output_file) {
-						fprintf(stderr, "Error opening %s\n", segment_name);
-						goto exit;
-					}
-					/* delete the oldest segment */
-					if (segment_number && ((s32) (segment_index - segment_number - 1) >= 0)){
-						char old_segment_name[GF_MAX_PATH];
-						if (segment_dir) {
-							if (strchr("\\/", segment_name[strlen(segment_name)-1])) {
-								sprintf(old_segment_name, "%s%s_%d.ts", segment_dir, segment_prefix, segment_index - segment_number - 1);
-							} else {
-								sprintf(old_segment_name, "%s/%s_%d.ts", segment_dir, segment_prefix, segment_index - segment_number - 1);
-							}
-						} else {
-							sprintf(old_segment_name, "%s_%d.ts", segment_prefix, segment_index - segment_number - 1);
-						}
-						gf_delete_file(old_segment_name);
-					}
-					write_manifest(segment_manifest, segment_dir, segment_duration, segment_prefix, segment_http_prefix, 
-//								   (segment_index >= segment_number/2 ? segment_index - segment_number/2 : 0), segment_index >1 ? segment_index-1 : 0, 0);
-								   ( (segment_index > segment_number ) ? segment_index - segment_number : 0), segment_index >1 ? segment_index-1 : 0, 0);
-				} 
-			}
-
-			if (ts_output_udp_sk != NULL) {
-				e = gf_sk_send(ts_output_udp_sk, (char*)ts_pck, 188 * nb_pck_in_pack); 
-				if (e) {
-					fprintf(stderr, "Error %s sending UDP packet\n", gf_error_to_string(e));
-				}
-			}
-#ifndef GPAC_DISABLE_STREAMING
-			if (ts_output_rtp != NULL) {
-				u32 ts;
-				hdr.SequenceNumber++;
-				/*muxer clock at 90k*/
-				ts = muxer->time.sec*90000 + muxer->time.nanosec*9/100000;
-				/*FIXME - better discontinuity check*/
-				hdr.Marker = (ts < hdr.TimeStamp) ? 1 : 0;
-				hdr.TimeStamp = ts;
-				e = gf_rtp_send_packet(ts_output_rtp, &hdr, (char*)ts_pck, 188 * nb_pck_in_pack, 0);
-				if (e) {
-					fprintf(stderr, "Error %s sending RTP packet\n", gf_error_to_string(e));
-				}
-			}
-#endif
-
-			nb_pck_in_pack = 0;
-
 			if (status>=GF_M2TS_STATE_PADDING) {
 				break;
 			}
@@ -2421,12 +2526,15 @@ do_flush:
 			}
 		}
 		if (status==GF_M2TS_STATE_EOS) {
-			if (ts_pack_buffer) 
-				goto do_flush;
 			break;
 		}
 	}
 
+	for (i=0; i<nb_sinks; i++) {
+		e = sink_flush(&sinks[i], muxer);
+		if (e && (sinks[i].type == GF_MP42TS_FILE)) goto exit;
+	}
+
 	{
 		u64 bits = muxer->tot_pck_sent*8*188;
 		u32 dur_sec = gf_m2ts_get_ts_clock(muxer) / 1000;
@@ -2435,24 +2543,13 @@ do_flush:
 	}
 
 exit:
-	if (ts_pack_buffer) gf_free(ts_pack_buffer);
 	run = 0;
-	if (segment_duration) {
-		write_manifest(segment_manifest, segment_dir, segment_duration, segment_prefix, segment_http_prefix, segment_index - segment_number, segment_index, 1);
+	for (i=0; i<nb_sinks; i++) {
+		sink_close(&sinks[i]);
 	}
-	if (ts_output_file && !is_stdout) fclose(ts_output_file);
-	if (ts_output_udp_sk) gf_sk_del(ts_output_udp_sk);
-#ifndef GPAC_DISABLE_STREAMING
-	if (ts_output_rtp) gf_rtp_del(ts_output_rtp);
-#endif
-	if (ts_out) gf_free(ts_out);
 	if (audio_input_udp_sk) gf_sk_del(audio_input_udp_sk);
 	if (audio_input_buffer) gf_free (audio_input_buffer);
 	if (video_buffer) gf_free(video_buffer);
-	if (udp_out) gf_free(udp_out);
-#ifndef GPAC_DISABLE_STREAMING
-	if (rtp_out) gf_free(rtp_out);
-#endif
 #ifndef GPAC_DISABLE_PLAYER
 	if (aac_reader) AAC_Reader_del(aac_reader);
 #endif
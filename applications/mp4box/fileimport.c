@@ -57,6 +57,7 @@ typedef struct
 #ifndef GPAC_DISABLE_MEDIA_IMPORT
 
 extern u32 swf_flags;
+extern Bool scene_cache;
 extern Float swf_flatten_angle;
 extern Bool keep_sys_tracks;
 
@@ -203,7 +204,8 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 
 	strcpy(szName, inName);
 	ext = strrchr(inName, '.');
-	if (!ext) {
+	/*"-" designates the standard input, its format being given with ":fmt="*/
+	if (!ext && ((inName[0]!='-') || (inName[1] && (inName[1]!=':') && (inName[1]!='#')))) {
 		fprintf(stderr, "Unknown input file type\n");
 		return GF_BAD_PARAM;
 	}
@@ -268,6 +270,7 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 		else if (!stricmp(ext+1, "subsamples")) import_flags |= GF_IMPORT_SET_SUBSAMPLES;
 		else if (!stricmp(ext+1, "forcesync")) import_flags |= GF_IMPORT_FORCE_SYNC;
 		else if (!stricmp(ext+1, "mpeg4")) import_flags |= GF_IMPORT_FORCE_MPEG4;
+		else if (!stricmp(ext+1, "stream")) import_flags |= GF_IMPORT_STREAMING;
 		else if (!strnicmp(ext+1, "agg=", 4)) frames_per_sample = atoi(ext+5);
 		else if (!strnicmp(ext+1, "dur=", 4)) import.duration = (u32) (atof(ext+5) * 1000);
 		else if (!strnicmp(ext+1, "par=", 4)) {
@@ -371,10 +374,12 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 	ext = strrchr(szName, '#');
 	if (ext) ext[0] = 0;
 
-	keep_handler = gf_isom_probe_file(szName);
+	/*streamed sources can only be read once and are not probed*/
+	if (!strcmp(szName, "-")) import_flags |= GF_IMPORT_STREAMING;
+	keep_handler = (import_flags & GF_IMPORT_STREAMING) ? 0 : gf_isom_probe_file(szName);
 
 	import.in_name = szName;
-	import.flags = GF_IMPORT_PROBE_ONLY;
+	import.flags = GF_IMPORT_PROBE_ONLY | (import_flags & GF_IMPORT_STREAMING);
 	e = gf_media_import(&import);
 	if (e) goto exit;
 
@@ -451,6 +456,8 @@ GF_Err import_file(GF_ISOFile *dest, char *inName, u32 import_flags, Double forc
 	if (!import.nb_tracks) {
 		u32 count, o_count;
 		o_count = gf_isom_get_track_count(import.dest);
+		/*no track info for streamed sources, the PID to extract from MPEG-2 TS is the one given by the user*/
+		if (import_flags & GF_IMPORT_STREAMING) import.trackID = track_id;
 		e = gf_media_import(&import);
 		if (e) return e;
 		count = gf_isom_get_track_count(import.dest);
@@ -1847,6 +1854,7 @@ GF_Err EncodeFile(char *in, GF_ISOFile *mp4, GF_SMEncodeOptions *opts, FILE *log
 	load.swf_flatten_limit = swf_flatten_angle;
 	/*since we're encoding we must get MPEG4 nodes only*/
 	load.flags = GF_SM_LOAD_MPEG4_STRICT;
+	if (scene_cache) load.flags |= GF_SM_LOAD_CONTEXT_CACHE;
 	e = gf_sm_load_init(&load);
 	if (e<0) {
 		gf_sm_load_done(&load);
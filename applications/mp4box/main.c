@@ -144,6 +144,7 @@ Bool keep_sys_tracks = 0;
 /*some global vars for swf import :(*/
 u32 swf_flags = 0;
 Float swf_flatten_angle = 0;
+Bool scene_cache = 0;
 s32 laser_resolution = 0;
 
 
@@ -196,6 +197,10 @@ void PrintGeneralUsage()
 			" -tight               performs tight interleaving (sample based) of the file\n"
 			"                       * Note: reduces disk seek but increases file size\n"
 			" -flat                stores file with all media data first, non-interleaved\n"
+			" -faststart           stores file with moov first, keeping media data as is (not reinterleaved)\n"
+			"                       * Note: media data is copied in one block, by the system when possible\n"
+			" -moov-space size     reserves size bytes for the moov before media data when importing with -flat\n"
+			"                       * Note: if the moov fits, the file is streamable without being rewritten\n"
 			" -frag time_in_ms     fragments file (track fragments of time_in_ms)\n"
 			"                       * Note: Always disables interleaving\n"
 			" -ffspace size        inserts free space before moof in fragmented files\n"
@@ -308,7 +313,10 @@ void PrintDASHUsage()
 			"                       MP4Box will run the live session until \'q\' is pressed or a fatal error occurs.\n"
 			" -ddbg-live[=F] dur   same as -dash-live without time regulation for debug purposes.\n"
 			" -dash-ctx FILE       stores/restore DASH timing from FILE.\n"
+			" -dash-ctx-bin        uses a binary checkpoint for new DASH context files instead of an INI file.\n"
 			" -dynamic             uses dynamic MPD type instead of static.\n"
+			" -dash-ll             low-latency mode: fragments are written to segments as soon as produced and segments\n"
+			"                       are announced in the MPD before completion. Disables SIDX.\n"
 			" -mpd-refresh TIME    specifies MPD update time in seconds.\n"
 			" -time-shift  TIME    specifies MPD time shift buffer depth in seconds (default 0). Specify -1 to keep all files\n"
 			" -subdur DUR          specifies maximum duration in ms of the input file to be dashed in LIVE or context mode.\n"
@@ -406,6 +414,8 @@ void PrintImportUsage()
 			" \":subsamples\"        adds SubSample information for AVC+SVC\n"
 			" \":forcesync\"         forces non IDR samples with I slices to be marked as sync points (AVC GDR)\n"
 			"       !! RESULTING FILE IS NOT COMPLIANT WITH THE SPEC but will fix seeking in most players\n"
+			" \":stream\"            source is a pipe or a file still being written (raw AVC, HEVC, AAC, AC3 and MPEG-2 TS)\n"
+			"                         use \"-\" as file name to import from standard input, with \":fmt=\" for the format\n"
 			" \":font=name\"         specifies font name for text import (default \"Serif\")\n"
 			" \":size=s\"            specifies font size for text import (default 18)\n"
 			" \":stype=4CC\"         forces the sample description type to a different value\n"
@@ -467,6 +477,7 @@ void PrintEncodeUsage()
 	fprintf(stderr, "MPEG-4 Scene Encoding Options\n"
 			" -mp4                 specify input file is for encoding.\n"
 			" -def                 encode DEF names\n"
+			" -scache              uses a binary cache of the parsed scene in GPAC cache directory\n"
 			" -sync time_in_ms     forces BIFS sync sample generation every time_in_ms\n"
 			"                       * Note: cannot be used with -shadow\n"
 			" -shadow time_ms      forces BIFS sync shadow sample generation every time_ms.\n"
@@ -1346,10 +1357,12 @@ int mp4boxMain(int argc, char **argv)
 	GF_DashSwitchingMode bitstream_switching_mode = GF_DASH_BSMODE_INBAND;
 	u32 i, stat_level, hint_flags, info_track_id, import_flags, nb_add, nb_cat, ismaCrypt, agg_samples, nb_sdp_ex, max_ptime, raw_sample_num, split_size, nb_meta_act, nb_track_act, rtp_rate, major_brand, nb_alt_brand_add, nb_alt_brand_rem, old_interleave, car_dur, minor_version, conv_type, nb_tsel_acts, program_number, dump_nal, time_shift_depth, dash_dynamic;
 	Bool HintIt, needSave, FullInter, Frag, HintInter, dump_std, dump_rtp, dump_mode, regular_iod, trackID, remove_sys_tracks, remove_hint, force_new, remove_root_od, import_subtitle, dump_chap;
-	Bool print_sdp, print_info, open_edit, track_dump_type, dump_isom, dump_cr, force_ocr, encode, do_log, do_flat, dump_srt, dump_ttxt, dump_timestamps, do_saf, dump_m2ts, dump_cart, do_hash, verbose, force_cat, align_cat, pack_wgt, single_group, dash_live;
+	Bool print_sdp, print_info, open_edit, track_dump_type, dump_isom, dump_cr, force_ocr, encode, do_log, do_flat, dump_srt, dump_ttxt, dump_timestamps, do_saf, dump_m2ts, dump_cart, do_hash, verbose, force_cat, align_cat, pack_wgt, single_group, dash_live, dash_ctx_bin, dash_low_latency;
 	char *inName, *outName, *arg, *mediaSource, *tmpdir, *input_ctx, *output_ctx, *drm_file, *avi2raw, *cprt, *chap_file, *pes_dump, *itunes_tags, *pack_file, *raw_cat, *seg_name, *dash_ctx_file;
 	Double min_buffer = 1.5;
 	u32 ast_shift_sec = 1;
+	u32 moov_space = 0;
+	Bool do_faststart = 0;
 	char **mpd_base_urls = NULL;
 	u32 nb_mpd_base_urls=0;
 
@@ -1400,7 +1413,7 @@ int mp4boxMain(int argc, char **argv)
 	dump_nal = 0;
 	FullInter = HintInter = encode = do_log = old_interleave = do_saf = do_hash = verbose = 0;
 	dump_mode = Frag = force_ocr = remove_sys_tracks = agg_samples = remove_hint = keep_sys_tracks = remove_root_od = single_group = 0;
-	conv_type = HintIt = needSave = print_sdp = print_info = regular_iod = dump_std = open_edit = dump_isom = dump_rtp = dump_cr = dump_chap = dump_srt = dump_ttxt = force_new = dump_timestamps = dump_m2ts = dump_cart = import_subtitle = force_cat = pack_wgt = dash_live = 0;
+	conv_type = HintIt = needSave = print_sdp = print_info = regular_iod = dump_std = open_edit = dump_isom = dump_rtp = dump_cr = dump_chap = dump_srt = dump_ttxt = force_new = dump_timestamps = dump_m2ts = dump_cart = import_subtitle = force_cat = pack_wgt = dash_live = dash_ctx_bin = dash_low_latency = 0;
 	dash_dynamic = 0;
 	/*align cat is the new default behaviour for -cat*/
 	align_cat = 1;
@@ -1776,6 +1789,7 @@ int mp4boxMain(int argc, char **argv)
 			dash_duration = atof(argv[i+1]) / 1000;
 			i++;
 		}
+		else if (!stricmp(arg, "-dash-ll")) { dash_low_latency = 1; }
 		else if (!stricmp(arg, "-mpd-refresh")) { CHECK_NEXT_ARG mpd_update_time = atoi(argv[i+1]); i++;   }
 		else if (!stricmp(arg, "-time-shift")) { 
 			CHECK_NEXT_ARG 
@@ -1809,6 +1823,8 @@ int mp4boxMain(int argc, char **argv)
 			CHECK_NEXT_ARG
 			dash_ctx_file = argv[i+1];
 			i++;
+		} else if (!stricmp(arg, "-dash-ctx-bin")) {
+			dash_ctx_bin = 1;
 		} else if (!stricmp(arg, "-daisy-chain")) {
 			daisy_chain_sidx = 1;
 		} else if (!stricmp(arg, "-single-segment")) {
@@ -1920,6 +1936,12 @@ int mp4boxMain(int argc, char **argv)
 		}
 		else if (!stricmp(arg, "-iod")) regular_iod = 1;
 		else if (!stricmp(arg, "-flat")) do_flat = 1;
+		else if (!stricmp(arg, "-faststart")) { do_faststart = 1; open_edit = 1; needSave = 1; }
+		else if (!stricmp(arg, "-moov-space")) {
+			CHECK_NEXT_ARG
+			moov_space = atoi(argv[i+1]);
+			i++;
+		}
 		else if (!stricmp(arg, "-new")) force_new = 1;
 		else if (!stricmp(arg, "-add") || !stricmp(arg, "-import") || !stricmp(arg, "-convert")) {
 			CHECK_NEXT_ARG
@@ -2125,6 +2147,7 @@ int mp4boxMain(int argc, char **argv)
 		
 #ifndef GPAC_DISABLE_SCENE_ENCODER
 		else if (!stricmp(arg, "-def")) opts.flags |= GF_SM_ENCODE_USE_NAMES;
+		else if (!stricmp(arg, "-scache")) scene_cache = 1;
 		else if (!stricmp(arg, "-sync")) {
 			CHECK_NEXT_ARG
 			opts.flags |= GF_SM_ENCODE_RAP_INBAND;
@@ -2646,6 +2669,10 @@ int mp4boxMain(int argc, char **argv)
 			fprintf(stderr, "Cannot open destination file %s: %s\n", inName, gf_error_to_string(gf_isom_last_error(NULL)) );
 			MP4BOX_EXIT_WITH_CODE(1);
 		}
+		if (moov_space && (open_mode == GF_ISOM_OPEN_WRITE)) {
+			e = gf_isom_reserve_moov_space(file, moov_space);
+			if (e) fprintf(stderr, "Cannot reserve space for moov: %s\n", gf_error_to_string(e));
+		}
 		for (i=0; i<(u32) argc; i++) {
 			if (!strcmp(argv[i], "-add")) {
 				char *src = argv[i+1];
@@ -2786,7 +2813,7 @@ int mp4boxMain(int argc, char **argv)
 
 	if (dash_duration) {
 		char szMPD[GF_MAX_PATH], *sep;
-		GF_Config *dash_ctx = NULL;
+		GF_DASHContext *dash_ctx = NULL;
 		u32 do_abort = 0;
 		gf_log_set_tool_level(GF_LOG_DASH, GF_LOG_INFO);
 		strcpy(outfile, outName ? outName : gf_url_get_resource_name(inName) );
@@ -2800,12 +2827,12 @@ int mp4boxMain(int argc, char **argv)
 			fprintf(stderr, "Live DASH-ing - press 'q' to quit, 's' to save context and quit\n");
 
 		if (!dash_ctx_file && dash_live) {
-			dash_ctx = gf_cfg_new(NULL, NULL);
+			dash_ctx = gf_dasher_context_new(NULL, 0);
 		} else if (dash_ctx_file) {
 			if (force_new) 
 				gf_delete_file(dash_ctx_file);
 
-			dash_ctx = gf_cfg_force_new(NULL, dash_ctx_file);
+			dash_ctx = gf_dasher_context_new(dash_ctx_file, dash_ctx_bin);
 		}
 
 		if (dash_profile==GF_DASH_PROFILE_UNKNOWN)
@@ -2827,7 +2854,8 @@ int mp4boxMain(int argc, char **argv)
 									   use_url_template, segment_timeline, single_segment, single_file, bitstream_switching_mode,
 									   seg_at_rap, dash_duration, seg_name, seg_ext, segment_marker,
 									   interleaving_time, subsegs_per_sidx, daisy_chain_sidx, frag_at_rap, tmpdir,
-									   dash_ctx, dash_dynamic, mpd_update_time, time_shift_depth, dash_subduration, min_buffer, ast_shift_sec);
+									   dash_ctx, dash_dynamic, mpd_update_time, time_shift_depth, dash_subduration, min_buffer, ast_shift_sec,
+									   dash_low_latency, NULL, NULL);
 			if (e) break;
 
 			if (dash_live) {
@@ -2859,11 +2887,10 @@ int mp4boxMain(int argc, char **argv)
 				char szName[1024];
 				fprintf(stderr, "Enter file name to save dash context:\n");
 				if (scanf("%s", szName) == 1) {
-					gf_cfg_set_filename(dash_ctx, szName);
-					gf_cfg_save(dash_ctx);
+					gf_dasher_context_save(dash_ctx, szName, dash_ctx_bin);
 				}
 			}
-			gf_cfg_del(dash_ctx);
+			gf_dasher_context_del(dash_ctx);
 		}
 		if (e) fprintf(stderr, "Error DASHing file: %s\n", gf_error_to_string(e));
 
@@ -2883,7 +2910,7 @@ int mp4boxMain(int argc, char **argv)
 		}
 		switch (get_file_type_by_ext(inName)) {
 		case 1:
-			file = gf_isom_open(inName, (u8) (open_edit ? GF_ISOM_OPEN_EDIT : ( ((dump_isom>0) || print_info) ? GF_ISOM_OPEN_READ_DUMP : GF_ISOM_OPEN_READ) ), tmpdir);
+			file = gf_isom_open(inName, open_edit ? GF_ISOM_OPEN_EDIT : ( (((dump_isom>0) || print_info) ? GF_ISOM_OPEN_READ_DUMP : GF_ISOM_OPEN_READ) | GF_ISOM_OPEN_LAZY_TABLES), tmpdir);
 			if (!file && (gf_isom_last_error(NULL) == GF_ISOM_INCOMPLETE_FILE) && !open_edit) {
 				u64 missing_bytes;
 				e = gf_isom_open_progressive(inName, 0, 0, &file, &missing_bytes);
@@ -3647,6 +3674,9 @@ int mp4boxMain(int argc, char **argv)
 	/*full interleave (sample-based) if just hinted*/
 	if (FullInter) {
 		e = gf_isom_set_storage_mode(file, GF_ISOM_STORE_TIGHT);
+	} else if (do_faststart) {
+		e = gf_isom_set_storage_mode(file, GF_ISOM_STORE_FASTSTART);
+		needSave = 1;
 	} else if (!interleaving_time) {
 		e = gf_isom_set_storage_mode(file, GF_ISOM_STORE_STREAMABLE);
 		needSave = 1;
@@ -3731,6 +3761,7 @@ int mp4boxMain(int argc, char **argv)
 		}
 		if (HintIt && FullInter) fprintf(stderr, "Hinted file - Full Interleaving\n");
 		else if (FullInter) fprintf(stderr, "Full Interleaving\n");
+		else if (do_faststart) fprintf(stderr, "Fast-start storage\n");
 		else if (do_flat || !interleaving_time) fprintf(stderr, "Flat storage\n");
 		else fprintf(stderr, "%.3f secs Interleaving%s\n", interleaving_time, old_interleave ? " - no drift control" : "");
 
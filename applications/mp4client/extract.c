@@ -649,6 +649,61 @@ Bool dump_file(char *url, u32 dump_mode, Double fps, u32 width, u32 height, Floa
 		gf_sc_release_screen_buffer(term->compositor, &fb);
 	}
 
+	if (dump_mode==12) {
+		u32 start, dump_dur, nb_frames, time, prev_time;
+		GF_VideoSurface out;
+		char *out_buf;
+
+		if (!fps) fps = GF_IMPORT_DEFAULT_FPS;
+		start = (nb_times==2) ? times[0] : 0;
+		if (nb_times==2) dump_dur = times[1] - times[0];
+		else dump_dur = times[0] ? times[0] : (u32) Duration;
+		if (!dump_dur) {
+			fprintf(stderr, "Warning: file has no duration, defaulting to 1 sec\n");
+			dump_dur = 1000;
+		}
+
+		/*render directly in our memory buffer*/
+		out_buf = gf_malloc(sizeof(char) * width * height * 3);
+		memset(&out, 0, sizeof(GF_VideoSurface));
+		out.width = width;
+		out.height = height;
+		out.pitch_x = 3;
+		out.pitch_y = 3*width;
+		out.pixel_format = GF_PIXEL_RGB_24;
+		out.video_buffer = out_buf;
+		e = gf_sc_set_output_buffer(term->compositor, &out);
+		if (e) {
+			fprintf(stderr, "Cannot render to memory buffer: %s\n", gf_error_to_string(e));
+			gf_free(out_buf);
+			return 1;
+		}
+
+		nb_frames = 0;
+		prev_time = 0;
+		i = gf_sys_clock();
+		e = gf_term_step_frame(term, start);
+		while (!e) {
+			nb_frames++;
+			time = (u32) (nb_frames*1000/fps);
+			if (time >= dump_dur) break;
+			e = gf_term_step_frame(term, time - prev_time);
+			prev_time = time;
+		}
+		i = gf_sys_clock() - i;
+		if (e) {
+			fprintf(stderr, "Error rendering frame %d: %s\n", nb_frames, gf_error_to_string(e));
+			gf_sc_set_output_buffer(term->compositor, NULL);
+			gf_free(out_buf);
+			return 1;
+		}
+		fprintf(stdout, "%s: %d frames (%dx%d) in %d ms - %.02f FPS\n", url, nb_frames, width, height, i, i ? 1000.0*nb_frames/i : 0);
+
+		gf_sc_set_output_buffer(term->compositor, NULL);
+		gf_free(out_buf);
+		return 0;
+	}
+
 	if (dump_mode==1 || dump_mode==5 || dump_mode==8 || dump_mode==10) {
 #ifdef GPAC_DISABLE_AVILIB
 		fprintf(stderr, "AVILib is disabled in this build of GPAC\n");
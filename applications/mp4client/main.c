@@ -206,6 +206,7 @@ void PrintUsage()
 		"\t-png [times]:   dumps given frames to png\n"
 		"\t-raw [times]:   dumps given frames to raw\n"
 		"\t-avi [times]:   dumps given file to raw avi\n"
+		"\t-bench [times]: renders given time range in memory as fast as possible and reports the frame rate\n"
 		"\t-rgbds:         dumps the RGBDS pixel format texture\n"
 		"                   with -avi [times]: dumps an rgbds-format .avi\n"
 		"\t-rgbd:          dumps the RGBD pixel format texture\n"
@@ -213,7 +214,7 @@ void PrintUsage()
 		"\t-depth:         dumps depthmap (z-buffer) frames\n"
 		"                   with -avi [times]: dumps depthmap in grayscale .avi\n"		
 		"                   with -bmp: dumps depthmap in grayscale .bmp\n"		
-		"\t-fps FPS:       specifies frame rate for AVI dumping (default: %f)\n"
+		"\t-fps FPS:       specifies frame rate for AVI dumping and benchmark (default: %f)\n"
 		"\t-scale s:       scales the visual size (default: 1)\n"
 		"\t-fill:          uses fill aspect ratio for dumping (default: none)\n"
 		"\t-show:          show window while dumping (default: no)\n"
@@ -925,6 +926,7 @@ int main (int argc, char **argv)
 	Double fps = GF_IMPORT_DEFAULT_FPS;
 	Bool fill_ar, visible;
 	char *url_arg, *the_cfg, *rti_file, *views;
+	char *prev_vout = NULL;
 	FILE *logfile = NULL;
 	Float scale = 1;
 #ifndef WIN32
@@ -1034,6 +1036,9 @@ int main (int argc, char **argv)
 		} else if (!strcmp(arg, "-raw")) {
 			dump_mode = 3;
 			if ((url_arg || (i+2<(u32)argc)) && get_time_list(argv[i+1], times, &nb_times)) i++;
+		} else if (!strcmp(arg, "-bench")) {
+			dump_mode = 12;
+			if ((url_arg || (i+2<(u32)argc)) && get_time_list(argv[i+1], times, &nb_times)) i++;
 
 		} else if (!stricmp(arg, "-size")) {
 			/*usage of %ud breaks sscanf on MSVC*/
@@ -1175,9 +1180,20 @@ int main (int argc, char **argv)
 
 	if (threading_flags & (GF_TERM_NO_DECODER_THREAD|GF_TERM_NO_COMPOSITOR_THREAD) ) term_step = 1;
 
+	/*benchmark renders in memory, no display needed*/
+	if (dump_mode==12) {
+		str = gf_cfg_get_key(cfg_file, "Video", "DriverName");
+		if (str) prev_vout = gf_strdup(str);
+		gf_cfg_set_key(cfg_file, "Video", "DriverName", "Raw Video Output");
+	}
+
 	fprintf(stderr, "Loading GPAC Terminal\n");	
 	i = gf_sys_clock();
 	term = gf_term_new(&user);
+	if (dump_mode==12) {
+		gf_cfg_set_key(cfg_file, "Video", "DriverName", prev_vout);
+		if (prev_vout) gf_free(prev_vout);
+	}
 	if (!term) {
 		fprintf(stderr, "\nInit error - check you have at least one video out and one rasterizer...\nFound modules:\n");
 		list_modules(user.modules);
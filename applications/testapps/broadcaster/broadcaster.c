@@ -113,7 +113,7 @@ u32 RAP_send(void *par)
 		dprintf(DEBUG_broadcaster, "Sending RAP, will sleep for %d seconds\n", *timer);
 		data->RAP = 1; 
 		gf_seng_aggregate_context(data->codec, 0);
-		gf_seng_encode_context(data->codec, SampleCallBack);
+		gf_seng_send_rap(data->codec, 0, SampleCallBack);
 
 		gf_mx_v(input->carrousel_mutex);
 		gf_sleep((*timer)*1000);
@@ -128,6 +128,7 @@ LOCAL_SRC_FILES := \
 	../../../../src/scene_manager/scene_engine.c \
 	../../../../src/scene_manager/scene_stats.c \
 	../../../../src/scene_manager/scene_manager.c \
+	../../../../src/scene_manager/context_cache.c \
 	../../../../src/scene_manager/text_to_bifs.c \
 	../../../../src/scene_manager/loader_isom.c \
 	../../../../src/scene_manager/swf_bifs.c \
@@ -85,6 +85,9 @@ GF_Err gf_bifs_encoder_new_stream(GF_BifsEncoder *codec, u16 ESID, GF_BIFSConfig
 the scenegraph used is the one described in SceneReplace command, hence scalable streams shall be encoded in time order
 */
 GF_Err gf_bifs_encode_au(GF_BifsEncoder *codec, u16 ESID, GF_List *command_list, char **out_data, u32 *out_data_length);
+/*same as above but encodes in the given buffer, reallocated (gf_realloc) if too small, so that the same memory can be used for
+all AUs. @buffer and @buffer_size are the buffer (may be NULL) and its allocated size, @out_data_length is set to the AU size*/
+GF_Err gf_bifs_encode_au_buffer(GF_BifsEncoder *codec, u16 ESID, GF_List *command_list, char **buffer, u32 *buffer_size, u32 *out_data_length);
 /*returns encoded config desc*/
 GF_Err gf_bifs_encoder_get_config(GF_BifsEncoder *codec, u16 ESID, char **out_data, u32 *out_data_length);
 /*returns BIFS version used by codec for given stream*/
@@ -93,6 +96,11 @@ u8 gf_bifs_encoder_get_version(GF_BifsEncoder *codec, u16 ESID);
 /*Encodes current graph as a scene replace*/
 GF_Err gf_bifs_encoder_get_rap(GF_BifsEncoder *codec, char **out_data, u32 *out_data_length);
 
+/*enables caching of encoded node subtrees: as long as a node and its children are not modified (cf gf_node_get_modification_count),
+the node is written from the cache rather than encoded again, which speeds up repeated encoding of the same scene (live RAPs).
+@max_size: maximum memory used by the cache in bytes, 0 disables the cache (default)*/
+GF_Err gf_bifs_encoder_set_node_cache(GF_BifsEncoder *codec, u32 max_size);
+
 #endif /*GPAC_DISABLE_BIFS_ENC*/
 
 #endif /*GPAC_DISABLE_BIFS*/
@@ -82,6 +82,29 @@ GF_BitStream *gf_bs_new(const char *buffer, u64 size, u32 mode);
  *	\warning RESULTS ARE UNEXPECTED IF YOU TOUCH THE FILE WHILE USING THE BITSTREAM.
  */
 GF_BitStream *gf_bs_from_file(FILE *f, u32 mode);
+/*!
+ *	\brief bitstream constructor from streamed source
+ *
+ * Creates a read bitstream on a source that cannot be seeked or sized beforehand, such as a pipe or a file still being written. 
+ * Data is read forward only through a window of window_size bytes, half of which is kept behind the current position:
+ * seeking back further than that fails. The size of the bitstream is the amount of data read so far, and \ref gf_bs_available only
+ * returns 0 once the source is over.
+ * \param f handle of the source, opened in binary mode.
+ *	\param window_size size of the read window in bytes, at least 256 kBytes.
+ *	\param idle_timeout for sources that can be positioned (files being written), time in milliseconds without new data after which the
+ * source is considered over. Pipes are over as soon as their writer closes them.
+ *	\return new bitstream object
+ */
+GF_BitStream *gf_bs_from_stream(FILE *f, u32 window_size, u32 idle_timeout);
+/*!
+ *	\brief memory file bitstream constructor
+ *
+ * Creates a write bitstream on a growable memory buffer owned by the bitstream and behaving like a file: the size of the bitstream
+ * is the amount of data written, data can be overwritten after a seek, read back with \ref gf_bs_read_data and truncated.
+ * The content is retrieved with \ref gf_bs_get_content, which empties the bitstream.
+ *	\return new bitstream object
+ */
+GF_BitStream *gf_bs_new_mem_file();
 /*!
  *	\brief bitstream constructor from file handle
  *
@@ -109,6 +132,27 @@ GF_Err gf_bs_set_output_buffering(GF_BitStream *bs, u32 size);
  */
 u32 gf_bs_get_output_buffering(GF_BitStream *bs);
 
+/*!
+ *	\brief flushes bitstream write cache
+ *
+ * Writes any data pending in the write cache of file-based bitstreams and flushes the underlying file.  
+ *	\param bs the target bitstream 
+ */
+void gf_bs_flush(GF_BitStream *bs);
+
+/*!
+ *	\brief sets bitstream read cache size
+ *
+ * Sets the read cache size for file-based bitstreams. Data is read from the file by blocks of the cache size, and seeking inside the
+ * cached block does not touch the file. While the cache is active, the file position no longer matches the bitstream position:
+ * the file handle shall not be used directly until the cache is removed (size 0) or the bitstream is destroyed, which both
+ * restore the file position to the bitstream position.
+ *	\param bs the target bitstream 
+ *	\param size size of the read cache in bytes, 0 removes the cache
+ *	\return error if any.
+ */
+GF_Err gf_bs_set_input_buffering(GF_BitStream *bs, u32 size);
+
 /*!
  *	\brief integer reading
  *
@@ -401,6 +445,31 @@ u64 gf_bs_available(GF_BitStream *bs);
 	* Once this function has been called, the internal bitstream buffer is reseted.
  */
 void gf_bs_get_content(GF_BitStream *bs, char **output, u32 *outSize);
+
+/*!
+ *	\brief buffer fetching without reallocation
+ *
+ *	Same as \ref gf_bs_get_content, but the internal buffer is not truncated to the written size, so that it can be reused 
+ *	later on (see \ref gf_bs_reassign_buffer).
+ *	\param bs the target bitstream
+ *	\param output address of a memory block to be allocated for bitstream data.
+ *	\param outSize set to the number of bytes written.
+ *	\param alloc_size set to the allocated size of the memory block. If NULL, this is the same as \ref gf_bs_get_content
+ */
+void gf_bs_get_content_no_truncate(GF_BitStream *bs, char **output, u32 *outSize, u32 *alloc_size);
+
+/*!
+ *	\brief buffer reassignment
+ *
+ *	Resets the bitstream to the start of a new buffer. For bitstreams created in write mode without a buffer, the buffer must be allocated
+ *	with gf_malloc and is owned by the bitstream until fetched again with \ref gf_bs_get_content_no_truncate; if NULL, an internal buffer is used.
+ *	This allows reusing the same memory for consecutive writes.
+ *	\param bs the target bitstream, in memory mode
+ *	\param buffer the new buffer
+ *	\param size the (allocated) size of the new buffer
+ *	\return error if any
+ */
+GF_Err gf_bs_reassign_buffer(GF_BitStream *bs, const char *buffer, u64 size);
 /*!
  *	\brief byte skipping
  *
@@ -487,6 +556,37 @@ u64 gf_bs_get_refreshed_size(GF_BitStream *bs);
  *\return error if any
  */
 GF_Err gf_bs_transfer(GF_BitStream *dst, GF_BitStream *src);
+
+/*!
+ *\brief written bits copy
+ *
+ *Copies bits already written in a memory bitstream, including the pending bits of the current byte.
+ *\param bs the target bitstream, in memory write mode
+ *\param bit_offset offset in bits, as returned by \ref gf_bs_get_bit_offset, of the first bit to copy
+ *\param nb_bits number of bits to copy
+ *\param output buffer receiving the bits, MSB first, of at least (nb_bits+7)/8 bytes. The unused bits of the last byte are set to 0
+ *\return error if any
+ */
+GF_Err gf_bs_copy_bits(GF_BitStream *bs, u32 bit_offset, u32 nb_bits, char *output);
+
+/*!
+ *\brief cookie assignment
+ *
+ *Attaches an opaque value to the bitstream, for use by the bitstream user (parsers, ...).
+ *\param bs the target bitstream
+ *\param cookie the new cookie value
+ *\return the previous cookie value
+ */
+u64 gf_bs_set_cookie(GF_BitStream *bs, u64 cookie);
+
+/*!
+ *\brief cookie query
+ *
+ *Returns the opaque value attached to the bitstream.
+ *\param bs the target bitstream
+ *\return the cookie value, 0 by default
+ */
+u64 gf_bs_get_cookie(GF_BitStream *bs);
 /*! @} */
 
 #ifdef __cplusplus
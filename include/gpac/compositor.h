@@ -115,6 +115,13 @@ GF_Err gf_sc_get_offscreen_buffer(GF_Compositor *sr, GF_VideoSurface *framebuffe
 /*releases screen buffer and unlocks graph*/
 GF_Err gf_sc_release_screen_buffer(GF_Compositor *sr, GF_VideoSurface *framebuffer);
 
+/*sets a caller-allocated buffer as the output of the compositor: frames are rendered directly in this buffer
+rather than in the video output backbuffer, and the output size is changed to the buffer size. The buffer shall stay 
+valid until the compositor is destroyed or another buffer is set. If @framebuffer is NULL, the video output is used again.
+Only supported with software 2D rendering and video outputs without hardware blitting (eg raw_out), GF_NOT_SUPPORTED
+is returned otherwise*/
+GF_Err gf_sc_set_output_buffer(GF_Compositor *sr, GF_VideoSurface *framebuffer);
+
 /*renders one frame*/
 void gf_sc_simulation_tick(GF_Compositor *sr);
 
@@ -169,6 +169,16 @@ u32 gf_cfg_get_key_count(GF_Config *cfgFile, const char *secName);
  *\return the key name if found, NULL otherwise
  */
 const char *gf_cfg_get_key_name(GF_Config *cfgFile, const char *secName, u32 keyIndex);
+/*!
+ *	\brief key value query by index
+ *
+ *Gets the value of a key in a section of the configuration file, without looking the key up by name
+ *\param cfgFile the target configuration file
+ *\param secName the target section
+ *\param keyIndex 0-based index of the key in the section
+ *\return the key value if found, NULL otherwise
+ */
+const char *gf_cfg_get_key_value(GF_Config *cfgFile, const char *secName, u32 keyIndex);
 
 /*!
  *	\brief key insertion
@@ -211,7 +221,7 @@ char * gf_cfg_get_filename(GF_Config *iniFile);
 /*!
  * Set the full filename associated with this config file
  * \param iniFile The Configuration
- * \param fileName new filename for the config
+ * \param fileName new filename for the config. If NULL, the config is no longer associated with a file and is never saved
  * \return erroro code
  */
 GF_Err gf_cfg_set_filename(GF_Config *iniFile, const char * fileName);
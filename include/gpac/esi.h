@@ -57,8 +57,17 @@ enum
 {
 	/*forces a data flush from interface to dest (caller) - used for non-threaded interfaces
 		corresponding parameter: unused
+	If the destination cannot accept more data for now, GF_BUFFER_TOO_SMALL is returned, the packet is
+	ignored and the parts of the AU already dispatched are discarded: the caller shall dispatch the whole AU 
+	again later on, or drop the remaining parts of the AU.
 	*/
-	GF_ESI_OUTPUT_DATA_DISPATCH
+	GF_ESI_OUTPUT_DATA_DISPATCH,
+	/*same as GF_ESI_OUTPUT_DATA_DISPATCH but the ownership of the packet data is given to the destination, 
+	which will call the packet release_data function (or gf_free if NULL) once done with the data. The data 
+	shall not be used by the caller after this call, unless GF_BUFFER_TOO_SMALL is returned.
+		corresponding parameter: pointer to the GF_ESIPacket
+	*/
+	GF_ESI_OUTPUT_DATA_TRANSFER
 };
 	
 /*
@@ -89,6 +98,10 @@ typedef struct __data_packet_ifce
 	u32 au_sn;
 	/*for packets using ISMACrypt/OMA/3GPP based crypto*/
 	u32 isma_bso;
+
+	/*data release function for GF_ESI_OUTPUT_DATA_TRANSFER, ignored otherwise. If NULL, data is freed with gf_free*/
+	void (*release_data)(void *release_udta, char *data);
+	void *release_udta;
 } GF_ESIPacket;
 
 struct __esi_video_info
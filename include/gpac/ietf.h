@@ -1280,6 +1280,9 @@ enum
 	GF_RTP_AVC_USE_ANNEX_B = (1<<8)
 };
 
+/*max number of dropped AU buffers kept for reuse*/
+#define GF_RTP_AU_POOL_SIZE	4
+
 /*
 		SL -> RTP packetization tool
 
@@ -1305,9 +1308,24 @@ struct __tag_rtp_depacketizer
 	GP_RTPSLMap sl_map;
 	u32 clock_rate;
 
-	/*inter-packet reconstruction bitstream (for 3GP text and H264)*/
+	/*inter-packet reconstruction bitstream (for 3GP text and DIMS)*/
 	GF_BitStream *inter_bs;
 
+	/*AU reconstruction buffer: holds the AU being reassembled in AU mode, followed by the H264 NAL being reassembled 
+	from FU-A packets (nal_size bytes)*/
+	char *au_data;
+	u32 au_size, au_alloc, nal_size;
+	/*allocated size of the last delivered AU, used to allocate the next one*/
+	u32 au_last_alloc;
+	/*AU mode callback and SL header of the current AU*/
+	void (*on_au)(void *udta, char *au, u32 size, u32 alloc_size, GF_SLHeader *hdr);
+	void *au_udta;
+	GF_SLHeader au_hdr;
+	/*dropped AU buffers given back by the user*/
+	char *au_pool[GF_RTP_AU_POOL_SIZE];
+	u32 au_pool_alloc[GF_RTP_AU_POOL_SIZE];
+	u32 nb_au_pool;
+
 	/*H264/AVC config*/
 	u32 h264_pck_mode;
 	
@@ -1327,6 +1345,16 @@ void gf_rtp_depacketizer_del(GF_RTPDepacketizer *rtp);
 void gf_rtp_depacketizer_reset(GF_RTPDepacketizer *rtp, Bool full_reset);
 void gf_rtp_depacketizer_process(GF_RTPDepacketizer *rtp, GF_RTPHeader *hdr, char *payload, u32 size);
 
+/*switches the depacketizer to AU mode: packet payloads are written directly in a single AU buffer and complete AUs are 
+delivered once through @on_au instead of the SL packet callback, using the same user data. The AU buffer is allocated 
+with gf_malloc, is @alloc_size bytes large and belongs to the user, which either keeps it (and frees it with gf_free) or,
+if it drops the AU, gives it back through gf_rtp_depacketizer_recycle_au. Delivered AUs are not recycled: each new AU
+buffer is allocated with the size of the previous one, so that reassembly usually needs a single allocation per AU.
+The SL header passed always has both AU start and end flags set*/
+void gf_rtp_depacketizer_set_au_callback(GF_RTPDepacketizer *rtp, void (*on_au)(void *udta, char *au, u32 size, u32 alloc_size, GF_SLHeader *hdr));
+/*gives back the buffer of a dropped AU for reuse - shall be called from the thread processing the RTP packets*/
+void gf_rtp_depacketizer_recycle_au(GF_RTPDepacketizer *rtp, char *au, u32 alloc_size);
+
 void gf_rtp_depacketizer_get_slconfig(GF_RTPDepacketizer *rtp, GF_SLConfig *sl);
 
 
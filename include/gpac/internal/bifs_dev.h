@@ -191,6 +191,19 @@ struct __tag_bifs_enc
 	/*keep track of DEF/USE*/
 	GF_List *encoded_nodes;
 	Bool is_encoding_command;
+
+	/*cache of encoded node subtrees (BIFSNodeCacheEntry), NULL if disabled*/
+	GF_List **node_cache;
+	u32 node_cache_max_size, node_cache_size;
+	/*number of nested node encodings being recorded*/
+	u32 node_cache_depth;
+	/*nodes encoded as USE while recording*/
+	GF_List *node_cache_uses;
+	/*set when the subtree being recorded cannot be cached*/
+	Bool node_cache_skip;
+
+	/*bitstream used by gf_bifs_encode_au_buffer, NULL until first used*/
+	GF_BitStream *au_bs;
 };
 
 GF_Err gf_bifs_enc_commands(GF_BifsEncoder *codec, GF_List *comList, GF_BitStream *bs);
@@ -202,6 +215,8 @@ GF_Err gf_bifs_enc_mf_field(GF_BifsEncoder *codec, GF_BitStream *bs, GF_Node *no
 GF_Err gf_bifs_enc_route(GF_BifsEncoder *codec, GF_Route *r, GF_BitStream *bs);
 void gf_bifs_enc_name(GF_BifsEncoder *codec, GF_BitStream *bs, char *name);
 GF_Node *gf_bifs_enc_find_node(GF_BifsEncoder *codec, u32 nodeID);
+/*destroys all cached node subtrees*/
+void gf_bifs_enc_node_cache_reset(GF_BifsEncoder *codec);
 
 #define GF_BIFS_WRITE_INT(codec, bs, val, nbBits, str, com)	{\
 		gf_bs_write_int(bs, val, nbBits);	\
@@ -330,6 +330,9 @@ struct __tag_compositor
 	Bool hw_locked;
 	/*screen buffer for direct access*/
 	GF_VideoSurface hw_surface;
+	/*caller-provided output buffer used instead of the video output backbuffer (offscreen rendering)*/
+	GF_VideoSurface ext_fb;
+	Bool use_ext_fb;
 	/*output buffer is configured in video memory*/
 	Bool video_memory, request_video_memory, was_system_memory;
 	/*indicate if overlays were prezsent in the previous frame*/
@@ -1275,6 +1278,8 @@ typedef struct __text_span
 
 GF_FontManager *gf_font_manager_new(GF_User *user);
 void gf_font_manager_del(GF_FontManager *fm);
+/*flushes the text layout and text texture caches*/
+void gf_font_manager_reset_cache(GF_FontManager *fm);
 
 GF_Font *gf_font_manager_set_font(GF_FontManager *fm, char **alt_fonts, u32 nb_fonts, u32 styles);
 GF_Font *gf_font_manager_set_font_ex(GF_FontManager *fm, char **alt_fonts, u32 nb_fonts, u32 styles, Bool check_only);
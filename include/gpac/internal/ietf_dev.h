@@ -55,19 +55,26 @@ typedef struct
 
 typedef struct __PRO_item
 {
-	struct __PRO_item *next;
 	u32 pck_seq_num;
 	void *pck;
+	/*packet size, 0 if no packet in this slot*/
 	u32 size;
+	/*allocated size of pck, kept from one packet to the next*/
+	u32 alloc_size;
 } GF_POItem;
 
 typedef struct __PO
 {
-	struct __PRO_item *in;
-	u32 head_seqnum;
+	/*circular buffer of packets indexed by seqnum modulo Capacity*/
+	GF_POItem *items;
+	u32 Capacity;
+	/*seqnum of the first packet to output and of the last packet in the queue*/
+	u32 head_seqnum, tail_seqnum;
+	/*seqnum of the last packet output, if any*/
+	u32 last_seqnum;
+	Bool has_output;
 	u32 Count;
 	u32 MaxCount;
-	u32 IsInit;
 	u32 MaxDelay, LastTime;
 } GF_RTPReorder;
 
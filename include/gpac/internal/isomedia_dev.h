@@ -57,6 +57,13 @@ This list is automatically taken into account during size() and write() function
 	u8 uuid[16];		\
 	u32 internal_4cc;		\
 
+/*sample table boxes (stts, ctts, stss, stsz/stz2, stco, co64) whose entries may be decoded on first access. 
+When lazy_bs is set, the entry table has not been decoded yet and is located at lazy_offset in lazy_bs*/
+#define GF_ISOM_LAZY_TABLE_BOX	\
+	GF_ISOM_FULL_BOX		\
+	GF_BitStream *lazy_bs;	\
+	u64 lazy_offset;		\
+
 typedef struct
 {
 	GF_ISOM_BOX
@@ -72,6 +79,14 @@ typedef struct
 	GF_ISOM_UUID_BOX
 } GF_UUIDBox;
 
+typedef struct
+{
+	GF_ISOM_LAZY_TABLE_BOX
+} GF_LazyTableBox;
+
+/*bitstream cookie set on the movie bitstream when sample tables shall not be decoded at parse time*/
+#define GF_ISOM_BS_COOKIE_LAZY_TABLES	1
+
 
 #define ISOM_DECL_BOX_ALLOC(__TYPE, __4cc)	__TYPE *tmp; \
 	GF_SAFEALLOC(tmp, __TYPE);	\
@@ -662,7 +677,7 @@ typedef struct
 
 typedef struct
 {
-	GF_ISOM_FULL_BOX
+	GF_ISOM_LAZY_TABLE_BOX
 	GF_SttsEntry *entries;
 	u32 nb_entries, alloc_size;
 
@@ -687,7 +702,7 @@ typedef struct
 
 typedef struct
 {
-	GF_ISOM_FULL_BOX
+	GF_ISOM_LAZY_TABLE_BOX
 	GF_DttsEntry *entries;
 	u32 nb_entries, alloc_size;
 
@@ -1019,7 +1034,7 @@ typedef struct
 
 typedef struct
 {
-	GF_ISOM_FULL_BOX
+	GF_ISOM_LAZY_TABLE_BOX
 	/*if this is the compact version, sample size is actually fieldSize*/
 	u32 sampleSize;
 	u32 sampleCount;
@@ -1029,7 +1044,7 @@ typedef struct
 
 typedef struct
 {
-	GF_ISOM_FULL_BOX
+	GF_ISOM_LAZY_TABLE_BOX
 	u32 nb_entries;
 	u32 alloc_size;
 	u32 *offsets;
@@ -1037,7 +1052,7 @@ typedef struct
 
 typedef struct 
 {
-	GF_ISOM_FULL_BOX
+	GF_ISOM_LAZY_TABLE_BOX
 	u32 nb_entries;
 	u32 alloc_size;
 	u64 *offsets;
@@ -1068,7 +1083,7 @@ typedef struct
 
 typedef struct
 {
-	GF_ISOM_FULL_BOX
+	GF_ISOM_LAZY_TABLE_BOX
 	u32 alloc_size, nb_entries;
 	u32 *sampleNumbers;
 	/*cache for READ mode (in write we realloc no matter what)*/
@@ -2333,6 +2348,14 @@ u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, char *buffer, u32 bufferLen
 #ifndef GPAC_DISABLE_ISOM_WRITE
 u64 gf_isom_datamap_get_offset(GF_DataMap *map);
 GF_Err gf_isom_datamap_add_data(GF_DataMap *ptr, char *data, u32 dataSize);
+/*flushes pending file writes, so that written data is visible to other readers of the file*/
+void gf_isom_datamap_flush(GF_DataMap *map);
+/*memory output data map (stream-less file data map on a memory file bitstream)*/
+GF_DataMap *gf_isom_fdm_new_mem();
+/*hands the content of a memory output bitstream to the user callback of the movie*/
+void gf_isom_send_mem_output(GF_ISOFile *movie, GF_BitStream *bs);
+/*same as above for a data map, does nothing if the map is not a memory output*/
+void gf_isom_datamap_send_mem_output(GF_ISOFile *movie, GF_DataMap *map);
 #endif	
 
 /*
@@ -2386,6 +2409,12 @@ struct __tag_isom {
 	GF_DataMap *editFileMap;
 	/*the interleaving time for dummy mode (in movie TimeScale)*/
 	u32 interleavingTime;
+	/*user callback for memory outputs*/
+	gf_isom_mem_output_callback on_mem_output;
+	void *mem_output_udta;
+	/*space reserved for the moov in capture mode, and offset of the free box holding it once written*/
+	u32 moov_reserved_size;
+	u64 moov_reserved_offset;
 #endif
 
 	u8 openMode;
@@ -2500,6 +2529,11 @@ u32 stbl_GetSampleFragmentSize(GF_SampleFragmentBox *stsf, u32 sampleNumber, u32
 GF_Err stbl_GetSampleDepType(GF_SampleDependencyTypeBox *stbl, u32 SampleNumber, u32 *dependsOn, u32 *dependedOn, u32 *redundant);
 
 
+/*decodes the entries of a sample table box parsed in lazy mode - does nothing if already decoded*/
+GF_Err gf_isom_box_unpack_lazy(GF_Box *a);
+/*decodes all lazy tables of the sample table*/
+GF_Err stbl_unpack_lazy_tables(GF_SampleTableBox *stbl);
+
 /*unpack sample2chunk and chunk offset so that we have 1 sample per chunk (edition mode only)*/
 GF_Err stbl_UnpackOffsets(GF_SampleTableBox *stbl);
 GF_Err SetTrackDuration(GF_TrackBox *trak);
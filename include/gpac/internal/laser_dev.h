@@ -95,6 +95,9 @@ struct __tag_laser_codec
 
 	char *cache_dir, *service_name;
 	GF_List *unresolved_commands;
+
+	/*encoder only: bitstream used by gf_laser_encode_au_buffer*/
+	GF_BitStream *au_bs;
 };
 
 s32 gf_lsr_anim_type_from_attribute(u32 tag);
@@ -133,6 +133,9 @@ typedef struct _nodepriv
 	
 	/*holder for all interactive stuff - THIS IS DYNAMICALLY CREATED*/
 	struct _node_interactive_ext *interact;
+
+	/*modification counter of the node subtree, see gf_node_get_modification_count*/
+	u32 modif_count;
 } NodePriv;
 
 
@@ -245,6 +248,13 @@ struct __tag_scene_graph
 	GF_Node *global_qp;
 #endif
 
+	/*set while the graph is being reset: parent lists are no longer valid and modification counts are not tracked*/
+	Bool in_reset;
+	/*set on the root graph once an encoder node cache is attached: node modification counts are only maintained in that case*/
+	Bool track_node_modifs;
+	/*modification counter of the root graph, cf gf_node_get_modification_count*/
+	u32 node_modif_count;
+
 
 #ifndef GPAC_DISABLE_SVG
 	/*use stack as used in the dom_fire_event - this is only valid during an event fire, and may be NULL*/
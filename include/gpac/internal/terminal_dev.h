@@ -608,6 +608,9 @@ struct _es_channel
 	/*Current reassembling buffer - currently packets are NOT reordered, only AUs are*/
 	char *buffer;
 	u32 len, allocSize;
+	/*complete AU given by the network service, used as reassembling buffer if possible*/
+	char *au_to_adopt;
+	u32 au_to_adopt_size;
 	/*only for last packet of an AU*/
 	u8 padingBits;
 	Bool IsEndOfStream;
@@ -700,6 +703,8 @@ GF_Err gf_es_start(GF_Channel *ch);
 GF_Err gf_es_stop(GF_Channel *ch);
 /*handles reception of an SL PDU*/
 void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *StreamBuf, u32 StreamLength, GF_SLHeader *header, GF_Err reception_status);
+/*handles reception of a complete AU allocated by the network service, which the channel owns after the call*/
+void gf_es_receive_sl_au(GF_ClientService *serv, GF_Channel *ch, char *au, u32 au_size, u32 alloc_size, GF_SLHeader *header, GF_Err reception_status);
 /*signals end of stream on the channel*/
 void gf_es_on_eos(GF_Channel *ch);
 /*fetches first AU available for decoding on this channel*/
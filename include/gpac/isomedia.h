@@ -67,6 +67,12 @@ enum
 	GF_ISOM_WRITE_EDIT,
 	/*Opens an existing file for fragment concatenation*/
 	GF_ISOM_OPEN_CAT_FRAGMENTS,
+
+	/*flag to combine with GF_ISOM_OPEN_READ or GF_ISOM_OPEN_READ_DUMP: the entries of the sample tables 
+	(stts, ctts, stss, stsz/stz2, stco/co64) are not decoded when opening the file but on first access to 
+	the track samples. This speeds up opening large files when only a few tracks or only the file 
+	structure are needed*/
+	GF_ISOM_OPEN_LAZY_TABLES = 0x100,
 };
 
 /*Movie Options for file writing*/
@@ -83,7 +89,10 @@ enum
 	GF_ISOM_STORE_DRIFT_INTERLEAVED,
 	/*tightly interleaves samples based on their DTS, therefore allowing better placement of samples in the file.
 	This is used for both http interleaving and Hinting optimizations*/
-	GF_ISOM_STORE_TIGHT
+	GF_ISOM_STORE_TIGHT,
+	/*FASTSTART: Same as STREAMABLE, but the media data is kept in its original order and copied as a single block, 
+	without going through each sample. If some samples were edited, STREAMABLE is used instead*/
+	GF_ISOM_STORE_FASTSTART
 
 };
 
@@ -350,6 +359,17 @@ only relies on the underlying OS fwrite/fgetc
 If movie is NULL, assigns the default write cache size for any new movie*/
 GF_Err gf_isom_set_output_buffering(GF_ISOFile *movie, u32 size);
 
+/*memory output: when used as file name for files created in GF_ISOM_OPEN_WRITE mode, as final name of edited files or as segment name 
+in gf_isom_start_segment, data is written to a growable memory buffer rather than to the file system*/
+#define GF_ISOM_MEM_OUTPUT	"gmem"
+
+/*callback receiving the content of a memory output once complete. The callback takes ownership of data and shall free it with gf_free*/
+typedef void (*gf_isom_mem_output_callback)(void *udta, char *data, u32 size);
+
+/*sets the callback for memory outputs of the file. A memory output is complete when the file is closed, or when a new segment 
+is started (the movie/init segment, then each media segment). Memory outputs completed while no callback is set are discarded*/
+GF_Err gf_isom_set_mem_output_callback(GF_ISOFile *movie, gf_isom_mem_output_callback on_output, void *udta);
+
 /********************************************************************
 				STREAMING API FUNCTIONS
 ********************************************************************/
@@ -869,6 +889,11 @@ GF_Err gf_isom_remove_sample(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNu
 /*changes media time scale - if force_rescale is 1, only the media timescale is changed but media times are not updated */
 GF_Err gf_isom_set_media_timescale(GF_ISOFile *the_file, u32 trackNumber, u32 new_timescale, Bool force_rescale);
 
+/*changes media time scale and retimes all samples already added to the track with a constant duration of sample_duration
+(expressed in new_timescale). Composition offsets are not modified. This is used by importers discovering the stream timing
+after the first samples have been written*/
+GF_Err gf_isom_set_media_timing(GF_ISOFile *the_file, u32 trackNumber, u32 new_timescale, u32 sample_duration);
+
 /*set the save file name of the (edited) movie. 
 If the movie is edited, the default fileName is avp_#openName)
 NOTE: you cannot save an edited file under the same name (overwrite not allowed)
@@ -880,6 +905,11 @@ GF_Err gf_isom_set_final_name(GF_ISOFile *the_file, char *filename);
 GF_Err gf_isom_set_storage_mode(GF_ISOFile *the_file, u8 storageMode);
 u8 gf_isom_get_storage_mode(GF_ISOFile *the_file);
 
+/*reserves size bytes (at least 8) for the moov box at the begining of a file created in GF_ISOM_OPEN_WRITE mode, through a free box 
+written before the media data. Must be called before any sample is added. When the file is closed, the moov box is written in this 
+space if it fits, making the file streamable without rewriting it; otherwise it is written at the end of the file as usual*/
+GF_Err gf_isom_reserve_moov_space(GF_ISOFile *the_file, u32 size);
+
 /*set the interleaving time of media data (INTERLEAVED mode only)
 InterleaveTime is in MovieTimeScale*/
 GF_Err gf_isom_set_interleave_time(GF_ISOFile *the_file, u32 InterleaveTime);
@@ -1211,7 +1241,8 @@ GF_Err gf_isom_set_traf_base_media_decode_time(GF_ISOFile *movie, u32 TrackID, u
 /*closes current segment - if fragments_per_sidx is <0, no sidx is used - if fragments_per_sidx is ==0, a single sidx is used*/
 GF_Err gf_isom_close_segment(GF_ISOFile *movie, s32 subsegs_per_sidx, u32 referenceTrackID, u64 ref_track_decode_time, u64 ref_track_next_cts, Bool daisy_chain_sidx, Bool last_segment, u32 segment_marker_4cc, u64 *index_start_range, u64 *index_end_range);
 
-/*writes any pending fragment to file for low-latency output. shall only be used if no SIDX is used (subsegs_per_sidx<0 or flushing all fragments before calling gf_isom_close_segment)*/
+/*writes any pending fragment to file for low-latency output and flushes the file, so that the segment can be read while being produced. 
+Shall only be used if no SIDX is used (subsegs_per_sidx<0 or flushing all fragments before calling gf_isom_close_segment)*/
 GF_Err gf_isom_flush_fragments(GF_ISOFile *movie, Bool last_segment);
 
 /*writes an empty sidx in the current movie. The SIDX will be forced to have nb_segs entries - nb_segs shall match the number of calls to
@@ -71,6 +71,9 @@ void gf_laser_encoder_del(GF_LASeRCodec *codec);
 GF_Err gf_laser_encoder_new_stream(GF_LASeRCodec *codec, u16 ESID, GF_LASERConfig *cfg);
 /*encodes a list of commands for the given stream in the output buffer - data is dynamically allocated for output*/
 GF_Err gf_laser_encode_au(GF_LASeRCodec *codec, u16 ESID, GF_List *command_list, Bool reset_encoding_context, char **out_data, u32 *out_data_length);
+/*same as above but encodes in the given buffer, reallocated (gf_realloc) if too small, so that the same memory can be used for
+all AUs. @buffer and @buffer_size are the buffer (may be NULL) and its allocated size, @out_data_length is set to the AU size*/
+GF_Err gf_laser_encode_au_buffer(GF_LASeRCodec *codec, u16 ESID, GF_List *command_list, Bool reset_encoding_context, char **buffer, u32 *buffer_size, u32 *out_data_length);
 /*returns encoded config desc*/
 GF_Err gf_laser_encoder_get_config(GF_LASeRCodec *codec, u16 ESID, char **out_data, u32 *out_data_length);
 
@@ -109,6 +109,10 @@ enum
 	THE RESULTING FILE IS NOT COMPLIANT*/
 	GF_IMPORT_FORCE_SYNC = 1<<16,
 
+	/*source is a pipe or a file still being written (raw AVC, HEVC, AAC, AC3 and MPEG-2 TS only): it is read once, forward only,
+	and samples are added as they arrive. Set automatically when the source name is "-" (standard input)*/
+	GF_IMPORT_STREAMING = 1<<17,
+
 	/*when set, only updates tracks info and return*/
 	GF_IMPORT_PROBE_ONLY	= 1<<20,
 	/*only set when probing, signals several frames per sample possible*/
@@ -293,16 +297,49 @@ typedef enum
 	GF_DASH_BSMODE_SINGLE
 } GF_DashSwitchingMode;
 
+/*DASH context, keeping the state of a live (or context-based) DASH session between successive calls to gf_dasher_segment_files.
+Per-representation counters are kept in a config structure, while the segment timeline and SegmentList entries are kept in memory
+as structured data, so that the cost of a new segment does not depend on the number of segments in the timeshift buffer. 
+The SegmentList entries are also kept serialized as written in the MPD and only updated for added and expired segments*/
+typedef struct __gf_dash_context GF_DASHContext;
+
+/*creates a new DASH context
+	@ctx_file: if set, the context is restored from this file if present (INI context or binary checkpoint, detected automatically) 
+and saved back to it when the context is destroyed. If NULL, the context is only kept in memory
+	@binary_checkpoint: if set, the context is saved as a compact binary checkpoint rather than as an INI file. Contexts 
+restored from a binary checkpoint are always saved as binary checkpoints
+*/
+GF_DASHContext *gf_dasher_context_new(const char *ctx_file, Bool binary_checkpoint);
+/*destroys the DASH context, saving it if created with a file, unless it was saved with gf_dasher_context_save and not modified since*/
+void gf_dasher_context_del(GF_DASHContext *dash_ctx);
+/*saves the DASH context to the given file - if binary_checkpoint is set, a compact binary checkpoint is written, otherwise an INI file*/
+GF_Err gf_dasher_context_save(GF_DASHContext *dash_ctx, const char *ctx_file, Bool binary_checkpoint);
+
+/*low-latency DASH callback, called each time a chunk (one or more moof+mdat) has been written and flushed to a media segment
+	@udta: user data passed to gf_dasher_segment_files
+	@segment_name: name of the file the chunk was written to
+	@chunk_offset, chunk_size: byte range of the chunk in this file. The size may be 0 for the last call of a segment
+	@segment_done: set if this chunk is the last one of the segment
+*/
+typedef void (*gf_dasher_chunk_callback)(void *udta, const char *segment_name, u64 chunk_offset, u64 chunk_size, Bool segment_done);
+
+/*DASH-ing of ISOBMFF and MPEG-2 TS files
+	@low_latency: if set, each fragment of a media segment is written to the segment file as soon as it is produced, and the MPD
+advertises segments as available once their first fragment is written (availabilityTimeOffset). SIDX boxes are not used in this mode, 
+since they would have to be written before the fragments they describe
+	@on_chunk, chunk_udta: optional callback notified of each chunk written in low-latency mode
+*/
 GF_Err gf_dasher_segment_files(const char *mpd_name, GF_DashSegmenterInput *inputs, u32 nb_inputs, GF_DashProfile profile, 
 							   const char *mpd_title, const char *mpd_source, const char *mpd_copyright,
 							   const char *mpd_moreInfoURL, const char **mpd_base_urls, u32 nb_mpd_base_urls, 
 							   Bool use_url_template, Bool use_segment_timeline,  Bool single_segment, Bool single_file, GF_DashSwitchingMode bitstream_switching_mode,
 							   Bool segments_start_with_rap, Double dash_duration_sec, char *seg_rad_name, char *seg_ext, u32 segment_marker_4cc,
 							   Double frag_duration_sec, s32 subsegs_per_sidx, Bool daisy_chain_sidx, Bool fragments_start_with_rap, const char *tmp_dir,  
-							   GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double subduration, Double min_buffer, u32 ast_shift_sec);
+							   GF_DASHContext *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double subduration, Double min_buffer, u32 ast_shift_sec,
+							   Bool low_latency, gf_dasher_chunk_callback on_chunk, void *chunk_udta);
 
 /*returns time to wait until end of currently generated segments*/
-u32 gf_dasher_next_update_time(GF_Config *dash_ctx, u32 mpd_update_time);
+u32 gf_dasher_next_update_time(GF_DASHContext *dash_ctx, u32 mpd_update_time);
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 
@@ -496,6 +496,9 @@ void gf_term_on_command(GF_ClientService *service, GF_NetworkCommand *com, GF_Er
 @reception_status: data reception status. To signal end of stream, set this to GF_EOS
 */
 void gf_term_on_sl_packet(GF_ClientService *service, LPNETCHANNEL ns, char *data, u32 data_size, GF_SLHeader *hdr, GF_Err reception_status);
+/*same as gf_term_on_sl_packet for a complete AU allocated with gf_malloc (alloc_size bytes), which the terminal owns after
+the call and uses as decoding buffer whenever possible*/
+void gf_term_on_sl_au(GF_ClientService *service, LPNETCHANNEL ns, char *au, u32 au_size, u32 alloc_size, GF_SLHeader *hdr, GF_Err reception_status);
 /*returns URL associated with service (so that you don't need to store it)*/
 const char *gf_term_get_service_url(GF_ClientService *service);
 
@@ -263,6 +263,42 @@ Bool gf_m2ts_probe_file(const char *fileName);
 */
 GF_Err gf_m2ts_restamp(char *buffer, u32 size, s64 ts_shift, u8 *is_pes);
 
+/*TS splicer: rewrites in place PIDs, continuity counters, PCR, PTS and DTS of whole TS packets so that 
+packets from several sources (ad insertion, channel stitching) form a single valid TS.
+Once created, the splicer never allocates memory while processing packets*/
+typedef struct __m2ts_splicer GF_M2TS_Splicer;
+
+/*splicer PID flags*/
+enum
+{
+	/*PTS and DTS of PES packets on this PID are shifted*/
+	GF_M2TS_SPLICE_PES = 1,
+	/*PID carries PAT or PMT sections in which remapped PIDs are rewritten (PAT is always set)*/
+	GF_M2TS_SPLICE_PSI = 1<<1,
+	/*packets on this PID are removed from the output*/
+	GF_M2TS_SPLICE_DROP = 1<<2,
+};
+
+GF_M2TS_Splicer *gf_m2ts_splicer_new();
+void gf_m2ts_splicer_del(GF_M2TS_Splicer *sp);
+/*sets output PID and GF_M2TS_SPLICE_* flags for packets of the given PID in the current source*/
+void gf_m2ts_splicer_set_pid(GF_M2TS_Splicer *sp, u16 pid, u16 out_pid, u32 flags);
+/*resets all PID settings, typically when switching to a new source. Continuity counters of output PIDs are kept*/
+void gf_m2ts_splicer_reset_pids(GF_M2TS_Splicer *sp);
+/*sets the timestamp shift in 90kHz applied to the current source*/
+void gf_m2ts_splicer_set_shift(GF_M2TS_Splicer *sp, s64 ts_shift);
+/*signals the next packet processed is the first one of a new source, and computes the timestamp shift so that 
+the source timeline continues the output one.
+@in_pcr: PCR in 27MHz of the new source at the splice point, as signaled by GF_M2TS_EVT_PES_PCR or GF_M2TS_PES::last_pcr_value. 
+Splice points are usually found on PES packets signaled with GF_M2TS_PES_PCK_RAP by the demuxer, the packet index in the source 
+being GF_M2TS_PES::pes_start_packet_number - 1. If 0, the shift is computed on the first PCR of the new source found in the 
+buffers passed to gf_m2ts_splicer_process. Until that PCR is found, possibly in a later call, packets of GF_M2TS_SPLICE_PES PIDs 
+are dropped, and output resumes on each of these PIDs with the next PES start.*/
+void gf_m2ts_splicer_splice(GF_M2TS_Splicer *sp, u64 in_pcr);
+/*processes all TS packets in the buffer. Dropped packets are removed from the buffer, and the resulting size is set in out_size.
+PIDs are only remapped in PAT and PMT sections contained in a single TS packet*/
+GF_Err gf_m2ts_splicer_process(GF_M2TS_Splicer *sp, char *buffer, u32 size, u32 *out_size);
+
 /*PES data framing modes*/
 enum
 {
@@ -944,6 +980,9 @@ typedef struct __m2ts_mux_pck
 	u32 data_len;
 	u32 flags;
 	u64 cts, dts;
+	/*data release for packets transfered by the input, NULL if data is to be freed with gf_free*/
+	void (*release_data)(void *release_udta, char *data);
+	void *release_udta;
 } GF_M2TS_Packet;
 
 
@@ -1004,11 +1043,16 @@ typedef struct __m2ts_mux_stream {
 	struct __elementary_stream_ifce *ifce;
 	Double ts_scale;
 
-	/*packet fifo*/
-	GF_M2TS_Packet *pck_first, *pck_last;
+	/*packet fifo: ring buffer written by the input only and read by the muxer only, so no lock is needed.
+	read and write indexes wrap around, queue size is a power of 2*/
+	GF_M2TS_Packet **pck_queue;
+	u32 pck_queue_size;
+	volatile u32 pck_queue_read, pck_queue_write;
 	/*packet reassembler (PES packets are most of the time full frames)*/
 	GF_M2TS_Packet *pck_reassembler;
-	GF_Mutex *mx;
+	/*unused packets given back by the muxer to the input, same ring buffer logic as the packet fifo*/
+	GF_M2TS_Packet **pck_pool;
+	volatile u32 pck_pool_read, pck_pool_write;
 	/*avg bitrate compute*/
 	u64 last_br_time;
 	u32 bytes_since_last_time, pes_since_last_time;
@@ -38,6 +38,8 @@ extern "C" {
 typedef struct __tag_scene_engine GF_SceneEngine;
 
 
+/*callback receiving the encoded AUs: @data belongs to the scene engine and is only valid during the callback
+(the same memory is reused for all AUs), it must be copied if needed afterwards*/
 typedef void (*gf_seng_callback)(void *udta, u16 ESID, char *data, u32 size, u64 ts);
 
 /**
@@ -168,6 +170,17 @@ GF_Err gf_seng_enable_aggregation(GF_SceneEngine *codec, u16 ESID, u16 onESID);
  */
 GF_Err gf_seng_aggregate_context(GF_SceneEngine *seng, u16 ESID);
 
+/**
+ * @seng, pointer to the GF_SceneEngine returned by gf_seng_init()
+ * @ESID, target stream, or 0 for all scene streams
+ * @AUCallback, pointer on a callback function to get the RAP of each stream
+ *
+ * sends the current RAP (first AU after aggregation) of the scene streams for carousel purposes.
+ * The RAP is only encoded once per aggregation: as long as no new commands are aggregated,
+ * the previously encoded AU is passed to the callback again
+ */
+GF_Err gf_seng_send_rap(GF_SceneEngine *seng, u16 ESID, gf_seng_callback callback);
+
 /**
  * @seng, pointer to the GF_SceneEngine returned by gf_seng_init()
  *
@@ -209,6 +209,10 @@ enum
 	GF_SM_LOAD_CONTEXT_STREAMING = 1<<3,
 	/*indicates that external resources in the content should be embedded as if possible*/
 	GF_SM_LOAD_EMBEDS_RES = 1<<4,
+	/*if set, BT/VRML/X3D/XMT files are loaded from a binary context cache in GPAC cache directory when 
+	available, and the cache is created once the file is completely loaded. Ignored for playback and 
+	when the context is not empty*/
+	GF_SM_LOAD_CONTEXT_CACHE = 1<<5,
 };
 
 /*loader type, usually detected based on file ext*/
@@ -269,6 +273,10 @@ struct __scene_loader
 	void (*done)(GF_SceneLoader *loader);
 	GF_Err (*parse_string)(GF_SceneLoader *loader, const char *str);
 	GF_Err (*suspend)(GF_SceneLoader *loader, Bool suspend);
+
+	/*private to context cache*/
+	char *cache_name;
+	Bool from_cache;
 };
 
 /*initializes the context loader - this will load any IOD and the first frame of the main scene*/
@@ -289,6 +297,12 @@ to clean ressources (needed for SAX progressive loading)
 */
 GF_Err gf_sm_load_string(GF_SceneLoader *load, const char *str, Bool clean_at_end);
 
+/*saves the context in a binary cache file, to be reloaded by the same GPAC build. Only VRML/MPEG-4/X3D 
+contexts are supported, GF_NOT_SUPPORTED is returned otherwise (SVG/LASeR, unknown GPAC internal descriptors...)*/
+GF_Err gf_sm_save_context_cache(GF_SceneManager *ctx, const char *cache_file);
+/*loads a context cache file - the context and its scene graph MUST be empty. On error the context is reset*/
+GF_Err gf_sm_load_context_cache(GF_SceneManager *ctx, const char *cache_file);
+
 #ifndef GPAC_DISABLE_SCENE_ENCODER
 
 /*encoding flags*/
@@ -211,6 +211,12 @@ GF_Err gf_node_replace(GF_Node *old_node, GF_Node *new_node, Bool updateOrderedG
 /*returns number of instances for this node*/
 u32 gf_node_get_num_instances(GF_Node *node);
 
+/*returns the modification count of the node. This count changes whenever the node, its DEF ID or any node below it
+is modified through gf_node_changed, and a new node never gets the count of a destroyed one, so that (node, count) 
+can be used to identify the state of a subtree. Counts are only maintained once an encoder node cache is attached to the 
+root scene graph (cf gf_bifs_encoder_set_node_cache), and are 0 otherwise*/
+u32 gf_node_get_modification_count(GF_Node *node);
+
 
 /*calls node traverse callback routine on this node*/
 void gf_node_traverse(GF_Node *node, void *udta);
@@ -150,6 +150,14 @@ NOTE: This can only be used when the terminal runs without visual thread (GF_TER
 */
 GF_Err gf_term_process_flush(GF_Terminal *term);
 
+/*renders next frame in non real-time mode: scene clocks are advanced by exactly @ms_diff milliseconds, pending media
+is decoded and the frame is composed before returning, regardless of the scene frame rate. For frame-accurate stepping
+at non-integer frame rates, compute @ms_diff from the frame index rather than accumulating a rounded frame duration.
+NOTE: This can only be used when the terminal runs without compositor thread (GF_TERM_NO_COMPOSITOR_THREAD flag set) 
+and the scene has been connected in paused mode (cf gf_term_connect_from_time)
+*/
+GF_Err gf_term_step_frame(GF_Terminal *term, u32 ms_diff);
+
 /*post user interaction to terminal*/
 /*NOT NEEDED WHEN THE TERMINAL IS HANDLING THE DISPLAY WINDOW (cf user.h)*/
 Bool gf_term_user_event(GF_Terminal *term, GF_Event *event);
@@ -279,6 +279,14 @@ void gf_sema_wait(GF_Semaphore *sm);
 */
 Bool gf_sema_wait_for(GF_Semaphore *sm, u32 time_out);
 
+/*
+ *\brief memory barrier
+ *
+ *Makes sure all memory accesses issued before the call are performed before any memory access issued after the call. This is
+ *needed by lock-free structures shared between two threads, such as single producer / single consumer queues.
+*/
+void gf_th_memory_barrier();
+
 /*! @} */
 
 #ifdef __cplusplus
@@ -8,6 +8,7 @@ struct avr_ts_muxer {
     GF_ESInterface * video, * audio;
     u64 frameTimeSentOverTS;
     GF_Socket * ts_output_udp_sk;
+    u32 nb_dropped_audio;
 };
 
 /*!
@@ -57,7 +58,14 @@ Bool ts_encode_audio_frame(GF_AbstractTSMuxer * ts, AVFrame * encodedFrame, uint
     ts->audioCurrentTSPacket.flags = GF_ESI_DATA_AU_START|GF_ESI_DATA_AU_END | GF_ESI_DATA_HAS_CTS | GF_ESI_DATA_HAS_DTS;
     //avr->audioCurrentTSPacket.cts = avr->audioCurrentTSPacket.dts = myTime;
     ts->videoCurrentTSPacket.dts = ts->videoCurrentTSPacket.cts = gf_m2ts_get_sys_clock(ts->muxer);
-    ts->audio->output_ctrl(ts->audio, GF_ESI_OUTPUT_DATA_DISPATCH, &(ts->audioCurrentTSPacket));
+    if (ts->audio->output_ctrl(ts->audio, GF_ESI_OUTPUT_DATA_DISPATCH, &(ts->audioCurrentTSPacket)) == GF_BUFFER_TOO_SMALL) {
+        /*muxer queue is full, send what can be sent and retry once*/
+        sendTSMux(ts);
+        if (ts->audio->output_ctrl(ts->audio, GF_ESI_OUTPUT_DATA_DISPATCH, &(ts->audioCurrentTSPacket)) == GF_BUFFER_TOO_SMALL) {
+            ts->nb_dropped_audio++;
+            GF_LOG(GF_LOG_WARNING, GF_LOG_MODULE, ("[AVRedirect] TS muxer queue full, dropping audio frame (%u frames dropped)\n", ts->nb_dropped_audio));
+        }
+    }
     return 0;
 }
 
@@ -75,7 +83,11 @@ static GF_Err void_input_ctrl(GF_ESInterface *ifce, u32 act_type, void *param)
                 gf_mx_p(ts->encodingMutex);
                 if (ts->frameTimeEncoded > ts->frameTimeSentOverTS) {
                     //fprintf(stderr, "Data PULL, avr=%p, avr->video=%p, encoded="LLU", sent over TS="LLU"\n", avr, &avr->video, avr->frameTimeEncoded, avr->frameTimeSentOverTS);
-                    ts->video->output_ctrl( ts->video, GF_ESI_OUTPUT_DATA_DISPATCH, &(ts->videoCurrentTSPacket));
+                    //muxer queue full, the frame is sent on the next pull
+                    if (ts->video->output_ctrl( ts->video, GF_ESI_OUTPUT_DATA_DISPATCH, &(ts->videoCurrentTSPacket)) != GF_OK) {
+                        gf_mx_v(avr->encodingMutex);
+                        break;
+                    }
                     ts->frameTimeSentOverTS = ts->frameTime;
                 } else {
                     //fprintf(stderr, "Data PULL IGNORED : encoded = "LLU", sent on TS="LLU"\n", avr->frameTimeEncoded, avr->frameTimeSentOverTS);
@@ -114,6 +126,7 @@ GF_AbstractTSMuxer * ts_amux_new(GF_AVRedirect * avr, u32 videoBitrateInBitsPerS
     GF_AbstractTSMuxer * ts = malloc(sizeof(GF_AbstractTSMuxer));
     ts->muxer = gf_m2ts_mux_new ( videoBitrateInBitsPerSec * audioBitRateInBitsPerSec + 1000000, 0, 1 );
     ts->ts_output_udp_sk = ts_output_udp_sk;
+    ts->nb_dropped_audio = 0;
     {
         //u32 cur_pid = 100;	/*PIDs start from 100*/
         GF_M2TS_Mux_Program *program = gf_m2ts_mux_program_add ( ts->muxer, 1, 100, 0, 0 );
@@ -135,6 +135,29 @@ static void rtp_sl_packet_cbk(void *udta, char *payload, u32 size, GF_SLHeader *
 	hdr->decodingTimeStamp = dts;
 }
 
+/*complete AUs reassembled by the depacketizer, given to the terminal without copy*/
+static void rtp_au_cbk(void *udta, char *au, u32 size, u32 alloc_size, GF_SLHeader *hdr)
+{
+	GF_Err e = GF_OK;
+	RTPStream *ch = (RTPStream *)udta;
+
+	if (!ch->rtcp_init) {
+		gf_rtp_depacketizer_recycle_au(ch->depacketizer, au, alloc_size);
+		return;
+	}
+	if (ch->owner->first_packet_drop && (hdr->packetSequenceNumber >= ch->owner->first_packet_drop) ) {
+		if ( !((hdr->packetSequenceNumber - ch->owner->first_packet_drop) % ch->owner->frequency_drop)) {
+			gf_rtp_depacketizer_recycle_au(ch->depacketizer, au, alloc_size);
+			return;
+		}
+	}
+	hdr->compositionTimeStamp += ch->ts_offset;
+	hdr->decodingTimeStamp += ch->ts_offset;
+	if (ch->rtp_ch->packet_loss) e = GF_REMOTE_SERVICE_ERROR;
+
+	gf_term_on_sl_au(ch->owner->service, ch->channel, au, size, alloc_size, hdr, e);
+}
+
 
 RTPStream *RP_NewStream(RTPClient *rtp, GF_SDPMedia *media, GF_SDPInfo *sdp, RTPStream *input_stream)
 {
@@ -275,6 +298,9 @@ RTPStream *RP_NewStream(RTPClient *rtp, GF_SDPMedia *media, GF_SDPInfo *sdp, RTP
 		RP_DeleteStream(tmp);
 		return NULL;
 	}
+	/*reassemble AVC AUs in the depacketizer, avoiding a copy for each NAL in the terminal*/
+	if (tmp->depacketizer->payt==GF_RTP_PAYT_H264_AVC)
+		gf_rtp_depacketizer_set_au_callback(tmp->depacketizer, rtp_au_cbk);
 	/*setup channel*/
 	gf_rtp_setup_payload(tmp->rtp_ch, map);
 
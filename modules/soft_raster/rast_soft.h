@@ -29,6 +29,7 @@
 #define _RAST_SOFT_H_
 
 #include <gpac/modules/raster2d.h>
+#include <gpac/thread.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -114,6 +115,22 @@ EVG_Raster evg_raster_new();
 void evg_raster_del(EVG_Raster raster);
 int evg_raster_render(EVG_Raster raster, EVG_Raster_Params *params);
 
+/*minimum number of scanlines per band when filling with several threads*/
+#define EVG_BAND_MIN_HEIGHT	32
+/*maximum number of threads used for a fill*/
+#define EVG_MAX_THREADS	16
+
+/*band worker: rasterizes the part of the outline falling in its clip band with its own raster state*/
+typedef struct
+{
+	EVGSurface *surf;
+	GF_Thread *th;
+	GF_Semaphore *sema_start;
+	EVG_Raster raster;
+	EVG_Raster_Params ftparams;
+	Bool stop;
+} EVGBandWorker;
+
 /*the surface object - currently only ARGB/RGB32, RGB/BGR and RGB555/RGB565 supported*/
 struct _evg_surface
 {
@@ -169,6 +186,13 @@ struct _evg_surface
 	EVG_Outline ftoutline;
 	EVG_Raster_Params ftparams;
 
+	/*number of threads allowed for band-parallel fills (0/1: disabled)*/
+	u32 nb_threads;
+	/*band workers, created on first parallel fill*/
+	EVGBandWorker *workers;
+	u32 nb_workers;
+	GF_Semaphore *sema_done;
+
 #ifndef INLINE_POINT_CONVERSION
 	/*transformed point list*/
 	u32 pointlen;
@@ -41,15 +41,89 @@ GF_SURFACE evg_surface_new(GF_Raster2D *_dr, Bool center_coords)
 	EVGSurface *_this;
 	GF_SAFEALLOC(_this, EVGSurface);
 	if (_this) {
+		const char *opt;
 		_this->center_coords = center_coords;
 		_this->texture_filter = GF_TEXTURE_FILTER_DEFAULT;
 		_this->ftparams.source = &_this->ftoutline;
 		_this->ftparams.user = _this;
 		_this->raster = evg_raster_new();
+
+		/*band-parallel filling, threads are only created when a large enough fill happens*/
+		opt = gf_modules_get_option((GF_BaseInterface *)_dr, "Compositor", "RasterThreads");
+		if (opt) _this->nb_threads = atoi(opt);
 	}
 	return _this;
 }
 
+static u32 evg_band_worker_run(void *par)
+{
+	EVGBandWorker *w = (EVGBandWorker *)par;
+	while (1) {
+		gf_sema_wait(w->sema_start);
+		if (w->stop) break;
+		evg_raster_render(w->raster, &w->ftparams);
+		gf_sema_notify(w->surf->sema_done, 1);
+	}
+	return 0;
+}
+
+static void evg_surface_del_workers(EVGSurface *surf)
+{
+	u32 i;
+	for (i=0; i<surf->nb_workers; i++) {
+		EVGBandWorker *w = &surf->workers[i];
+		w->stop = 1;
+		gf_sema_notify(w->sema_start, 1);
+		gf_th_del(w->th);
+		gf_sema_del(w->sema_start);
+		evg_raster_del(w->raster);
+	}
+	if (surf->workers) gf_free(surf->workers);
+	surf->workers = NULL;
+	surf->nb_workers = 0;
+	if (surf->sema_done) gf_sema_del(surf->sema_done);
+	surf->sema_done = NULL;
+}
+
+static Bool evg_surface_setup_workers(EVGSurface *surf)
+{
+	u32 i, count;
+	if (surf->nb_workers) return 1;
+
+	if (surf->nb_threads > EVG_MAX_THREADS) surf->nb_threads = EVG_MAX_THREADS;
+	count = surf->nb_threads - 1;
+	surf->workers = (EVGBandWorker *) gf_malloc(sizeof(EVGBandWorker) * count);
+	if (!surf->workers) {
+		surf->nb_threads = 0;
+		return 0;
+	}
+	memset(surf->workers, 0, sizeof(EVGBandWorker) * count);
+	surf->sema_done = gf_sema_new(count, 0);
+
+	for (i=0; i<count; i++) {
+		EVGBandWorker *w = &surf->workers[i];
+		w->surf = surf;
+		w->raster = evg_raster_new();
+		w->sema_start = gf_sema_new(1, 0);
+		w->th = gf_th_new("EVGBand");
+		if (!w->raster || !w->sema_start || !w->th || (gf_th_run(w->th, evg_band_worker_run, w) != GF_OK)) {
+			if (w->th) gf_th_del(w->th);
+			if (w->sema_start) gf_sema_del(w->sema_start);
+			if (w->raster) evg_raster_del(w->raster);
+			break;
+		}
+		surf->nb_workers++;
+	}
+	if (!surf->nb_workers) {
+		evg_surface_del_workers(surf);
+		GF_LOG(GF_LOG_WARNING, GF_LOG_COMPOSE, ("[EVG] Cannot create raster threads, using single-threaded fill\n"));
+		surf->nb_threads = 0;
+		return 0;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_COMPOSE, ("[EVG] Using %d threads for surface fill\n", surf->nb_workers+1));
+	return 1;
+}
+
 void evg_surface_delete(GF_SURFACE _this)
 {
 	EVGSurface *surf = (EVGSurface *)_this;
@@ -61,6 +135,7 @@ void evg_surface_delete(GF_SURFACE _this)
 #endif
 	if (surf->stencil_pix_run) gf_free(surf->stencil_pix_run);
 	surf->stencil_pix_run = NULL;
+	evg_surface_del_workers(surf);
 	if (surf->raster) evg_raster_del(surf->raster);
 	surf->raster = NULL;
 	gf_free(surf);
@@ -550,6 +625,45 @@ GF_Err evg_surface_set_path(GF_SURFACE _this, GF_Path *gp)
 	return GF_OK;
 }
 
+/*splits the clip area in horizontal bands rasterized in parallel. Only used for solid fills on
+memory surfaces: the span callbacks then only read the surface, and each band writes its own scanlines.
+Variable stencils keep per-run state in the stencil and are always filled from the calling thread*/
+static Bool evg_surface_fill_bands(EVGSurface *surf)
+{
+	u32 i, nb_bands, height;
+	s32 y, band_h;
+	EVG_Raster_Params params;
+
+	if (surf->nb_threads<2) return 0;
+	if (surf->raster_cbk || (surf->sten->type != GF_STENCIL_SOLID)) return 0;
+
+	height = surf->ftparams.clip_yMax - surf->ftparams.clip_yMin;
+	nb_bands = height / EVG_BAND_MIN_HEIGHT;
+	if (nb_bands<2) return 0;
+	if (!evg_surface_setup_workers(surf)) return 0;
+	if (nb_bands > surf->nb_workers + 1) nb_bands = surf->nb_workers + 1;
+
+	band_h = height / nb_bands;
+	y = surf->ftparams.clip_yMin;
+	for (i=0; i<nb_bands-1; i++) {
+		EVGBandWorker *w = &surf->workers[i];
+		w->ftparams = surf->ftparams;
+		w->ftparams.clip_yMin = y;
+		w->ftparams.clip_yMax = y + band_h;
+		y += band_h;
+		gf_sema_notify(w->sema_start, 1);
+	}
+	/*last band is done by the calling thread*/
+	params = surf->ftparams;
+	params.clip_yMin = y;
+	evg_raster_render(surf->raster, &params);
+
+	for (i=0; i<nb_bands-1; i++) {
+		gf_sema_wait(surf->sema_done);
+	}
+	return 1;
+}
+
 /* static void gray_spans_stub(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf){} */
 
 GF_Err evg_surface_fill(GF_SURFACE _this, GF_STENCIL stencil)
@@ -646,7 +760,8 @@ GF_Err evg_surface_fill(GF_SURFACE _this, GF_STENCIL stencil)
 	}
 
 	/*and call the raster*/
-	evg_raster_render(surf->raster, &surf->ftparams);
+	if (!evg_surface_fill_bands(surf))
+		evg_raster_render(surf->raster, &surf->ftparams);
 
 	/*restore stencil matrix*/
 	if (sten->type != GF_STENCIL_SOLID) {
@@ -327,6 +327,8 @@ void gf_bifs_encoder_del(GF_BifsEncoder *codec)
 	}
 	gf_list_del(codec->streamInfo);
 	gf_list_del(codec->encoded_nodes);
+	gf_bifs_encoder_set_node_cache(codec, 0);
+	if (codec->au_bs) gf_bs_del(codec->au_bs);
 //	gf_mx_del(codec->mx);
 	gf_free(codec);
 }
@@ -403,6 +405,33 @@ GF_Err gf_bifs_encode_au(GF_BifsEncoder *codec, u16 ESID, GF_List *command_list,
 	return e;
 }
 
+GF_EXPORT
+GF_Err gf_bifs_encode_au_buffer(GF_BifsEncoder *codec, u16 ESID, GF_List *command_list, char **buffer, u32 *buffer_size, u32 *out_data_length)
+{
+	GF_Err e;
+
+	if (!codec || !command_list || !buffer || !buffer_size || !out_data_length) return GF_BAD_PARAM;
+
+	codec->info = BE_GetStream(codec, ESID);
+	if (!codec->info) return GF_BAD_PARAM;
+
+	if (!codec->au_bs) {
+		codec->au_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+		if (!codec->au_bs) return GF_OUT_OF_MEM;
+	}
+	/*the bitstream takes the caller buffer and grows it if needed*/
+	e = gf_bs_reassign_buffer(codec->au_bs, *buffer, *buffer ? *buffer_size : 0);
+	if (e) return e;
+
+	if (codec->info->config.elementaryMasks) {
+		e = GF_NOT_SUPPORTED;
+	} else {
+		e = gf_bifs_enc_commands(codec, command_list, codec->au_bs);
+	}
+	gf_bs_get_content_no_truncate(codec->au_bs, buffer, out_data_length, buffer_size);
+	return e;
+}
+
 GF_EXPORT
 GF_Err gf_bifs_encoder_get_config(GF_BifsEncoder *codec, u16 ESID, char **out_data, u32 *out_data_length)
 {
@@ -177,7 +177,10 @@ GF_Err gf_bifs_enc_sf_field(GF_BifsEncoder *codec, GF_BitStream *bs, GF_Node *no
 		cb->bufferSize = 0;
 		if (gf_list_count(cb->commandList)) {
 			u32 i, nbBits;
-			GF_BitStream *bs_cond = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+			GF_BitStream *bs_cond;
+			/*commands may depend on the encoder state, don't cache the node*/
+			if (codec->node_cache_depth) codec->node_cache_skip = 1;
+			bs_cond = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CODING, ("[BIFS] /*SFCommandBuffer*/\n" ));
 			e = gf_bifs_enc_commands(codec, cb->commandList, bs_cond);
 			if (!e) gf_bs_get_content(bs_cond, (char**)&cb->buffer, &cb->bufferSize);
@@ -528,13 +531,16 @@ Bool BE_NodeIsUSE(GF_BifsEncoder * codec, GF_Node *node)
 	if (!node || !gf_node_get_id(node) ) return 0;
 	count = gf_list_count(codec->encoded_nodes);
 	for (i=0; i<count; i++) {
-		if (gf_list_get(codec->encoded_nodes, i) == node) return 1;
+		if (gf_list_get(codec->encoded_nodes, i) == node) {
+			if (codec->node_cache_depth) gf_list_add(codec->node_cache_uses, node);
+			return 1;
+		}
 	}
 	gf_list_add(codec->encoded_nodes, node);
 	return 0;
 }
 
-GF_Err gf_bifs_enc_node(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_BitStream *bs)
+static GF_Err BE_EncodeNode(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_BitStream *bs)
 {
 	u32 NDTBits, node_type, node_tag, BVersion, node_id;
 	const char *node_name;
@@ -636,5 +642,234 @@ GF_Err gf_bifs_enc_node(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_B
 	return GF_OK;
 }
 
+/*node cache*/
+#define BIFS_NODE_CACHE_HASH_SIZE	256
+/*below this size, encoding the node is cheaper than checking the cache*/
+#define BIFS_NODE_CACHE_MIN_BITS	256
+
+typedef struct
+{
+	GF_Node *node;
+	u32 modif_count, NDT_Tag;
+	/*encoder state when the node was encoded - the node is only reused in the same state*/
+	BIFSStreamInfo *info;
+	Bool use_names, is_encoding_command;
+	M_QuantizationParameter *qp;
+	u32 qp_modif_count, nb_qps;
+	u32 num_coord;
+	Bool coord_stored, storing_coord;
+	/*nodes DEF'd in the subtree, and nodes the subtree USEs*/
+	GF_List *def_nodes, *use_nodes;
+	char *data;
+	u32 nb_bits;
+} BIFSNodeCacheEntry;
+
+#define BE_NODE_CACHE_BUCKET(_node)	((u32) ((PTR_TO_U_CAST (_node)) >> 4) % BIFS_NODE_CACHE_HASH_SIZE)
+
+static void BE_NodeCacheEntryDel(BIFSNodeCacheEntry *ent)
+{
+	gf_list_del(ent->def_nodes);
+	gf_list_del(ent->use_nodes);
+	if (ent->data) gf_free(ent->data);
+	gf_free(ent);
+}
+
+void gf_bifs_enc_node_cache_reset(GF_BifsEncoder *codec)
+{
+	u32 i;
+	if (!codec->node_cache) return;
+	for (i=0; i<BIFS_NODE_CACHE_HASH_SIZE; i++) {
+		GF_List *bucket = codec->node_cache[i];
+		if (!bucket) continue;
+		while (gf_list_count(bucket)) {
+			BIFSNodeCacheEntry *ent = (BIFSNodeCacheEntry *)gf_list_last(bucket);
+			gf_list_rem_last(bucket);
+			BE_NodeCacheEntryDel(ent);
+		}
+	}
+	codec->node_cache_size = 0;
+}
+
+GF_EXPORT
+GF_Err gf_bifs_encoder_set_node_cache(GF_BifsEncoder *codec, u32 max_size)
+{
+	u32 i;
+	if (!codec) return GF_BAD_PARAM;
+	gf_bifs_enc_node_cache_reset(codec);
+	if (!max_size) {
+		if (codec->node_cache) {
+			for (i=0; i<BIFS_NODE_CACHE_HASH_SIZE; i++) {
+				if (codec->node_cache[i]) gf_list_del(codec->node_cache[i]);
+			}
+			gf_free(codec->node_cache);
+			codec->node_cache = NULL;
+		}
+		if (codec->node_cache_uses) gf_list_del(codec->node_cache_uses);
+		codec->node_cache_uses = NULL;
+	} else {
+		GF_SceneGraph *sg = codec->scene_graph;
+		/*node modification counts are maintained from now on, for the lifetime of the graph*/
+		while (sg && sg->parent_scene) sg = sg->parent_scene;
+		if (sg) sg->track_node_modifs = 1;
+		if (!codec->node_cache) {
+			codec->node_cache = (GF_List **)gf_malloc(sizeof(GF_List *) * BIFS_NODE_CACHE_HASH_SIZE);
+			memset(codec->node_cache, 0, sizeof(GF_List *) * BIFS_NODE_CACHE_HASH_SIZE);
+		}
+		if (!codec->node_cache_uses) codec->node_cache_uses = gf_list_new();
+	}
+	codec->node_cache_max_size = max_size;
+	return GF_OK;
+}
+
+static BIFSNodeCacheEntry *BE_NodeCacheFind(GF_BifsEncoder *codec, GF_Node *node, u32 NDT_Tag)
+{
+	u32 i=0;
+	BIFSNodeCacheEntry *ent;
+	GF_List *bucket = codec->node_cache[BE_NODE_CACHE_BUCKET(node)];
+	if (!bucket) return NULL;
+	while ((ent = (BIFSNodeCacheEntry *)gf_list_enum(bucket, &i))) {
+		if ((ent->node==node) && (ent->NDT_Tag==NDT_Tag)) return ent;
+	}
+	return NULL;
+}
+
+static Bool BE_NodeCacheMatch(GF_BifsEncoder *codec, BIFSNodeCacheEntry *ent)
+{
+	u32 i;
+	GF_Node *n;
+	if (ent->modif_count != gf_node_get_modification_count(ent->node)) return 0;
+	if (ent->info != codec->info) return 0;
+	if (ent->use_names != codec->UseName) return 0;
+	if (ent->is_encoding_command != codec->is_encoding_command) return 0;
+	if (ent->qp != codec->ActiveQP) return 0;
+	if (ent->qp && (ent->qp_modif_count != gf_node_get_modification_count((GF_Node *)ent->qp))) return 0;
+	if (ent->nb_qps != gf_list_count(codec->QPs)) return 0;
+	if (ent->num_coord != codec->NumCoord) return 0;
+	if (ent->coord_stored != codec->coord_stored) return 0;
+	if (ent->storing_coord != codec->storing_coord) return 0;
+	/*DEF/USE must resolve the same way*/
+	i=0;
+	while ((n = (GF_Node *)gf_list_enum(ent->def_nodes, &i))) {
+		if (gf_list_find(codec->encoded_nodes, n) >= 0) return 0;
+	}
+	i=0;
+	while ((n = (GF_Node *)gf_list_enum(ent->use_nodes, &i))) {
+		if (gf_list_find(codec->encoded_nodes, n) < 0) return 0;
+	}
+	return 1;
+}
+
+static void BE_NodeCacheWrite(GF_BifsEncoder *codec, BIFSNodeCacheEntry *ent, GF_BitStream *bs)
+{
+	u32 i, nb_bytes, nb_bits;
+	GF_Node *n;
+
+	i=0;
+	while ((n = (GF_Node *)gf_list_enum(ent->def_nodes, &i))) {
+		gf_list_add(codec->encoded_nodes, n);
+	}
+	if (codec->node_cache_depth) {
+		i=0;
+		while ((n = (GF_Node *)gf_list_enum(ent->use_nodes, &i))) {
+			gf_list_add(codec->node_cache_uses, n);
+		}
+	}
+	nb_bytes = ent->nb_bits / 8;
+	nb_bits = ent->nb_bits % 8;
+	if (nb_bytes) gf_bs_write_data(bs, ent->data, nb_bytes);
+	if (nb_bits) gf_bs_write_int(bs, ((u8) ent->data[nb_bytes]) >> (8 - nb_bits), nb_bits);
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CODING, ("[BIFS] Node %s written from cache (%d bits)\n", gf_node_get_class_name(ent->node), ent->nb_bits));
+}
+
+GF_Err gf_bifs_enc_node(GF_BifsEncoder * codec, GF_Node *node, u32 NDT_Tag, GF_BitStream *bs)
+{
+	GF_Err e;
+	BIFSNodeCacheEntry *ent;
+	M_QuantizationParameter *qp;
+	u32 i, size, start_bit, nb_bits, nb_defs, nb_uses, nb_qps, num_coord;
+	Bool prev_skip, coord_stored, storing_coord;
+
+	/*no cache, NULL node, USE or proto encoding*/
+	if (!codec->node_cache || !node || codec->encoding_proto || codec->current_proto_graph
+		|| (gf_node_get_id(node) && (gf_list_find(codec->encoded_nodes, node)>=0)) ) {
+		return BE_EncodeNode(codec, node, NDT_Tag, bs);
+	}
+
+	ent = BE_NodeCacheFind(codec, node, NDT_Tag);
+	if (ent && BE_NodeCacheMatch(codec, ent)) {
+		BE_NodeCacheWrite(codec, ent, bs);
+		return GF_OK;
+	}
+
+	/*encode and record the node*/
+	start_bit = gf_bs_get_bit_offset(bs);
+	nb_defs = gf_list_count(codec->encoded_nodes);
+	nb_uses = gf_list_count(codec->node_cache_uses);
+	qp = codec->ActiveQP;
+	nb_qps = gf_list_count(codec->QPs);
+	num_coord = codec->NumCoord;
+	coord_stored = codec->coord_stored;
+	storing_coord = codec->storing_coord;
+	prev_skip = codec->node_cache_skip;
+	codec->node_cache_skip = 0;
+
+	codec->node_cache_depth++;
+	e = BE_EncodeNode(codec, node, NDT_Tag, bs);
+	codec->node_cache_depth--;
+
+	nb_bits = gf_bs_get_bit_offset(bs) - start_bit;
+	/*only keep nodes leaving the encoder state untouched*/
+	if (!e && !codec->node_cache_skip && (nb_bits >= BIFS_NODE_CACHE_MIN_BITS)
+		&& (qp == codec->ActiveQP) && (nb_qps == gf_list_count(codec->QPs)) && (num_coord == codec->NumCoord)
+		&& (coord_stored == codec->coord_stored) && (storing_coord == codec->storing_coord)
+		&& (nb_defs <= gf_list_count(codec->encoded_nodes))
+	) {
+		size = (nb_bits+7) / 8;
+		/*cache full, flush it - children entries may be gone so look the node up again*/
+		if (codec->node_cache_size + size > codec->node_cache_max_size) {
+			gf_bifs_enc_node_cache_reset(codec);
+		}
+		ent = BE_NodeCacheFind(codec, node, NDT_Tag);
+		if (!ent) {
+			u32 idx = BE_NODE_CACHE_BUCKET(node);
+			GF_SAFEALLOC(ent, BIFSNodeCacheEntry);
+			ent->node = node;
+			ent->NDT_Tag = NDT_Tag;
+			ent->def_nodes = gf_list_new();
+			ent->use_nodes = gf_list_new();
+			if (!codec->node_cache[idx]) codec->node_cache[idx] = gf_list_new();
+			gf_list_add(codec->node_cache[idx], ent);
+		} else {
+			codec->node_cache_size -= (ent->nb_bits+7) / 8;
+			gf_list_reset(ent->def_nodes);
+			gf_list_reset(ent->use_nodes);
+		}
+		ent->data = (char*)gf_realloc(ent->data, size);
+		gf_bs_copy_bits(bs, start_bit, nb_bits, ent->data);
+		ent->nb_bits = nb_bits;
+		codec->node_cache_size += size;
+
+		ent->modif_count = gf_node_get_modification_count(node);
+		ent->info = codec->info;
+		ent->use_names = codec->UseName;
+		ent->is_encoding_command = codec->is_encoding_command;
+		ent->qp = qp;
+		ent->qp_modif_count = qp ? gf_node_get_modification_count((GF_Node *)qp) : 0;
+		ent->nb_qps = nb_qps;
+		ent->num_coord = num_coord;
+		ent->coord_stored = coord_stored;
+		ent->storing_coord = storing_coord;
+		for (i=nb_defs; i<gf_list_count(codec->encoded_nodes); i++) {
+			gf_list_add(ent->def_nodes, gf_list_get(codec->encoded_nodes, i));
+		}
+		for (i=nb_uses; i<gf_list_count(codec->node_cache_uses); i++) {
+			gf_list_add(ent->use_nodes, gf_list_get(codec->node_cache_uses, i));
+		}
+	}
+	codec->node_cache_skip |= prev_skip;
+	if (!codec->node_cache_depth) gf_list_reset(codec->node_cache_uses);
+	return e;
+}
+
 
 #endif /*GPAC_DISABLE_BIFS_ENC*/
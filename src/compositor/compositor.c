@@ -543,6 +543,8 @@ void gf_sc_del(GF_Compositor *compositor)
 		}
 		gf_th_del(compositor->VisualThread);
 	}
+	/*cached text textures may hold video output resources*/
+	if (compositor->font_manager) gf_font_manager_reset_cache(compositor->font_manager);
 	if (compositor->video_out) {
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_COMPOSE, ("[Compositor] Closing video output\n"));
 		compositor->video_out->Shutdown(compositor->video_out);
@@ -837,6 +839,9 @@ GF_Err gf_sc_set_scene(GF_Compositor *compositor, GF_SceneGraph *scene_graph)
 	/*reset main surface*/
 	gf_sc_reset(compositor);
 
+	/*drop cached text of the previous scene*/
+	if (!scene_graph && compositor->font_manager) gf_font_manager_reset_cache(compositor->font_manager);
+
 	/*set current graph*/
 	compositor->scene = scene_graph;
 	do_notif = 0;
@@ -1664,6 +1669,34 @@ void gf_sc_map_point(GF_Compositor *compositor, s32 X, s32 Y, Fixed *bifsX, Fixe
 }
 
 
+GF_EXPORT
+GF_Err gf_sc_set_output_buffer(GF_Compositor *compositor, GF_VideoSurface *framebuffer)
+{
+	if (!compositor) return GF_BAD_PARAM;
+	if (framebuffer) {
+		if (!framebuffer->video_buffer || !framebuffer->width || !framebuffer->height) return GF_BAD_PARAM;
+		/*hardware blitters and OpenGL would write to the video output and bypass the buffer*/
+		if (compositor->video_out->Blit || compositor->video_out->BlitTexture
+			|| (compositor->video_out->hw_caps & (GF_VIDEO_HW_HAS_LINE_BLIT | GF_VIDEO_HW_HAS_HWND_HDC | GF_VIDEO_HW_OPENGL))
+		) {
+			return GF_NOT_SUPPORTED;
+		}
+	}
+
+	gf_sc_lock(compositor, 1);
+	if (framebuffer) {
+		compositor->ext_fb = *framebuffer;
+		compositor->use_ext_fb = 1;
+	} else {
+		compositor->use_ext_fb = 0;
+	}
+	gf_sc_lock(compositor, 0);
+
+	if (framebuffer) return gf_sc_set_size(compositor, framebuffer->width, framebuffer->height);
+	gf_sc_next_frame_state(compositor, GF_SC_DRAW_FRAME);
+	return GF_OK;
+}
+
 GF_EXPORT
 GF_Err gf_sc_get_screen_buffer(GF_Compositor *compositor, GF_VideoSurface *framebuffer, u32 depth_dump_mode)
 {
@@ -1677,6 +1710,10 @@ GF_Err gf_sc_get_screen_buffer(GF_Compositor *compositor, GF_VideoSurface *frame
 #endif
 	/*no depth dump in 2D mode*/
 	if (depth_dump_mode) e = GF_NOT_SUPPORTED;
+	else if (compositor->use_ext_fb) {
+		*framebuffer = compositor->ext_fb;
+		e = GF_OK;
+	}
 	else e = compositor->video_out->LockBackBuffer(compositor->video_out, framebuffer, 1);
 	
 	if (e != GF_OK) gf_mx_v(compositor->mx);
@@ -1709,7 +1746,8 @@ GF_Err gf_sc_release_screen_buffer(GF_Compositor *compositor, GF_VideoSurface *f
 	if (compositor->visual->type_3d) e = compositor_3d_release_screen_buffer(compositor, framebuffer);
 	else
 #endif
-	e = compositor->video_out->LockBackBuffer(compositor->video_out, framebuffer, 0);
+	if (compositor->use_ext_fb) e = GF_OK;
+	else e = compositor->video_out->LockBackBuffer(compositor->video_out, framebuffer, 0);
 
 	gf_mx_v(compositor->mx);
 	return e;
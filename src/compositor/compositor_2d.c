@@ -234,6 +234,23 @@ GF_Err compositor_2d_get_video_access(GF_VisualManager *visual)
 	compositor->hw_locked = 0;
 	e = GF_IO_ERR;
 
+	/*offscreen rendering in caller memory*/
+	if (compositor->use_ext_fb) {
+		e = compositor->rasterizer->surface_attach_to_buffer(visual->raster_surface, compositor->ext_fb.video_buffer,
+							compositor->ext_fb.width,
+							compositor->ext_fb.height,
+							compositor->ext_fb.pitch_x,
+							compositor->ext_fb.pitch_y,
+							(GF_PixelFormat) compositor->ext_fb.pixel_format);
+		if (!e) {
+			visual->is_attached = 1;
+			return GF_OK;
+		}
+		GF_LOG(GF_LOG_ERROR, GF_LOG_COMPOSE, ("[Compositor2D] Cannot attach output buffer to raster: %s\n", gf_error_to_string(e) ));
+		visual->is_attached = 0;
+		return e;
+	}
+
 	/*try from video memory handle (WIN32) if supported*/
 	if ((compositor->video_out->hw_caps & GF_VIDEO_HW_HAS_HWND_HDC)
 		&& compositor->rasterizer->surface_attach_to_device
@@ -648,11 +665,17 @@ static Bool compositor_2d_draw_bitmap_ex(GF_VisualManager *visual, GF_TextureHan
 	}
 	if (use_soft_stretch) {
 		GF_VideoSurface backbuffer;
-		e = visual->compositor->video_out->LockBackBuffer(visual->compositor->video_out, &backbuffer, GF_TRUE);
-		if (!e) {
-			gf_stretch_bits(&backbuffer, &video_src, &dst_wnd, &src_wnd, alpha, 0, col_key, ctx->col_mat);
-			e = visual->compositor->video_out->LockBackBuffer(visual->compositor->video_out, &backbuffer, GF_FALSE);
+		if (visual->compositor->use_ext_fb) {
+			gf_stretch_bits(&visual->compositor->ext_fb, &video_src, &dst_wnd, &src_wnd, alpha, 0, col_key, ctx->col_mat);
+			e = GF_OK;
 		} else {
+			e = visual->compositor->video_out->LockBackBuffer(visual->compositor->video_out, &backbuffer, GF_TRUE);
+			if (!e) {
+				gf_stretch_bits(&backbuffer, &video_src, &dst_wnd, &src_wnd, alpha, 0, col_key, ctx->col_mat);
+				e = visual->compositor->video_out->LockBackBuffer(visual->compositor->video_out, &backbuffer, GF_FALSE);
+			}
+		}
+		if (e) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_COMPOSE, ("[Compositor2D] Cannot lock back buffer - Error %s\n", gf_error_to_string(e) ));
 			if (is_attached) visual_2d_init_raster(visual);
 			return GF_FALSE;
@@ -41,8 +41,61 @@ struct _gf_ft_mgr
 	u32 id_buffer_size;
 
 	Bool wait_font_load;
+
+	/*layout cache: glyph IDs of the last shaped strings, most recently used first*/
+	GF_List *layout_cache;
+	u32 max_layouts;
+	/*coverage cache: text textures of destroyed spans, most recently released first*/
+	GF_List *texture_cache;
+	u32 texture_cache_size, max_texture_cache_size;
 };
 
+typedef struct
+{
+	GF_Font *font;
+	char *text, *lang;
+	u32 *ids;
+	u32 nb_ids;
+	Bool is_rtl;
+} GF_TextLayoutEntry;
+
+typedef struct
+{
+	GF_Font *font;
+	Fixed font_size, x_scale, y_scale;
+	Fixed width, height;
+	u32 flags;
+	u32 *ids;
+	u32 nb_ids;
+	GF_TextureHandler *txh;
+} GF_TextTextureEntry;
+
+/*span flags affecting the rasterized coverage*/
+#define TEXT_TEXTURE_FLAGS	(GF_TEXT_SPAN_HORIZONTAL | GF_TEXT_SPAN_FLIP)
+
+static void text_texture_del(GF_TextureHandler *txh)
+{
+	gf_sc_texture_destroy(txh);
+	if (txh->data) gf_free(txh->data);
+	gf_free(txh);
+}
+
+static void text_texture_entry_del(GF_FontManager *fm, GF_TextTextureEntry *tte)
+{
+	fm->texture_cache_size -= tte->txh->stride * tte->txh->height;
+	text_texture_del(tte->txh);
+	gf_free(tte->ids);
+	gf_free(tte);
+}
+
+static void text_layout_entry_del(GF_TextLayoutEntry *tle)
+{
+	gf_free(tle->text);
+	if (tle->lang) gf_free(tle->lang);
+	gf_free(tle->ids);
+	gf_free(tle);
+}
+
 
 GF_FontManager *gf_font_manager_new(GF_User *user)
 {
@@ -96,9 +149,39 @@ GF_FontManager *gf_font_manager_new(GF_User *user)
 	if (!opt) gf_cfg_set_key(user->config, "FontEngine", "WaitForFontLoad", "no");
 	if (opt && !strcmp(opt, "yes")) font_mgr->wait_font_load = 1;
 
+	opt = gf_cfg_get_key(user->config, "FontEngine", "LayoutCacheSize");
+	if (!opt) {
+		gf_cfg_set_key(user->config, "FontEngine", "LayoutCacheSize", "64");
+		opt = "64";
+	}
+	font_mgr->max_layouts = atoi(opt);
+	font_mgr->layout_cache = gf_list_new();
+
+	opt = gf_cfg_get_key(user->config, "FontEngine", "TextureCacheSize");
+	if (!opt) {
+		gf_cfg_set_key(user->config, "FontEngine", "TextureCacheSize", "1024");
+		opt = "1024";
+	}
+	font_mgr->max_texture_cache_size = 1024 * atoi(opt);
+	font_mgr->texture_cache = gf_list_new();
+
 	return font_mgr;
 }
 
+void gf_font_manager_reset_cache(GF_FontManager *fm)
+{
+	while (gf_list_count(fm->layout_cache)) {
+		GF_TextLayoutEntry *tle = gf_list_last(fm->layout_cache);
+		gf_list_rem_last(fm->layout_cache);
+		text_layout_entry_del(tle);
+	}
+	while (gf_list_count(fm->texture_cache)) {
+		GF_TextTextureEntry *tte = gf_list_last(fm->texture_cache);
+		gf_list_rem_last(fm->texture_cache);
+		text_texture_entry_del(fm, tte);
+	}
+}
+
 void gf_font_predestroy(GF_Font *font)
 {
 	if (font->spans) {
@@ -145,6 +228,9 @@ void gf_font_manager_del(GF_FontManager *fm)
 		gf_font_del(font);
 		font = next;
 	}
+	gf_font_manager_reset_cache(fm);
+	gf_list_del(fm->layout_cache);
+	gf_list_del(fm->texture_cache);
 	gf_free(fm->id_buffer);
 	gf_path_del(fm->line_path);
 	gf_free(fm);
@@ -386,6 +472,54 @@ static GF_Glyph *gf_font_get_glyph(GF_FontManager *fm, GF_Font *font, u32 name)
 }
 
 
+static Bool font_manager_get_cached_layout(GF_FontManager *fm, GF_Font *font, char *text, const char *xml_lang, u32 *len, Bool *is_rtl)
+{
+	u32 i, count;
+	count = gf_list_count(fm->layout_cache);
+	for (i=0; i<count; i++) {
+		GF_TextLayoutEntry *tle = gf_list_get(fm->layout_cache, i);
+		if (tle->font != font) continue;
+		if (strcmp(tle->text, text)) continue;
+		if (xml_lang ? (!tle->lang || strcmp(tle->lang, xml_lang)) : (tle->lang!=NULL)) continue;
+
+		if (tle->nb_ids > fm->id_buffer_size) {
+			fm->id_buffer_size = tle->nb_ids;
+			fm->id_buffer = gf_realloc(fm->id_buffer, sizeof(u32) * tle->nb_ids);
+		}
+		memcpy(fm->id_buffer, tle->ids, sizeof(u32) * tle->nb_ids);
+		*len = tle->nb_ids;
+		*is_rtl = tle->is_rtl;
+		/*move to front*/
+		if (i) {
+			gf_list_rem(fm->layout_cache, i);
+			gf_list_insert(fm->layout_cache, tle, 0);
+		}
+		return 1;
+	}
+	return 0;
+}
+
+static void font_manager_cache_layout(GF_FontManager *fm, GF_Font *font, char *text, const char *xml_lang, u32 len, Bool is_rtl)
+{
+	GF_TextLayoutEntry *tle;
+	GF_SAFEALLOC(tle, GF_TextLayoutEntry);
+	if (!tle) return;
+	tle->font = font;
+	tle->text = gf_strdup(text);
+	if (xml_lang) tle->lang = gf_strdup(xml_lang);
+	tle->nb_ids = len;
+	tle->ids = gf_malloc(sizeof(u32) * len);
+	memcpy(tle->ids, fm->id_buffer, sizeof(u32) * len);
+	tle->is_rtl = is_rtl;
+	gf_list_insert(fm->layout_cache, tle, 0);
+
+	while (gf_list_count(fm->layout_cache) > fm->max_layouts) {
+		tle = gf_list_last(fm->layout_cache);
+		gf_list_rem_last(fm->layout_cache);
+		text_layout_entry_del(tle);
+	}
+}
+
 GF_TextSpan *gf_font_manager_create_span(GF_FontManager *fm, GF_Font *font, char *text, Fixed font_size, Bool needs_x_offset, Bool needs_y_offset, Bool needs_rotate, const char *xml_lang, Bool fliped_text, u32 styles, GF_Node *user)
 {
 	GF_Err e;
@@ -395,21 +529,28 @@ GF_TextSpan *gf_font_manager_create_span(GF_FontManager *fm, GF_Font *font, char
 
 	if (!strlen(text)) return NULL;
 
-	len = fm->id_buffer_size;
-	if (font->get_glyphs)
-		e = font->get_glyphs(font->udta, text, fm->id_buffer, &len, xml_lang, &is_rtl);
-	else
-		e = fm->reader->get_glyphs(fm->reader, text, fm->id_buffer, &len, xml_lang, &is_rtl);
-
-	if (e==GF_BUFFER_TOO_SMALL) {
-		fm->id_buffer_size = len;
-		fm->id_buffer = gf_realloc(fm->id_buffer, sizeof(u32) * len);
-		if (!fm->id_buffer) return NULL;
-	
+	/*SVG fonts resolve glyphs themselves and may be reloaded, only cache shaping done by the font reader*/
+	if (!font->get_glyphs && fm->max_layouts && font_manager_get_cached_layout(fm, font, text, xml_lang, &len, &is_rtl)) {
+		e = GF_OK;
+	} else {
+		len = fm->id_buffer_size;
 		if (font->get_glyphs)
 			e = font->get_glyphs(font->udta, text, fm->id_buffer, &len, xml_lang, &is_rtl);
 		else
 			e = fm->reader->get_glyphs(fm->reader, text, fm->id_buffer, &len, xml_lang, &is_rtl);
+
+		if (e==GF_BUFFER_TOO_SMALL) {
+			fm->id_buffer_size = len;
+			fm->id_buffer = gf_realloc(fm->id_buffer, sizeof(u32) * len);
+			if (!fm->id_buffer) return NULL;
+		
+			if (font->get_glyphs)
+				e = font->get_glyphs(font->udta, text, fm->id_buffer, &len, xml_lang, &is_rtl);
+			else
+				e = fm->reader->get_glyphs(fm->reader, text, fm->id_buffer, &len, xml_lang, &is_rtl);
+		}
+		if (!e && !font->get_glyphs && fm->max_layouts) 
+			font_manager_cache_layout(fm, font, text, xml_lang, len, is_rtl);
 	}
 	if (e) return NULL;
 
@@ -469,15 +610,95 @@ typedef struct _span_internal
 } GF_SpanExtensions;
 
 
+static u32 *span_get_glyph_ids(GF_TextSpan *span)
+{
+	u32 i;
+	u32 *ids = gf_malloc(sizeof(u32) * span->nb_glyphs);
+	for (i=0; i<span->nb_glyphs; i++) {
+		ids[i] = span->glyphs[i] ? span->glyphs[i]->ID : 0xFFFFFFFF;
+	}
+	return ids;
+}
+
+/*keeps the coverage texture of a destroyed span so that an identical span (same text, font and size) 
+created later, as typically done by subtitles and tickers, can reuse it without rasterizing again*/
+static Bool span_texture_cache_put(GF_TextSpan *span)
+{
+	GF_TextTextureEntry *tte;
+	GF_FontManager *fm;
+	GF_TextureHandler *txh = span->ext->txh;
+	u32 size;
+
+	/*span is detached from its font, the font may already be destroyed*/
+	if (!span->user) return 0;
+	fm = span->font->ft_mgr;
+	if (!fm || !fm->max_texture_cache_size) return 0;
+	if (span->font->get_glyphs || span->dx || span->dy || span->rot) return 0;
+	if (!txh->data) return 0;
+	size = txh->stride * txh->height;
+	if (size > fm->max_texture_cache_size) return 0;
+
+	GF_SAFEALLOC(tte, GF_TextTextureEntry);
+	if (!tte) return 0;
+	tte->font = span->font;
+	tte->font_size = span->font_size;
+	tte->x_scale = span->x_scale;
+	tte->y_scale = span->y_scale;
+	tte->width = span->bounds.width;
+	tte->height = span->bounds.height;
+	tte->flags = span->flags & TEXT_TEXTURE_FLAGS;
+	tte->nb_ids = span->nb_glyphs;
+	tte->ids = span_get_glyph_ids(span);
+	tte->txh = txh;
+	span->ext->txh = NULL;
+
+	gf_list_insert(fm->texture_cache, tte, 0);
+	fm->texture_cache_size += size;
+	while (fm->texture_cache_size > fm->max_texture_cache_size) {
+		tte = gf_list_last(fm->texture_cache);
+		gf_list_rem_last(fm->texture_cache);
+		text_texture_entry_del(fm, tte);
+	}
+	return 1;
+}
+
+static GF_TextureHandler *span_texture_cache_get(GF_TextSpan *span, u32 width, u32 height)
+{
+	u32 i, count;
+	u32 *ids = NULL;
+	GF_FontManager *fm = span->font->ft_mgr;
+
+	if (!fm) return NULL;
+	if (span->font->get_glyphs || span->dx || span->dy || span->rot) return NULL;
+
+	count = gf_list_count(fm->texture_cache);
+	for (i=0; i<count; i++) {
+		GF_TextureHandler *txh;
+		GF_TextTextureEntry *tte = gf_list_get(fm->texture_cache, i);
+		if ((tte->font != span->font) || (tte->nb_ids != span->nb_glyphs)) continue;
+		if ((tte->txh->width != width) || (tte->txh->height != height)) continue;
+		if ((tte->font_size != span->font_size) || (tte->x_scale != span->x_scale) || (tte->y_scale != span->y_scale)) continue;
+		if ((tte->width != span->bounds.width) || (tte->height != span->bounds.height)) continue;
+		if (tte->flags != (span->flags & TEXT_TEXTURE_FLAGS)) continue;
+		if (!ids) ids = span_get_glyph_ids(span);
+		if (memcmp(tte->ids, ids, sizeof(u32) * tte->nb_ids)) continue;
+
+		txh = tte->txh;
+		gf_list_rem(fm->texture_cache, i);
+		fm->texture_cache_size -= txh->stride * txh->height;
+		gf_free(tte->ids);
+		gf_free(tte);
+		gf_free(ids);
+		return txh;
+	}
+	if (ids) gf_free(ids);
+	return NULL;
+}
+
 void gf_font_manager_delete_span(GF_FontManager *fm, GF_TextSpan *span)
 {
 	if (span->user && span->font->spans) gf_list_del_item(span->font->spans, span);
 
-	gf_free(span->glyphs);
-	if (span->dx) gf_free(span->dx);
-	if (span->dy) gf_free(span->dy);
-	if (span->rot) gf_free(span->rot);
-
 	if (span->ext) {
 		if (span->ext->path) gf_path_del(span->ext->path);
 #ifndef GPAC_DISABLE_3D
@@ -486,12 +707,14 @@ void gf_font_manager_delete_span(GF_FontManager *fm, GF_TextSpan *span)
 		if (span->ext->outline) mesh_free(span->ext->outline);
 #endif
 		if (span->ext->txh) {
-			gf_sc_texture_destroy(span->ext->txh);
-			if (span->ext->txh->data) gf_free(span->ext->txh->data);
-			gf_free(span->ext->txh);
+			if (!span_texture_cache_put(span)) text_texture_del(span->ext->txh);
 		}
 		gf_free(span->ext);
 	}
+	gf_free(span->glyphs);
+	if (span->dx) gf_free(span->dx);
+	if (span->dy) gf_free(span->dy);
+	if (span->rot) gf_free(span->rot);
 	gf_free(span);
 }
 
@@ -665,6 +888,7 @@ static Bool span_setup_texture(GF_Compositor *compositor, GF_TextSpan *span, Boo
 	GF_SURFACE surface;
 	u32 width, height;
 	Fixed scale;
+	Bool from_cache = 0;
 	GF_Raster2D *raster = compositor->rasterizer;
 
 	span_alloc_extensions(span);
@@ -727,10 +951,17 @@ static Bool span_setup_texture(GF_Compositor *compositor, GF_TextSpan *span, Boo
 #endif
 
 	if (span->ext->txh) {
-		gf_sc_texture_destroy(span->ext->txh);
-		if (span->ext->txh->data) gf_free(span->ext->txh->data);
-		gf_free(span->ext->txh);
+		text_texture_del(span->ext->txh);
+		span->ext->txh = NULL;
 	}
+
+	/*identical span was rendered before, reuse its coverage*/
+	span->ext->txh = span_texture_cache_get(span, width, height);
+	if (span->ext->txh) {
+		from_cache = 1;
+		goto setup_path;
+	}
+
 	GF_SAFEALLOC(span->ext->txh, GF_TextureHandler);
 	gf_sc_texture_setup(span->ext->txh, compositor, NULL);
 	gf_sc_texture_allocate(span->ext->txh);
@@ -777,6 +1008,7 @@ static Bool span_setup_texture(GF_Compositor *compositor, GF_TextSpan *span, Boo
 	raster->surface_delete(surface);
 	gf_path_del(span_path);
 
+setup_path:
 	if (span->font->baseline) {
 		Fixed dy = gf_mulfix(span->font->baseline, span->font_scale);
 		bounds.y += dy;
@@ -789,8 +1021,10 @@ static Bool span_setup_texture(GF_Compositor *compositor, GF_TextSpan *span, Boo
 	gf_path_add_line_to(span->ext->path, bounds.x, bounds.y);
 	gf_path_close(span->ext->path);
 
-	gf_sc_texture_set_stencil(span->ext->txh, stencil);
-	gf_sc_texture_set_data(span->ext->txh);
+	if (!from_cache) {
+		gf_sc_texture_set_stencil(span->ext->txh, stencil);
+		gf_sc_texture_set_data(span->ext->txh);
+	}
 
 #ifndef GPAC_DISABLE_3D
 	gf_sc_texture_set_blend_mode(span->ext->txh, TX_BLEND);
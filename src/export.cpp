@@ -154,6 +154,8 @@
 /* Bitstream */
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_from_file) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_new_mem_file) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_from_stream) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_bit) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_read_int) )
@@ -180,6 +182,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_align) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_available) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_content) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_content_no_truncate) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_reassign_buffer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_skip_bytes) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_seek) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_peek_bits) )
@@ -187,7 +191,12 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_size) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_refreshed_size) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_set_output_buffering) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_flush) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_set_input_buffering) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_transfer) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_copy_bits) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_set_cookie) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_cookie) )
 
 /* Thread */
 #pragma comment (linker, EXPORT_SYMBOL(gf_th_new) )
@@ -209,6 +218,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_sema_notify) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sema_wait) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sema_wait_for) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_th_memory_barrier) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_global_resource_lock) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_global_resource_unlock) )
 
@@ -269,6 +279,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_section_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_key_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_key_name) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_key_value) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_insert_key) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_del_section) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_filename) )
@@ -769,6 +780,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_remove_sample) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_final_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_storage_mode) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_reserve_moov_space) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_storage_mode) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_interleave_time) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_interleave_time) )
@@ -860,6 +872,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_3gp_config_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_3gp_config_update) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_media_timescale) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_media_timing) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_estimate_size) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_meta_type) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_add_meta_item) )
@@ -883,6 +896,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_sample_roll_group) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_composition_offset_mode) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_output_buffering) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_mem_output_callback) )
 
 
 #ifndef GPAC_DISABLE_ISOM_HINTING
@@ -963,6 +977,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_on_disconnect) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_on_command) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_on_sl_packet) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_term_on_sl_au) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_get_service_url) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_on_service_event) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_add_media) )
@@ -974,6 +989,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_download_update_stats) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_scene_update) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_process_step) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_term_step_frame) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_get_screen_buffer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_release_screen_buffer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_get_offscreen_buffer) )
@@ -1112,6 +1128,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_depacketizer_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_depacketizer_reset) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_depacketizer_process) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_depacketizer_set_au_callback) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_depacketizer_recycle_au) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_depacketizer_get_slconfig) )
 #endif /*GPAC_DISABLE_STREAMING*/
 
@@ -1267,6 +1285,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_sm_load_string) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sm_load_run) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sm_load_suspend) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sm_save_context_cache) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sm_load_context_cache) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sm_import_bifs_subtitle) )
 #endif
 
@@ -1310,6 +1330,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_save_context) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_enable_aggregation) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_aggregate_context) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_seng_send_rap) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_get_base64_iod) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_get_iod) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_seng_terminate) )
@@ -1335,9 +1356,11 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_new_stream) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encode_au) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encode_au_buffer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_get_config) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_get_version) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_get_rap) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bifs_encoder_set_node_cache) )
 #endif
 #endif /*GPAC_DISABLE_BIFS*/
 
@@ -1349,6 +1372,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_node_get_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_node_get_id) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_node_get_name_and_id) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_node_get_modification_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_node_get_private) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_node_set_private) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_node_set_callback_function) )
@@ -1641,6 +1665,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_sc_get_fps) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sc_get_screen_buffer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sc_release_screen_buffer) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sc_set_output_buffer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sc_simulation_tick) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sc_reset_graphics) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sc_pick_node) )
@@ -1700,6 +1725,13 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_get_stream_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_crc32_check) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_restamp) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_splicer_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_splicer_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_splicer_set_pid) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_splicer_reset_pids) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_splicer_set_shift) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_splicer_splice) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_m2ts_splicer_process) )
 
 
 /* carousel.h */
@@ -1754,6 +1786,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_laser_encoder_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_laser_encoder_new_stream) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_laser_encode_au) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_laser_encode_au_buffer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_laser_encoder_get_config) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_laser_encoder_get_rap) )
 #endif /*GPAC_DISABLE_LASER*/
@@ -1772,6 +1805,9 @@
 
 #pragma comment (linker, EXPORT_SYMBOL(gf_dasher_segment_files) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_dasher_next_update_time) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_context_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_context_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_dasher_context_save) )
 
 /* dvb_mpe.h */
 #ifdef GPAC_ENST_PRIVATE
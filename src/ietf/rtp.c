@@ -331,12 +331,13 @@ void gf_rtp_get_next_report_time(GF_RTPChannel *ch)
 }
 
 
+static u32 gf_rtp_reorderer_get_copy(GF_RTPReorder *po, char *buffer, u32 buffer_size);
+
 GF_EXPORT
 u32 gf_rtp_read_rtp(GF_RTPChannel *ch, char *buffer, u32 buffer_size)
 {
 	GF_Err e;
 	u32 seq_num, res;
-	char *pck;
 
 	//only if the socket exist (otherwise RTSP interleaved channel)
 	if (!ch || !ch->rtp) return 0;
@@ -355,11 +356,7 @@ u32 gf_rtp_read_rtp(GF_RTPChannel *ch, char *buffer, u32 buffer_size)
 		}
 
 		//pck queue may need to be flushed
-		pck = (char *) gf_rtp_reorderer_get(ch->po, &res);
-		if (pck) {
-			memcpy(buffer, pck, res);
-			gf_free(pck);
-		}
+		res = gf_rtp_reorderer_get_copy(ch->po, buffer, buffer_size);
 	}
 	/*monitor keep-alive period*/
 	if (ch->nat_keepalive_time_period) {
@@ -757,7 +754,8 @@ void gf_rtp_get_ports(GF_RTPChannel *ch, u16 *rtp_port, u16 *rtcp_port)
 	RTP packet reorderer
 */
 
-#define SN_CHECK_OFFSET		0x0A
+/*min number of slots in the reordering buffer*/
+#define PO_MIN_CAPACITY		64
 
 GF_RTPReorder *gf_rtp_reorderer_new(u32 MaxCount, u32 MaxDelay)
 {
@@ -768,129 +766,156 @@ GF_RTPReorder *gf_rtp_reorderer_new(u32 MaxCount, u32 MaxDelay)
 	GF_SAFEALLOC(tmp , GF_RTPReorder);
 	tmp->MaxCount = MaxCount;
 	tmp->MaxDelay = MaxDelay;
+	/*leave room for lost packets in the reordering window - capacity is a power of 2*/
+	tmp->Capacity = PO_MIN_CAPACITY;
+	while (tmp->Capacity < 2*MaxCount) tmp->Capacity *= 2;
+	tmp->items = (GF_POItem *) gf_malloc(sizeof(GF_POItem) * tmp->Capacity);
+	memset(tmp->items, 0, sizeof(GF_POItem) * tmp->Capacity);
 	return tmp;
 }
 
-static void DelItem(GF_POItem *it)
-{
-	if (it) {
-		if (it->next) DelItem(it->next);
-		gf_free(it->pck);
-		gf_free(it);
-	}
-}
-
-
 void gf_rtp_reorderer_del(GF_RTPReorder *po)
 {
-	if (po->in) DelItem(po->in);
+	u32 i;
+	for (i=0; i<po->Capacity; i++) {
+		if (po->items[i].pck) gf_free(po->items[i].pck);
+	}
+	gf_free(po->items);
 	gf_free(po);
 }
 
 void gf_rtp_reorderer_reset(GF_RTPReorder *po)
 {
+	u32 i;
 	if (!po) return;
 
-	if (po->in) DelItem(po->in);
-	po->head_seqnum = 0;
+	/*keep packet buffers for later use*/
+	for (i=0; i<po->Capacity; i++) po->items[i].size = 0;
+	po->head_seqnum = po->tail_seqnum = 0;
 	po->Count = 0;
-	po->IsInit = 0;
-	po->in = NULL;
+	po->LastTime = 0;
+	po->has_output = 0;
 }
 
+#define PO_ITEM(_po, _sn)	(&(_po)->items[(_sn) & ((_po)->Capacity - 1)])
+
 GF_Err gf_rtp_reorderer_add(GF_RTPReorder *po, const void * pck, u32 pck_size, u32 pck_seqnum)
 {
-	GF_POItem *it, *cur;
-	u32 bounds;
+	GF_POItem *it;
+	u16 offset;
 
 	if (!po) return GF_BAD_PARAM;
+	if (!pck_size) return GF_OK;
 
-	it = (GF_POItem *) gf_malloc(sizeof(GF_POItem));
-	it->pck_seq_num = pck_seqnum;
-	it->next = NULL;
-	it->size = pck_size;
-	it->pck = gf_malloc(pck_size);
-	memcpy(it->pck, pck, pck_size);
+	pck_seqnum &= 0xFFFF;
 	/*reset timeout*/
 	po->LastTime = 0;
 
-	//no input, this packet will be the input
-	if (!po->in) {
-		//the seq num was not initialized
-		if (!po->head_seqnum) {
+	//packet already output or given up on, drop it - if too old, assume the sender restarted its seqnums
+	if (po->has_output && ((u16) (pck_seqnum - po->last_seqnum - 1) >= 0x7FFF)) {
+		if ((u16) (po->last_seqnum - pck_seqnum) < po->Capacity) goto discard;
+		GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[rtp] Packet Reorderer: packet %d out of reordering window (last output %d), flushing %d packets\n", pck_seqnum, po->last_seqnum, po->Count));
+		gf_rtp_reorderer_reset(po);
+	}
+
+	//no input, this packet will be the head
+	if (!po->Count) {
+		po->head_seqnum = po->tail_seqnum = pck_seqnum;
+	} else {
+		//this is 16 bit seq num, as we work with RTP only for now
+		offset = (u16) (pck_seqnum - po->head_seqnum);
+		//packet after the head
+		if (offset < 0x8000) {
+			//too far from the head, assume the sender jumped in seqnum and restart from this packet
+			if (offset >= po->Capacity) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[rtp] Packet Reorderer: packet %d out of reordering window (head %d), flushing %d packets\n", pck_seqnum, po->head_seqnum, po->Count));
+				gf_rtp_reorderer_reset(po);
+				po->head_seqnum = po->tail_seqnum = pck_seqnum;
+			}
+			else if (offset > (u16) (po->tail_seqnum - po->head_seqnum)) {
+#ifndef GPAC_DISABLE_LOG
+				if (((po->tail_seqnum + 1) & 0xFFFF) != pck_seqnum) 
+					GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[rtp] Packet Reorderer: got %d expected %d\n", pck_seqnum, (po->tail_seqnum+1) & 0xFFFF));
+#endif
+				po->tail_seqnum = pck_seqnum;
+			}
+		}
+		//packet before the head, insert at head if the window can hold it
+		else {
+			offset = (u16) (po->head_seqnum - pck_seqnum);
+			if ((u32) offset + (u16) (po->tail_seqnum - po->head_seqnum) >= po->Capacity) goto discard;
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: inserting packet %d at head\n", pck_seqnum));
 			po->head_seqnum = pck_seqnum;
-		} else if (!po->IsInit) {
-			//this is not in our current range for init
-			if (ABSDIFF(po->head_seqnum, pck_seqnum) > SN_CHECK_OFFSET) goto discard;
-			po->IsInit = 1;
 		}
-
-		po->in = it;
-		po->Count += 1;
-		return GF_OK;
 	}
 
-	//this is 16 bitr seq num, as we work with RTP only for now
-	bounds = 0;
-	if ( (po->head_seqnum >= 0xf000 ) || (po->head_seqnum <= 0x1000) ) bounds = 0x2000;
-
-	//first check the head of the list
+	it = PO_ITEM(po, pck_seqnum);
 	//same seq num, we drop
-	if (po->in->pck_seq_num == pck_seqnum) goto discard;
-
-	if ( ( (u16) (pck_seqnum + bounds) <= (u16) (po->in->pck_seq_num + bounds) )
-		&& ( (u16) (pck_seqnum + bounds) >= (u16) (po->head_seqnum + bounds)) ) {
+	if (it->size) goto discard;
 
-		it->next = po->in;
-		po->in = it;
-		po->Count += 1;
-
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: inserting packet %d at head\n", pck_seqnum));
-		return GF_OK;
+	if (it->alloc_size < pck_size) {
+		it->pck = gf_realloc(it->pck, pck_size);
+		it->alloc_size = pck_size;
 	}
+	memcpy(it->pck, pck, pck_size);
+	it->size = pck_size;
+	it->pck_seq_num = pck_seqnum;
+	po->Count += 1;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Inserting packet %d\n", pck_seqnum));
+	return GF_OK;
 
-	//no, insert at the right place
-	cur = po->in;
+discard:
+	GF_LOG(GF_LOG_ERROR, GF_LOG_RTP, ("[rtp] Packet Reorderer: Dropping packet %d", pck_seqnum));
+	return GF_OK;
+}
 
-	while (1) {
-		//same seq num, we drop
-		if (cur->pck_seq_num == pck_seqnum) goto discard;
+//locates the first available packet, if it can be released
+static GF_POItem *gf_rtp_reorderer_check(GF_RTPReorder *po)
+{
+	GF_POItem *it, *next;
 
-		//end of list
-		if (!cur->next) {
-			cur->next = it;
-			po->Count += 1;
-#ifndef GPAC_DISABLE_LOG
-			if (cur->pck_seq_num +1 != it->pck_seq_num) 
-				GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[rtp] Packet Reorderer: got %d expected %d\n", cur->pck_seq_num+1, it->pck_seq_num));
+	//empty queue
+	if (!po->Count) return NULL;
 
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Appending packet %d\n", pck_seqnum));
-#endif
-			return GF_OK;
-		}
+	it = PO_ITEM(po, po->head_seqnum);
+	next = PO_ITEM(po, po->head_seqnum + 1);
 
-		//are we in the bounds ??
-		if ( ( (u16) (cur->pck_seq_num + bounds) < (u16) (pck_seqnum + bounds) )
-			&& ( (u16) (pck_seqnum + bounds) < (u16) (cur->next->pck_seq_num + bounds)) ) {
+	//release the output if SN in order or maxCount reached
+	if ((po->Count>1) && next->size && (next->pck_seq_num == ((po->head_seqnum + 1) & 0xFFFF)) ) 
+		return it;
 
-			//insert
-			it->next = cur->next;
-			cur->next = it;
-			po->Count += 1;
+	if (po->MaxCount && (po->Count >= po->MaxCount)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[rtp] Packet Reorderer: Fetched %d, next packet missing\n", it->pck_seq_num));
+		return it;
+	}
 
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Inserting packet %d", pck_seqnum));
-			//done
-			return GF_OK;
-		}
-		cur = cur->next;
+	//update timing
+	if (!po->LastTime) {
+		po->LastTime = gf_sys_clock();
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: starting timeout at %d\n", po->LastTime));
+		return NULL;
 	}
-	
+	//if exceeding the delay send the head
+	if (gf_sys_clock() - po->LastTime >= po->MaxDelay) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Forcing output after %d ms wait (max allowed %d)\n", gf_sys_clock() - po->LastTime, po->MaxDelay));
+		return it;
+	}
+	return NULL;
+}
 
-discard:
-	gf_free(it->pck);
-	gf_free(it);
-	GF_LOG(GF_LOG_ERROR, GF_LOG_RTP, ("[rtp] Packet Reorderer: Dropping packet %d", pck_seqnum));
-	return GF_OK;
+//removes the head packet and moves the head to the next available packet
+static void gf_rtp_reorderer_pop(GF_RTPReorder *po, GF_POItem *it)
+{
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Fetching %d\n", it->pck_seq_num));
+	it->size = 0;
+	po->last_seqnum = it->pck_seq_num;
+	po->has_output = 1;
+	po->Count -= 1;
+	if (!po->Count) return;
+	//skip lost packets
+	do {
+		po->head_seqnum = (po->head_seqnum + 1) & 0xFFFF;
+	} while (!PO_ITEM(po, po->head_seqnum)->size);
 }
 
 //retrieve the first available packet. Note that the behavior will be undefined if the first
@@ -898,68 +923,35 @@ discard:
 //the BUFFER is yours, you must delete it
 void *gf_rtp_reorderer_get(GF_RTPReorder *po, u32 *pck_size)
 {
-	GF_POItem *t;
-	u32 bounds;
+	GF_POItem *it;
 	void *ret;
 
 	if (!po || !pck_size) return NULL;
 
 	*pck_size = 0;
+	it = gf_rtp_reorderer_check(po);
+	if (!it) return NULL;
+
+	*pck_size = it->size;
+	//give the packet buffer away, the slot will allocate a new one
+	ret = it->pck;
+	it->pck = NULL;
+	it->alloc_size = 0;
+	gf_rtp_reorderer_pop(po, it);
+	return ret;
+}
 
-	//empty queue
-	if (!po->in) return NULL;
-
-	//check we have received the first packet
-	if ( po->head_seqnum && po->MaxCount
-		&& (po->MaxCount > po->Count) 
-		&& (po->in->pck_seq_num != po->head_seqnum)) 
-		return NULL;
-
-	//no entry
-	if (!po->in->next) goto check_timeout;
-
-	bounds = 0;
-	if ( (po->head_seqnum >= 0xf000 ) || (po->head_seqnum <= 0x1000) ) bounds = 0x2000;
-
-	//release the output if SN in order or maxCount reached
-	if (( (u16) (po->in->pck_seq_num + bounds + 1) == (u16) (po->in->next->pck_seq_num + bounds)) 
-		|| (po->MaxCount && (po->Count >= po->MaxCount)) ) {
-
-#ifndef GPAC_DISABLE_LOG
-		if (po->in->pck_seq_num + 1 != po->in->next->pck_seq_num) 
-			GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[rtp] Packet Reorderer: Fetched %d expected %d\n", po->in->pck_seq_num, po->in->next->pck_seq_num));
-#endif
-		goto send_it;
-	}
-	//update timing
-	else {
-check_timeout:
-		if (!po->LastTime) {
-			po->LastTime = gf_sys_clock();
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: starting timeout at %d\n", po->LastTime));
-			return NULL;
-		}
-		//if exceeding the delay send the head
-		if (gf_sys_clock() - po->LastTime >= po->MaxDelay) {
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Forcing output after %d ms wait (max allowed %d)\n", gf_sys_clock() - po->LastTime, po->MaxDelay));
-			goto send_it;
-		}
-	}
-	return NULL;
-
+//same as above but copies the packet in the given buffer, keeping the slot buffer for later packets
+static u32 gf_rtp_reorderer_get_copy(GF_RTPReorder *po, char *buffer, u32 buffer_size)
+{
+	u32 size;
+	GF_POItem *it = gf_rtp_reorderer_check(po);
+	if (!it) return 0;
 
-send_it:
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Fetching %d\n", po->in->pck_seq_num));
-	*pck_size = po->in->size;
-	t = po->in;
-	po->in = po->in->next;
-	//no other output. reset the head seqnum
-	po->head_seqnum = po->in ? po->in->pck_seq_num : 0;
-	po->Count -= 1;
-	//release the item
-	ret = t->pck;
-	gf_free(t);
-	return ret;
+	size = MIN(it->size, buffer_size);
+	memcpy(buffer, it->pck, size);
+	gf_rtp_reorderer_pop(po, it);
+	return size;
 }
 
 #endif /*GPAC_DISABLE_STREAMING*/
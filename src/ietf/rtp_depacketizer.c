@@ -582,18 +582,103 @@ static void gf_rtp_parse_ttxt(GF_RTPDepacketizer *rtp, GF_RTPHeader *hdr, char *
 	gf_bs_del(bs);
 }
 
-static void gf_rtp_h264_flush(GF_RTPDepacketizer *rtp, GF_RTPHeader *hdr, Bool missed_end)
+/*makes sure size bytes can be written after the current AU and NAL data, returns the write pointer*/
+static char *gf_rtp_au_reserve(GF_RTPDepacketizer *rtp, u32 size)
 {
-	char *data;
-	u32 data_size, nal_s;
-	if (!rtp->inter_bs) return;
+	u32 needed = rtp->au_size + rtp->nal_size + size;
+	if (rtp->au_alloc < needed) {
+		/*new AU buffers start with the size of the previous AU buffer, usually avoiding any realloc*/
+		u32 alloc = rtp->au_alloc ? rtp->au_alloc : (rtp->au_last_alloc ? rtp->au_last_alloc : 4096);
+		while (alloc < needed) alloc *= 2;
+		rtp->au_data = (char*)gf_realloc(rtp->au_data, sizeof(char)*alloc);
+		rtp->au_alloc = alloc;
+	}
+	return rtp->au_data + rtp->au_size + rtp->nal_size;
+}
 
-	data = NULL;
-	data_size = 0;
-	gf_bs_get_content(rtp->inter_bs, &data, &data_size);
-	gf_bs_del(rtp->inter_bs);
-	rtp->inter_bs = NULL;
-	nal_s = data_size-4;
+/*AU mode: delivers the current AU to the user and gets a new buffer from the dropped AUs given back if any*/
+static void gf_rtp_au_dispatch(GF_RTPDepacketizer *rtp)
+{
+	char *au = rtp->au_data;
+	u32 size = rtp->au_size;
+	u32 alloc_size = rtp->au_alloc;
+
+	if (!size) return;
+	assert(!rtp->nal_size);
+
+	rtp->au_data = NULL;
+	rtp->au_size = rtp->au_alloc = 0;
+	rtp->au_last_alloc = alloc_size;
+	if (rtp->nb_au_pool) {
+		rtp->nb_au_pool--;
+		rtp->au_data = rtp->au_pool[rtp->nb_au_pool];
+		rtp->au_alloc = rtp->au_pool_alloc[rtp->nb_au_pool];
+	}
+	rtp->au_hdr.accessUnitStartFlag = rtp->au_hdr.accessUnitEndFlag = 1;
+	rtp->on_au(rtp->au_udta, au, size, alloc_size, &rtp->au_hdr);
+}
+
+static u32 gf_rtp_h264_close_nal(GF_RTPDepacketizer *rtp, Bool missed_end);
+
+/*AU mode: SL packets from payload parsers are appended to the AU buffer*/
+static void gf_rtp_au_sl_packet(void *udta, char *payload, u32 size, GF_SLHeader *hdr, GF_Err e)
+{
+	GF_RTPDepacketizer *rtp = (GF_RTPDepacketizer *)udta;
+	Bool in_place = (rtp->nal_size && (payload == rtp->au_data + rtp->au_size)) ? 1 : 0;
+
+	/*the NAL being reassembled was not completed, keep it in the AU as corrupted*/
+	if (rtp->nal_size && !in_place) rtp->au_size += gf_rtp_h264_close_nal(rtp, 1);
+
+	/*begining of a new AU, dispatch the previous one if its end was missed*/
+	if (hdr->accessUnitStartFlag && rtp->au_size && !in_place) gf_rtp_au_dispatch(rtp);
+
+	if (!rtp->au_size) {
+		rtp->au_hdr = *hdr;
+	} else if (hdr->randomAccessPointFlag) {
+		rtp->au_hdr.randomAccessPointFlag = 1;
+	}
+
+	if (size) {
+		/*NAL data already written in the AU buffer*/
+		if (in_place) {
+			rtp->nal_size = 0;
+		} else {
+			memcpy(gf_rtp_au_reserve(rtp, size), payload, size);
+		}
+		rtp->au_size += size;
+	}
+	if (hdr->accessUnitEndFlag) gf_rtp_au_dispatch(rtp);
+}
+
+GF_EXPORT
+void gf_rtp_depacketizer_set_au_callback(GF_RTPDepacketizer *rtp, void (*on_au)(void *udta, char *au, u32 size, u32 alloc_size, GF_SLHeader *hdr))
+{
+	if (!rtp || !on_au || rtp->on_au) return;
+	rtp->on_au = on_au;
+	rtp->au_udta = rtp->udta;
+	rtp->on_sl_packet = gf_rtp_au_sl_packet;
+	rtp->udta = rtp;
+}
+
+GF_EXPORT
+void gf_rtp_depacketizer_recycle_au(GF_RTPDepacketizer *rtp, char *au, u32 alloc_size)
+{
+	if (!au) return;
+	if (!rtp || (rtp->nb_au_pool == GF_RTP_AU_POOL_SIZE)) {
+		gf_free(au);
+		return;
+	}
+	rtp->au_pool[rtp->nb_au_pool] = au;
+	rtp->au_pool_alloc[rtp->nb_au_pool] = alloc_size;
+	rtp->nb_au_pool++;
+}
+
+/*writes the size field of the NAL reassembled from FU-A packets, located after the AU data, and returns its size*/
+static u32 gf_rtp_h264_close_nal(GF_RTPDepacketizer *rtp, Bool missed_end)
+{
+	char *data = rtp->au_data + rtp->au_size;
+	u32 data_size = rtp->nal_size;
+	u32 nal_s = data_size-4;
 
 	if (rtp->flags & GF_RTP_AVC_USE_ANNEX_B) {
 		data[0] = data[1] = data[2] = 0; data[3] = 1;
@@ -602,6 +687,20 @@ static void gf_rtp_h264_flush(GF_RTPDepacketizer *rtp, GF_RTPHeader *hdr, Bool m
 	}
 	/*set F-bit since nal is corrupted*/
 	if (missed_end) data[4] |= 0x80;
+	rtp->nal_size = 0;
+	return data_size;
+}
+
+static void gf_rtp_h264_flush(GF_RTPDepacketizer *rtp, GF_RTPHeader *hdr, Bool missed_end)
+{
+	char *data;
+	u32 data_size;
+	if (!rtp->nal_size) return;
+
+	data = rtp->au_data + rtp->au_size;
+	data_size = gf_rtp_h264_close_nal(rtp, missed_end);
+	/*in AU mode, the NAL data stays pending until appended in place to the AU*/
+	if (rtp->on_au) rtp->nal_size = data_size;
 
 	rtp->sl_hdr.accessUnitEndFlag = (rtp->flags & GF_RTP_UNRELIABLE_M) ? 0 : hdr->Marker;
 	rtp->sl_hdr.compositionTimeStampFlag = 1;
@@ -610,7 +709,6 @@ static void gf_rtp_h264_flush(GF_RTPDepacketizer *rtp, GF_RTPHeader *hdr, Bool m
 	rtp->on_sl_packet(rtp->udta, data, data_size, &rtp->sl_hdr, GF_OK);
 	rtp->sl_hdr.accessUnitStartFlag = 0;
 	rtp->sl_hdr.randomAccessPointFlag = 0;
-	gf_free(data);
 }
 
 void gf_rtp_parse_h264(GF_RTPDepacketizer *rtp, GF_RTPHeader *hdr, char *payload, u32 size)
@@ -708,20 +806,27 @@ void gf_rtp_parse_h264(GF_RTPDepacketizer *rtp, GF_RTPHeader *hdr, char *payload
 			return;
 
 		/*setup*/
-		if (!rtp->inter_bs) {
-			u8 nal_hdr;
-			rtp->inter_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+		if (!rtp->nal_size) {
+			char *nal;
+			/*AU mode, the NAL begins a new AU: dispatch the previous one now since the NAL is reassembled after it*/
+			if (rtp->on_au && rtp->sl_hdr.accessUnitStartFlag) gf_rtp_au_dispatch(rtp);
+			/*and the AU header is the one of the NAL in case its end is never received*/
+			if (rtp->on_au && !rtp->au_size) rtp->au_hdr = rtp->sl_hdr;
+
+			nal = gf_rtp_au_reserve(rtp, 5);
+			/*dummy size field*/
+			nal[0] = nal[1] = nal[2] = nal[3] = 0;
 			/*copy F and NRI*/
-			nal_hdr = payload[0] & 0xE0;
+			nal[4] = payload[0] & 0xE0;
 			/*start bit not set, signal corrupted data (we missed start packet)*/
-			if (!is_start) nal_hdr |= 0x80;
+			if (!is_start) nal[4] |= 0x80;
 			/*copy NALU type*/
-			nal_hdr |= (payload[1] & 0x1F);
-			/*dummy size field*/
-			gf_bs_write_u32(rtp->inter_bs, 0);
-			gf_bs_write_u8(rtp->inter_bs, nal_hdr);
+			nal[4] |= (payload[1] & 0x1F);
+			rtp->nal_size = 5;
 		}
-		gf_bs_write_data(rtp->inter_bs, payload+2, size-2);
+		/*write fragment data directly after the AU*/
+		memcpy(gf_rtp_au_reserve(rtp, size-2), payload+2, size-2);
+		rtp->nal_size += size-2;
 		if (is_end || hdr->Marker) gf_rtp_h264_flush(rtp, hdr, 0);
 	}
 }
@@ -1459,6 +1564,8 @@ void gf_rtp_depacketizer_reset(GF_RTPDepacketizer *rtp, Bool full_reset)
 	if (rtp) {
 		if (rtp->inter_bs) gf_bs_del(rtp->inter_bs);
 		rtp->inter_bs = NULL;
+		/*discard pending AU / NAL data but keep the buffer*/
+		rtp->au_size = rtp->nal_size = 0;
 		rtp->flags |= GF_RTP_NEW_AU;
 		if (full_reset) {
 			u32 dur = rtp->sl_hdr.au_duration;
@@ -1473,6 +1580,11 @@ void gf_rtp_depacketizer_del(GF_RTPDepacketizer *rtp)
 {
 	if (rtp) {
 		gf_rtp_depacketizer_reset(rtp, 0);
+		if (rtp->au_data) gf_free(rtp->au_data);
+		while (rtp->nb_au_pool) {
+			rtp->nb_au_pool--;
+			gf_free(rtp->au_pool[rtp->nb_au_pool]);
+		}
 		if (rtp->sl_map.config) gf_free(rtp->sl_map.config);
 		if (rtp->key) gf_free(rtp->key);
 		gf_free(rtp);
@@ -29,6 +29,19 @@
 
 #ifndef GPAC_DISABLE_ISOM
 
+/*in lazy mode, only records where the entry table is located and skips it - the table is decoded by gf_isom_box_unpack_lazy*/
+static Bool isom_lazy_table_defer(GF_Box *s, GF_BitStream *bs, u64 table_size)
+{
+	GF_LazyTableBox *ptr = (GF_LazyTableBox *)s;
+	if (!table_size || !(gf_bs_get_cookie(bs) & GF_ISOM_BS_COOKIE_LAZY_TABLES)) return 0;
+	/*broken table, let the regular parsing deal with it*/
+	if (table_size > gf_bs_available(bs)) return 0;
+	ptr->lazy_bs = bs;
+	ptr->lazy_offset = gf_bs_get_position(bs);
+	gf_bs_skip_bytes(bs, table_size);
+	return 1;
+}
+
 void co64_del(GF_Box *s)
 {
 	GF_ChunkLargeOffsetBox *ptr;
@@ -38,14 +51,9 @@ void co64_del(GF_Box *s)
 	gf_free(ptr);
 }
 
-GF_Err co64_Read(GF_Box *s,GF_BitStream *bs)
+static GF_Err co64_read_entries(GF_ChunkLargeOffsetBox *ptr, GF_BitStream *bs)
 {
-	GF_Err e;
 	u32 entries;
-	GF_ChunkLargeOffsetBox *ptr = (GF_ChunkLargeOffsetBox *) s;
-	e = gf_isom_full_box_read(s, bs);
-	if (e) return e;
-	ptr->nb_entries = gf_bs_read_u32(bs);
 	ptr->offsets = (u64 *) gf_malloc(ptr->nb_entries * sizeof(u64) );
 	if (ptr->offsets == NULL) return GF_OUT_OF_MEM;
 	ptr->alloc_size = ptr->nb_entries;
@@ -55,6 +63,17 @@ GF_Err co64_Read(GF_Box *s,GF_BitStream *bs)
 	return GF_OK;
 }
 
+GF_Err co64_Read(GF_Box *s,GF_BitStream *bs)
+{
+	GF_Err e;
+	GF_ChunkLargeOffsetBox *ptr = (GF_ChunkLargeOffsetBox *) s;
+	e = gf_isom_full_box_read(s, bs);
+	if (e) return e;
+	ptr->nb_entries = gf_bs_read_u32(bs);
+	if (isom_lazy_table_defer(s, bs, (u64) ptr->nb_entries * 8)) return GF_OK;
+	return co64_read_entries(ptr, bs);
+}
+
 GF_Box *co64_New()
 {
 	ISOM_DECL_BOX_ALLOC(GF_ChunkLargeOffsetBox, GF_ISOM_BOX_TYPE_CO64);	
@@ -71,6 +90,8 @@ GF_Err co64_Write(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	GF_ChunkLargeOffsetBox *ptr = (GF_ChunkLargeOffsetBox *) s;
 	
+	e = gf_isom_box_unpack_lazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
@@ -307,16 +328,11 @@ void ctts_del(GF_Box *s)
 
 
 
-GF_Err ctts_Read(GF_Box *s, GF_BitStream *bs)
+static GF_Err ctts_read_entries(GF_CompositionOffsetBox *ptr, GF_BitStream *bs)
 {
-	GF_Err e;
 	u32 i;
 	u32 sampleCount;
-	GF_CompositionOffsetBox *ptr = (GF_CompositionOffsetBox *)s;
-	
-	e = gf_isom_full_box_read(s, bs);
-	if (e) return e;
-	ptr->nb_entries = gf_bs_read_u32(bs);
+
 	ptr->alloc_size = ptr->nb_entries;
 	ptr->entries = (GF_DttsEntry *)gf_malloc(sizeof(GF_DttsEntry)*ptr->alloc_size);
 	if (!ptr->entries) return GF_OUT_OF_MEM;
@@ -335,6 +351,18 @@ GF_Err ctts_Read(GF_Box *s, GF_BitStream *bs)
 	return GF_OK;
 }
 
+GF_Err ctts_Read(GF_Box *s, GF_BitStream *bs)
+{
+	GF_Err e;
+	GF_CompositionOffsetBox *ptr = (GF_CompositionOffsetBox *)s;
+	
+	e = gf_isom_full_box_read(s, bs);
+	if (e) return e;
+	ptr->nb_entries = gf_bs_read_u32(bs);
+	if (isom_lazy_table_defer(s, bs, (u64) ptr->nb_entries * 8)) return GF_OK;
+	return ctts_read_entries(ptr, bs);
+}
+
 GF_Box *ctts_New()
 {
 	ISOM_DECL_BOX_ALLOC(GF_CompositionOffsetBox, GF_ISOM_BOX_TYPE_CTTS);
@@ -353,6 +381,8 @@ GF_Err ctts_Write(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	GF_CompositionOffsetBox *ptr = (GF_CompositionOffsetBox *)s;
 	
+	e = gf_isom_box_unpack_lazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
@@ -4740,16 +4770,9 @@ void stco_del(GF_Box *s)
 }
 
 
-GF_Err stco_Read(GF_Box *s, GF_BitStream *bs)
+static GF_Err stco_read_entries(GF_ChunkOffsetBox *ptr, GF_BitStream *bs)
 {
-	GF_Err e;
 	u32 entries;
-	GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)s;
-
-	e = gf_isom_full_box_read(s, bs);
-	if (e) return e;
-	ptr->nb_entries = gf_bs_read_u32(bs);
-
 	if (ptr->nb_entries) {
 		ptr->offsets = (u32 *) gf_malloc(ptr->nb_entries * sizeof(u32) );
 		if (ptr->offsets == NULL) return GF_OUT_OF_MEM;
@@ -4762,6 +4785,18 @@ GF_Err stco_Read(GF_Box *s, GF_BitStream *bs)
 	return GF_OK;
 }
 
+GF_Err stco_Read(GF_Box *s, GF_BitStream *bs)
+{
+	GF_Err e;
+	GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)s;
+
+	e = gf_isom_full_box_read(s, bs);
+	if (e) return e;
+	ptr->nb_entries = gf_bs_read_u32(bs);
+	if (isom_lazy_table_defer(s, bs, (u64) ptr->nb_entries * 4)) return GF_OK;
+	return stco_read_entries(ptr, bs);
+}
+
 GF_Box *stco_New()
 {
 	ISOM_DECL_BOX_ALLOC(GF_ChunkOffsetBox, GF_ISOM_BOX_TYPE_STCO);
@@ -4778,6 +4813,8 @@ GF_Err stco_Write(GF_Box *s, GF_BitStream *bs)
 	GF_Err e;
 	u32 i;
 	GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)s;
+	e = gf_isom_box_unpack_lazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
@@ -5277,15 +5314,9 @@ void stss_del(GF_Box *s)
 	gf_free(ptr);
 }
 
-GF_Err stss_Read(GF_Box *s, GF_BitStream *bs)
+static GF_Err stss_read_entries(GF_SyncSampleBox *ptr, GF_BitStream *bs)
 {
-	GF_Err e;
 	u32 i;
-	GF_SyncSampleBox *ptr = (GF_SyncSampleBox *)s;
-
-	e = gf_isom_full_box_read(s, bs);
-	if (e) return e;
-	ptr->nb_entries = gf_bs_read_u32(bs);
 	ptr->alloc_size = ptr->nb_entries;
 	ptr->sampleNumbers = (u32 *) gf_malloc( ptr->alloc_size * sizeof(u32));
 	if (ptr->sampleNumbers == NULL) return GF_OUT_OF_MEM;
@@ -5296,6 +5327,18 @@ GF_Err stss_Read(GF_Box *s, GF_BitStream *bs)
 	return GF_OK;
 }
 
+GF_Err stss_Read(GF_Box *s, GF_BitStream *bs)
+{
+	GF_Err e;
+	GF_SyncSampleBox *ptr = (GF_SyncSampleBox *)s;
+
+	e = gf_isom_full_box_read(s, bs);
+	if (e) return e;
+	ptr->nb_entries = gf_bs_read_u32(bs);
+	if (isom_lazy_table_defer(s, bs, (u64) ptr->nb_entries * 4)) return GF_OK;
+	return stss_read_entries(ptr, bs);
+}
+
 GF_Box *stss_New()
 {
 	ISOM_DECL_BOX_ALLOC(GF_SyncSampleBox, GF_ISOM_BOX_TYPE_STSS);
@@ -5312,6 +5355,8 @@ GF_Err stss_Write(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	GF_SyncSampleBox *ptr = (GF_SyncSampleBox *)s;
 
+	e = gf_isom_box_unpack_lazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
@@ -5343,10 +5388,13 @@ void stsz_del(GF_Box *s)
 }
 
 
+static GF_Err stsz_read_entries(GF_SampleSizeBox *ptr, GF_BitStream *bs);
+
 GF_Err stsz_Read(GF_Box *s, GF_BitStream *bs)
 {
 	GF_Err e;
 	u32 i, estSize;
+	u64 table_size;
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
 	if (ptr == NULL) return GF_BAD_PARAM;
 
@@ -5388,6 +5436,21 @@ GF_Err stsz_Read(GF_Box *s, GF_BitStream *bs)
 		}
 	}
 	if (s->type == GF_ISOM_BOX_TYPE_STSZ) {
+		if (ptr->sampleSize) return GF_OK;
+		table_size = (u64) ptr->sampleCount * 4;
+	} else if (ptr->sampleSize == 4) {
+		table_size = ((u64) ptr->sampleCount + 1) / 2;
+	} else {
+		table_size = (u64) ptr->sampleCount * ptr->sampleSize / 8;
+	}
+	if (isom_lazy_table_defer(s, bs, table_size)) return GF_OK;
+	return stsz_read_entries(ptr, bs);
+}
+
+static GF_Err stsz_read_entries(GF_SampleSizeBox *ptr, GF_BitStream *bs)
+{
+	u32 i;
+	if (ptr->type == GF_ISOM_BOX_TYPE_STSZ) {
 		if (! ptr->sampleSize && ptr->sampleCount) {
 			ptr->sizes = (u32 *) gf_malloc(ptr->sampleCount * sizeof(u32));
 			ptr->alloc_size = ptr->sampleCount;
@@ -5444,6 +5507,8 @@ GF_Err stsz_Write(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
 	
+	e = gf_isom_box_unpack_lazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	//in both versions this is still valid
@@ -5489,6 +5554,9 @@ GF_Err stsz_Size(GF_Box *s)
 	GF_Err e;
 	u32 i, fieldSize, size;
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
+	/*the compact field size is computed from the sizes*/
+	e = gf_isom_box_unpack_lazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_get_size(s);
 	if (e) return e;
 
@@ -5561,19 +5629,13 @@ void stts_del(GF_Box *s)
 }
 
 
-GF_Err stts_Read(GF_Box *s, GF_BitStream *bs)
+static GF_Err stts_read_entries(GF_TimeToSampleBox *ptr, GF_BitStream *bs)
 {
-	GF_Err e;
 	u32 i;
-	GF_TimeToSampleBox *ptr = (GF_TimeToSampleBox *)s;
-
-	e = gf_isom_full_box_read(s, bs);
-	if (e) return e;
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 	ptr->w_LastDTS = 0;
 #endif
-	ptr->nb_entries = gf_bs_read_u32(bs);
 	ptr->alloc_size = ptr->nb_entries;
 	ptr->entries = gf_malloc(sizeof(GF_SttsEntry)*ptr->alloc_size);
 	if (!ptr->entries) return GF_OUT_OF_MEM;
@@ -5592,6 +5654,18 @@ GF_Err stts_Read(GF_Box *s, GF_BitStream *bs)
 	return GF_OK;
 }
 
+GF_Err stts_Read(GF_Box *s, GF_BitStream *bs)
+{
+	GF_Err e;
+	GF_TimeToSampleBox *ptr = (GF_TimeToSampleBox *)s;
+
+	e = gf_isom_full_box_read(s, bs);
+	if (e) return e;
+	ptr->nb_entries = gf_bs_read_u32(bs);
+	if (isom_lazy_table_defer(s, bs, (u64) ptr->nb_entries * 8)) return GF_OK;
+	return stts_read_entries(ptr, bs);
+}
+
 GF_Box *stts_New()
 {
 	ISOM_DECL_BOX_ALLOC(GF_TimeToSampleBox, GF_ISOM_BOX_TYPE_STTS);
@@ -5608,6 +5682,8 @@ GF_Err stts_Write(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	GF_TimeToSampleBox *ptr = (GF_TimeToSampleBox *)s;
 	
+	e = gf_isom_box_unpack_lazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
@@ -5632,6 +5708,53 @@ GF_Err stts_Size(GF_Box *s)
 #endif /*GPAC_DISABLE_ISOM_WRITE*/
 
 
+GF_Err gf_isom_box_unpack_lazy(GF_Box *a)
+{
+	GF_Err e;
+	u64 pos;
+	GF_BitStream *bs;
+	GF_LazyTableBox *ptr = (GF_LazyTableBox *)a;
+	if (!ptr || !ptr->lazy_bs) return GF_OK;
+
+	bs = ptr->lazy_bs;
+	ptr->lazy_bs = NULL;
+	/*the movie bitstream is shared with the sample data reader, restore its position*/
+	pos = gf_bs_get_position(bs);
+	gf_bs_seek(bs, ptr->lazy_offset);
+	switch (a->type) {
+	case GF_ISOM_BOX_TYPE_STTS: e = stts_read_entries((GF_TimeToSampleBox *)a, bs); break;
+	case GF_ISOM_BOX_TYPE_CTTS: e = ctts_read_entries((GF_CompositionOffsetBox *)a, bs); break;
+	case GF_ISOM_BOX_TYPE_STSS: e = stss_read_entries((GF_SyncSampleBox *)a, bs); break;
+	case GF_ISOM_BOX_TYPE_STSZ: 
+	case GF_ISOM_BOX_TYPE_STZ2: e = stsz_read_entries((GF_SampleSizeBox *)a, bs); break;
+	case GF_ISOM_BOX_TYPE_STCO: e = stco_read_entries((GF_ChunkOffsetBox *)a, bs); break;
+	case GF_ISOM_BOX_TYPE_CO64: e = co64_read_entries((GF_ChunkLargeOffsetBox *)a, bs); break;
+	default: e = GF_BAD_PARAM; break;
+	}
+	gf_bs_seek(bs, pos);
+	ptr->lazy_offset = 0;
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to load entries of box \"%s\": %s\n", gf_4cc_to_str(a->type), gf_error_to_string(e) ));
+	}
+	return e;
+}
+
+GF_Err stbl_unpack_lazy_tables(GF_SampleTableBox *stbl)
+{
+	GF_Err e;
+	if (!stbl) return GF_OK;
+	e = gf_isom_box_unpack_lazy((GF_Box *) stbl->TimeToSample);
+	if (e) return e;
+	e = gf_isom_box_unpack_lazy((GF_Box *) stbl->CompositionOffset);
+	if (e) return e;
+	e = gf_isom_box_unpack_lazy((GF_Box *) stbl->SyncSample);
+	if (e) return e;
+	e = gf_isom_box_unpack_lazy((GF_Box *) stbl->SampleSize);
+	if (e) return e;
+	return gf_isom_box_unpack_lazy(stbl->ChunkOffset);
+}
+
+
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 
 void tfhd_del(GF_Box *s)
@@ -1108,6 +1108,7 @@ GF_Err stts_dump(GF_Box *a, FILE * trace)
 	u32 i, nb_samples;
 
 	p = (GF_TimeToSampleBox *)a;
+	gf_isom_box_unpack_lazy(a);
 	fprintf(trace, "<TimeToSampleBox EntryCount=\"%d\">\n", p->nb_entries);
 	DumpBox(a, trace);
 	gf_full_box_dump(a, trace);
@@ -1127,6 +1128,7 @@ GF_Err ctts_dump(GF_Box *a, FILE * trace)
 	GF_CompositionOffsetBox *p;
 	u32 i, nb_samples;
 	p = (GF_CompositionOffsetBox *)a;
+	gf_isom_box_unpack_lazy(a);
 	fprintf(trace, "<CompositionOffsetBox EntryCount=\"%d\">\n", p->nb_entries);
 	DumpBox(a, trace);
 	gf_full_box_dump(a, trace);
@@ -1219,6 +1221,7 @@ GF_Err stsz_dump(GF_Box *a, FILE * trace)
 	GF_SampleSizeBox *p;
 	u32 i;
 	p = (GF_SampleSizeBox *)a;
+	gf_isom_box_unpack_lazy(a);
 
 	fprintf(trace, "<%sBox SampleCount=\"%d\"", (a->type == GF_ISOM_BOX_TYPE_STSZ) ? "SampleSize" : "CompactSampleSize", p->sampleCount);
 	if (a->type == GF_ISOM_BOX_TYPE_STSZ) {
@@ -1253,6 +1256,7 @@ GF_Err stco_dump(GF_Box *a, FILE * trace)
 	u32 i;
 
 	p = (GF_ChunkOffsetBox *)a;
+	gf_isom_box_unpack_lazy(a);
 	fprintf(trace, "<ChunkOffsetBox EntryCount=\"%d\">\n", p->nb_entries);
 	DumpBox(a, trace);
 	gf_full_box_dump(a, trace);
@@ -1274,6 +1278,7 @@ GF_Err stss_dump(GF_Box *a, FILE * trace)
 	u32 i;
 
 	p = (GF_SyncSampleBox *)a;
+	gf_isom_box_unpack_lazy(a);
 	fprintf(trace, "<SyncSampleBox EntryCount=\"%d\">\n", p->nb_entries);
 	DumpBox(a, trace);
 	gf_full_box_dump(a, trace);
@@ -1357,6 +1362,7 @@ GF_Err co64_dump(GF_Box *a, FILE * trace)
 	u32 i;
 
 	p = (GF_ChunkLargeOffsetBox *)a;
+	gf_isom_box_unpack_lazy(a);
 	fprintf(trace, "<ChunkLargeOffsetBox EntryCount=\"%d\">\n", p->nb_entries);
 	DumpBox(a, trace);
 	gf_full_box_dump(a, trace);
@@ -42,6 +42,15 @@ GF_Err gf_isom_set_output_buffering(GF_ISOFile *movie, u32 size)
 	return gf_bs_set_output_buffering(movie->editFileMap->bs, size);
 }
 
+GF_EXPORT
+GF_Err gf_isom_set_mem_output_callback(GF_ISOFile *movie, gf_isom_mem_output_callback on_output, void *udta)
+{
+	if (!movie) return GF_BAD_PARAM;
+	movie->on_mem_output = on_output;
+	movie->mem_output_udta = udta;
+	return GF_OK;
+}
+
 
 void gf_isom_datamap_del(GF_DataMap *ptr)
 {
@@ -121,6 +130,17 @@ GF_Err gf_isom_datamap_new(const char *location, const char *parentPath, u8 mode
 		//not supported yet
 		return GF_NOT_SUPPORTED;
 	}
+	//memory output
+	if (!strcmp(location, GF_ISOM_MEM_OUTPUT)) {
+#ifndef GPAC_DISABLE_ISOM_WRITE
+		if (mode != GF_ISOM_DATA_MAP_WRITE) return GF_NOT_SUPPORTED;
+		*outDataMap = gf_isom_fdm_new_mem();
+		if (! (*outDataMap)) return GF_OUT_OF_MEM;
+		return GF_OK;
+#else
+		return GF_NOT_SUPPORTED;
+#endif
+	}
 	//we need a temp file ...
 	if (!strcmp(location, "mp4_tmp_edit")) {
 #ifndef GPAC_DISABLE_ISOM_WRITE
@@ -292,6 +312,53 @@ GF_Err gf_isom_datamap_add_data(GF_DataMap *ptr, char *data, u32 dataSize)
 	}
 }
 
+void gf_isom_datamap_flush(GF_DataMap *map)
+{
+	if (!map) return;
+
+	if (map->type == GF_ISOM_DATA_FILE) {
+		gf_bs_flush(map->bs);
+	}
+}
+
+GF_DataMap *gf_isom_fdm_new_mem()
+{
+	GF_FileDataMap *tmp = (GF_FileDataMap *) gf_malloc(sizeof(GF_FileDataMap));
+	if (!tmp) return NULL;
+	memset(tmp, 0, sizeof(GF_FileDataMap));
+	tmp->type = GF_ISOM_DATA_FILE;
+	tmp->mode = GF_ISOM_DATA_MAP_WRITE;
+	tmp->bs = gf_bs_new_mem_file();
+	if (!tmp->bs) {
+		gf_free(tmp);
+		return NULL;
+	}
+	return (GF_DataMap *)tmp;
+}
+
+void gf_isom_send_mem_output(GF_ISOFile *movie, GF_BitStream *bs)
+{
+	char *data = NULL;
+	u32 size = 0;
+	gf_bs_get_content(bs, &data, &size);
+	if (!data) return;
+
+	if (movie->on_mem_output) {
+		movie->on_mem_output(movie->mem_output_udta, data, size);
+	} else {
+		gf_free(data);
+	}
+}
+
+void gf_isom_datamap_send_mem_output(GF_ISOFile *movie, GF_DataMap *map)
+{
+	GF_FileDataMap *fdm = (GF_FileDataMap *)map;
+	if (!map || (map->type != GF_ISOM_DATA_FILE)) return;
+	/*memory outputs are the only stream-less write maps*/
+	if (fdm->stream || (fdm->mode == GF_ISOM_DATA_MAP_READ)) return;
+	gf_isom_send_mem_output(movie, map->bs);
+}
+
 GF_DataMap *gf_isom_fdm_new_temp(const char *sPath)
 {
 	GF_FileDataMap *tmp = (GF_FileDataMap *) gf_malloc(sizeof(GF_FileDataMap));
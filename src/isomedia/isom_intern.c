@@ -351,9 +351,13 @@ GF_ISOFile *gf_isom_open_file(const char *fileName, u32 OpenMode, const char *tm
 {
 	GF_Err e;
 	u64 bytes;
+	Bool lazy_tables;
 	GF_ISOFile *mov = gf_isom_new_movie();
 	if (! mov) return NULL;
 
+	lazy_tables = (OpenMode & GF_ISOM_OPEN_LAZY_TABLES) ? 1 : 0;
+	OpenMode &= 0xFF;
+
 	mov->fileName = gf_strdup(fileName);
 	mov->openMode = OpenMode;
 
@@ -377,6 +381,8 @@ GF_ISOFile *gf_isom_open_file(const char *fileName, u32 OpenMode, const char *tm
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 		if (OpenMode == GF_ISOM_OPEN_READ_DUMP) mov->FragmentsFlags |= GF_ISOM_FRAG_READ_DEBUG;
 #endif
+		/*the movie file map is kept open until the file is closed, sample tables can be loaded from it later on*/
+		if (lazy_tables) gf_bs_set_cookie(mov->movieFileMap->bs, GF_ISOM_BS_COOKIE_LAZY_TABLES);
 
 	} else {
 
@@ -252,6 +252,10 @@ GF_Err gf_isom_close(GF_ISOFile *movie)
 		} else
 #endif
 			e = WriteToFile(movie);
+
+		/*memory output of WRITE mode is complete*/
+		if (!e && (movie->openMode == GF_ISOM_OPEN_WRITE))
+			gf_isom_datamap_send_mem_output(movie, movie->editFileMap);
 	}
 
 #endif /*GPAC_DISABLE_ISOM_WRITE*/
@@ -1105,6 +1109,7 @@ u32 gf_isom_has_time_offset(GF_ISOFile *the_file, u32 trackNumber)
 
 	//return true at the first offset found
 	ctts = trak->Media->information->sampleTable->CompositionOffset;
+	if (gf_isom_box_unpack_lazy((GF_Box *) ctts) != GF_OK) return 0;
 	for (i=0; i<ctts->nb_entries; i++) {
 		if (ctts->entries[i].decodingOffset && ctts->entries[i].sampleCount) return ctts->version ? 2 : 1;
 	}
@@ -1940,6 +1945,7 @@ GF_Err gf_isom_get_fragment_defaults(GF_ISOFile *the_file, u32 trackNumber,
 	//duration
 	if (defaultDuration) {
 		maxValue = value = 0;
+		gf_isom_box_unpack_lazy((GF_Box *) stbl->TimeToSample);
 		for (i=0; i<stbl->TimeToSample->nb_entries; i++) {
 			if (stbl->TimeToSample->entries[i].sampleCount>maxValue) {
 				value = stbl->TimeToSample->entries[i].sampleDelta;
@@ -2049,7 +2055,10 @@ GF_Err gf_isom_release_segment(GF_ISOFile *movie, Bool reset_tables)
 		if (trak->Media->information->dataHandler == movie->movieFileMap) {
 			trak->Media->information->dataHandler = NULL;
 		}
-		if (reset_tables) {
+		/*the movie file map is about to be destroyed, load the tables still pointing to it*/
+		if (!reset_tables) {
+			stbl_unpack_lazy_tables(trak->Media->information->sampleTable);
+		} else {
 			u32 type, dur;
 			u64 dts;
 			GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
@@ -2407,6 +2416,7 @@ u64 gf_isom_get_media_data_size(GF_ISOFile *movie, u32 trackNumber)
 	if (!tk) return 0;
 	stsz = tk->Media->information->sampleTable->SampleSize;
 	if (stsz->sampleSize) return stsz->sampleSize*stsz->sampleCount;
+	if (gf_isom_box_unpack_lazy((GF_Box *) stsz) != GF_OK) return 0;
 	size = 0;
 	for (i=0; i<stsz->sampleCount;i++) size += stsz->sizes[i];
 	return size;
@@ -25,6 +25,12 @@
  */
 
 #include <gpac/internal/isomedia_dev.h>
+#include <gpac/thread.h>
+
+#if defined(GPAC_CONFIG_LINUX) && !defined(GPAC_ANDROID)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
 
 #if !defined(GPAC_DISABLE_ISOM) && !defined(GPAC_DISABLE_ISOM_WRITE)
 
@@ -78,14 +84,150 @@ typedef struct
 	GF_Box *stco;
 } TrackWriter;
 
+/*number of sample buffers the writing thread may lag behind the reading one*/
+#define SAMPLE_WRITER_SLOTS	8
+/*consecutive samples are gathered in a slot until it holds this many bytes*/
+#define SAMPLE_WRITER_SLOT_SIZE	0x40000
+
+typedef struct
+{
+	char *data;
+	u32 size, alloc_size;
+} SampleWriterSlot;
+
+/*sample copy pipeline: payloads are read from the data maps in the calling thread and written to the 
+output bitstream by a dedicated thread, so that reading the next samples overlaps writing the previous ones*/
+typedef struct
+{
+	GF_BitStream *bs;
+	GF_Thread *th;
+	GF_Semaphore *free_slots, *ready_slots;
+	SampleWriterSlot slots[SAMPLE_WRITER_SLOTS];
+	u32 read_idx, write_idx;
+	/*slot being filled by the calling thread, if any*/
+	SampleWriterSlot *cur;
+	/*first write error, set by the writing thread*/
+	GF_Err e;
+	volatile Bool stop;
+} SampleWriter;
+
 typedef struct
 {
 	char *buffer;
 	u32 size;
 	GF_ISOFile *movie;
 	u32 total_samples, nb_done;
+	/*NULL when samples are copied synchronously*/
+	SampleWriter *sample_writer;
+	/*media data keeps its original layout, starting at layout_start in the original file*/
+	Bool keep_layout;
+	u64 layout_start;
 } MovieWriter;
 
+static u32 sample_writer_run(void *par)
+{
+	SampleWriter *sw = (SampleWriter *)par;
+	while (1) {
+		SampleWriterSlot *slot;
+		gf_sema_wait(sw->ready_slots);
+		if (sw->stop) break;
+
+		slot = &sw->slots[sw->read_idx];
+		sw->read_idx = (sw->read_idx + 1) % SAMPLE_WRITER_SLOTS;
+		if (!sw->e && (gf_bs_write_data(sw->bs, slot->data, slot->size) != slot->size))
+			sw->e = GF_IO_ERR;
+		gf_sema_notify(sw->free_slots, 1);
+	}
+	return 0;
+}
+
+/*the output bitstream shall not be used by the caller until the writer is flushed or destroyed*/
+static SampleWriter *sample_writer_new(GF_BitStream *bs)
+{
+	SampleWriter *sw;
+	GF_SAFEALLOC(sw, SampleWriter);
+	if (!sw) return NULL;
+	sw->bs = bs;
+	sw->free_slots = gf_sema_new(SAMPLE_WRITER_SLOTS, SAMPLE_WRITER_SLOTS);
+	sw->ready_slots = gf_sema_new(SAMPLE_WRITER_SLOTS+1, 0);
+	sw->th = gf_th_new("ISOSampleWriter");
+	if (!sw->free_slots || !sw->ready_slots || !sw->th || gf_th_run(sw->th, sample_writer_run, sw)) {
+		if (sw->th) gf_th_del(sw->th);
+		if (sw->free_slots) gf_sema_del(sw->free_slots);
+		if (sw->ready_slots) gf_sema_del(sw->ready_slots);
+		gf_free(sw);
+		return NULL;
+	}
+	return sw;
+}
+
+static void sample_writer_push(SampleWriter *sw)
+{
+	if (!sw->cur) return;
+	sw->cur = NULL;
+	gf_sema_notify(sw->ready_slots, 1);
+}
+
+/*returns a buffer of size bytes at the end of the current slot, to be committed with sample_writer_commit*/
+static GF_Err sample_writer_get_buffer(SampleWriter *sw, u32 size, char **buffer)
+{
+	SampleWriterSlot *slot;
+	*buffer = NULL;
+	if (sw->e) return sw->e;
+	if (sw->cur && (sw->cur->size + size > sw->cur->alloc_size) && (sw->cur->size + size > SAMPLE_WRITER_SLOT_SIZE))
+		sample_writer_push(sw);
+
+	if (!sw->cur) {
+		gf_sema_wait(sw->free_slots);
+		sw->cur = &sw->slots[sw->write_idx];
+		sw->write_idx = (sw->write_idx + 1) % SAMPLE_WRITER_SLOTS;
+		sw->cur->size = 0;
+	}
+	slot = sw->cur;
+	if (slot->size + size > slot->alloc_size) {
+		u32 alloc_size = MAX(slot->size + size, SAMPLE_WRITER_SLOT_SIZE);
+		char *data = (char*)gf_realloc(slot->data, alloc_size);
+		if (!data) return GF_OUT_OF_MEM;
+		slot->data = data;
+		slot->alloc_size = alloc_size;
+	}
+	*buffer = slot->data + slot->size;
+	return GF_OK;
+}
+
+static void sample_writer_commit(SampleWriter *sw, u32 size)
+{
+	sw->cur->size += size;
+}
+
+/*sends the current slot and waits for all pending data to be written*/
+static GF_Err sample_writer_flush(SampleWriter *sw)
+{
+	u32 i;
+	if (!sw) return GF_OK;
+	sample_writer_push(sw);
+	for (i=0; i<SAMPLE_WRITER_SLOTS; i++) 
+		gf_sema_wait(sw->free_slots);
+	gf_sema_notify(sw->free_slots, SAMPLE_WRITER_SLOTS);
+	return sw->e;
+}
+
+static void sample_writer_del(SampleWriter *sw)
+{
+	u32 i;
+	if (!sw) return;
+	sample_writer_flush(sw);
+	sw->stop = 1;
+	gf_sema_notify(sw->ready_slots, 1);
+	gf_th_del(sw->th);
+	gf_sema_del(sw->free_slots);
+	gf_sema_del(sw->ready_slots);
+	for (i=0; i<SAMPLE_WRITER_SLOTS; i++) {
+		if (sw->slots[i].data) gf_free(sw->slots[i].data);
+	}
+	gf_free(sw);
+}
+
 void CleanWriters(GF_List *writers)
 {
 	TrackWriter *writer;
@@ -209,6 +351,29 @@ static GF_Err ShiftOffset(GF_ISOFile *file, GF_List *writers, u64 offset)
 	while ((writer = (TrackWriter *)gf_list_enum(writers, &i))) {
 		if (writer->mdia->mediaTrack->meta) ShiftMetaOffset(writer->mdia->mediaTrack->meta, offset);
 
+		//if some offsets no longer fit in 32 bits, switch to 64 bit offsets before shifting
+		if (writer->stco->type == GF_ISOM_BOX_TYPE_STCO) {
+			stco = (GF_ChunkOffsetBox *) writer->stco;
+			for (k=0; k<stco->nb_entries; k++) {
+				if (stco->offsets[k] + offset > 0xFFFFFFFF) break;
+			}
+			if (k<stco->nb_entries) {
+				co64 = (GF_ChunkLargeOffsetBox *) gf_isom_box_new(GF_ISOM_BOX_TYPE_CO64);
+				if (!co64) return GF_OUT_OF_MEM;
+				co64->nb_entries = co64->alloc_size = stco->nb_entries;
+				co64->offsets = (u64*)gf_malloc(co64->nb_entries * sizeof(u64));
+				if (!co64->offsets) {
+					gf_isom_box_del((GF_Box *)co64);
+					return GF_OUT_OF_MEM;
+				}
+				for (l = 0; l < co64->nb_entries; l++) {
+					co64->offsets[l] = (u64) stco->offsets[l];
+				}
+				gf_isom_box_del(writer->stco);
+				writer->stco = (GF_Box *)co64;
+			}
+		}
+
 		//we have to proceed entry by entry in case a part of the media is not self-contained...
 		for (j=0; j<writer->stsc->nb_entries; j++) {
 			ent = &writer->stsc->entries[j];
@@ -220,28 +385,7 @@ static GF_Err ShiftOffset(GF_ISOFile *file, GF_List *writers, u64 offset)
 				//be carefull for the last entry, nextChunk is set to 0 in edit mode...
 				last = ent->nextChunk ? ent->nextChunk : stco->nb_entries + 1;
 				for (k = ent->firstChunk; k < last; k++) {
-
-					if (stco->offsets[k-1] + offset > 0xFFFFFFFF) {
-						//too bad, rewrite the table....
-						co64 = (GF_ChunkLargeOffsetBox *) gf_isom_box_new(GF_ISOM_BOX_TYPE_CO64);
-						if (!co64) return GF_OUT_OF_MEM;
-						co64->nb_entries = stco->nb_entries;
-						co64->offsets = (u64*)gf_malloc(co64->nb_entries * sizeof(u64));
-						if (!co64) {
-							gf_isom_box_del((GF_Box *)co64);
-							return GF_OUT_OF_MEM;
-						}
-						//duplicate the table 
-						for (l = 0; l < co64->nb_entries; l++) {
-							co64->offsets[l] = (u64) stco->offsets[l];
-							if (l + 1 == k) co64->offsets[l] += offset;
-						}
-						//and replace our box
-						gf_isom_box_del(writer->stco);
-						writer->stco = (GF_Box *)co64;
-					} else {
-						stco->offsets[k-1] += (u32) offset;
-					}
+					stco->offsets[k-1] += (u32) offset;
 				}
 			} else {
 				co64 = (GF_ChunkLargeOffsetBox *) writer->stco;
@@ -345,29 +489,41 @@ u64 GetMoovAndMetaSize(GF_ISOFile *movie, GF_List *writers)
 //Write a sample to the file - this is only called for self-contained media
 GF_Err WriteSample(MovieWriter *mw, u32 size, u64 offset, u8 isEdited, GF_BitStream *bs)
 {
+	GF_Err e;
 	GF_DataMap *map;
+	char *buffer;
 	u32 bytes;
+	Bool pipelined = (mw->sample_writer && (mw->sample_writer->bs == bs)) ? 1 : 0;
 
-	if (size>mw->size) {
-		mw->buffer = (char*)gf_realloc(mw->buffer, size);
-		mw->size = size;
+	if (pipelined) {
+		e = sample_writer_get_buffer(mw->sample_writer, size, &buffer);
+		if (e) return e;
+	} else {
+		if (size>mw->size) {
+			mw->buffer = (char*)gf_realloc(mw->buffer, size);
+			mw->size = size;
+		}
+		if (!mw->buffer) return GF_OUT_OF_MEM;
+		buffer = mw->buffer;
 	}
 
-	if (!mw->buffer) return GF_OUT_OF_MEM;
-
 	if (isEdited) {
 		map = mw->movie->editFileMap;
 	} else {
 		map = mw->movie->movieFileMap;
 	}
 	//get the payload...
-	bytes = gf_isom_datamap_get_data(map, mw->buffer, size, offset);
-	if (bytes != size) 
-		return GF_IO_ERR;
-	//write it to our stream...
-	bytes = gf_bs_write_data(bs, mw->buffer, size);
+	bytes = gf_isom_datamap_get_data(map, buffer, size, offset);
 	if (bytes != size) 
 		return GF_IO_ERR;
+	//write it to our stream, or let the writing thread do it
+	if (pipelined) {
+		sample_writer_commit(mw->sample_writer, size);
+	} else {
+		bytes = gf_bs_write_data(bs, buffer, size);
+		if (bytes != size) 
+			return GF_IO_ERR;
+	}
 
 	mw->nb_done++;
 	gf_set_progress("ISO File Writing", mw->nb_done, mw->total_samples);
@@ -561,6 +717,10 @@ GF_Err DoWrite(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8 Emulation
 				offset = sampOffset;
 				if (predOffset != offset) 
 					force = 1;
+			} else if (mw->keep_layout) {
+				offset = StartOffset + sampOffset - mw->layout_start;
+				if (predOffset != offset) 
+					force = 1;
 			}
 			//update our global offset...
 			if (Media_IsSelfContained(writer->mdia, descIndex) ) {
@@ -568,6 +728,8 @@ GF_Err DoWrite(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8 Emulation
 				if (e) return e;
 				if (movie->openMode == GF_ISOM_OPEN_WRITE) {
 					predOffset = sampOffset + sampSize;
+				} else if (mw->keep_layout) {
+					predOffset = offset + sampSize;
 				} else {
 					offset += sampSize;
 					mdatSize += sampSize;
@@ -596,15 +758,48 @@ GF_Err DoWrite(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8 Emulation
 	}
 	//set the mdatSize...
 	movie->mdat->dataSize = mdatSize;
-	return GF_OK;
+	//wait for pending samples before the bitstream is used again
+	return sample_writer_flush(mw->sample_writer);
 }
 
 
+//capture mode: write the moov in the free box reserved at the begining of the file, if it fits
+static GF_Err WriteMoovInReservedSpace(GF_ISOFile *movie, GF_List *writers, GF_BitStream *bs, Bool *written)
+{
+	GF_Err e;
+	u64 size, pos;
+
+	*written = 0;
+	if ((movie->openMode != GF_ISOM_OPEN_WRITE) || !movie->moov_reserved_offset) return GF_OK;
+
+	size = GetMoovAndMetaSize(movie, writers);
+	/*the remaining space must hold a free box*/
+	if ((size != movie->moov_reserved_size) && (size + 8 > movie->moov_reserved_size)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[IsoMedia] moov size "LLU" exceeds the %d bytes reserved for it - writing it at the end of the file\n", size, movie->moov_reserved_size));
+		return GF_OK;
+	}
+	pos = gf_bs_get_position(bs);
+	e = gf_bs_seek(bs, movie->moov_reserved_offset);
+	if (e) return e;
+	e = WriteMoovAndMeta(movie, writers, bs);
+	if (e) return e;
+	/*the reserved space was filled with 0, only write the free box header*/
+	if (size < movie->moov_reserved_size) {
+		gf_bs_write_u32(bs, (u32) (movie->moov_reserved_size - size));
+		gf_bs_write_u32(bs, GF_ISOM_BOX_TYPE_FREE);
+	}
+	e = gf_bs_seek(bs, pos);
+	if (e) return e;
+	*written = 1;
+	return GF_OK;
+}
+
 //write the file track by track, with moov box before or after the mdat
 GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs)
 {
 	GF_Err e;
 	u32 i;
+	Bool moov_written;
 	u64 offset, finalOffset, totSize, begin, firstSize, finalSize;
 	GF_Box *a;
 	GF_List *writers = gf_list_new();
@@ -645,6 +840,7 @@ GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs)
 				if (movie->is_jp2) begin += 12;
 				if (movie->brand) begin += movie->brand->size;
 				if (movie->pdin) begin += movie->pdin->size;
+				if (movie->moov_reserved_offset) begin += movie->moov_reserved_size;
 			}
 			totSize -= begin;
 		} else {
@@ -707,9 +903,13 @@ GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs)
 			}
 		}
 
-		//OK, write the movie box.
-		e = WriteMoovAndMeta(movie, writers, bs);
+		//OK, write the movie box, in the space reserved for it if possible
+		e = WriteMoovInReservedSpace(movie, writers, bs, &moov_written);
 		if (e) goto exit;
+		if (!moov_written) {
+			e = WriteMoovAndMeta(movie, writers, bs);
+			if (e) goto exit;
+		}
 
 #ifndef GPAC_DISABLE_ISOM_ADOBE
 		i=0;
@@ -826,6 +1026,232 @@ exit:
 	return e;
 }
 
+typedef struct
+{
+	u64 start, end;
+} MediaDataRange;
+
+static int compare_media_range(const void *a, const void *b)
+{
+	const MediaDataRange *ra = (const MediaDataRange *)a;
+	const MediaDataRange *rb = (const MediaDataRange *)b;
+	if (ra->start < rb->start) return -1;
+	return (ra->start > rb->start) ? 1 : 0;
+}
+
+/*checks that all media data stored in the file comes from the original file and gets the byte range it spans there.
+The range must only contain the data of the samples written, otherwise data of removed tracks or samples would be kept*/
+static Bool GetMediaDataRange(MovieWriter *mw, GF_List *writers, u64 *start, u64 *end)
+{
+	u32 i, j, chunkNumber, descIndex, sampSize, nb_ranges, alloc_ranges;
+	u64 sampOffset;
+	u8 isEdited;
+	Bool ret;
+	TrackWriter *writer;
+	MediaDataRange *ranges;
+	GF_ISOFile *movie = mw->movie;
+
+	if (!movie->movieFileMap) return 0;
+	/*items are not handled*/
+	if (movie->meta || (movie->moov && movie->moov->meta)) return 0;
+
+	/*byte ranges of consecutive samples, usually one per chunk*/
+	nb_ranges = 0;
+	alloc_ranges = 64;
+	ranges = (MediaDataRange *)gf_malloc(sizeof(MediaDataRange) * alloc_ranges);
+	if (!ranges) return 0;
+	ret = 0;
+
+	i=0;
+	while ((writer = (TrackWriter*)gf_list_enum(writers, &i))) {
+		GF_SampleTableBox *stbl = writer->mdia->information->sampleTable;
+		if (writer->mdia->mediaTrack->meta) goto exit;
+
+		for (j=0; j<stbl->SampleSize->sampleCount; j++) {
+			if (stbl_GetSampleInfos(stbl, j+1, &sampOffset, &chunkNumber, &descIndex, &isEdited)) goto exit;
+			if (!Media_IsSelfContained(writer->mdia, descIndex)) continue;
+			if (isEdited) goto exit;
+			if (stbl_GetSampleSize(stbl->SampleSize, j+1, &sampSize)) goto exit;
+			if (nb_ranges && (ranges[nb_ranges-1].end == sampOffset)) {
+				ranges[nb_ranges-1].end += sampSize;
+				continue;
+			}
+			if (nb_ranges == alloc_ranges) {
+				alloc_ranges *= 2;
+				ranges = (MediaDataRange *)gf_realloc(ranges, sizeof(MediaDataRange) * alloc_ranges);
+				if (!ranges) goto exit;
+			}
+			ranges[nb_ranges].start = sampOffset;
+			ranges[nb_ranges].end = sampOffset + sampSize;
+			nb_ranges++;
+		}
+	}
+	if (!nb_ranges) goto exit;
+
+	qsort(ranges, nb_ranges, sizeof(MediaDataRange), compare_media_range);
+	*start = ranges[0].start;
+	*end = ranges[0].end;
+	for (j=1; j<nb_ranges; j++) {
+		/*gap between samples, the data in between is not written*/
+		if (ranges[j].start > *end) {
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[IsoMedia] Media data of written samples not contiguous in the original file\n"));
+			goto exit;
+		}
+		if (ranges[j].end > *end) *end = ranges[j].end;
+	}
+	ret = (*end > *start) ? 1 : 0;
+
+exit:
+	gf_free(ranges);
+	return ret;
+}
+
+#define MEDIA_COPY_BLOCK_SIZE	0x100000
+
+/*copies size bytes from offset in the original file to the output. On Linux, the kernel copies the data (copy_file_range), 
+sharing the data blocks when the file system supports it; otherwise the data is copied by blocks*/
+static GF_Err CopyMediaData(GF_ISOFile *movie, GF_BitStream *bs, FILE *out, u64 offset, u64 size)
+{
+	GF_Err e;
+	char *buffer;
+	u32 bytes;
+
+#if defined(GPAC_CONFIG_LINUX) && !defined(GPAC_ANDROID) && defined(__NR_copy_file_range)
+	if (out && movie->fileName) {
+		FILE *src = gf_f64_open(movie->fileName, "rb");
+		if (src) {
+			s64 in_off = offset;
+			s64 out_off;
+			u64 copied = 0;
+			gf_bs_flush(bs);
+			out_off = gf_bs_get_position(bs);
+			while (copied < size) {
+				long res = syscall(__NR_copy_file_range, fileno(src), &in_off, fileno(out), &out_off, (size_t) MIN(size - copied, 0x40000000), 0);
+				/*not supported for these files (kernel, file systems), copy what remains ourselves*/
+				if (res <= 0) break;
+				copied += res;
+			}
+			fclose(src);
+			/*data was written behind the bitstream, skipping it updates the bitstream size*/
+			gf_bs_skip_bytes(bs, copied);
+			offset += copied;
+			size -= copied;
+		}
+	}
+#endif
+
+	if (!size) return GF_OK;
+	buffer = (char*)gf_malloc(sizeof(char) * MEDIA_COPY_BLOCK_SIZE);
+	if (!buffer) return GF_OUT_OF_MEM;
+	e = GF_OK;
+	while (size) {
+		bytes = (u32) MIN(size, MEDIA_COPY_BLOCK_SIZE);
+		if (gf_isom_datamap_get_data(movie->movieFileMap, buffer, bytes, offset) != bytes) {
+			e = GF_IO_ERR;
+			break;
+		}
+		if (gf_bs_write_data(bs, buffer, bytes) != bytes) {
+			e = GF_IO_ERR;
+			break;
+		}
+		offset += bytes;
+		size -= bytes;
+	}
+	gf_free(buffer);
+	return e;
+}
+
+//write the moov box first, followed by the media data of the original file kept as is. 
+//out is the output file if the data may be copied by the system, NULL otherwise
+static GF_Err WriteFastStart(MovieWriter *mw, GF_BitStream *bs, FILE *out)
+{
+	GF_Err e;
+	u32 i;
+	u64 start, end, offset, prevOffset;
+	GF_Box *a;
+	GF_List *writers = gf_list_new();
+	GF_ISOFile *movie = mw->movie;
+
+	e = SetupWriters(mw, writers, 0);
+	if (e) goto exit;
+
+	if (!GetMediaDataRange(mw, writers, &start, &end)) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[IsoMedia] Media data not only made of the original file data, rewriting it\n"));
+		CleanWriters(writers);
+		gf_list_del(writers);
+		return WriteFlat(mw, 1, bs);
+	}
+
+	if (movie->is_jp2) {
+		gf_bs_write_u32(bs, 12);
+		gf_bs_write_u32(bs, GF_4CC('j','P',' ',' '));
+		gf_bs_write_u32(bs, 0x0D0A870A);
+	}
+	if (movie->brand) {
+		e = gf_isom_box_size((GF_Box *)movie->brand);
+		if (e) goto exit;
+		e = gf_isom_box_write((GF_Box *)movie->brand, bs);
+		if (e) goto exit;
+	}
+	if (movie->pdin) {
+		e = gf_isom_box_size((GF_Box *)movie->pdin);
+		if (e) goto exit;
+		e = gf_isom_box_write((GF_Box *)movie->pdin, bs);
+		if (e) goto exit;
+	}
+
+	//emulate the write to get the chunk tables, with offsets relative to the start of the media data
+	mw->keep_layout = 1;
+	mw->layout_start = start;
+	e = DoWrite(mw, writers, bs, 1, 0);
+	mw->keep_layout = 0;
+	if (e) goto exit;
+	movie->mdat->dataSize = end - start;
+
+	//then shift them after the moov and mdat header, until the moov size no longer changes (64 bit offsets)
+	prevOffset = 0;
+	while (1) {
+		offset = gf_bs_get_position(bs) + GetMoovAndMetaSize(movie, writers) + 8 + (movie->mdat->dataSize > 0xFFFFFFFF ? 8 : 0);
+		if (offset == prevOffset) break;
+		e = ShiftOffset(movie, writers, offset - prevOffset);
+		if (e) goto exit;
+		prevOffset = offset;
+	}
+
+	e = WriteMoovAndMeta(movie, writers, bs);
+	if (e) goto exit;
+	e = gf_isom_box_size((GF_Box *)movie->mdat);
+	if (e) goto exit;
+	e = gf_isom_box_write((GF_Box *)movie->mdat, bs);
+	if (e) goto exit;
+
+	e = CopyMediaData(movie, bs, out, start, end - start);
+	if (e) goto exit;
+
+	//then the rest
+	i=0;
+	while ((a = (GF_Box*)gf_list_enum(movie->TopBoxes, &i))) {
+		switch (a->type) {
+		case GF_ISOM_BOX_TYPE_MOOV:
+		case GF_ISOM_BOX_TYPE_META:
+		case GF_ISOM_BOX_TYPE_FTYP:
+		case GF_ISOM_BOX_TYPE_PDIN:
+		case GF_ISOM_BOX_TYPE_MDAT:
+			break;
+		default:
+			e = gf_isom_box_size(a);
+			if (e) goto exit;
+			e = gf_isom_box_write(a, bs);
+			if (e) goto exit;
+		}
+	}
+
+exit:
+	CleanWriters(writers);
+	gf_list_del(writers);
+	return e;
+}
+
 GF_Err DoFullInterleave(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8 Emulation, u64 StartOffset)
 {
 
@@ -947,7 +1373,7 @@ GF_Err DoFullInterleave(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8
 		curGroupID ++;
 	}
 	movie->mdat->dataSize = totSize;
-	return GF_OK;
+	return sample_writer_flush(mw->sample_writer);
 }
 
 /*uncomment the following to easily test large file generation. This will prepend 4096*1MByte of 0 before the media data*/
@@ -1155,7 +1581,7 @@ GF_Err DoInterleave(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8 Emul
 		curGroupID ++;
 	}
 	if (movie->mdat) movie->mdat->dataSize = mdatSize;
-	return GF_OK;
+	return sample_writer_flush(mw->sample_writer);
 }
 
 
@@ -1279,16 +1705,25 @@ GF_Err WriteToFile(GF_ISOFile *movie)
 	} else {
 		u32 buffer_size = movie->editFileMap ? gf_bs_get_output_buffering(movie->editFileMap->bs) : 0;
 		Bool is_stdout = 0;
+		Bool is_mem = 0;
 		if (!strcmp(movie->finalName, "std"))
 			is_stdout = 1;
+		else if (!strcmp(movie->finalName, GF_ISOM_MEM_OUTPUT))
+			is_mem = 1;
 
 		//OK, we need a new bitstream
-		stream = is_stdout ? stdout : gf_f64_open(movie->finalName, "w+b");
-		if (!stream) 
-			return GF_IO_ERR;
-		bs = gf_bs_from_file(stream, GF_BITSTREAM_WRITE);
+		if (is_mem) {
+			stream = NULL;
+			bs = gf_bs_new_mem_file();
+			buffer_size = 0;
+		} else {
+			stream = is_stdout ? stdout : gf_f64_open(movie->finalName, "w+b");
+			if (!stream) 
+				return GF_IO_ERR;
+			bs = gf_bs_from_file(stream, GF_BITSTREAM_WRITE);
+		}
 		if (!bs) {
-			if (!is_stdout)
+			if (stream && !is_stdout)
 				fclose(stream);
 			return GF_OUT_OF_MEM;
 		}
@@ -1296,6 +1731,8 @@ GF_Err WriteToFile(GF_ISOFile *movie)
 		if (buffer_size) {
 			gf_bs_set_output_buffering(bs, buffer_size);
 		}
+		/*samples are copied from the original file or the edit file, pipeline reads and writes*/
+		mw.sample_writer = sample_writer_new(bs);
 
 		switch (movie->storageMode) {
 		case GF_ISOM_STORE_TIGHT:
@@ -1308,13 +1745,19 @@ GF_Err WriteToFile(GF_ISOFile *movie)
 		case GF_ISOM_STORE_STREAMABLE:
 			e = WriteFlat(&mw, 1, bs);
 			break;
+		case GF_ISOM_STORE_FASTSTART:
+			e = WriteFastStart(&mw, bs, (stream && !is_stdout) ? stream : NULL);
+			break;
 		default:
 			e = WriteFlat(&mw, 0, bs);
 			break;
 		}
-		
+		/*the writing thread must be done with bs before we use it*/
+		sample_writer_del(mw.sample_writer);
+		if (is_mem && !e)
+			gf_isom_send_mem_output(movie, bs);
 		gf_bs_del(bs);
-		if (!is_stdout)
+		if (stream && !is_stdout)
 			fclose(stream);
 	}
 	if (mw.buffer) gf_free(mw.buffer);
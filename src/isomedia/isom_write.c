@@ -70,6 +70,18 @@ GF_Err FlushCaptureMode(GF_ISOFile *movie)
 		if (e) return e;
 	}
 
+	/*space reserved for the moov box, as a free box filled with 0*/
+	if (movie->moov_reserved_size) {
+		movie->moov_reserved_offset = gf_bs_get_position(movie->editFileMap->bs);
+		gf_bs_write_u32(movie->editFileMap->bs, movie->moov_reserved_size);
+		gf_bs_write_u32(movie->editFileMap->bs, GF_ISOM_BOX_TYPE_FREE);
+		if (gf_bs_write_byte(movie->editFileMap->bs, 0, movie->moov_reserved_size - 8) != movie->moov_reserved_size - 8) {
+			movie->moov_reserved_offset = 0;
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[IsoMedia] Failed to write the %d bytes reserved for the moov\n", movie->moov_reserved_size));
+			return GF_IO_ERR;
+		}
+	}
+
 	/*we have a trick here: the data will be stored on the fly, so the first
 	thing in the file is the MDAT. As we don't know if we have a large file (>4 GB) or not
 	do as if we had one and write 16 bytes: 4 (type) + 4 (size) + 8 (largeSize)...*/
@@ -1298,6 +1310,7 @@ GF_Err gf_isom_set_storage_mode(GF_ISOFile *movie, u8 storageMode)
 	case GF_ISOM_STORE_INTERLEAVED:
 	case GF_ISOM_STORE_DRIFT_INTERLEAVED:
 	case GF_ISOM_STORE_TIGHT:
+	case GF_ISOM_STORE_FASTSTART:
 		movie->storageMode = storageMode;
 		return GF_OK;
 	default:
@@ -1305,6 +1318,20 @@ GF_Err gf_isom_set_storage_mode(GF_ISOFile *movie, u8 storageMode)
 	}
 }
 
+GF_EXPORT
+GF_Err gf_isom_reserve_moov_space(GF_ISOFile *movie, u32 size)
+{
+	GF_Err e;
+	if (!movie) return GF_BAD_PARAM;
+	if (movie->openMode != GF_ISOM_OPEN_WRITE) return GF_ISOM_INVALID_MODE;
+	/*space must be reserved before the first sample*/
+	e = CheckNoData(movie);
+	if (e) return e;
+	if (size && (size < 8)) return GF_BAD_PARAM;
+	movie->moov_reserved_size = size;
+	return GF_OK;
+}
+
 
 //update or insert a new edit segment in the track time line. Edits are used to modify
 //the media normal timing. EditTime and EditDuration are expressed in Movie TimeScale
@@ -3250,6 +3277,46 @@ GF_Err gf_isom_set_media_timescale(GF_ISOFile *the_file, u32 trackNumber, u32 ne
 	return SetTrackDuration(trak);
 }
 
+GF_EXPORT
+GF_Err gf_isom_set_media_timing(GF_ISOFile *the_file, u32 trackNumber, u32 newTS, u32 sample_duration)
+{
+	u32 nb_samples;
+	GF_TimeToSampleBox *stts;
+	GF_TrackBox *trak;
+	GF_Err e;
+
+	e = CanAccessMovie(the_file, GF_ISOM_OPEN_WRITE);
+	if (e) return e;
+	trak = gf_isom_get_track_from_file(the_file, trackNumber);
+	if (!trak || !trak->Media || !trak->Media->mediaHeader || !sample_duration) return GF_BAD_PARAM;
+	if (!trak->Media->information->sampleTable || !trak->Media->information->sampleTable->TimeToSample) return GF_ISOM_INVALID_FILE;
+
+	trak->Media->mediaHeader->timeScale = newTS;
+
+	stts = trak->Media->information->sampleTable->TimeToSample;
+	nb_samples = 0;
+	if (trak->Media->information->sampleTable->SampleSize)
+		nb_samples = trak->Media->information->sampleTable->SampleSize->sampleCount;
+
+	/*collapse the table in a single run - the write cache must reflect the new last DTS for samples appended afterwards*/
+	stts->r_FirstSampleInEntry = 0;
+	stts->r_currentEntryIndex = 0;
+	stts->r_CurrentDTS = 0;
+	if (nb_samples) {
+		if (!stts->alloc_size) {
+			stts->entries = (GF_SttsEntry*)gf_malloc(sizeof(GF_SttsEntry));
+			if (!stts->entries) return GF_OUT_OF_MEM;
+			stts->alloc_size = 1;
+		}
+		stts->nb_entries = 1;
+		stts->entries[0].sampleCount = nb_samples;
+		stts->entries[0].sampleDelta = sample_duration;
+		stts->w_currentSampleNum = nb_samples;
+		stts->w_LastDTS = (u64) (nb_samples-1) * sample_duration;
+	}
+	return SetTrackDuration(trak);
+}
+
 
 GF_EXPORT
 Bool gf_isom_is_same_sample_description(GF_ISOFile *f1, u32 tk1, u32 sdesc_index1, GF_ISOFile *f2, u32 tk2, u32 sdesc_index2)
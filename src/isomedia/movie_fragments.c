@@ -966,6 +966,10 @@ GF_Err gf_isom_flush_fragments(GF_ISOFile *movie, Bool last_segment)
 		}
 		gf_isom_datamap_del(movie->editFileMap);
 		movie->editFileMap = gf_isom_fdm_new_temp(NULL);
+		gf_isom_datamap_flush(movie->movieFileMap);
+	} else {
+		/*make the fragments visible to readers of the segment while it is being produced*/
+		gf_isom_datamap_flush(movie->editFileMap);
 	}
 	movie->segment_start = gf_bs_get_position(movie->editFileMap->bs);
 	return GF_OK;
@@ -1026,6 +1030,7 @@ GF_Err gf_isom_close_segment(GF_ISOFile *movie, s32 subsegments_per_sidx, u32 re
 			} else {
 				gf_bs_write_u32(movie->editFileMap->bs, 8);	//write size field
 				gf_bs_write_u32(movie->editFileMap->bs, segment_marker_4cc); //write box type field
+				gf_isom_datamap_flush(movie->editFileMap);
 			}
 		}
 		return GF_OK;
@@ -1442,6 +1447,8 @@ GF_Err gf_isom_start_segment(GF_ISOFile *movie, char *SegName)
 	movie->append_segment = 0;
 	/*update segment file*/
 	if (SegName) {
+		/*previous memory output is complete*/
+		gf_isom_datamap_send_mem_output(movie, movie->editFileMap);
 		gf_isom_datamap_del(movie->editFileMap);
 		e = gf_isom_datamap_new(SegName, NULL, GF_ISOM_DATA_MAP_WRITE, & movie->editFileMap);
 		movie->segment_start = 0;
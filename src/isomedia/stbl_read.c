@@ -30,6 +30,7 @@
 //Get the sample number
 GF_Err findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *sampleNumber, u32 *prevSampleNumber)
 {
+	GF_Err e;
 	u32 i, j, curSampNum, count;
 	s32 CTSOffset;
 	u64 curDTS;
@@ -37,6 +38,9 @@ GF_Err findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *sample
 	(*sampleNumber) = 0;
 	(*prevSampleNumber) = 0;
 
+	e = gf_isom_box_unpack_lazy((GF_Box *) stbl->TimeToSample);
+	if (e) return e;
+
 	if (!stbl->CompositionOffset) useCTS = 0;
 	/*FIXME: CTS is ALWAYS disabled for now to make sure samples are fetched in 
 	decoding order. */
@@ -124,9 +128,12 @@ entry_found:
 //Get the Size of a given sample
 GF_Err stbl_GetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 *Size)
 {
+	GF_Err e;
 	if (!stsz || !SampleNumber || SampleNumber > stsz->sampleCount) return GF_BAD_PARAM;
 
 	(*Size) = 0;
+	e = gf_isom_box_unpack_lazy((GF_Box *) stsz);
+	if (e) return e;
 
 	if (stsz->sampleSize && (stsz->type != GF_ISOM_BOX_TYPE_STZ2)) {
 		(*Size) = stsz->sampleSize;
@@ -141,11 +148,14 @@ GF_Err stbl_GetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 *Size)
 //Get the CTS offset of a given sample
 GF_Err stbl_GetSampleCTS(GF_CompositionOffsetBox *ctts, u32 SampleNumber, s32 *CTSoffset)
 {
+	GF_Err e;
 	u32 i;
 
 	(*CTSoffset) = 0;
 	//test on SampleNumber is done before
 	if (!ctts || !SampleNumber) return GF_BAD_PARAM;
+	e = gf_isom_box_unpack_lazy((GF_Box *) ctts);
+	if (e) return e;
 
 	if (ctts->r_FirstSampleInEntry && (ctts->r_FirstSampleInEntry < SampleNumber) ) {
 		i = ctts->r_currentEntryIndex;
@@ -171,11 +181,14 @@ GF_Err stbl_GetSampleCTS(GF_CompositionOffsetBox *ctts, u32 SampleNumber, s32 *C
 //Get the DTS of a sample
 GF_Err stbl_GetSampleDTS_and_Duration(GF_TimeToSampleBox *stts, u32 SampleNumber, u64 *DTS, u32 *duration)
 {
+	GF_Err e;
 	u32 i, j, count;
 	GF_SttsEntry *ent;
 
 	(*DTS) = 0;
 	if (!stts || !SampleNumber) return GF_BAD_PARAM;
+	e = gf_isom_box_unpack_lazy((GF_Box *) stts);
+	if (e) return e;
 
 	ent = NULL;
 	//use our cache
@@ -228,12 +241,15 @@ GF_Err stbl_GetSampleDTS(GF_TimeToSampleBox *stts, u32 SampleNumber, u64 *DTS)
 //Retrieve closes RAP for a given sample - if sample is RAP, sets the RAP flag
 GF_Err stbl_GetSampleRAP(GF_SyncSampleBox *stss, u32 SampleNumber, u8 *IsRAP, u32 *prevRAP, u32 *nextRAP)
 {
+	GF_Err e;
 	u32 i;
 	if (prevRAP) *prevRAP = 0;
 	if (nextRAP) *nextRAP = 0;
 
 	(*IsRAP) = 0;
 	if (!stss || !SampleNumber) return GF_BAD_PARAM;
+	e = gf_isom_box_unpack_lazy((GF_Box *) stss);
+	if (e) return e;
 
 	if (stss->r_LastSyncSample && (stss->r_LastSyncSample < SampleNumber) ) {
 		i = stss->r_LastSampleIndex;
@@ -393,6 +409,8 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 	(*isEdited) = 0;
 	if (!stbl || !sampleNumber) return GF_BAD_PARAM;
 	if (!stbl->ChunkOffset) return GF_ISOM_INVALID_FILE;
+	e = gf_isom_box_unpack_lazy(stbl->ChunkOffset);
+	if (e) return e;
 
 	if (stbl->SampleToChunk->nb_entries == stbl->SampleSize->sampleCount) {
 		ent = &stbl->SampleToChunk->entries[sampleNumber-1];
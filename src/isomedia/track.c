@@ -408,6 +408,9 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, u64 moof_offset,
 
     if (trak->Header->trackID != traf->tfhd->trackID) return GF_OK;
 
+	/*fragment samples are appended to the sample tables, make sure they are loaded*/
+	stbl_unpack_lazy_tables(trak->Media->information->sampleTable);
+
 	//setup all our defaults
 	DescIndex = (traf->tfhd->flags & GF_ISOM_TRAF_SAMPLE_DESC) ? traf->tfhd->sample_desc_index : traf->trex->def_sample_desc_index;
 	def_duration = (traf->tfhd->flags & GF_ISOM_TRAF_SAMPLE_DUR) ? traf->tfhd->def_sample_duration : traf->trex->def_sample_duration;
@@ -72,6 +72,7 @@ void gf_laser_encoder_del(GF_LASeRCodec *codec)
 		gf_list_rem_last(codec->font_table);
 	}
 	gf_list_del(codec->font_table);
+	if (codec->au_bs) gf_bs_del(codec->au_bs);
 	gf_free(codec);
 }
 
@@ -145,6 +146,20 @@ GF_Err gf_laser_encoder_get_config(GF_LASeRCodec *codec, u16 ESID, char **out_da
 	return GF_OK;
 }
 
+/*sets up coding parameters from the config of the current stream*/
+static void lsr_setup_stream_coding(GF_LASeRCodec *codec)
+{
+	codec->coord_bits = codec->info->cfg.coord_bits;
+	codec->scale_bits = codec->info->cfg.scale_bits_minus_coord_bits;
+	codec->time_resolution = codec->info->cfg.time_resolution;
+	codec->color_scale = (1<<codec->info->cfg.colorComponentBits) - 1;
+	if (codec->info->cfg.resolution>=0) {
+		u32 res = 1 << codec->info->cfg.resolution;
+		codec->res_factor = gf_divfix(FIX_ONE, INT2FIX(res) );
+	} else {
+		codec->res_factor = INT2FIX(1 << (-codec->info->cfg.resolution));
+	}
+}
 
 GF_Err gf_laser_encode_au(GF_LASeRCodec *codec, u16 ESID, GF_List *command_list, Bool reset_context, char **out_data, u32 *out_data_length)
 {
@@ -153,14 +168,7 @@ GF_Err gf_laser_encode_au(GF_LASeRCodec *codec, u16 ESID, GF_List *command_list,
 
 	codec->info = lsr_get_stream(codec, ESID);
 	if (!codec->info) return GF_BAD_PARAM;
-	codec->coord_bits = codec->info->cfg.coord_bits;
-	codec->scale_bits = codec->info->cfg.scale_bits_minus_coord_bits;
-	codec->time_resolution = codec->info->cfg.time_resolution;
-	codec->color_scale = (1<<codec->info->cfg.colorComponentBits) - 1;
-	if (codec->info->cfg.resolution>=0)
-		codec->res_factor = gf_divfix(FIX_ONE, INT2FIX(1<<codec->info->cfg.resolution) );
-	else
-		codec->res_factor = INT2FIX(1 << (-codec->info->cfg.resolution));
+	lsr_setup_stream_coding(codec);
 
 	codec->bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
 	e = lsr_write_laser_unit(codec, command_list, reset_context);
@@ -173,18 +181,36 @@ GF_Err gf_laser_encode_au(GF_LASeRCodec *codec, u16 ESID, GF_List *command_list,
 	return e;
 }
 
+GF_Err gf_laser_encode_au_buffer(GF_LASeRCodec *codec, u16 ESID, GF_List *command_list, Bool reset_context, char **buffer, u32 *buffer_size, u32 *out_data_length)
+{
+	GF_Err e;
+	if (!codec || !command_list || !buffer || !buffer_size || !out_data_length) return GF_BAD_PARAM;
+
+	codec->info = lsr_get_stream(codec, ESID);
+	if (!codec->info) return GF_BAD_PARAM;
+	lsr_setup_stream_coding(codec);
+
+	if (!codec->au_bs) {
+		codec->au_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+		if (!codec->au_bs) return GF_OUT_OF_MEM;
+	}
+	e = gf_bs_reassign_buffer(codec->au_bs, *buffer, *buffer ? *buffer_size : 0);
+	if (e) return e;
+
+	codec->bs = codec->au_bs;
+	e = lsr_write_laser_unit(codec, command_list, reset_context);
+	/*always get the buffer back*/
+	gf_bs_get_content_no_truncate(codec->bs, buffer, out_data_length, buffer_size);
+	if (e) *out_data_length = 0;
+	codec->bs = NULL;
+	return e;
+}
+
 GF_Err gf_laser_encoder_get_rap(GF_LASeRCodec *codec, char **out_data, u32 *out_data_length)
 {
 	GF_Err e;
 	if (!codec->info) codec->info = (LASeRStreamInfo*)gf_list_get(codec->streamInfo, 0);
-	codec->coord_bits = codec->info->cfg.coord_bits;
-	codec->scale_bits = codec->info->cfg.scale_bits_minus_coord_bits;
-	codec->time_resolution = codec->info->cfg.time_resolution;
-	codec->color_scale = (1<<codec->info->cfg.colorComponentBits) - 1;
-	if (codec->info->cfg.resolution>=0)
-		codec->res_factor = gf_divfix(FIX_ONE, INT2FIX(1<<codec->info->cfg.resolution) );
-	else
-		codec->res_factor = INT2FIX(1 << (-codec->info->cfg.resolution));
+	lsr_setup_stream_coding(codec);
 
 	codec->bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
 	e = lsr_write_laser_unit(codec, NULL, 0);
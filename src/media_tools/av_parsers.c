@@ -1474,6 +1474,9 @@ static u32 bs_get_ue(GF_BitStream *bs)
 		bits += 8;
 	}
 	coded = avc_golomb_bits[read];
+	/*leading zeros and INFO field in one read when they fit*/
+	if (bits + 2*coded + 1 <= 32)
+		return gf_bs_read_int(bs, bits + 2*coded + 1) - 1;
 	gf_bs_read_int(bs, coded);
 	bits += coded;
 	return gf_bs_read_int(bs, bits + 1) - 1;
@@ -1505,37 +1508,62 @@ u32 gf_media_nalu_is_start_code(GF_BitStream *bs)
 	return is_sc;
 }
 
+/*returns the position of the first 0x0000XX pattern (XX being non zero) fully contained in data, or data_len if none.
+Zero bytes are located with memchr, which the C library vectorizes, and the bytes following a zero tell how far we can jump*/
+static u32 nalu_find_zero_zero_code(const u8 *data, u32 data_len, u8 code)
+{
+	const u8 *ptr = data;
+	const u8 *end = data + data_len;
+	while (ptr + 3 <= end) {
+		const u8 *zero = (const u8 *) memchr(ptr, 0, end - ptr - 2);
+		if (!zero) break;
+		if (zero[1]) {
+			ptr = zero + 2;
+		} else if (zero[2] == code) {
+			return (u32) (zero - data);
+		} else {
+			/*0x0000 followed by zero may still start a pattern at the next byte*/
+			ptr = zero[2] ? zero + 3 : zero + 1;
+		}
+	}
+	return data_len;
+}
+
 /*read that amount of data at each IO access rather than fetching byte by byte...*/
 #define AVC_CACHE_SIZE	4096
 u32 gf_media_nalu_next_start_code_bs(GF_BitStream *bs)
 {
-	u32 v, bpos;
+	u32 load_size, sc_pos;
 	char avc_cache[AVC_CACHE_SIZE];
-	u64 end, cache_start, load_size;
+	u64 end, cache_start, avail;
 	u64 start = gf_bs_get_position(bs);
 	if (start<3) return 0;
 	
-	load_size = 0;
-	bpos = 0;
-	cache_start = 0;
 	end = 0;
-	v = 0xffffffff;
-	while (!end) {
-		/*refill cache*/
-		if (bpos == (u32) load_size) {
-			if (!gf_bs_available(bs)) break;
-			load_size = gf_bs_available(bs);
-			if (load_size>AVC_CACHE_SIZE) load_size=AVC_CACHE_SIZE;
-			bpos = 0;
-			cache_start = gf_bs_get_position(bs);
-			gf_bs_read_data(bs, avc_cache, (u32) load_size);
+	cache_start = start;
+	while (1) {
+		avail = gf_bs_available(bs);
+		if (!avail) break;
+		load_size = (avail>AVC_CACHE_SIZE) ? AVC_CACHE_SIZE : (u32) avail;
+		gf_bs_read_data(bs, avc_cache, load_size);
+
+		sc_pos = nalu_find_zero_zero_code((u8 *) avc_cache, load_size, 0x01);
+		if (sc_pos < load_size) {
+			/*4-bytes start code - a start code found at 0 can only be in the first load, see below*/
+			if (sc_pos && !avc_cache[sc_pos-1]) sc_pos--;
+			end = cache_start + sc_pos;
+			break;
 		}
-		v = ( (v<<8) & 0xFFFFFF00) | ((u32) avc_cache[bpos]);
-		bpos++;
-		if (v == 0x00000001) end = cache_start+bpos-4;
-		else if ( (v & 0x00FFFFFF) == 0x00000001) end = cache_start+bpos-3;
+		if (load_size == avail) break;
+		/*reload the last 2 bytes, a start code may straddle the two loads*/
+		cache_start += load_size - 3;
+		if (gf_bs_seek(bs, cache_start) != GF_OK) break;
+	}
+	/*streamed sources only keep a limited window behind the current position*/
+	if (gf_bs_seek(bs, start) != GF_OK) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[NAL] Cannot seek back to NAL unit start at "LLU" - NAL unit larger than the source buffering window\n", start));
+		return 0;
 	}
-	gf_bs_seek(bs, start);
 	if (!end) end = gf_bs_get_size(bs);
 	return (u32) (end-start);
 }
@@ -1543,32 +1571,15 @@ u32 gf_media_nalu_next_start_code_bs(GF_BitStream *bs)
 GF_EXPORT
 u32 gf_media_nalu_next_start_code(u8 *data, u32 data_len, u32 *sc_size)
 {
-	u32 v, bpos;
-	u32 end;
-	
-	bpos = 0;
-	end = 0;
-	v = 0xffffffff;
-	while (!end) {
-		/*refill cache*/
-		if (bpos == (u32) data_len) 
-			break;
+	u32 pos = nalu_find_zero_zero_code(data, data_len, 0x01);
+	if (pos == data_len) return data_len;
 
-		v = ( (v<<8) & 0xFFFFFF00) | ((u32) data[bpos]);
-		bpos++;
-		if (v == 0x00000001) {
-			end = bpos-4;
-			*sc_size = 4;
-			return end;
-		}
-		else if ( (v & 0x00FFFFFF) == 0x00000001) {
-			end = bpos-3;
-			*sc_size = 3;
-			return end;
-		}
+	if (pos && !data[pos-1]) {
+		*sc_size = 4;
+		return pos-1;
 	}
-	if (!end) end = data_len;
-	return (u32) (end);
+	*sc_size = 3;
+	return pos;
 }
 
 Bool gf_media_avc_slice_is_intra(AVCState *avc) 
@@ -1731,11 +1742,10 @@ static u32 avc_emulation_bytes_remove_count(unsigned char *buffer, u32 nal_size)
 /*nal_size is updated to allow better error detection*/
 static u32 avc_remove_emulation_bytes(const char *buffer_src, char *buffer_dst, u32 nal_size) 
 { 
-	u32 i = 0, emulation_bytes_count = 0;
-	u8 num_zero = 0; 
+	const u8 *src = (const u8 *) buffer_src;
+	u32 scan = 0, copy_from = 0, zero_run_start = 0, size = 0;
 
-	while (i < nal_size) 
-	{ 
+	while (scan + 3 <= nal_size) {
 		/*ISO 14496-10: "Within the NAL unit, any four-byte sequence that starts with 0x000003 
 		  other than the following sequences shall not occur at any byte-aligned position: 
 		  0x00000300 
@@ -1743,28 +1753,22 @@ static u32 avc_remove_emulation_bytes(const char *buffer_src, char *buffer_dst,
 		  0x00000302 
 		  0x00000303" 
 		*/ 
-		if (num_zero == 2 
-			&& buffer_src[i] == 0x03 
-			&& i+1 < nal_size /*next byte is readable*/ 
-			&& buffer_src[i+1] < 0x04) 
-		{ 
+		u32 pos = scan + nalu_find_zero_zero_code(src + scan, nal_size - scan, 0x03);
+		if (pos + 3 > nal_size) break;
+
+		/*exactly two zeros since the last emulation byte, and next byte readable*/
+		if ((pos + 3 < nal_size) && (buffer_src[pos+3] < 0x04) && ((pos == zero_run_start) || src[pos-1])) {
 			/*emulation code found*/ 
-			num_zero = 0;
-			emulation_bytes_count++;
-			i++;
+			memmove(buffer_dst + size, buffer_src + copy_from, pos + 2 - copy_from);
+			size += pos + 2 - copy_from;
+			copy_from = zero_run_start = scan = pos + 3;
+		} else {
+			scan = pos + 1;
 		}
-
-		buffer_dst[i-emulation_bytes_count] = buffer_src[i];
-
-		if (!buffer_src[i]) 
-			num_zero++; 
-		else 
-			num_zero = 0; 
-
-		i++; 
-	} 
-	
-	return nal_size-emulation_bytes_count; 
+	}
+	memmove(buffer_dst + size, buffer_src + copy_from, nal_size - copy_from);
+	size += nal_size - copy_from;
+	return size;
 } 
 
 s32 gf_media_avc_read_sps(const char *sps_data, u32 sps_size, AVCState *avc, u32 subseq_sps, u32 *vui_flag_pos)
@@ -3498,11 +3502,11 @@ static Bool AC3_FindSyncCodeBS(GF_BitStream *bs)
 {
 	u8 b1;
 	u64 pos = gf_bs_get_position(bs);
-	u64 end = gf_bs_get_size(bs) - 6;
 
 	pos += 1;
 	b1 = gf_bs_read_u8(bs);
-	while (pos <= end) {
+	/*check availability rather than the size, which is not known beforehand for streamed sources*/
+	while (gf_bs_available(bs) >= 6) {
 		u8 b2 = gf_bs_read_u8(bs);
 		if ((b1 == 0x0b) && (b2==0x77)) {
 			gf_bs_seek(bs, pos-1);
@@ -81,8 +81,15 @@ typedef struct
 	Double fragment_duration;
 
 	GF_Config *dash_ctx;
+	/*live context owning dash_ctx, holding segment timeline and SegmentList entries*/
+	GF_DASHContext *dash_context;
 
 	const char *tmpdir;
+
+	/*low-latency mode: fragments are flushed to the segment file as soon as they are produced*/
+	Bool low_latency;
+	gf_dasher_chunk_callback on_chunk;
+	void *chunk_udta;
 } GF_DASHSegmenterOptions;
 
 struct _dash_segment_input
@@ -238,13 +245,526 @@ GF_Err gf_media_mpd_format_segment_name(GF_DashTemplateSegmentType seg_type, Boo
 	return GF_OK;
 }
 
-GF_Err gf_dasher_store_segment_info(GF_DASHSegmenterOptions *dash_cfg, const char *SegmentName, Double segStartTime)
+typedef struct
+{
+	char *file_name;
+	Double start_time;
+} GF_DASHSegmentInfo;
+
+typedef struct
+{
+	u32 index;
+	char *entry;
+} GF_DASHSegmentURL;
+
+typedef struct
+{
+	/*"URLs_" + representation ID, as used in INI contexts*/
+	char *name;
+	/*GF_DASHSegmentURL sorted by index*/
+	GF_List *urls;
+	/*SegmentURL lines as written in the MPD, updated as segments are added and expired so that the list
+	is not serialized again at each MPD update*/
+	char *text;
+	u32 text_size, text_alloc;
+	/*set when text must be rebuilt from urls*/
+	Bool text_dirty;
+} GF_DASHURLList;
+
+struct __gf_dash_context
+{
+	/*session and per-representation state, constant size*/
+	GF_Config *cfg;
+	/*GF_DASHSegmentInfo in generation order, used for timeshift cleanup*/
+	GF_List *segments;
+	/*GF_DASHURLList, one per representation not using URL templates*/
+	GF_List *url_lists;
+	/*file the context is restored from and saved to on destruction, NULL if only kept in memory*/
+	char *ctx_file;
+	/*set if ctx_file is a binary checkpoint rather than an INI file*/
+	Bool binary_checkpoint;
+	/*set by gf_dasher_context_save, reset when the context is modified*/
+	Bool saved;
+};
+
+#define DASH_CTX_CHECKPOINT_MAGIC	GF_4CC('G','D','C','X')
+#define DASH_CTX_CHECKPOINT_VERSION	1
+
+static GF_DASHURLList *dash_ctx_get_url_list(GF_DASHContext *ctx, const char *name, Bool create)
+{
+	u32 i=0;
+	GF_DASHURLList *ul;
+	while ((ul = gf_list_enum(ctx->url_lists, &i))) {
+		if (!strcmp(ul->name, name)) return ul;
+	}
+	if (!create) return NULL;
+	GF_SAFEALLOC(ul, GF_DASHURLList);
+	ul->name = gf_strdup(name);
+	ul->urls = gf_list_new();
+	ul->text_dirty = GF_TRUE;
+	gf_list_add(ctx->url_lists, ul);
+	return ul;
+}
+
+static void dash_url_list_append_text(GF_DASHURLList *ul, const char *entry)
+{
+	u32 len = 6 + (u32) strlen(entry);
+	if (ul->text_size + len + 1 > ul->text_alloc) {
+		ul->text_alloc = 2 * (ul->text_size + len + 1);
+		ul->text = gf_realloc(ul->text, sizeof(char)*ul->text_alloc);
+	}
+	sprintf(ul->text + ul->text_size, "     %s\n", entry);
+	ul->text_size += len;
+}
+
+/*gets the SegmentURL lines of the list, rebuilding them only if entries were replaced or inserted*/
+static const char *dash_url_list_get_text(GF_DASHURLList *ul, u32 *size)
+{
+	if (ul->text_dirty) {
+		GF_DASHSegmentURL *su;
+		u32 i=0;
+		ul->text_size = 0;
+		while ((su = gf_list_enum(ul->urls, &i))) {
+			dash_url_list_append_text(ul, su->entry);
+		}
+		ul->text_dirty = GF_FALSE;
+	}
+	*size = ul->text_size;
+	return ul->text;
+}
+
+static void dash_ctx_set_url(GF_DASHContext *ctx, const char *name, u32 index, const char *entry)
+{
+	s32 i;
+	GF_DASHSegmentURL *su;
+	GF_DASHURLList *ul = dash_ctx_get_url_list(ctx, name, GF_TRUE);
+
+	/*segments are produced in order, the new entry usually goes at the end of the list*/
+	for (i=gf_list_count(ul->urls)-1; i>=0; i--) {
+		su = gf_list_get(ul->urls, i);
+		if (su->index < index) break;
+		if (su->index == index) {
+			gf_free(su->entry);
+			su->entry = gf_strdup(entry);
+			ul->text_dirty = GF_TRUE;
+			return;
+		}
+	}
+	GF_SAFEALLOC(su, GF_DASHSegmentURL);
+	su->index = index;
+	su->entry = gf_strdup(entry);
+	if (i+1 < (s32) gf_list_count(ul->urls)) ul->text_dirty = GF_TRUE;
+	else if (!ul->text_dirty) dash_url_list_append_text(ul, entry);
+	gf_list_insert(ul->urls, su, i+1);
+}
+
+/*removes the SegmentList entry of a deleted segment*/
+static void dash_ctx_remove_url(GF_DASHContext *ctx, const char *file_name)
+{
+	u32 i, j;
+	GF_DASHURLList *ul;
+	const char *res_name = gf_url_get_resource_name(file_name);
+
+	i=0;
+	while ((ul = gf_list_enum(ctx->url_lists, &i))) {
+		GF_DASHSegmentURL *su;
+		j=0;
+		while ((su = gf_list_enum(ul->urls, &j))) {
+			if (strstr(su->entry, res_name)) {
+				/*expired segments are usually the oldest ones*/
+				if ((j==1) && !ul->text_dirty) {
+					u32 len = 6 + (u32) strlen(su->entry);
+					ul->text_size -= len;
+					memmove(ul->text, ul->text + len, ul->text_size);
+				} else {
+					ul->text_dirty = GF_TRUE;
+				}
+				gf_list_rem(ul->urls, j-1);
+				gf_free(su->entry);
+				gf_free(su);
+				return;
+			}
+		}
+	}
+}
+
+static void dash_ctx_reset_timeline(GF_DASHContext *ctx)
+{
+	while (gf_list_count(ctx->segments)) {
+		GF_DASHSegmentInfo *si = gf_list_last(ctx->segments);
+		gf_list_rem_last(ctx->segments);
+		gf_free(si->file_name);
+		gf_free(si);
+	}
+	while (gf_list_count(ctx->url_lists)) {
+		GF_DASHURLList *ul = gf_list_last(ctx->url_lists);
+		gf_list_rem_last(ctx->url_lists);
+		while (gf_list_count(ul->urls)) {
+			GF_DASHSegmentURL *su = gf_list_last(ul->urls);
+			gf_list_rem_last(ul->urls);
+			gf_free(su->entry);
+			gf_free(su);
+		}
+		gf_list_del(ul->urls);
+		if (ul->text) gf_free(ul->text);
+		gf_free(ul->name);
+		gf_free(ul);
+	}
+}
+
+/*moves the timeline stored in an INI context to our structures*/
+static void dash_ctx_import_timeline(GF_DASHContext *ctx)
+{
+	s32 i;
+	u32 j, count;
+
+	count = gf_cfg_get_key_count(ctx->cfg, "SegmentsStartTimes");
+	for (j=0; j<count; j++) {
+		GF_DASHSegmentInfo *si;
+		const char *name = gf_cfg_get_key_name(ctx->cfg, "SegmentsStartTimes", j);
+		const char *time = gf_cfg_get_key_value(ctx->cfg, "SegmentsStartTimes", j);
+		GF_SAFEALLOC(si, GF_DASHSegmentInfo);
+		si->file_name = gf_strdup(name);
+		si->start_time = time ? atof(time) : 0;
+		gf_list_add(ctx->segments, si);
+	}
+	gf_cfg_del_section(ctx->cfg, "SegmentsStartTimes");
+
+	for (i=gf_cfg_get_section_count(ctx->cfg)-1; i>=0; i--) {
+		char *sec_name;
+		const char *name = gf_cfg_get_section_name(ctx->cfg, i);
+		if (strncmp(name, "URLs_", 5)) continue;
+
+		count = gf_cfg_get_key_count(ctx->cfg, name);
+		for (j=0; j<count; j++) {
+			u32 index = 0;
+			const char *key = gf_cfg_get_key_name(ctx->cfg, name, j);
+			sscanf(key, "UrlInfo%u", &index);
+			dash_ctx_set_url(ctx, name, index, gf_cfg_get_key_value(ctx->cfg, name, j));
+		}
+		sec_name = gf_strdup(name);
+		gf_cfg_del_section(ctx->cfg, sec_name);
+		gf_free(sec_name);
+	}
+}
+
+/*writes the context as an INI file, in the layout used by gf_cfg_save*/
+static GF_Err dash_ctx_save_ini(GF_DASHContext *ctx, const char *file)
 {
-	char szKey[512];
-	if (!dash_cfg->dash_ctx) return GF_OK;
+	u32 i, j, count, nb_keys;
+	GF_DASHSegmentInfo *si;
+	GF_DASHURLList *ul;
+	FILE *f = gf_f64_open(file, "wt");
+	if (!f) return GF_IO_ERR;
+
+	count = gf_cfg_get_section_count(ctx->cfg);
+	for (i=0; i<count; i++) {
+		const char *sec_name = gf_cfg_get_section_name(ctx->cfg, i);
+		/*temporary sections are not saved*/
+		if (!strnicmp(sec_name, "Temp", 4)) continue;
+		fprintf(f, "[%s]\n", sec_name);
+		nb_keys = gf_cfg_get_key_count(ctx->cfg, sec_name);
+		for (j=0; j<nb_keys; j++) {
+			const char *key = gf_cfg_get_key_name(ctx->cfg, sec_name, j);
+			fprintf(f, "%s=%s\n", key, gf_cfg_get_key(ctx->cfg, sec_name, key));
+		}
+		fprintf(f, "\n");
+	}
 
-	sprintf(szKey, "%g", segStartTime);
-	return gf_cfg_set_key(dash_cfg->dash_ctx, "SegmentsStartTimes", SegmentName, szKey);
+	if (gf_list_count(ctx->segments)) {
+		fprintf(f, "[SegmentsStartTimes]\n");
+		i=0;
+		while ((si = gf_list_enum(ctx->segments, &i))) {
+			fprintf(f, "%s=%g\n", si->file_name, si->start_time);
+		}
+		fprintf(f, "\n");
+	}
+	i=0;
+	while ((ul = gf_list_enum(ctx->url_lists, &i))) {
+		GF_DASHSegmentURL *su;
+		if (!gf_list_count(ul->urls)) continue;
+		fprintf(f, "[%s]\n", ul->name);
+		j=0;
+		while ((su = gf_list_enum(ul->urls, &j))) {
+			fprintf(f, "UrlInfo%d=%s\n", su->index, su->entry);
+		}
+		fprintf(f, "\n");
+	}
+	if (ferror(f)) {
+		fclose(f);
+		return GF_IO_ERR;
+	}
+	fclose(f);
+	return GF_OK;
+}
+
+/*loads an INI context - the config is detached from the file so that it is never saved by itself*/
+static GF_Err dash_ctx_load_ini(GF_DASHContext *ctx, const char *file)
+{
+	GF_Config *ini = gf_cfg_new(NULL, file);
+	if (!ini) return GF_URL_ERROR;
+	gf_cfg_set_filename(ini, NULL);
+
+	gf_cfg_del(ctx->cfg);
+	ctx->cfg = ini;
+	dash_ctx_import_timeline(ctx);
+	return GF_OK;
+}
+
+static void dash_ctx_write_string(GF_BitStream *bs, const char *str)
+{
+	u32 len = str ? strlen(str) : 0;
+	gf_bs_write_u32(bs, len);
+	if (len) gf_bs_write_data(bs, str, len);
+}
+
+static char *dash_ctx_read_string(GF_BitStream *bs)
+{
+	char *str;
+	u32 len = gf_bs_read_u32(bs);
+	if (len > gf_bs_available(bs)) return NULL;
+	str = gf_malloc(sizeof(char)*(len+1));
+	gf_bs_read_data(bs, str, len);
+	str[len] = 0;
+	return str;
+}
+
+static Bool dash_ctx_is_checkpoint(const char *file)
+{
+	u8 buf[4];
+	Bool res = GF_FALSE;
+	FILE *f = gf_f64_open(file, "rb");
+	if (!f) return GF_FALSE;
+	if (fread(buf, 1, 4, f) == 4) {
+		res = (GF_4CC(buf[0], buf[1], buf[2], buf[3]) == DASH_CTX_CHECKPOINT_MAGIC) ? GF_TRUE : GF_FALSE;
+	}
+	fclose(f);
+	return res;
+}
+
+static GF_Err dash_ctx_save_checkpoint(GF_DASHContext *ctx, const char *file)
+{
+	u32 i, j, count, nb_keys, size;
+	char *data;
+	FILE *f;
+	GF_DASHSegmentInfo *si;
+	GF_DASHURLList *ul;
+	GF_BitStream *bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+
+	gf_bs_write_u32(bs, DASH_CTX_CHECKPOINT_MAGIC);
+	gf_bs_write_u8(bs, DASH_CTX_CHECKPOINT_VERSION);
+
+	count = gf_cfg_get_section_count(ctx->cfg);
+	gf_bs_write_u32(bs, count);
+	for (i=0; i<count; i++) {
+		const char *sec_name = gf_cfg_get_section_name(ctx->cfg, i);
+		dash_ctx_write_string(bs, sec_name);
+		nb_keys = gf_cfg_get_key_count(ctx->cfg, sec_name);
+		gf_bs_write_u32(bs, nb_keys);
+		for (j=0; j<nb_keys; j++) {
+			const char *key = gf_cfg_get_key_name(ctx->cfg, sec_name, j);
+			dash_ctx_write_string(bs, key);
+			dash_ctx_write_string(bs, gf_cfg_get_key(ctx->cfg, sec_name, key));
+		}
+	}
+
+	gf_bs_write_u32(bs, gf_list_count(ctx->segments));
+	i=0;
+	while ((si = gf_list_enum(ctx->segments, &i))) {
+		dash_ctx_write_string(bs, si->file_name);
+		gf_bs_write_double(bs, si->start_time);
+	}
+
+	gf_bs_write_u32(bs, gf_list_count(ctx->url_lists));
+	i=0;
+	while ((ul = gf_list_enum(ctx->url_lists, &i))) {
+		GF_DASHSegmentURL *su;
+		dash_ctx_write_string(bs, ul->name);
+		gf_bs_write_u32(bs, gf_list_count(ul->urls));
+		j=0;
+		while ((su = gf_list_enum(ul->urls, &j))) {
+			gf_bs_write_u32(bs, su->index);
+			dash_ctx_write_string(bs, su->entry);
+		}
+	}
+
+	data = NULL;
+	gf_bs_get_content(bs, &data, &size);
+	gf_bs_del(bs);
+
+	f = gf_f64_open(file, "wb");
+	if (!f) {
+		gf_free(data);
+		return GF_IO_ERR;
+	}
+	if (fwrite(data, 1, size, f) != size) {
+		fclose(f);
+		gf_free(data);
+		return GF_IO_ERR;
+	}
+	fclose(f);
+	gf_free(data);
+	return GF_OK;
+}
+
+static GF_Err dash_ctx_load_checkpoint(GF_DASHContext *ctx, const char *file)
+{
+	u32 i, j, count, nb_keys, size;
+	char *data;
+	FILE *f;
+	GF_Err e = GF_OK;
+	GF_BitStream *bs;
+
+	f = gf_f64_open(file, "rb");
+	if (!f) return GF_URL_ERROR;
+	gf_f64_seek(f, 0, SEEK_END);
+	size = (u32) gf_f64_tell(f);
+	gf_f64_seek(f, 0, SEEK_SET);
+	data = gf_malloc(sizeof(char)*size);
+	if (fread(data, 1, size, f) != size) {
+		fclose(f);
+		gf_free(data);
+		return GF_IO_ERR;
+	}
+	fclose(f);
+
+	bs = gf_bs_new(data, size, GF_BITSTREAM_READ);
+	if ((gf_bs_read_u32(bs) != DASH_CTX_CHECKPOINT_MAGIC) || (gf_bs_read_u8(bs) != DASH_CTX_CHECKPOINT_VERSION)) {
+		e = GF_NOT_SUPPORTED;
+		goto exit;
+	}
+
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		char *sec_name = dash_ctx_read_string(bs);
+		if (!sec_name) { e = GF_NON_COMPLIANT_BITSTREAM; goto exit; }
+		nb_keys = gf_bs_read_u32(bs);
+		for (j=0; j<nb_keys; j++) {
+			char *key = dash_ctx_read_string(bs);
+			char *val = dash_ctx_read_string(bs);
+			if (key && val) gf_cfg_set_key(ctx->cfg, sec_name, key, val);
+			if (key) gf_free(key);
+			if (val) gf_free(val);
+			if (!key || !val) { e = GF_NON_COMPLIANT_BITSTREAM; break; }
+		}
+		gf_free(sec_name);
+		if (e) goto exit;
+	}
+
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		GF_DASHSegmentInfo *si;
+		char *name = dash_ctx_read_string(bs);
+		if (!name) { e = GF_NON_COMPLIANT_BITSTREAM; goto exit; }
+		GF_SAFEALLOC(si, GF_DASHSegmentInfo);
+		si->file_name = name;
+		si->start_time = gf_bs_read_double(bs);
+		gf_list_add(ctx->segments, si);
+	}
+
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		GF_DASHURLList *ul;
+		char *name = dash_ctx_read_string(bs);
+		if (!name) { e = GF_NON_COMPLIANT_BITSTREAM; goto exit; }
+		ul = dash_ctx_get_url_list(ctx, name, GF_TRUE);
+		gf_free(name);
+		nb_keys = gf_bs_read_u32(bs);
+		for (j=0; j<nb_keys; j++) {
+			GF_DASHSegmentURL *su;
+			u32 index = gf_bs_read_u32(bs);
+			char *entry = dash_ctx_read_string(bs);
+			if (!entry) { e = GF_NON_COMPLIANT_BITSTREAM; goto exit; }
+			GF_SAFEALLOC(su, GF_DASHSegmentURL);
+			su->index = index;
+			su->entry = entry;
+			gf_list_add(ul->urls, su);
+		}
+	}
+
+exit:
+	gf_bs_del(bs);
+	gf_free(data);
+	return e;
+}
+
+GF_EXPORT
+GF_DASHContext *gf_dasher_context_new(const char *ctx_file, Bool binary_checkpoint)
+{
+	FILE *f;
+	GF_DASHContext *ctx;
+	GF_SAFEALLOC(ctx, GF_DASHContext);
+	if (!ctx) return NULL;
+	ctx->segments = gf_list_new();
+	ctx->url_lists = gf_list_new();
+	ctx->cfg = gf_cfg_new(NULL, NULL);
+	if (!ctx_file) return ctx;
+
+	ctx->ctx_file = gf_strdup(ctx_file);
+	ctx->binary_checkpoint = binary_checkpoint;
+	f = gf_f64_open(ctx_file, "rb");
+	if (f) {
+		GF_Err e;
+		fclose(f);
+		/*checkpoints are always saved back as checkpoints, INI contexts follow binary_checkpoint*/
+		if (dash_ctx_is_checkpoint(ctx_file)) {
+			ctx->binary_checkpoint = GF_TRUE;
+			e = dash_ctx_load_checkpoint(ctx, ctx_file);
+		} else {
+			e = dash_ctx_load_ini(ctx, ctx_file);
+		}
+		if (e) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Failed to load context %s: %s - starting new session\n", ctx_file, gf_error_to_string(e) ));
+			dash_ctx_reset_timeline(ctx);
+			gf_cfg_del(ctx->cfg);
+			ctx->cfg = gf_cfg_new(NULL, NULL);
+		}
+	}
+	return ctx;
+}
+
+GF_EXPORT
+GF_Err gf_dasher_context_save(GF_DASHContext *ctx, const char *ctx_file, Bool binary_checkpoint)
+{
+	GF_Err e;
+	if (!ctx || !ctx_file) return GF_BAD_PARAM;
+	if (binary_checkpoint) e = dash_ctx_save_checkpoint(ctx, ctx_file);
+	else e = dash_ctx_save_ini(ctx, ctx_file);
+	if (!e) ctx->saved = GF_TRUE;
+	return e;
+}
+
+GF_EXPORT
+void gf_dasher_context_del(GF_DASHContext *ctx)
+{
+	if (!ctx) return;
+	if (ctx->ctx_file) {
+		/*already saved by the user and not modified since*/
+		if (!ctx->saved) {
+			GF_Err e = ctx->binary_checkpoint ? dash_ctx_save_checkpoint(ctx, ctx->ctx_file) : dash_ctx_save_ini(ctx, ctx->ctx_file);
+			if (e) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Failed to save context %s: %s\n", ctx->ctx_file, gf_error_to_string(e) ));
+			}
+		}
+		gf_free(ctx->ctx_file);
+	}
+	gf_cfg_del(ctx->cfg);
+	dash_ctx_reset_timeline(ctx);
+	gf_list_del(ctx->segments);
+	gf_list_del(ctx->url_lists);
+	gf_free(ctx);
+}
+
+GF_Err gf_dasher_store_segment_info(GF_DASHSegmenterOptions *dash_cfg, const char *SegmentName, Double segStartTime)
+{
+	GF_DASHSegmentInfo *si;
+	if (!dash_cfg->dash_context) return GF_OK;
+
+	GF_SAFEALLOC(si, GF_DASHSegmentInfo);
+	if (!si) return GF_OUT_OF_MEM;
+	si->file_name = gf_strdup(SegmentName);
+	si->start_time = segStartTime;
+	return gf_list_add(dash_cfg->dash_context->segments, si);
 }
 
 
@@ -326,6 +846,30 @@ typedef struct
 	u32 split_sample_dts_shift;
 } GF_ISOMTrackFragmenter;
 
+/*low-latency mode: notifies the data written to the current segment since the last notification*/
+static void dasher_notify_chunk(GF_DASHSegmenterOptions *dash_cfg, GF_ISOFile *output, const char *seg_name, u64 *chunk_start, Bool segment_done)
+{
+	u64 chunk_end;
+	if (!dash_cfg->low_latency || !dash_cfg->on_chunk) return;
+
+	chunk_end = gf_isom_get_file_size(output);
+	if ((chunk_end <= *chunk_start) && !segment_done) return;
+
+	dash_cfg->on_chunk(dash_cfg->chunk_udta, seg_name, *chunk_start, (chunk_end > *chunk_start) ? chunk_end - *chunk_start : 0, segment_done);
+	*chunk_start = chunk_end;
+}
+
+/*low-latency mode: segments can be fetched once their first fragment is written, and are not complete at that time*/
+static void dasher_write_low_latency_info(FILE *mpd, GF_DASHSegmenterOptions *dash_cfg)
+{
+	Double ato;
+	if (!dash_cfg->low_latency) return;
+
+	ato = dash_cfg->segment_duration - dash_cfg->fragment_duration;
+	if (ato <= 0) return;
+	fprintf(mpd, " availabilityTimeOffset=\"%.3f\" availabilityTimeComplete=\"false\"", ato);
+}
+
 static u64 isom_get_next_sap_time(GF_ISOFile *input, u32 track, u32 sample_count, u32 sample_num)
 {
 	GF_ISOSample *samp;
@@ -379,6 +923,8 @@ static GF_Err gf_media_isom_segment_file(GF_ISOFile *input, const char *output_f
 	Bool next_sample_rap = GF_FALSE;
 	Bool flush_all_samples = GF_FALSE;
 	Bool simulation_pass = GF_FALSE;
+	Bool segment_done = GF_FALSE;
+	u64 chunk_start = 0;
 	Bool init_segment_deleted = GF_FALSE;
 	Bool first_segment_in_timeline = GF_TRUE;
 	u64 previous_segment_duration = 0;
@@ -855,12 +1401,11 @@ restart_fragmentation_pass:
 	if (dash_cfg->dash_ctx) {
 		const char *opt;
 		char sKey[100];
-		count = gf_cfg_get_key_count(dash_cfg->dash_ctx, RepURLsSecName);
-		for (i=0; i<count; i++) {
-			const char *key_name = gf_cfg_get_key_name(dash_cfg->dash_ctx, RepURLsSecName, i);
-			opt = gf_cfg_get_key(dash_cfg->dash_ctx, RepURLsSecName, key_name);
-			sprintf(szMPDTempLine, "     %s\n", opt);	
-			gf_bs_write_data(mpd_bs, szMPDTempLine, strlen(szMPDTempLine));
+		GF_DASHURLList *ul = dash_ctx_get_url_list(dash_cfg->dash_context, RepURLsSecName, GF_FALSE);
+		if (ul) {
+			u32 size;
+			const char *text = dash_url_list_get_text(ul, &size);
+			if (size) gf_bs_write_data(mpd_bs, (char *) text, size);
 		}
 
 		opt = gf_cfg_get_key(dash_cfg->dash_ctx, RepSecName, "NextSegmentIndex");
@@ -927,16 +1472,16 @@ restart_fragmentation_pass:
 						const char *name = gf_url_get_resource_name(SegmentName);
 						sprintf(szMPDTempLine, "     <SegmentURL media=\"%s\"/>\n", name );	
 						gf_bs_write_data(mpd_bs, szMPDTempLine, strlen(szMPDTempLine));
-						if (dash_cfg->dash_ctx) {
-							char szKey[100], szVal[4046];
-							sprintf(szKey, "UrlInfo%d", cur_seg );
+						if (dash_cfg->dash_context) {
+							char szVal[4046];
 							sprintf(szVal, "<SegmentURL media=\"%s\"/>", name);
-							gf_cfg_set_key(dash_cfg->dash_ctx, RepURLsSecName, szKey, szVal);
+							dash_ctx_set_url(dash_cfg->dash_context, RepURLsSecName, cur_seg, szVal);
 						}
 					}
 				} else {
 					e = gf_isom_start_segment(output, NULL);
 				}
+				chunk_start = seg_rad_name ? 0 : gf_isom_get_file_size(output);
 			}
 
 			cur_seg++;
@@ -1226,19 +1771,22 @@ restart_fragmentation_pass:
 			SegmentDuration += maxFragDurationOverSegment;
 			maxFragDurationOverSegment=0;
 
+			/*next fragment will exceed segment length, abort fragment now (all samples RAPs)*/
+			if (tfref && tfref->all_sample_raps && (SegmentDuration + MaxFragmentDuration >= MaxSegmentDuration)) {
+				force_switch_segment = GF_TRUE;
+			}
+			segment_done = (force_switch_segment || ((SegmentDuration >= MaxSegmentDuration) && (!split_seg_at_rap || next_sample_rap))) ? GF_TRUE : GF_FALSE;
+
 			/*if no simulation and no SIDX is used, flush fragments as we write them*/
 			if (!simulation_pass && (dash_cfg->subsegs_per_sidx<0) ) {
 				e = gf_isom_flush_fragments(output, flush_all_samples ? GF_TRUE : GF_FALSE);
 				if (e) goto err_exit;
+				/*last chunk of the segment is notified once the segment is closed*/
+				if (!segment_done)
+					dasher_notify_chunk(dash_cfg, output, seg_rad_name ? SegmentName : gf_isom_get_filename(output), &chunk_start, GF_FALSE);
 			}
 
-
-			/*next fragment will exceed segment length, abort fragment now (all samples RAPs)*/
-			if (tfref && tfref->all_sample_raps && (SegmentDuration + MaxFragmentDuration >= MaxSegmentDuration)) {
-				force_switch_segment = GF_TRUE;
-			}
-
-			if (force_switch_segment || ((SegmentDuration >= MaxSegmentDuration) && (!split_seg_at_rap || next_sample_rap))) {
+			if (segment_done) {
 
 				if (mpd_timeline_bs) {
 
@@ -1284,6 +1832,7 @@ restart_fragmentation_pass:
 					
 					gf_isom_close_segment(output, dash_cfg->subsegs_per_sidx, ref_track_id, ref_track_first_dts, ref_track_next_cts, dash_cfg->daisy_chain_sidx, flush_all_samples ? GF_TRUE : GF_FALSE, dash_cfg->segment_marker_4cc, &idx_start_range, &idx_end_range);
 					ref_track_first_dts = (u64) -1;
+					dasher_notify_chunk(dash_cfg, output, seg_rad_name ? SegmentName : gf_isom_get_filename(output), &chunk_start, GF_TRUE);
 
 					if (!seg_rad_name) {
 						file_size = gf_isom_get_file_size(output);
@@ -1297,11 +1846,10 @@ restart_fragmentation_pass:
 							}
 							gf_bs_write_data(mpd_bs, "/>\n", 3);
 
-							if (dash_cfg->dash_ctx) {
-								char szKey[100], szVal[4046];
-								sprintf(szKey, "UrlInfo%d", cur_seg );
+							if (dash_cfg->dash_context) {
+								char szVal[4046];
 								sprintf(szVal, "<SegmentURL mediaRange=\""LLD"-"LLD"\" indexRange=\""LLD"-"LLD"\"/>", start_range, end_range, idx_start_range, idx_end_range);
-								gf_cfg_set_key(dash_cfg->dash_ctx, RepURLsSecName, szKey, szVal);
+								dash_ctx_set_url(dash_cfg->dash_context, RepURLsSecName, cur_seg, szVal);
 							}
 						}
 					} else {
@@ -1352,6 +1900,7 @@ restart_fragmentation_pass:
 			segment_start_time += SegmentDuration;
 
 			gf_isom_close_segment(output, dash_cfg->subsegs_per_sidx, ref_track_id, ref_track_first_dts, ref_track_next_cts, dash_cfg->daisy_chain_sidx, 1, dash_cfg->segment_marker_4cc, &idx_start_range, &idx_end_range);
+			dasher_notify_chunk(dash_cfg, output, seg_rad_name ? SegmentName : gf_isom_get_filename(output), &chunk_start, GF_TRUE);
 			nb_segments++;
 
 			if (!seg_rad_name) {
@@ -1366,11 +1915,10 @@ restart_fragmentation_pass:
 					}
 					gf_bs_write_data(mpd_bs, "/>\n", 3);
 
-					if (dash_cfg->dash_ctx) {
-						char szKey[100], szVal[4046];
-						sprintf(szKey, "UrlInfo%d", cur_seg );
+					if (dash_cfg->dash_context) {
+						char szVal[4046];
 						sprintf(szVal, "<SegmentURL mediaRange=\""LLD"-"LLD"\" indexRange=\""LLD"-"LLD"\"/>", start_range, end_range, idx_start_range, idx_end_range);
-						gf_cfg_set_key(dash_cfg->dash_ctx, RepURLsSecName, szKey, szVal);
+						dash_ctx_set_url(dash_cfg->dash_context, RepURLsSecName, cur_seg, szVal);
 					}
 				}
 			} else {
@@ -1424,6 +1972,7 @@ restart_fragmentation_pass:
 				fprintf(dash_cfg->mpd, " initialization=\"%s\"", SegmentName);
 				if (presentationTimeOffset) 
 					fprintf(dash_cfg->mpd, " presentationTimeOffset=\"%d\"", presentationTimeOffset);
+				dasher_write_low_latency_info(dash_cfg->mpd, dash_cfg);
 
 				if (mpd_timeline_bs) {
 					char *mpd_seg_info = NULL;
@@ -1534,6 +2083,7 @@ restart_fragmentation_pass:
 				}
 				if (presentationTimeOffset) 
 					fprintf(dash_cfg->mpd, " presentationTimeOffset=\"%d\"", presentationTimeOffset);
+				dasher_write_low_latency_info(dash_cfg->mpd, dash_cfg);
 				fprintf(dash_cfg->mpd, "/>\n");
 			}
 		} else if (dash_cfg->single_file_mode==1) {
@@ -1549,6 +2099,7 @@ restart_fragmentation_pass:
 			fprintf(dash_cfg->mpd, "    <SegmentList timescale=\"1000\" duration=\"%d\"", (u32) (max_segment_duration*1000));	
 			if (presentationTimeOffset) 
 				fprintf(dash_cfg->mpd, " presentationTimeOffset=\"%d\"", presentationTimeOffset);
+			dasher_write_low_latency_info(dash_cfg->mpd, dash_cfg);
 			fprintf(dash_cfg->mpd, ">\n");	
 			/*we are not in bitstreamSwitching mode*/
 			if (!is_bs_switching) {
@@ -2896,13 +3447,11 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 		/*rewrite previous SegmentList entries*/
 		if ( dash_cfg->dash_ctx && ((dash_cfg->single_file_mode==2) || (!dash_cfg->single_file_mode && !dash_cfg->use_url_template))) {
 			/*rewrite previous URLs*/
-			const char *opt;
-			u32 count, i;
-			count = gf_cfg_get_key_count(dash_cfg->dash_ctx, szRepURLsSecName);
-			for (i=0; i<count; i++) {
-				const char *key_name = gf_cfg_get_key_name(dash_cfg->dash_ctx, szRepURLsSecName, i);
-				opt = gf_cfg_get_key(dash_cfg->dash_ctx, szRepURLsSecName, key_name);
-				fprintf(dash_cfg->mpd, "     %s\n", opt);	
+			GF_DASHURLList *ul = dash_ctx_get_url_list(dash_cfg->dash_context, szRepURLsSecName, GF_FALSE);
+			if (ul) {
+				u32 size;
+				const char *text = dash_url_list_get_text(ul, &size);
+				if (size) gf_fwrite(text, 1, size, dash_cfg->mpd);
 			}
 		}
 
@@ -2972,11 +3521,10 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 					gf_media_mpd_format_segment_name(GF_DASH_TEMPLATE_SEGMENT, 1, SegName, basename, dash_input->representationID, dash_cfg->seg_rad_name, "ts", 0, bandwidth, segment_index, dash_cfg->use_segment_timeline);
 					fprintf(dash_cfg->mpd, "     <SegmentURL media=\"%s\"/>\n", SegName);
 
-					if (dash_cfg->dash_ctx) {
-						char szKey[100], szVal[4046];
-						sprintf(szKey, "UrlInfo%d", segment_index);
+					if (dash_cfg->dash_context) {
+						char szVal[4046];
 						sprintf(szVal, "<SegmentURL media=\"%s\"/>", SegName);
-						gf_cfg_set_key(dash_cfg->dash_ctx, szRepURLsSecName, szKey, szVal);
+						dash_ctx_set_url(dash_cfg->dash_context, szRepURLsSecName, segment_index, szVal);
 					}
 				}
 
@@ -3396,13 +3944,17 @@ static GF_Err gf_dasher_init_context(GF_Config *dash_ctx, u32 *dynamic, u32 *tim
 }
 
 GF_EXPORT
-u32 gf_dasher_next_update_time(GF_Config *dash_ctx, u32 mpd_update_time)
+u32 gf_dasher_next_update_time(GF_DASHContext *dash_context, u32 mpd_update_time)
 {
 	Double max_dur = 0;
 	Double safety_dur;
 	Double ms_elapsed;
 	u32 i, ntp_sec, frac, prev_sec, prev_frac;
 	const char *opt, *section;
+	GF_Config *dash_ctx;
+
+	if (!dash_context) return 0;
+	dash_ctx = dash_context->cfg;
 
 	opt = gf_cfg_get_key(dash_ctx, "DASH", "MaxSegmentDuration");
 	if (!opt) return 0;
@@ -3445,7 +3997,7 @@ u32 gf_dasher_next_update_time(GF_Config *dash_ctx, u32 mpd_update_time)
 }
 
 /*peform all file cleanup*/
-static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double dash_duration, u32 ast_shift_sec)
+static Bool gf_dasher_cleanup(GF_DASHContext *dash_context, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double dash_duration, u32 ast_shift_sec)
 {
 	Double max_dur = 0;
 	Double elapsed = 0;
@@ -3453,6 +4005,7 @@ static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_upd
 	u32 i, ntp_sec, frac, prev_sec;
 	const char *opt, *section;
 	GF_Err e;
+	GF_Config *dash_ctx = dash_context->cfg;
 
 	opt = gf_cfg_get_key(dash_ctx, "DASH", "StoreParams");
 	if (opt && !strcmp(opt, "yes")) return 1;
@@ -3494,16 +4047,13 @@ static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_upd
 
 	/*cleanup old segments*/
 	if ((s32) time_shift_depth >= 0) {
-		for (i=0; i<gf_cfg_get_key_count(dash_ctx, "SegmentsStartTimes"); i++) {
+		/*segments are stored in generation order, oldest first*/
+		while (gf_list_count(dash_context->segments)) {
 			Double seg_time;
-			Bool found=0;
-			u32 j;
-			const char *fileName = gf_cfg_get_key_name(dash_ctx, "SegmentsStartTimes", i);
-			const char *MPDTime = gf_cfg_get_key(dash_ctx, "SegmentsStartTimes", fileName);
-			if (!fileName) 
-				break;
+			GF_DASHSegmentInfo *si = gf_list_get(dash_context->segments, 0);
+			const char *fileName = si->file_name;
 
-			seg_time = atof(MPDTime);
+			seg_time = si->start_time;
 			seg_time += ast_shift_sec;
 			seg_time += dash_duration + time_shift_depth;
 			seg_time -= elapsed;
@@ -3522,24 +4072,11 @@ static Bool gf_dasher_cleanup(GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_upd
 			}
 
 			/*check all reps*/
-			for (j=0; j<gf_cfg_get_section_count(dash_ctx); j++) {
-				u32 k;
-				const char *secName = gf_cfg_get_section_name(dash_ctx, j);
-				if (!strstr(secName, "URLs_")) continue;
-				for (k=0; k<gf_cfg_get_key_count(dash_ctx, secName); k++) {
-					const char *entry = gf_cfg_get_key_name(dash_ctx, secName, k);
-					const char *name = gf_cfg_get_key(dash_ctx, secName, entry);
-					if (strstr(name, fileName)) {
-						gf_cfg_set_key(dash_ctx, secName, entry, NULL);
-						found=1;
-						break;
-					}
-				}
-				if (found) break;
-			}
+			dash_ctx_remove_url(dash_context, fileName);
 
-			gf_cfg_set_key(dash_ctx, "SegmentsStartTimes", fileName, NULL);
-			i--;
+			gf_list_rem(dash_context->segments, 0);
+			gf_free(si->file_name);
+			gf_free(si);
 		}
 	}
 	return 1;
@@ -3554,7 +4091,8 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 							   Bool use_url_template, Bool use_segment_timeline,  Bool single_segment, Bool single_file, GF_DashSwitchingMode bitstream_switching, 
 							   Bool seg_at_rap, Double dash_duration, char *seg_name, char *seg_ext, u32 segment_marker_4cc,
 							   Double frag_duration, s32 subsegs_per_sidx, Bool daisy_chain_sidx, Bool frag_at_rap, const char *tmpdir,
-							   GF_Config *dash_ctx, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double subduration, Double min_buffer, u32 ast_shift_sec)
+							   GF_DASHContext *dash_context, u32 dash_dynamic, u32 mpd_update_time, u32 time_shift_depth, Double subduration, Double min_buffer, u32 ast_shift_sec,
+							   Bool low_latency, gf_dasher_chunk_callback on_chunk, void *chunk_udta)
 {
 	u32 i, j, segment_mode;
 	char *sep, szSegName[GF_MAX_PATH], szSolvedSegName[GF_MAX_PATH], szTempMPD[GF_MAX_PATH];
@@ -3572,9 +4110,11 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 	FILE *mpd = NULL;
 	GF_DashSegInput *dash_inputs;
 	GF_DASHSegmenterOptions dash_opts;
+	GF_Config *dash_ctx = dash_context ? dash_context->cfg : NULL;
 
 	/*init dash context if needed*/
 	if (dash_ctx) {
+		dash_context->saved = GF_FALSE;
 
 		e = gf_dasher_init_context(dash_ctx, &dash_dynamic, &time_shift_depth, NULL, ast_shift_sec);
 		if (e) return e;
@@ -3596,7 +4136,7 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 			}
 
 			/*peform all file cleanup*/
-			regenerate = gf_dasher_cleanup(dash_ctx, dash_dynamic, mpd_update_time, time_shift_depth, dash_duration, ast_shift_sec);
+			regenerate = gf_dasher_cleanup(dash_context, dash_dynamic, mpd_update_time, time_shift_depth, dash_duration, ast_shift_sec);
 			if (!regenerate) return GF_OK;
 		}
 	}
@@ -3747,6 +4287,17 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 	}
 	if (frag_at_rap) seg_at_rap = 1;
 
+	if (low_latency) {
+		if (single_segment) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Low-latency mode not supported in single segment mode, ignoring\n"));
+			low_latency = 0;
+		} else if (subsegs_per_sidx>=0) {
+			/*the sidx would have to be written before the fragments it indexes*/
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Low-latency mode: SIDX cannot be used, disabling it\n"));
+			subsegs_per_sidx = -1;
+		}
+	}
+
 	if (seg_at_rap) {
 		GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("Spliting segments %sat GOP boundaries\n", frag_at_rap ? "and fragments " : ""));
 	}
@@ -3764,9 +4315,13 @@ GF_Err gf_dasher_segment_files(const char *mpdfile, GF_DashSegmenterInput *input
 	dash_opts.fragment_duration = frag_duration;
 	dash_opts.tmpdir = tmpdir;
 	dash_opts.dash_ctx = dash_ctx;
+	dash_opts.dash_context = dash_context;
 	dash_opts.time_shift_depth = (s32) time_shift_depth;
 	dash_opts.subduration = subduration;
 	dash_opts.segment_marker_4cc = segment_marker_4cc;
+	dash_opts.low_latency = low_latency;
+	dash_opts.on_chunk = on_chunk;
+	dash_opts.chunk_udta = chunk_udta;
 	dash_opts.inband_param_set = ((bitstream_switching == GF_DASH_BSMODE_INBAND) || (bitstream_switching == GF_DASH_BSMODE_SINGLE) ) ? 1 : 0;
 
 	for (cur_period=0; cur_period<max_period; cur_period++) {
@@ -39,6 +39,8 @@
 #define ADAPTATION_FLAGS_LENGTH 1 
 /* length of encoded pcr */
 #define PCR_LENGTH 6
+/*max number of AUs pending in a stream fifo, power of 2*/
+#define PCK_QUEUE_SIZE	512
 
 
 static GFINLINE Bool gf_m2ts_time_less(GF_M2TS_Time *a, GF_M2TS_Time *b) {
@@ -745,6 +747,90 @@ static void gf_m2ts_remap_timestamps_for_pes(GF_M2TS_Mux_Stream *stream, u32 pck
 	*dts = *dts - stream->program->initial_ts + pcr_offset;
 }
 
+/*releases the current packet data, either through the input release function if the data was transfered or using gf_free*/
+static void gf_m2ts_stream_release_data(GF_M2TS_Mux_Stream *stream, char *data)
+{
+	if (stream->curr_pck.release_data) {
+		stream->curr_pck.release_data(stream->curr_pck.release_udta, data);
+		stream->curr_pck.release_data = NULL;
+		stream->curr_pck.release_udta = NULL;
+	} else {
+		gf_free(data);
+	}
+}
+
+/*packets are recycled per stream to avoid an alloc/free for each AU - called by the input only*/
+static GF_M2TS_Packet *gf_m2ts_stream_get_packet(GF_M2TS_Mux_Stream *stream)
+{
+	GF_M2TS_Packet *pck;
+	u32 idx = stream->pck_pool_read;
+	if (idx == stream->pck_pool_write) {
+		GF_SAFEALLOC(pck, GF_M2TS_Packet);
+		return pck;
+	}
+	/*make sure we read the packet after the write index*/
+	gf_th_memory_barrier();
+	pck = stream->pck_pool[idx & (stream->pck_queue_size-1)];
+	gf_th_memory_barrier();
+	stream->pck_pool_read = idx+1;
+	memset(pck, 0, sizeof(GF_M2TS_Packet));
+	return pck;
+}
+
+/*called by the muxer only*/
+static void gf_m2ts_stream_recycle_packet(GF_M2TS_Mux_Stream *stream, GF_M2TS_Packet *pck)
+{
+	u32 idx = stream->pck_pool_write;
+	if (idx - stream->pck_pool_read >= stream->pck_queue_size) {
+		gf_free(pck);
+		return;
+	}
+	stream->pck_pool[idx & (stream->pck_queue_size-1)] = pck;
+	/*make sure the packet is written before the write index*/
+	gf_th_memory_barrier();
+	stream->pck_pool_write = idx+1;
+}
+
+/*discards the AU being reassembled when the input cannot be queued, so that the input restarts or drops the whole AU - called by the input only*/
+static GF_Err gf_m2ts_stream_reject_packet(GF_M2TS_Mux_Stream *stream)
+{
+	if (stream->pck_reassembler) {
+		if (stream->pck_reassembler->data) gf_free(stream->pck_reassembler->data);
+		gf_free(stream->pck_reassembler);
+		stream->pck_reassembler = NULL;
+	}
+	stream->force_new = 1;
+	return GF_BUFFER_TOO_SMALL;
+}
+
+/*called by the input only, the caller shall check there is room in the fifo*/
+static void gf_m2ts_stream_queue_packet(GF_M2TS_Mux_Stream *stream, GF_M2TS_Packet *pck)
+{
+	u32 idx = stream->pck_queue_write;
+	assert(idx - stream->pck_queue_read < stream->pck_queue_size);
+	pck->next = NULL;
+	stream->pck_queue[idx & (stream->pck_queue_size-1)] = pck;
+	gf_th_memory_barrier();
+	stream->pck_queue_write = idx+1;
+}
+
+/*returns the first packet in the fifo if any - called by the muxer only*/
+static GF_M2TS_Packet *gf_m2ts_stream_first_packet(GF_M2TS_Mux_Stream *stream)
+{
+	u32 idx = stream->pck_queue_read;
+	if (!stream->pck_queue || (idx == stream->pck_queue_write)) return NULL;
+	gf_th_memory_barrier();
+	return stream->pck_queue[idx & (stream->pck_queue_size-1)];
+}
+
+/*removes the first packet from the fifo - called by the muxer only*/
+static void gf_m2ts_stream_drop_first_packet(GF_M2TS_Mux_Stream *stream)
+{
+	/*make sure we are done reading the packet before releasing the slot*/
+	gf_th_memory_barrier();
+	stream->pck_queue_read++;
+}
+
 u32 gf_m2ts_stream_process_stream(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *stream)
 {
 	Bool ret = 0;
@@ -769,7 +855,7 @@ u32 gf_m2ts_stream_process_stream(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *stream
 	if (stream->ifce->caps & GF_ESI_AU_PULL_CAP) {
 		if (stream->curr_pck.data_len) {
 			/*discard packet data if we use SL over PES*/
-			if (stream->discard_data) gf_free(stream->curr_pck.data);
+			if (stream->discard_data) gf_m2ts_stream_release_data(stream, stream->curr_pck.data);
 			/*release data*/
 			stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_RELEASE, NULL);
 		}
@@ -780,39 +866,36 @@ u32 gf_m2ts_stream_process_stream(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *stream
 		/*EOS*/
 		if (stream->ifce->caps & GF_ESI_STREAM_IS_OVER) return ret;
 		assert( stream->ifce->input_ctrl);
+		stream->curr_pck.release_data = NULL;
 		stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_PULL, &stream->curr_pck);
 	} else {
 		GF_M2TS_Packet *curr_pck;
 
-		if (!stream->pck_first && (stream->ifce->caps & GF_ESI_STREAM_IS_OVER)) 
+		if (!gf_m2ts_stream_first_packet(stream) && (stream->ifce->caps & GF_ESI_STREAM_IS_OVER)) 
 			return ret;
 		
 		/*flush input pipe*/
 		if (stream->ifce->input_ctrl) stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_FLUSH, NULL);
 
-		gf_mx_p(stream->mx);
-
 		stream->pck_offset = 0;
 		stream->curr_pck.data_len = 0;
 
 		/*fill curr_pck*/
-		curr_pck = stream->pck_first;
-		if (!curr_pck) {
-			gf_mx_v(stream->mx);
-			return ret;
-		}
+		curr_pck = gf_m2ts_stream_first_packet(stream);
+		if (!curr_pck) return ret;
+
 		stream->curr_pck.cts = curr_pck->cts;
 		stream->curr_pck.data = curr_pck->data;
 		stream->curr_pck.data_len = curr_pck->data_len;
 		stream->curr_pck.dts = curr_pck->dts;
 		stream->curr_pck.flags = curr_pck->flags;
+		stream->curr_pck.release_data = curr_pck->release_data;
+		stream->curr_pck.release_udta = curr_pck->release_udta;
 
 		/*discard first packet*/
-		stream->pck_first = curr_pck->next;
-		gf_free(curr_pck);
+		gf_m2ts_stream_drop_first_packet(stream);
+		gf_m2ts_stream_recycle_packet(stream, curr_pck);
 		stream->discard_data = 1;
-
-		gf_mx_v(stream->mx);
 	}
 
 	if (!(stream->curr_pck.flags & GF_ESI_DATA_HAS_DTS))
@@ -858,7 +941,7 @@ u32 gf_m2ts_stream_process_stream(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *stream
 
 		/*packet data is now copied in sections, discard it if not pull*/
 		if (!(stream->ifce->caps & GF_ESI_AU_PULL_CAP)) {
-			gf_free(stream->curr_pck.data);
+			gf_m2ts_stream_release_data(stream, stream->curr_pck.data);
 			stream->curr_pck.data = NULL;
 			stream->curr_pck.data_len = 0;
 		}
@@ -890,8 +973,10 @@ u32 gf_m2ts_stream_process_stream(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *stream
 
 		/*discard src data*/
 		if (!(stream->ifce->caps & GF_ESI_AU_PULL_CAP)) {
-			gf_free(src_data);
+			gf_m2ts_stream_release_data(stream, src_data);
 		}
+		/*the SL packet is allocated by us*/
+		stream->curr_pck.release_data = NULL;
 		GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[MPEG-2 TS Muxer] PID %d: Encapsulating MPEG-4 SL Data (%p - %p) on PES - SL Header size %d\n", stream->pid, src_data, stream->curr_pck.data, stream->curr_pck.data_len - src_data_len));
 
 		/*moving from PES to SL reallocates a new buffer, force discard even in pull mode*/
@@ -944,7 +1029,7 @@ u32 gf_m2ts_stream_process_stream(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *stream
 		stream->reframe_overhead = stream->curr_pck.data_len;
 		gf_bs_write_data(bs, stream->curr_pck.data, stream->curr_pck.data_len);
 		gf_bs_align(bs);
-		gf_free(stream->curr_pck.data);
+		gf_m2ts_stream_release_data(stream, stream->curr_pck.data);
 		gf_bs_get_content(bs, &stream->curr_pck.data, &stream->curr_pck.data_len);
 		gf_bs_del(bs);
 		stream->reframe_overhead = stream->curr_pck.data_len - stream->reframe_overhead;
@@ -981,7 +1066,7 @@ u32 gf_m2ts_stream_process_stream(GF_M2TS_Mux *muxer, GF_M2TS_Mux_Stream *stream
 
 			gf_bs_write_data(bs, stream->curr_pck.data, stream->curr_pck.data_len);
 			gf_bs_align(bs);
-			gf_free(stream->curr_pck.data);
+			gf_m2ts_stream_release_data(stream, stream->curr_pck.data);
 			gf_bs_get_content(bs, &stream->curr_pck.data, &stream->curr_pck.data_len);
 			gf_bs_del(bs);
 			/*constant reframe overhead*/
@@ -1077,12 +1162,16 @@ void gf_m2ts_stream_update_data_following(GF_M2TS_Mux_Stream *stream)
 		}
 	} else {
 		/*flush input*/
-		if (!stream->pck_first && stream->ifce->input_ctrl) stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_FLUSH, NULL);
-		if (stream->pck_first) {
-			stream->next_payload_size = stream->pck_first->data_len;
-			stream->next_pck_cts = stream->pck_first->cts;
-			stream->next_pck_dts = stream->pck_first->dts;
-			stream->next_pck_flags = stream->pck_first->flags;
+		GF_M2TS_Packet *next_pck = gf_m2ts_stream_first_packet(stream);
+		if (!next_pck && stream->ifce->input_ctrl) {
+			stream->ifce->input_ctrl(stream->ifce, GF_ESI_INPUT_DATA_FLUSH, NULL);
+			next_pck = gf_m2ts_stream_first_packet(stream);
+		}
+		if (next_pck) {
+			stream->next_payload_size = next_pck->data_len;
+			stream->next_pck_cts = next_pck->cts;
+			stream->next_pck_dts = next_pck->dts;
+			stream->next_pck_flags = next_pck->flags;
 		}
 	}
 	/*consider we don't have the next AU if:
@@ -1449,7 +1538,7 @@ void gf_m2ts_mux_pes_get_next_packet(GF_M2TS_Mux_Stream *stream, char *packet)
 	
 	if (stream->pck_offset == stream->curr_pck.data_len) {
 		/*PES has been sent, discard internal buffer*/
-		if (stream->discard_data) gf_free(stream->curr_pck.data);
+		if (stream->discard_data) gf_m2ts_stream_release_data(stream, stream->curr_pck.data);
 		stream->curr_pck.data = NULL;
 		stream->curr_pck.data_len = 0;
 		stream->pck_offset = 0;
@@ -1511,7 +1600,7 @@ void gf_m2ts_mux_pes_get_next_packet(GF_M2TS_Mux_Stream *stream, char *packet)
 				if (stream->pck_offset == stream->curr_pck.data_len) {
 					assert(!remain || (remain>=stream->min_bytes_copy_from_next));
 					/*PES has been sent, discard internal buffer*/
-					if (stream->discard_data) gf_free(stream->curr_pck.data);
+					if (stream->discard_data) gf_m2ts_stream_release_data(stream, stream->curr_pck.data);
 					stream->curr_pck.data = NULL;
 					stream->curr_pck.data_len = 0;
 					stream->pck_offset = 0;
@@ -1546,24 +1635,49 @@ GF_Err gf_m2ts_output_ctrl(GF_ESInterface *_self, u32 ctrl_type, void *param)
 
 	GF_M2TS_Mux_Stream *stream = (GF_M2TS_Mux_Stream *)_self->output_udta;
 	switch (ctrl_type) {
+	case GF_ESI_OUTPUT_DATA_TRANSFER:
+		esi_pck = (GF_ESIPacket *)param;
+		/*a call may push up to 2 packets in the fifo, the input shall retry later if full*/
+		if (stream->pck_queue_write - stream->pck_queue_read + 2 > stream->pck_queue_size)
+			return gf_m2ts_stream_reject_packet(stream);
+
+		/*complete AU, queue the input buffer as is*/
+		if ((esi_pck->flags & GF_ESI_DATA_AU_END) && (stream->force_new || !stream->pck_reassembler || (esi_pck->flags & GF_ESI_DATA_AU_START))) {
+			GF_M2TS_Packet *pck;
+			if (stream->pck_reassembler) {
+				gf_m2ts_stream_queue_packet(stream, stream->pck_reassembler);
+				stream->pck_reassembler = NULL;
+			}
+			pck = gf_m2ts_stream_get_packet(stream);
+			pck->cts = esi_pck->cts;
+			pck->dts = esi_pck->dts;
+			pck->flags = esi_pck->flags;
+			pck->data = esi_pck->data;
+			pck->data_len = esi_pck->data_len;
+			pck->release_data = esi_pck->release_data;
+			pck->release_udta = esi_pck->release_udta;
+			gf_m2ts_stream_queue_packet(stream, pck);
+			stream->force_new = 1;
+			break;
+		}
+		/*partial AU, reassemble it and release the input buffer*/
+		gf_m2ts_output_ctrl(_self, GF_ESI_OUTPUT_DATA_DISPATCH, param);
+		if (esi_pck->release_data) esi_pck->release_data(esi_pck->release_udta, esi_pck->data);
+		else gf_free(esi_pck->data);
+		break;
 	case GF_ESI_OUTPUT_DATA_DISPATCH:
 		esi_pck = (GF_ESIPacket *)param;
+		if (stream->pck_queue_write - stream->pck_queue_read + 2 > stream->pck_queue_size)
+			return gf_m2ts_stream_reject_packet(stream);
 
 		if (stream->force_new || (esi_pck->flags & GF_ESI_DATA_AU_START)) {
 			if (stream->pck_reassembler) {
-				gf_mx_p(stream->mx);
-				if (!stream->pck_first) {
-					stream->pck_first = stream->pck_last = stream->pck_reassembler;
-				} else {
-					stream->pck_last->next = stream->pck_reassembler;
-					stream->pck_last = stream->pck_reassembler;
-				}
-				gf_mx_v(stream->mx);
+				gf_m2ts_stream_queue_packet(stream, stream->pck_reassembler);
 				stream->pck_reassembler = NULL;
 			}
 		}
 		if (!stream->pck_reassembler) {
-			GF_SAFEALLOC(stream->pck_reassembler, GF_M2TS_Packet);
+			stream->pck_reassembler = gf_m2ts_stream_get_packet(stream);
 			stream->pck_reassembler->cts = esi_pck->cts;
 			stream->pck_reassembler->dts = esi_pck->dts;
 		}
@@ -1576,14 +1690,7 @@ GF_Err gf_m2ts_output_ctrl(GF_ESInterface *_self, u32 ctrl_type, void *param)
 
 		stream->pck_reassembler->flags |= esi_pck->flags;
 		if (stream->force_new) {
-			gf_mx_p(stream->mx);
-			if (!stream->pck_first) {
-				stream->pck_first = stream->pck_last = stream->pck_reassembler;
-			} else {
-				stream->pck_last->next = stream->pck_reassembler;
-				stream->pck_last = stream->pck_reassembler;
-			}
-			gf_mx_v(stream->mx);
+			gf_m2ts_stream_queue_packet(stream, stream->pck_reassembler);
 			stream->pck_reassembler = NULL;
 		}
 		break;
@@ -1804,7 +1911,9 @@ GF_M2TS_Mux_Stream *gf_m2ts_program_stream_add(GF_M2TS_Mux_Program *program, str
 
 	stream->ifce->output_ctrl = gf_m2ts_output_ctrl;
 	stream->ifce->output_udta = stream;
-	stream->mx = gf_mx_new("M2TS PID");
+	stream->pck_queue_size = PCK_QUEUE_SIZE;
+	stream->pck_queue = (GF_M2TS_Packet **)gf_malloc(sizeof(GF_M2TS_Packet *)*stream->pck_queue_size);
+	stream->pck_pool = (GF_M2TS_Packet **)gf_malloc(sizeof(GF_M2TS_Packet *)*stream->pck_queue_size);
 	if (ifce->timescale != 90000) stream->ts_scale = 90000.0 / ifce->timescale;
 	return stream;
 }
@@ -1889,14 +1998,28 @@ void gf_m2ts_mux_stream_del(GF_M2TS_Mux_Stream *st)
 		gf_free(st->tables);
 		st->tables = tab;
 	}
-	while (st->pck_first) {
-		GF_M2TS_Packet *curr_pck = st->pck_first;
-		st->pck_first = curr_pck->next;
-		gf_free(curr_pck->data);
-		gf_free(curr_pck);
+	if (st->pck_queue) {
+		while (st->pck_queue_read != st->pck_queue_write) {
+			GF_M2TS_Packet *curr_pck = st->pck_queue[st->pck_queue_read & (st->pck_queue_size-1)];
+			if (curr_pck->release_data) curr_pck->release_data(curr_pck->release_udta, curr_pck->data);
+			else gf_free(curr_pck->data);
+			gf_free(curr_pck);
+			st->pck_queue_read++;
+		}
+		gf_free(st->pck_queue);
+	}
+	if (st->pck_pool) {
+		while (st->pck_pool_read != st->pck_pool_write) {
+			gf_free(st->pck_pool[st->pck_pool_read & (st->pck_queue_size-1)]);
+			st->pck_pool_read++;
+		}
+		gf_free(st->pck_pool);
+	}
+	if (st->pck_reassembler) {
+		if (st->pck_reassembler->data) gf_free(st->pck_reassembler->data);
+		gf_free(st->pck_reassembler);
 	}
-	if (st->curr_pck.data) gf_free(st->curr_pck.data);
-	if (st->mx) gf_mx_del(st->mx);
+	if (st->curr_pck.data) gf_m2ts_stream_release_data(st, st->curr_pck.data);
 	if (st->loop_descriptors) {
 		while (gf_list_count(st->loop_descriptors) ) {
 			GF_M2TSDescriptor *desc = gf_list_last(st->loop_descriptors);
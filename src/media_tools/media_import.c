@@ -38,10 +38,52 @@
 #include <gpac/xml.h>
 #include <gpac/mpegts.h>
 #include <gpac/constants.h>
+#include <gpac/thread.h>
+
+#if defined(WIN32) && !defined(_WIN32_WCE)
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 
 #ifndef GPAC_DISABLE_MEDIA_IMPORT
 
+/*read window for raw elementary stream files, parsed through file bitstreams*/
+#define IMPORT_READ_BUFFER_SIZE		0x100000
+/*read window for streamed sources: NAL units and frames up to half of it can be parsed*/
+#define IMPORT_STREAM_WINDOW_SIZE	0x800000
+/*time in ms without new data after which a file being written is considered complete*/
+#define IMPORT_STREAM_IDLE_TIMEOUT	5000
+
+
+/*opens the source of raw importers, "-" designating the standard input*/
+static FILE *import_open_source(GF_MediaImporter *import)
+{
+	if (!strcmp(import->in_name, "-")) {
+#if defined(WIN32) && !defined(_WIN32_WCE)
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+		return stdin;
+	}
+	return gf_f64_open(import->in_name, "rb");
+}
+
+static void import_close_source(FILE *f)
+{
+	if (f != stdin) fclose(f);
+}
+
+/*streamed sources are read forward only, regular files through a read window*/
+static GF_BitStream *import_source_bs(GF_MediaImporter *import, FILE *f)
+{
+	GF_BitStream *bs;
+	if (import->flags & GF_IMPORT_STREAMING)
+		return gf_bs_from_stream(f, IMPORT_STREAM_WINDOW_SIZE, IMPORT_STREAM_IDLE_TIMEOUT);
+
+	bs = gf_bs_from_file(f, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_BUFFER_SIZE);
+	return bs;
+}
 
 GF_Err gf_import_message(GF_MediaImporter *import, GF_Err e, char *format, ...)
 {
@@ -619,15 +661,15 @@ GF_Err gf_import_aac_adts(GF_MediaImporter *import)
 	u32 max_size, track, di, i;
 	GF_ISOSample *samp;
 
-	in = gf_f64_open(import->in_name, "rb");
+	in = import_open_source(import);
 	if (!in) return gf_import_message(import, GF_URL_ERROR, "Opening file %s failed", import->in_name);
 
-	bs = gf_bs_from_file(in, GF_BITSTREAM_READ);
+	bs = import_source_bs(import, in);
 
 	sync_frame = ADTS_SyncFrame(bs, &hdr);
 	if (!sync_frame) {
 		gf_bs_del(bs);
-		fclose(in);
+		import_close_source(in);
 		return gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Audio isn't MPEG-2/4 AAC with ADTS");
 	}
 	if (import->flags & GF_IMPORT_FORCE_MPEG4) hdr.is_mp2 = 0;
@@ -644,7 +686,7 @@ GF_Err gf_import_aac_adts(GF_MediaImporter *import)
 		import->tk_info[0].audio_info.sample_rate = sr;
 		import->tk_info[0].audio_info.nb_channels = hdr.nb_ch;
 		gf_bs_del(bs);
-		fclose(in);
+		import_close_source(in);
 		return GF_OK;
 	}
 
@@ -843,7 +885,7 @@ exit:
 	}
 	if (samp) gf_isom_sample_del(&samp);
 	gf_bs_del(bs);
-	fclose(in);
+	import_close_source(in);
 	return e;
 }
 
@@ -869,6 +911,7 @@ static GF_Err gf_import_cmp(GF_MediaImporter *import, Bool mpeg12)
 	mdia = gf_f64_open(import->in_name, "rb");
 	if (!mdia) return gf_import_message(import, GF_URL_ERROR, "Opening %s failed", import->in_name);
 	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_BUFFER_SIZE);
 
 	samp = NULL;
 	vparse = gf_m4v_parser_bs_new(bs, mpeg12);
@@ -3677,6 +3720,7 @@ GF_Err gf_import_h263(GF_MediaImporter *import)
 
 	e = GF_OK;
 	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	gf_bs_set_input_buffering(bs, IMPORT_READ_BUFFER_SIZE);
 	if (!H263_IsStartCode(bs)) {
 		e = gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Cannot find H263 Picture Start Code");
 		goto exit;
@@ -3829,9 +3873,145 @@ GF_Err gf_media_avc_rewrite_samples(GF_ISOFile *file, u32 track, u32 prev_size,
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
+/*number of NAL units the reader thread may load ahead of the parser*/
+#define NAL_READER_SLOTS	64
+
+typedef struct
+{
+	char *data;
+	u32 size, alloc_size;
+	/*position of the NAL payload in the source file*/
+	u64 pos;
+	Bool eos;
+} NALReaderSlot;
+
+/*NAL unit reader: a dedicated thread reads the file, locates start codes and loads NAL units in a ring of slots,
+while the importer parses slice headers and builds samples from the previous ones*/
+typedef struct
+{
+	GF_BitStream *bs;
+	const char *name;
+	GF_Thread *th;
+	GF_Semaphore *free_slots, *ready_slots;
+	NALReaderSlot slots[NAL_READER_SLOTS];
+	u32 read_idx, write_idx;
+	/*slot currently handed out to the importer, recycled on next fetch*/
+	Bool slot_in_use;
+	volatile Bool stop;
+	/*set when the reader could not locate the next NAL unit*/
+	GF_Err error;
+} NALReader;
+
+static u32 nal_reader_run(void *par)
+{
+	u64 nal_start;
+	u32 nal_size;
+	Bool done = 0;
+	NALReader *nr = (NALReader *)par;
+
+	while (1) {
+		NALReaderSlot *slot;
+		gf_sema_wait(nr->free_slots);
+		if (nr->stop) break;
+
+		slot = &nr->slots[nr->write_idx];
+		nr->write_idx = (nr->write_idx + 1) % NAL_READER_SLOTS;
+		slot->size = 0;
+		slot->eos = done || !gf_bs_available(nr->bs);
+		if (!slot->eos) {
+			slot->pos = gf_bs_get_position(nr->bs);
+			nal_size = gf_media_nalu_next_start_code_bs(nr->bs);
+			/*the start of the NAL unit is no longer buffered (streamed source)*/
+			if (gf_bs_get_position(nr->bs) != slot->pos) {
+				nr->error = GF_NOT_SUPPORTED;
+				slot->eos = 1;
+				gf_sema_notify(nr->ready_slots, 1);
+				break;
+			}
+			if (nal_size > slot->alloc_size) {
+				slot->data = (char*)gf_realloc(slot->data, sizeof(char)*nal_size);
+				slot->alloc_size = nal_size;
+			}
+			gf_bs_read_data(nr->bs, slot->data, nal_size);
+			slot->size = nal_size;
+
+			/*consume next start code*/
+			if (!nal_size || !gf_bs_available(nr->bs)) {
+				done = 1;
+			} else {
+				nal_start = gf_media_nalu_next_start_code_bs(nr->bs);
+				if (nal_start) {
+					GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[%s] invalid nal_size (%u)? Skipping "LLU" bytes to reach next start code\n", nr->name, nal_size, nal_start));
+					gf_bs_skip_bytes(nr->bs, nal_start);
+				}
+				if (!gf_media_nalu_is_start_code(nr->bs)) {
+					GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[%s] error: no start code found ("LLU" bytes read out of "LLU") - leaving\n", nr->name, gf_bs_get_position(nr->bs), gf_bs_get_size(nr->bs)));
+					done = 1;
+				}
+			}
+		}
+		gf_sema_notify(nr->ready_slots, 1);
+		if (slot->eos) break;
+	}
+	return 0;
+}
+
+/*starts reading NAL units from the current position of bs, which must be right after a start code*/
+static NALReader *nal_reader_new(GF_BitStream *bs, const char *name)
+{
+	NALReader *nr;
+	GF_SAFEALLOC(nr, NALReader);
+	if (!nr) return NULL;
+	nr->bs = bs;
+	nr->name = name;
+	nr->free_slots = gf_sema_new(NAL_READER_SLOTS+1, NAL_READER_SLOTS);
+	nr->ready_slots = gf_sema_new(NAL_READER_SLOTS, 0);
+	nr->th = gf_th_new(name);
+	if (!nr->free_slots || !nr->ready_slots || !nr->th || gf_th_run(nr->th, nal_reader_run, nr)) {
+		if (nr->th) gf_th_del(nr->th);
+		if (nr->free_slots) gf_sema_del(nr->free_slots);
+		if (nr->ready_slots) gf_sema_del(nr->ready_slots);
+		gf_free(nr);
+		return NULL;
+	}
+	return nr;
+}
+
+/*gets next NAL unit - the returned slot stays valid until the next call. Returns NULL once the file is consumed*/
+static NALReaderSlot *nal_reader_next(NALReader *nr)
+{
+	NALReaderSlot *slot;
+	if (nr->slot_in_use) {
+		nr->slot_in_use = 0;
+		gf_sema_notify(nr->free_slots, 1);
+	}
+	gf_sema_wait(nr->ready_slots);
+	slot = &nr->slots[nr->read_idx];
+	nr->read_idx = (nr->read_idx + 1) % NAL_READER_SLOTS;
+	nr->slot_in_use = 1;
+	if (slot->eos) return NULL;
+	return slot;
+}
+
+static void nal_reader_del(NALReader *nr)
+{
+	u32 i;
+	if (!nr) return;
+	/*unblock the reader if it waits for a free slot, and wait for it to exit*/
+	nr->stop = 1;
+	gf_sema_notify(nr->free_slots, 1);
+	gf_th_del(nr->th);
+	gf_sema_del(nr->free_slots);
+	gf_sema_del(nr->ready_slots);
+	for (i=0; i<NAL_READER_SLOTS; i++) {
+		if (nr->slots[i].data) gf_free(nr->slots[i].data);
+	}
+	gf_free(nr);
+}
+
 static GF_Err gf_import_avc_h264(GF_MediaImporter *import)
 {
-	u64 nal_start, nal_end, total_size;
+	u64 nal_start, total_size;
 	u32 nal_size, track, trackID, di, cur_samp, nb_i, nb_idr, nb_p, nb_b, nb_sp, nb_si, nb_sei, max_w, max_h, max_total_delay;
 	s32 idx, sei_recovery_frame_count;
 	u64 duration;
@@ -3841,8 +4021,10 @@ static GF_Err gf_import_avc_h264(GF_MediaImporter *import)
 	AVCState avc;
 	GF_AVCConfigSlot *slc;
 	GF_AVCConfig *avccfg, *svccfg, *dstcfg;
-	GF_BitStream *bs;
+	GF_BitStream *bs, *nal_bs;
 	GF_BitStream *sample_data;
+	NALReader *nal_reader;
+	NALReaderSlot *nal;
 	Bool flush_sample, sample_is_rap, sample_has_islice, first_nal, slice_is_ref, has_cts_offset, detect_fps, is_paff, set_subsamples, slice_force_ref;
 	u32 ref_frame, timescale, copy_size, size_length, dts_inc;
 	s32 last_poc, max_last_poc, max_last_b_poc, poc_diff, prev_last_poc, min_poc, poc_shift;
@@ -3853,7 +4035,6 @@ static GF_Err gf_import_avc_h264(GF_MediaImporter *import)
 	u8 priority_prev_nalu_prefix;
 	Double FPS;
 	char *buffer;
-	u32 max_size = 4096;
 
 	if (import->flags & GF_IMPORT_PROBE_ONLY) {
 		import->nb_tracks = 1;
@@ -3865,7 +4046,7 @@ static GF_Err gf_import_avc_h264(GF_MediaImporter *import)
 
 	set_subsamples = (import->flags & GF_IMPORT_SET_SUBSAMPLES) ? 1 : 0;
 
-	mdia = gf_f64_open(import->in_name, "rb");
+	mdia = import_open_source(import);
 	if (!mdia) return gf_import_message(import, GF_URL_ERROR, "Cannot find file %s", import->in_name);
 
 	detect_fps = 1;
@@ -3882,22 +4063,19 @@ static GF_Err gf_import_avc_h264(GF_MediaImporter *import)
 
 	poc_diff = 0;
 
-
-restart_import:
-
 	memset(&avc, 0, sizeof(AVCState));
 	avc.sps_active_idx = -1;
 	avccfg = gf_odf_avc_cfg_new();
 	svccfg = gf_odf_avc_cfg_new();
 	/*we don't handle split import (one track / layer)*/
 	svccfg->complete_representation = 1;
-	buffer = (char*)gf_malloc(sizeof(char) * max_size);
 	sample_data = NULL;
+	nal_reader = NULL;
 	first_avc = 1;
 	last_svc_sps = 0;
 	sei_recovery_frame_count = -1;
 
-	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	bs = import_source_bs(import, mdia);
 	if (!gf_media_nalu_is_start_code(bs)) {
 		e = gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Cannot find H264 start code");
 		goto exit;
@@ -3952,20 +4130,23 @@ restart_import:
 	res_prev_nalu_prefix = 0;
 	priority_prev_nalu_prefix = 0;
 
-	while (gf_bs_available(bs)) {
-		u8 nal_hdr, skip_nal, is_subseq, add_sps;
-		nal_size = gf_media_nalu_next_start_code_bs(bs);
-
-		if (nal_size>max_size) {
-			buffer = (char*)gf_realloc(buffer, sizeof(char)*nal_size);
-			max_size = nal_size;
-		}
+	/*file reading and start code scanning run in a separate thread, NAL units are parsed from memory*/
+	nal_reader = nal_reader_new(bs, "avc-h264");
+	if (!nal_reader) {
+		e = gf_import_message(import, GF_IO_ERR, "Cannot start H264 NAL reader");
+		goto exit;
+	}
 
-		/*read the file, and work on a memory buffer*/
-		gf_bs_read_data(bs, buffer, nal_size);
+	while ((nal = nal_reader_next(nal_reader)) != NULL) {
+		s32 res;
+		u8 nal_hdr, skip_nal, is_subseq, add_sps;
+		nal_start = nal->pos;
+		nal_size = nal->size;
+		buffer = nal->data;
+		if (!nal_size) break;
 
-		gf_bs_seek(bs, nal_start);
-		nal_hdr = gf_bs_read_u8(bs);
+		nal_bs = gf_bs_new(buffer, nal_size, GF_BITSTREAM_READ);
+		nal_hdr = gf_bs_read_u8(nal_bs);
 		nal_type = nal_hdr & 0x1F;
 
 		is_subseq = 0;
@@ -3976,7 +4157,9 @@ restart_import:
 			avc.is_svc = 1;
 		}
 
-		switch (gf_media_avc_parse_nalu(bs, nal_hdr, &avc)) {
+		res = gf_media_avc_parse_nalu(nal_bs, nal_hdr, &avc);
+		gf_bs_del(nal_bs);
+		switch (res) {
 		case 1:
 			flush_sample = 1;
 			break;
@@ -4069,18 +4252,12 @@ restart_import:
 					dts_inc =   2 * avc.sps[idx].vui.num_units_in_tick * DeltaTfiDivisorIdx;
 					FPS = (Double)timescale / dts_inc;
 					detect_fps = 0;
-					gf_isom_remove_track(import->dest, track);
-					if (sample_data) gf_bs_del(sample_data);
-					gf_odf_avc_cfg_del(avccfg);
-					avccfg = NULL;
-					gf_odf_avc_cfg_del(svccfg);
-					svccfg = NULL;
-					gf_free(buffer);
-					buffer = NULL;
-					gf_bs_del(bs);
-					bs = NULL;
-					gf_f64_seek(mdia, 0, SEEK_SET);
-					goto restart_import;
+					/*retime the track in place rather than re-parsing the whole file: sample DTS are derived from dts_inc
+					and CTS offsets only hold POC orders until the final pass, so only the media timescale and the samples
+					already written need updating*/
+					e = gf_isom_set_media_timing(import->dest, track, timescale, dts_inc);
+					if (e) goto exit;
+					duration = (u64) ( ((Double)import->duration) * timescale / 1000.0);
 				}
 
 				if (is_subseq) {
@@ -4243,8 +4420,6 @@ restart_import:
 			break;
 		}
 
-		if (!nal_size) break;
-
 		if (flush_sample && sample_data) {
 			GF_ISOSample *samp = gf_isom_sample_new();
 			samp->DTS = (u64)dts_inc*cur_samp;
@@ -4515,29 +4690,12 @@ restart_import:
 			}
 		}
 
-		gf_bs_align(bs);
-		nal_end = gf_bs_get_position(bs);
-		assert(nal_start <= nal_end);
-		assert(nal_end <= nal_start + nal_size);
-		if (nal_end != nal_start + nal_size)
-			gf_bs_seek(bs, nal_start + nal_size);
-
-		if (!gf_bs_available(bs)) break;
 		if (duration && (dts_inc*cur_samp > duration)) break;
 		if (import->flags & GF_IMPORT_DO_ABORT) break;
-
-		/*consume next start code*/
-		nal_start = gf_media_nalu_next_start_code_bs(bs);
-		if (nal_start) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[avc-h264] invalid nal_size (%u)? Skipping "LLU" bytes to reach next start code\n", nal_size, nal_start));
-			gf_bs_skip_bytes(bs, nal_start);
-		}
-		nal_start = gf_media_nalu_is_start_code(bs);
-		if (!nal_start) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[avc-h264] error: no start code found ("LLU" bytes read out of "LLU") - leaving\n", gf_bs_get_position(bs), gf_bs_get_size(bs)));
-			break;
-		}
-		nal_start = gf_bs_get_position(bs);
+	}
+	if (nal_reader->error) {
+		e = gf_import_message(import, nal_reader->error, "NAL unit too large to be imported from a streamed source");
+		goto exit;
 	}
 	
 	/*final flush*/
@@ -4699,12 +4857,13 @@ restart_import:
 	}
 
 exit:
+	/*stop the reader before releasing the file bitstream*/
+	nal_reader_del(nal_reader);
 	if (sample_data) gf_bs_del(sample_data);
 	gf_odf_avc_cfg_del(avccfg);
 	gf_odf_avc_cfg_del(svccfg);
-	gf_free(buffer);
 	gf_bs_del(bs);
-	fclose(mdia);
+	import_close_source(mdia);
 	return e;
 }
 
@@ -4714,7 +4873,7 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 #ifdef GPAC_DISABLE_HEVC
 	return GF_NOT_SUPPORTED;
 #else
-	u64 nal_start, nal_end, total_size;
+	u64 nal_start, total_size;
 	u32 nal_size, track, trackID, di, cur_samp, nb_i, nb_idr, nb_p, nb_b, nb_sp, nb_si, nb_sei, max_w, max_h, max_total_delay;
 	s32 idx, sei_recovery_frame_count;
 	u64 duration;
@@ -4724,7 +4883,9 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 	GF_AVCConfigSlot *slc;
 	GF_HEVCConfig *hevccfg;
 	GF_HEVCParamArray *spss, *ppss, *vpss;
-	GF_BitStream *bs;
+	GF_BitStream *bs, *nal_bs;
+	NALReader *nal_reader;
+	NALReaderSlot *nal;
 	GF_BitStream *sample_data;
 	Bool flush_sample, sample_is_rap, sample_has_islice, first_nal, slice_is_ref, has_cts_offset, is_paff, set_subsamples, slice_force_ref;
 	u32 ref_frame, timescale, copy_size, size_length, dts_inc;
@@ -4734,7 +4895,6 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 
 	Double FPS;
 	char *buffer;
-	u32 max_size = 4096;
 
 	if (import->flags & GF_IMPORT_PROBE_ONLY) {
 		import->nb_tracks = 1;
@@ -4746,7 +4906,7 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 
 	set_subsamples = (import->flags & GF_IMPORT_SET_SUBSAMPLES) ? 1 : 0;
 
-	mdia = gf_f64_open(import->in_name, "rb");
+	mdia = import_open_source(import);
 	if (!mdia) return gf_import_message(import, GF_URL_ERROR, "Cannot find file %s", import->in_name);
 
 	//detect_fps = 1;
@@ -4765,19 +4925,16 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 
 	poc_diff = 0;
 
-
-//restart_import:
-
 	memset(&hevc, 0, sizeof(HEVCState));
 	hevc.sps_active_idx = -1;
 	hevccfg = gf_odf_hevc_cfg_new();
-	buffer = (char*)gf_malloc(sizeof(char) * max_size);
 	sample_data = NULL;
+	nal_reader = NULL;
 	first_avc = 1;
 	sei_recovery_frame_count = -1;
 	spss = ppss = vpss = NULL;
 
-	bs = gf_bs_from_file(mdia, GF_BITSTREAM_READ);
+	bs = import_source_bs(import, mdia);
 	if (!gf_media_nalu_is_start_code(bs)) {
 		e = gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Cannot find HEVC start code");
 		goto exit;
@@ -4829,23 +4986,25 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 	min_poc = 0;
 	poc_shift = 0;
 
-	while (gf_bs_available(bs)) {
+	/*file reading and start code scanning run in a separate thread, NAL units are parsed from memory*/
+	nal_reader = nal_reader_new(bs, "hevc");
+	if (!nal_reader) {
+		e = gf_import_message(import, GF_IO_ERR, "Cannot start HEVC NAL reader");
+		goto exit;
+	}
+
+	while ((nal = nal_reader_next(nal_reader)) != NULL) {
 		s32 res;
 		u8 nal_unit_type, temporal_id;
 		Bool skip_nal, add_sps, is_slice;
-		nal_size = gf_media_nalu_next_start_code_bs(bs);
-
-		if (nal_size>max_size) {
-			buffer = (char*)gf_realloc(buffer, sizeof(char)*nal_size);
-			max_size = nal_size;
-		}
-
-		/*read the file, and work on a memory buffer*/
-		gf_bs_read_data(bs, buffer, nal_size);
-
-		gf_bs_seek(bs, nal_start);
+		nal_start = nal->pos;
+		nal_size = nal->size;
+		buffer = nal->data;
+		if (!nal_size) break;
 
-		res = gf_media_hevc_parse_nalu(bs, &hevc, &nal_unit_type, &temporal_id);
+		nal_bs = gf_bs_new(buffer, nal_size, GF_BITSTREAM_READ);
+		res = gf_media_hevc_parse_nalu(nal_bs, &hevc, &nal_unit_type, &temporal_id);
+		gf_bs_del(nal_bs);
 
 		skip_nal = 0;
 		copy_size = flush_sample = 0;
@@ -5076,8 +5235,6 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 			break;
 		}
 
-		if (!nal_size) break;
-
 		if (flush_sample && sample_data) {
 			GF_ISOSample *samp = gf_isom_sample_new();
 			samp->DTS = (u64)dts_inc*cur_samp;
@@ -5274,29 +5431,12 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 			}
 		}
 
-		gf_bs_align(bs);
-		nal_end = gf_bs_get_position(bs);
-		assert(nal_start <= nal_end);
-		assert(nal_end <= nal_start + nal_size);
-		if (nal_end != nal_start + nal_size)
-			gf_bs_seek(bs, nal_start + nal_size);
-
-		if (!gf_bs_available(bs)) break;
 		if (duration && (dts_inc*cur_samp > duration)) break;
 		if (import->flags & GF_IMPORT_DO_ABORT) break;
-
-		/*consume next start code*/
-		nal_start = gf_media_nalu_next_start_code_bs(bs);
-		if (nal_start) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[hevc] invalid nal_size (%u)? Skipping "LLU" bytes to reach next start code\n", nal_size, nal_start));
-			gf_bs_skip_bytes(bs, nal_start);
-		}
-		nal_start = gf_media_nalu_is_start_code(bs);
-		if (!nal_start) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[hevc] error: no start code found ("LLU" bytes read out of "LLU") - leaving\n", gf_bs_get_position(bs), gf_bs_get_size(bs)));
-			break;
-		}
-		nal_start = gf_bs_get_position(bs);
+	}
+	if (nal_reader->error) {
+		e = gf_import_message(import, nal_reader->error, "NAL unit too large to be imported from a streamed source");
+		goto exit;
 	}
 	
 	/*final flush*/
@@ -5442,11 +5582,12 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 	}
 
 exit:
+	/*stop the reader before releasing the file bitstream*/
+	nal_reader_del(nal_reader);
 	if (sample_data) gf_bs_del(sample_data);
 	gf_odf_hevc_cfg_del(hevccfg);
-	gf_free(buffer);
 	gf_bs_del(bs);
-	fclose(mdia);
+	import_close_source(mdia);
 	return e;
 #endif //GPAC_DISABLE_HEVC
 }
@@ -7203,17 +7344,25 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 	u32 size;
 	Bool do_import = 1;
 	FILE *mts;
+	GF_BitStream *bs;
 	char progress[1000];
 
 	if (import->trackID > GF_M2TS_MAX_STREAMS)
 		return gf_import_message(import, GF_BAD_PARAM, "Invalid PID %d", import->trackID );
 
-	mts = gf_f64_open(import->in_name, "rb");
+	mts = import_open_source(import);
 	if (!mts) return gf_import_message(import, GF_URL_ERROR, "Opening file %s failed", import->in_name);
 
-	gf_f64_seek(mts, 0, SEEK_END);
-	fsize = gf_f64_tell(mts);
-	gf_f64_seek(mts, 0, SEEK_SET);
+	/*streamed sources have no known size and are read through a bitstream waiting for new data*/
+	bs = NULL;
+	fsize = 0;
+	if (import->flags & GF_IMPORT_STREAMING) {
+		bs = import_source_bs(import, mts);
+	} else {
+		gf_f64_seek(mts, 0, SEEK_END);
+		fsize = gf_f64_tell(mts);
+		gf_f64_seek(mts, 0, SEEK_SET);
+	}
 	done = 0;
 
 	memset(&tsimp, 0, sizeof(GF_TSImport));
@@ -7230,15 +7379,20 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 	sprintf(progress, "Importing MPEG-2 TS (PID %d)", import->trackID);
 	if (do_import) gf_import_message(import, GF_OK, progress);
 
-	while (!feof(mts)) {
-		size = fread(data, sizeof(char), 188, mts);
+	while (bs || !feof(mts)) {
+		if (bs) size = gf_bs_read_data(bs, data, 188);
+		else size = fread(data, sizeof(char), 188, mts);
 		if (size<188)
 			break;
 
 		gf_m2ts_process_data(ts, data, size);
 		if (import->flags & GF_IMPORT_DO_ABORT) break;
 		done += size;
-		if (do_import) gf_set_progress(progress, (u32) (done/1024), (u32) (fsize/1024));
+		if (do_import) gf_set_progress(progress, (u32) (done/1024), (u32) ((bs ? done : fsize)/1024));
+	}
+	if (bs) {
+		gf_bs_del(bs);
+		fsize = done;
 	}
 	import->flags &= ~GF_IMPORT_DO_ABORT;
 
@@ -7247,7 +7401,7 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 		import->last_error = GF_OK;
 		if (tsimp.avccfg) gf_odf_avc_cfg_del(tsimp.avccfg);
   		gf_m2ts_demux_del(ts);
-  		fclose(mts);
+  		import_close_source(mts);
 		return e;
 	}
 	import->esd = NULL;
@@ -7261,7 +7415,7 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 		es = (GF_M2TS_ES *)ts->ess[import->trackID];
   		if (!es) {
   			gf_m2ts_demux_del(ts);
-  			fclose(mts);
+  			import_close_source(mts);
   			return gf_import_message(import, GF_BAD_PARAM, "Unknown PID %d", import->trackID);
   		}
 
@@ -7305,7 +7459,7 @@ GF_Err gf_import_mpeg_ts(GF_MediaImporter *import)
 	}
 
 	gf_m2ts_demux_del(ts);
-	fclose(mts);
+	import_close_source(mts);
 	return GF_OK;
 }
 
@@ -7586,20 +7740,20 @@ GF_Err gf_import_ac3(GF_MediaImporter *import)
 	u64 tot_size, done, duration;
 	GF_ISOSample *samp;
 
-	in = gf_f64_open(import->in_name, "rb");
+	in = import_open_source(import);
 	if (!in) return gf_import_message(import, GF_URL_ERROR, "Opening file %s failed", import->in_name);
-	bs = gf_bs_from_file(in, GF_BITSTREAM_READ);
+	bs = import_source_bs(import, in);
 
 	if (!gf_ac3_parser_bs(bs, &hdr, 1)) {
 		gf_bs_del(bs);
-		fclose(in);
+		import_close_source(in);
 		return gf_import_message(import, GF_NON_COMPLIANT_BITSTREAM, "Audio isn't AC3 audio");
 	}
 	sr = hdr.sample_rate;
 
 	if (import->flags & GF_IMPORT_PROBE_ONLY) {
 		gf_bs_del(bs);
-		fclose(in);
+		import_close_source(in);
 		import->tk_info[0].track_num = 1;
 		import->tk_info[0].type = GF_ISOM_MEDIA_AUDIO;
 		import->tk_info[0].media_type = GF_4CC('A', 'C', '3', ' ');
@@ -7697,7 +7851,8 @@ exit:
 		import->esd = NULL;
 	}
 	if (samp) gf_isom_sample_del(&samp);
-	fclose(in);
+	gf_bs_del(bs);
+	import_close_source(in);
 	return e;
 }
 #endif
@@ -7958,10 +8113,22 @@ GF_Err gf_media_import(GF_MediaImporter *importer)
 	GF_Err e;
 	char *ext, *xml_type;
 	char *fmt = "";
-	if (!importer || (!importer->dest && (importer->flags!=GF_IMPORT_PROBE_ONLY)) || (!importer->in_name && !importer->orig) ) return GF_BAD_PARAM;
+	if (!importer || (!importer->dest && !(importer->flags & GF_IMPORT_PROBE_ONLY)) || (!importer->in_name && !importer->orig) ) return GF_BAD_PARAM;
 
 	if (importer->orig) return gf_import_isomedia(importer);
 
+	/*streamed sources can be read only once, and cannot be referenced*/
+	if (!strcmp(importer->in_name, "-")) importer->flags |= GF_IMPORT_STREAMING;
+	if (importer->flags & GF_IMPORT_STREAMING) {
+		if (importer->flags & GF_IMPORT_USE_DATAREF) 
+			return gf_import_message(importer, GF_NOT_SUPPORTED, "Cannot reference data of streamed source %s", importer->in_name);
+		/*probing would consume the source: no track info, the whole source will be imported*/
+		if (importer->flags & GF_IMPORT_PROBE_ONLY) {
+			importer->nb_tracks = 0;
+			return GF_OK;
+		}
+	}
+
 	if (importer->force_ext) {
 		ext = importer->force_ext;
 	} else {
@@ -7972,6 +8139,25 @@ GF_Err gf_media_import(GF_MediaImporter *importer)
 	if (importer->streamFormat) fmt = importer->streamFormat;
 
 
+	/*only raw AVC, HEVC, AAC, AC3 and MPEG-2 TS can be imported from streamed sources*/
+	if (importer->flags & GF_IMPORT_STREAMING) {
+#ifndef GPAC_DISABLE_AV_PARSERS
+		if (!stricmp(fmt, "AVC") || !stricmp(fmt, "H264") || !strnicmp(ext, ".h264", 5) || !strnicmp(ext, ".264", 4)) 
+			return gf_import_avc_h264(importer);
+		if (!stricmp(fmt, "HEVC") || !stricmp(fmt, "H265") || !strnicmp(ext, ".hevc", 5) || !strnicmp(ext, ".265", 4)) 
+			return gf_import_hevc(importer);
+		if (!stricmp(fmt, "AAC") || !strnicmp(ext, ".aac", 4)) 
+			return gf_import_aac_adts(importer);
+		if (!stricmp(fmt, "AC3") || !strnicmp(ext, ".ac3", 4)) 
+			return gf_import_ac3(importer);
+#endif
+#ifndef GPAC_DISABLE_MPEG2TS
+		if (!stricmp(fmt, "MPEGTS") || !stricmp(fmt, "MPEG-TS") || !strnicmp(ext, ".ts", 3)) 
+			return gf_import_mpeg_ts(importer);
+#endif
+		return gf_import_message(importer, GF_NOT_SUPPORTED, "Format of %s cannot be imported from a streamed source", importer->in_name);
+	}
+
 	/*always try with MP4 - this allows using .m4v extension for both raw CMP and iPod's files*/
 	if (gf_isom_probe_file(importer->in_name)) {
 		importer->orig = gf_isom_open(importer->in_name, GF_ISOM_OPEN_READ, NULL);
@@ -3405,5 +3405,305 @@ GF_Err gf_m2ts_restamp(char *buffer, u32 size, s64 ts_shift, u8 *is_pes)
 	return GF_OK;
 }
 
+/*TS splicer state - all tables are allocated once so that packet processing never allocates*/
+struct __m2ts_splicer
+{
+	/*output PID of each input PID*/
+	u16 pid_map[GF_M2TS_MAX_STREAMS];
+	/*GF_M2TS_SPLICE_* flags of each input PID*/
+	u8 flags[GF_M2TS_MAX_STREAMS];
+	/*last continuity counter seen per input PID, 0xFF if none*/
+	u8 in_cc[GF_M2TS_MAX_STREAMS];
+	/*last continuity counter written per output PID, 0xFF if none*/
+	u8 out_cc[GF_M2TS_MAX_STREAMS];
+	/*true if at least one PID is remapped, PSI of the source must then be rewritten*/
+	Bool has_remap;
+
+	/*shift applied to PCR, PTS and DTS of the current source, in 90kHz*/
+	s64 ts_shift;
+	/*PCR (27MHz) of the source at the pending splice point, or 0 if none*/
+	u64 splice_pcr;
+	Bool splice_pending;
+	/*set for PES PIDs whose packets are dropped until the splice is resolved and a new PES starts on the PID*/
+	u8 pes_wait[GF_M2TS_MAX_STREAMS];
+
+	/*last two PCR bases written and the number of packets output since/between them, used to extrapolate the output clock*/
+	u64 last_pcr, prev_pcr;
+	u32 nb_pck_since_pcr, nb_pck_between_pcr;
+};
+
+GF_EXPORT
+GF_M2TS_Splicer *gf_m2ts_splicer_new()
+{
+	GF_M2TS_Splicer *sp;
+	GF_SAFEALLOC(sp, GF_M2TS_Splicer);
+	if (!sp) return NULL;
+	memset(sp->out_cc, 0xFF, sizeof(u8)*GF_M2TS_MAX_STREAMS);
+	gf_m2ts_splicer_reset_pids(sp);
+	return sp;
+}
+
+GF_EXPORT
+void gf_m2ts_splicer_del(GF_M2TS_Splicer *sp)
+{
+	if (sp) gf_free(sp);
+}
+
+GF_EXPORT
+void gf_m2ts_splicer_reset_pids(GF_M2TS_Splicer *sp)
+{
+	u32 i;
+	for (i=0; i<GF_M2TS_MAX_STREAMS; i++) sp->pid_map[i] = i;
+	memset(sp->flags, 0, sizeof(u8)*GF_M2TS_MAX_STREAMS);
+	memset(sp->in_cc, 0xFF, sizeof(u8)*GF_M2TS_MAX_STREAMS);
+	/*PAT is always parsed for PMT PID remapping*/
+	sp->flags[GF_M2TS_PID_PAT] = GF_M2TS_SPLICE_PSI;
+	sp->has_remap = 0;
+}
+
+GF_EXPORT
+void gf_m2ts_splicer_set_pid(GF_M2TS_Splicer *sp, u16 pid, u16 out_pid, u32 flags)
+{
+	if ((pid>=GF_M2TS_MAX_STREAMS) || (out_pid>=GF_M2TS_MAX_STREAMS)) return;
+	sp->pid_map[pid] = out_pid;
+	sp->flags[pid] = (u8) flags;
+	if (pid != out_pid) sp->has_remap = 1;
+}
+
+GF_EXPORT
+void gf_m2ts_splicer_set_shift(GF_M2TS_Splicer *sp, s64 ts_shift)
+{
+	sp->ts_shift = ts_shift;
+	sp->splice_pending = 0;
+}
+
+#define M2TS_TS_MASK	0x1FFFFFFFFULL
+
+/*maps in_pcr on the output clock extrapolated nb_pck_ahead packets after the current one*/
+static void m2ts_splicer_compute_shift(GF_M2TS_Splicer *sp, u64 in_pcr, u32 nb_pck_ahead)
+{
+	u64 out_pcr = sp->last_pcr;
+	/*PCR bases wrap at 2^33*/
+	if (sp->nb_pck_between_pcr)
+		out_pcr += ((sp->last_pcr - sp->prev_pcr) & M2TS_TS_MASK) * (sp->nb_pck_since_pcr + nb_pck_ahead) / sp->nb_pck_between_pcr;
+	out_pcr &= M2TS_TS_MASK;
+	sp->ts_shift = (s64) out_pcr - (s64) (in_pcr/300);
+	sp->splice_pending = 0;
+}
+
+GF_EXPORT
+void gf_m2ts_splicer_splice(GF_M2TS_Splicer *sp, u64 in_pcr)
+{
+	/*nothing output yet, keep the source timing*/
+	if (!sp->last_pcr && !sp->nb_pck_since_pcr) {
+		sp->ts_shift = 0;
+		sp->splice_pending = 0;
+		return;
+	}
+	if (!in_pcr) {
+		/*shift computed on the first PCR of the new source, PES data before it cannot be timed and is dropped*/
+		sp->splice_pending = 1;
+		memset(sp->pes_wait, 1, sizeof(u8)*GF_M2TS_MAX_STREAMS);
+		return;
+	}
+	m2ts_splicer_compute_shift(sp, in_pcr, 0);
+}
+
+/*shifts a 33 bits timestamp, modulo 2^33*/
+static GFINLINE u64 m2ts_splicer_shift(u64 TS, s64 ts_shift)
+{
+	return (u64) ((s64) TS + ts_shift) & M2TS_TS_MASK;
+}
+
+/*rewrites PIDs of a PAT or PMT section fully contained in the packet payload and recomputes its CRC*/
+static void m2ts_splicer_rewrite_psi(GF_M2TS_Splicer *sp, u8 *data, u32 size)
+{
+	u32 pos, section_length, table_id, crc;
+	u8 *sec;
+
+	/*pointer field*/
+	pos = 1 + data[0];
+	if (pos + 3 > size) return;
+	sec = data + pos;
+	table_id = sec[0];
+	section_length = ((sec[1] & 0x0F) << 8) | sec[2];
+	if ((section_length < 9) || (pos + 3 + section_length > size)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[M2TS Splicer] Table %d section spanning several packets, PIDs not remapped - output may reference source PIDs\n", table_id));
+		return;
+	}
+	/*PAT*/
+	if (table_id == GF_M2TS_TABLE_ID_PAT) {
+		pos = 8;
+		while (pos + 4 <= 3 + section_length - 4) {
+			u16 pid = ((sec[pos+2] & 0x1F) << 8) | sec[pos+3];
+			/*program 0 points to the NIT PID, remapped as well*/
+			pid = sp->pid_map[pid];
+			sec[pos+2] = (sec[pos+2] & 0xE0) | (u8) (pid >> 8);
+			sec[pos+3] = (u8) pid;
+			pos += 4;
+		}
+	}
+	/*PMT*/
+	else if (table_id == GF_M2TS_TABLE_ID_PMT) {
+		u16 pid = ((sec[8] & 0x1F) << 8) | sec[9];
+		u32 info_length;
+		pid = sp->pid_map[pid];
+		sec[8] = (sec[8] & 0xE0) | (u8) (pid >> 8);
+		sec[9] = (u8) pid;
+		info_length = ((sec[10] & 0x0F) << 8) | sec[11];
+		pos = 12 + info_length;
+		while (pos + 5 <= 3 + section_length - 4) {
+			pid = ((sec[pos+1] & 0x1F) << 8) | sec[pos+2];
+			pid = sp->pid_map[pid];
+			sec[pos+1] = (sec[pos+1] & 0xE0) | (u8) (pid >> 8);
+			sec[pos+2] = (u8) pid;
+			info_length = ((sec[pos+3] & 0x0F) << 8) | sec[pos+4];
+			pos += 5 + info_length;
+		}
+	} else {
+		return;
+	}
+	crc = gf_crc_32((char *) sec, 3 + section_length - 4);
+	sec[3 + section_length - 4] = (u8) (crc >> 24);
+	sec[3 + section_length - 3] = (u8) (crc >> 16);
+	sec[3 + section_length - 2] = (u8) (crc >> 8);
+	sec[3 + section_length - 1] = (u8) crc;
+}
+
+/*looks for the first PCR (27MHz) carried on a kept PID in the given packets, and the number of packets output before it*/
+static Bool m2ts_splicer_find_pcr(GF_M2TS_Splicer *sp, u8 *data, u32 size, u64 *pcr, u32 *nb_pck)
+{
+	u32 pos = 0;
+	*nb_pck = 0;
+	while (pos + 188 <= size) {
+		u8 *pck = data + pos;
+		u16 pid = ((pck[1] & 0x1F) << 8) | pck[2];
+		pos += 188;
+		if (pck[0]!=0x47) return 0;
+		if ((pid != GF_M2TS_MAX_STREAMS-1) && (sp->flags[pid] & GF_M2TS_SPLICE_DROP)) continue;
+		if ((pck[3] & 0x20) && (pck[4] >= 7) && (pck[5] & 0x10)) {
+			*pcr = 300 * (((u64)pck[6] << 25) | (pck[7] << 17) | (pck[8] << 9) | (pck[9] << 1) | (pck[10] >> 7));
+			return 1;
+		}
+		(*nb_pck)++;
+	}
+	return 0;
+}
+
+GF_EXPORT
+GF_Err gf_m2ts_splicer_process(GF_M2TS_Splicer *sp, char *buffer, u32 size, u32 *out_size)
+{
+	u32 done, written;
+	Bool pcr_lookup_done = 0;
+
+	done = written = 0;
+	while (done + 188 <= size) {
+		u8 *pck = (u8*) buffer + done;
+		u8 *payload;
+		u32 flags, af, af_length, cc;
+		u16 pid, out_pid;
+
+		if (pck[0]!=0x47) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[M2TS Splicer] Invalid sync byte %X\n", pck[0]));
+			if (out_size) *out_size = written;
+			return GF_NON_COMPLIANT_BITSTREAM;
+		}
+		/*pending splice: the shift must be known before restamping PES packets preceding the first PCR of the new source*/
+		if (sp->splice_pending && !pcr_lookup_done) {
+			u64 in_pcr;
+			u32 nb_pck;
+			if (m2ts_splicer_find_pcr(sp, pck, size - done, &in_pcr, &nb_pck)) m2ts_splicer_compute_shift(sp, in_pcr, nb_pck);
+			pcr_lookup_done = 1;
+		}
+		done += 188;
+		pid = ((pck[1] & 0x1F) << 8) | pck[2];
+		/*null packets are left untouched*/
+		if (pid == GF_M2TS_MAX_STREAMS-1) goto next;
+
+		flags = sp->flags[pid];
+		if (flags & GF_M2TS_SPLICE_DROP) continue;
+
+		/*PES data of the new source is only output once its timeline is known, starting with a new PES*/
+		if ((flags & GF_M2TS_SPLICE_PES) && sp->pes_wait[pid] && (pck[3] & 0x10)) {
+			if (sp->splice_pending || !(pck[1] & 0x40)) {
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[M2TS Splicer] PID %d: dropping PES data before the first PCR of the new source\n", pid));
+				continue;
+			}
+			sp->pes_wait[pid] = 0;
+		}
+
+		/*PID remapping*/
+		out_pid = sp->pid_map[pid];
+		if (out_pid != pid) {
+			pck[1] = (pck[1] & 0xE0) | (u8) (out_pid >> 8);
+			pck[2] = (u8) out_pid;
+		}
+
+		/*continuity counter: only incremented for packets with payload, duplicated packets keep the same counter*/
+		af = (pck[3] >> 4) & 0x3;
+		cc = pck[3] & 0x0F;
+		if (af & 0x1) {
+			if ((sp->in_cc[pid] != cc) || (sp->out_cc[out_pid] == 0xFF)) {
+				sp->out_cc[out_pid] = (sp->out_cc[out_pid] + 1) & 0x0F;
+			}
+		} else if (sp->out_cc[out_pid] == 0xFF) {
+			sp->out_cc[out_pid] = cc;
+		}
+		sp->in_cc[pid] = cc;
+		pck[3] = (pck[3] & 0xF0) | sp->out_cc[out_pid];
+
+		af_length = 0;
+		if (af & 0x2) {
+			af_length = 1 + pck[4];
+			if ((pck[4] >= 7) && (pck[5] & 0x10) /*PCR_flag*/) {
+				u64 pcr_base = ((u64)pck[6] << 25) | (pck[7] << 17) | (pck[8] << 9) | (pck[9] << 1) | (pck[10] >> 7);
+				if (sp->splice_pending) {
+					/*first PCR of the new source, map it right after the last one output*/
+					m2ts_splicer_compute_shift(sp, pcr_base*300, 0);
+				}
+				pcr_base = m2ts_splicer_shift(pcr_base, sp->ts_shift);
+				pck[6] = (u8) (pcr_base >> 25);
+				pck[7] = (u8) (pcr_base >> 17);
+				pck[8] = (u8) (pcr_base >> 9);
+				pck[9] = (u8) (pcr_base >> 1);
+				pck[10] = (u8) ((pcr_base & 0x1) << 7) | (pck[10] & 0x7F);
+
+				if (sp->last_pcr) sp->nb_pck_between_pcr = sp->nb_pck_since_pcr;
+				sp->prev_pcr = sp->last_pcr;
+				sp->last_pcr = pcr_base;
+				sp->nb_pck_since_pcr = 0;
+			}
+			if (af_length >= 184) goto next;
+		}
+		if (!(af & 0x1) || !(pck[1] & 0x40)) goto next;
+		payload = pck + 4 + af_length;
+
+		if ((flags & GF_M2TS_SPLICE_PSI) && sp->has_remap) {
+			m2ts_splicer_rewrite_psi(sp, payload, 184 - af_length);
+		}
+		else if ((flags & GF_M2TS_SPLICE_PES) && sp->ts_shift && (af_length + 14 <= 184)
+			&& !payload[0] && !payload[1] && (payload[2]==0x01) && ((payload[6] & 0xC0) == 0x80)) {
+			/*PES header: PTS and DTS*/
+			if (payload[7] & 0x80) {
+				u64 pts, dts;
+				if (af_length + 19 > 184) goto next;
+				pts = gf_m2ts_get_pts(payload+9);
+				dts = (payload[7] & 0x40) ? gf_m2ts_get_pts(payload+14) : pts;
+				rewrite_pts_dts(payload+9, m2ts_splicer_shift(pts, sp->ts_shift));
+				if (payload[7] & 0x40) {
+					rewrite_pts_dts(payload+14, m2ts_splicer_shift(dts, sp->ts_shift));
+				}
+			}
+		}
+
+next:
+		sp->nb_pck_since_pcr++;
+		if (written != done - 188) memmove(buffer + written, pck, 188);
+		written += 188;
+	}
+	if (out_size) *out_size = written;
+	return GF_OK;
+}
+
 #endif /*GPAC_DISABLE_MPEG2TS*/
 
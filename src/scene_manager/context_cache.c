@@ -0,0 +1,1861 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2000-2012
+ *					All rights reserved
+ *
+ *  This file is part of GPAC / Scene Management sub-project
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+/*
+	Binary scene context cache
+
+  The cache is a raw dump of a loaded VRML/MPEG-4/X3D scene context (streams, AUs, commands, nodes,
+protos and routes) meant to be reloaded by the same GPAC build on the same machine: numbers are written
+in native layout so that MF fields can be read back in one block. Nodes and protos are written once and
+referenced by index afterwards (DEF/USE), in the order they are first met when browsing the context,
+the loader replaying the exact same order.
+  Anything the cache cannot represent (SVG/LASeR, proto instances with loaded code, unknown internal
+descriptors, ...) makes the writer fail with GF_NOT_SUPPORTED, in which case the scene is simply
+parsed from its textual source.
+*/
+
+#include <gpac/scene_manager.h>
+#include <gpac/constants.h>
+#include <gpac/version.h>
+#include <gpac/internal/scenegraph_dev.h>
+#include <gpac/internal/odf_dev.h>
+#include <gpac/nodes_mpeg4.h>
+#include <gpac/nodes_x3d.h>
+
+
+#ifndef GPAC_DISABLE_VRML
+
+#define SM_CACHE_MAGIC		GF_4CC('g','s','c','c')
+/*to increase whenever the format changes*/
+#define SM_CACHE_VERSION	1
+
+enum
+{
+	SM_CACHE_NULL = 0,
+	SM_CACHE_DEF,
+	SM_CACHE_USE,
+};
+
+enum
+{
+	SM_CACHE_ROUTE_IS = 1,
+	SM_CACHE_ROUTE,
+};
+
+#define SM_CACHE_INTERNAL_DESC(_tag)	(((_tag)>=GF_ODF_MUXINFO_TAG) && ((_tag)<=GF_ODF_LASER_CFG_TAG))
+
+typedef struct
+{
+	GF_BitStream *bs;
+	GF_SceneManager *ctx;
+
+	/*node pointer to index hash table*/
+	GF_Node **node_keys;
+	u32 *node_idx;
+	u32 hash_size, nb_nodes;
+
+	GF_List *protos;
+	GF_List *graphs;
+} SMCacheWriter;
+
+typedef struct
+{
+	GF_BitStream *bs;
+	GF_SceneManager *ctx;
+
+	GF_Node **nodes;
+	u32 nb_nodes, nodes_alloc;
+
+	GF_List *protos;
+	GF_List *graphs;
+} SMCacheReader;
+
+
+static u32 smc_hash_node(GF_Node *node, u32 hash_size)
+{
+	u32 h = (u32) (((size_t) node) >> 3);
+	h *= 2654435761U;
+	return h & (hash_size-1);
+}
+
+/*returns index+1 of the node if already written, 0 otherwise*/
+static u32 smc_find_node(SMCacheWriter *cw, GF_Node *node)
+{
+	u32 h = smc_hash_node(node, cw->hash_size);
+	while (cw->node_keys[h]) {
+		if (cw->node_keys[h]==node) return cw->node_idx[h] + 1;
+		h = (h+1) & (cw->hash_size-1);
+	}
+	return 0;
+}
+
+static void smc_add_node(SMCacheWriter *cw, GF_Node *node)
+{
+	u32 h;
+	if (2*(cw->nb_nodes+1) > cw->hash_size) {
+		u32 i, old_size = cw->hash_size;
+		GF_Node **old_keys = cw->node_keys;
+		u32 *old_idx = cw->node_idx;
+
+		cw->hash_size *= 2;
+		cw->node_keys = (GF_Node **)gf_malloc(sizeof(GF_Node *)*cw->hash_size);
+		memset(cw->node_keys, 0, sizeof(GF_Node *)*cw->hash_size);
+		cw->node_idx = (u32 *)gf_malloc(sizeof(u32)*cw->hash_size);
+		for (i=0; i<old_size; i++) {
+			if (!old_keys[i]) continue;
+			h = smc_hash_node(old_keys[i], cw->hash_size);
+			while (cw->node_keys[h]) h = (h+1) & (cw->hash_size-1);
+			cw->node_keys[h] = old_keys[i];
+			cw->node_idx[h] = old_idx[i];
+		}
+		gf_free(old_keys);
+		gf_free(old_idx);
+	}
+	h = smc_hash_node(node, cw->hash_size);
+	while (cw->node_keys[h]) h = (h+1) & (cw->hash_size-1);
+	cw->node_keys[h] = node;
+	cw->node_idx[h] = cw->nb_nodes;
+	cw->nb_nodes++;
+}
+
+/*size of fields stored as plain memory, 0 for other types*/
+static u32 smc_pod_size(u32 sf_type)
+{
+	switch (sf_type) {
+	case GF_SG_VRML_SFBOOL: return sizeof(SFBool);
+	case GF_SG_VRML_SFFLOAT: return sizeof(SFFloat);
+	case GF_SG_VRML_SFTIME: return sizeof(SFTime);
+	case GF_SG_VRML_SFDOUBLE: return sizeof(SFDouble);
+	case GF_SG_VRML_SFINT32: return sizeof(SFInt32);
+	case GF_SG_VRML_SFVEC2F: return sizeof(SFVec2f);
+	case GF_SG_VRML_SFVEC3F: return sizeof(SFVec3f);
+	case GF_SG_VRML_SFVEC4F: return sizeof(SFVec4f);
+	case GF_SG_VRML_SFROTATION: return sizeof(SFRotation);
+	case GF_SG_VRML_SFCOLOR: return sizeof(SFColor);
+	case GF_SG_VRML_SFCOLORRGBA: return sizeof(SFColorRGBA);
+	case GF_SG_VRML_SFVEC2D: return sizeof(SFVec2d);
+	case GF_SG_VRML_SFVEC3D: return sizeof(SFVec3d);
+	default: return 0;
+	}
+}
+
+static Bool smc_is_script(u32 tag)
+{
+	if (tag==TAG_MPEG4_Script) return 1;
+#ifndef GPAC_DISABLE_X3D
+	if (tag==TAG_X3D_Script) return 1;
+#endif
+	return 0;
+}
+
+/*graph a node is declared in - proto instances own a private namespace*/
+static GF_SceneGraph *smc_node_graph(GF_Node *node)
+{
+	GF_SceneGraph *sg = node->sgprivate->scenegraph;
+	if (sg->pOwningProto && (node == (GF_Node *) sg->pOwningProto)) sg = sg->parent_scene;
+	return sg;
+}
+
+
+/*
+		writer
+*/
+
+static void smc_write_string(GF_BitStream *bs, const char *str)
+{
+	u32 len = str ? (u32) strlen(str) + 1 : 0;
+	gf_bs_write_u32(bs, len);
+	if (len>1) gf_bs_write_data(bs, str, len-1);
+}
+
+static GF_Err smc_write_node(SMCacheWriter *cw, GF_Node *node);
+static GF_Err smc_write_command(SMCacheWriter *cw, GF_Command *com);
+static GF_Err smc_write_proto(SMCacheWriter *cw, GF_Proto *proto);
+
+static GF_Err smc_write_node_list(SMCacheWriter *cw, GF_ChildNodeItem *list)
+{
+	GF_Err e;
+	gf_bs_write_u32(cw->bs, gf_node_list_get_count(list));
+	while (list) {
+		e = smc_write_node(cw, list->node);
+		if (e) return e;
+		list = list->next;
+	}
+	return GF_OK;
+}
+
+/*attribute references do not hold the node, which must have been written before*/
+static GF_Err smc_write_attr_ref(SMCacheWriter *cw, SFAttrRef *ar)
+{
+	u32 idx = ar->node ? smc_find_node(cw, ar->node) : 0;
+	if (ar->node && !idx) return GF_NOT_SUPPORTED;
+	gf_bs_write_u32(cw->bs, idx);
+	gf_bs_write_u32(cw->bs, ar->fieldIndex);
+	return GF_OK;
+}
+
+static GF_Err smc_write_field(SMCacheWriter *cw, u32 fieldType, void *ptr)
+{
+	u32 i, size;
+	GF_Err e;
+	GF_BitStream *bs = cw->bs;
+
+	size = smc_pod_size(fieldType);
+	if (size) {
+		gf_bs_write_data(bs, (char *) ptr, size);
+		return GF_OK;
+	}
+	if (!gf_sg_vrml_is_sf_field(fieldType)) {
+		size = smc_pod_size(gf_sg_vrml_get_sf_type(fieldType));
+		if (size) {
+			GenMFField *mf = (GenMFField *)ptr;
+			gf_bs_write_u32(bs, mf->count);
+			if (mf->count) gf_bs_write_data(bs, mf->array, mf->count*size);
+			return GF_OK;
+		}
+	}
+
+	switch (fieldType) {
+	case GF_SG_VRML_SFSTRING:
+		smc_write_string(bs, ((SFString *)ptr)->buffer);
+		return GF_OK;
+	case GF_SG_VRML_SFURL:
+		gf_bs_write_u32(bs, ((SFURL *)ptr)->OD_ID);
+		smc_write_string(bs, ((SFURL *)ptr)->url);
+		return GF_OK;
+	case GF_SG_VRML_SFSCRIPT:
+		smc_write_string(bs, ((SFScript *)ptr)->script_text);
+		return GF_OK;
+	case GF_SG_VRML_SFIMAGE:
+	{
+		SFImage *img = (SFImage *)ptr;
+		gf_bs_write_u32(bs, img->width);
+		gf_bs_write_u32(bs, img->height);
+		gf_bs_write_u8(bs, img->numComponents);
+		size = img->pixels ? img->width * img->height * img->numComponents : 0;
+		gf_bs_write_u32(bs, size);
+		if (size) gf_bs_write_data(bs, (char *) img->pixels, size);
+	}
+		return GF_OK;
+	case GF_SG_VRML_SFCOMMANDBUFFER:
+	{
+		SFCommandBuffer *cb = (SFCommandBuffer *)ptr;
+		gf_bs_write_u32(bs, cb->buffer ? cb->bufferSize : 0);
+		if (cb->buffer && cb->bufferSize) gf_bs_write_data(bs, (char *) cb->buffer, cb->bufferSize);
+		size = gf_list_count(cb->commandList);
+		gf_bs_write_u32(bs, size);
+		for (i=0; i<size; i++) {
+			e = smc_write_command(cw, (GF_Command *)gf_list_get(cb->commandList, i));
+			if (e) return e;
+		}
+	}
+		return GF_OK;
+	case GF_SG_VRML_SFNODE:
+		return smc_write_node(cw, *(GF_Node **)ptr);
+	case GF_SG_VRML_MFNODE:
+		return smc_write_node_list(cw, *(GF_ChildNodeItem **)ptr);
+	case GF_SG_VRML_MFSTRING:
+	{
+		MFString *mf = (MFString *)ptr;
+		gf_bs_write_u32(bs, mf->count);
+		for (i=0; i<mf->count; i++) smc_write_string(bs, mf->vals[i]);
+	}
+		return GF_OK;
+	case GF_SG_VRML_MFURL:
+	{
+		MFURL *mf = (MFURL *)ptr;
+		gf_bs_write_u32(bs, mf->count);
+		for (i=0; i<mf->count; i++) {
+			gf_bs_write_u32(bs, mf->vals[i].OD_ID);
+			smc_write_string(bs, mf->vals[i].url);
+		}
+	}
+		return GF_OK;
+	case GF_SG_VRML_MFSCRIPT:
+	{
+		MFScript *mf = (MFScript *)ptr;
+		gf_bs_write_u32(bs, mf->count);
+		for (i=0; i<mf->count; i++) smc_write_string(bs, mf->vals[i].script_text);
+	}
+		return GF_OK;
+	case GF_SG_VRML_SFATTRREF:
+		return smc_write_attr_ref(cw, (SFAttrRef *)ptr);
+	case GF_SG_VRML_MFATTRREF:
+	{
+		MFAttrRef *mf = (MFAttrRef *)ptr;
+		gf_bs_write_u32(bs, mf->count);
+		for (i=0; i<mf->count; i++) {
+			e = smc_write_attr_ref(cw, &mf->vals[i]);
+			if (e) return e;
+		}
+	}
+		return GF_OK;
+	default:
+		GF_LOG(GF_LOG_INFO, GF_LOG_SCENE, ("[SceneCache] Field type %s not supported\n", gf_sg_vrml_get_field_type_by_name(fieldType)));
+		return GF_NOT_SUPPORTED;
+	}
+}
+
+static GF_Err smc_write_node(SMCacheWriter *cw, GF_Node *node)
+{
+	u32 i, count, tag, ID;
+	s32 idx;
+	GF_Err e;
+	GF_FieldInfo info;
+	GF_BitStream *bs = cw->bs;
+
+	if (!node) {
+		gf_bs_write_u8(bs, SM_CACHE_NULL);
+		return GF_OK;
+	}
+	i = smc_find_node(cw, node);
+	if (i) {
+		gf_bs_write_u8(bs, SM_CACHE_USE);
+		gf_bs_write_u32(bs, i-1);
+		return GF_OK;
+	}
+	tag = node->sgprivate->tag;
+	if ((tag!=TAG_ProtoNode) && ((tag<GF_NODE_RANGE_FIRST_MPEG4) || (tag>GF_NODE_RANGE_LAST_MPEG4))
+#ifndef GPAC_DISABLE_X3D
+		&& ((tag<GF_NODE_RANGE_FIRST_X3D) || (tag>GF_NODE_RANGE_LAST_X3D))
+#endif
+	) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_SCENE, ("[SceneCache] Node %s not supported\n", gf_node_get_class_name(node)));
+		return GF_NOT_SUPPORTED;
+	}
+	idx = gf_list_find(cw->graphs, smc_node_graph(node));
+	if (idx<0) return GF_NOT_SUPPORTED;
+
+	smc_add_node(cw, node);
+	gf_bs_write_u8(bs, SM_CACHE_DEF);
+	gf_bs_write_u32(bs, idx);
+	gf_bs_write_u32(bs, tag);
+	if (tag==TAG_ProtoNode) {
+		GF_ProtoInstance *inst = (GF_ProtoInstance *)node;
+		/*instance code is only loaded for playback*/
+		if (gf_list_count(inst->node_code)) return GF_NOT_SUPPORTED;
+		idx = gf_list_find(cw->protos, inst->proto_interface);
+		if (idx<0) return GF_NOT_SUPPORTED;
+		gf_bs_write_u32(bs, idx);
+	}
+	ID = gf_node_get_id(node);
+	gf_bs_write_u32(bs, ID);
+	if (ID) smc_write_string(bs, gf_node_get_name(node));
+
+	/*dynamic fields must be declared before the values are restored*/
+	if (smc_is_script(tag)) {
+		GF_ScriptField *sf;
+		GF_ScriptPriv *priv = (GF_ScriptPriv *)gf_node_get_private(node);
+		count = priv ? gf_list_count(priv->fields) : 0;
+		gf_bs_write_u32(bs, count);
+		for (i=0; i<count; i++) {
+			sf = (GF_ScriptField *)gf_list_get(priv->fields, i);
+			/*stored as gf_sg_script_field_new types*/
+			switch (sf->eventType) {
+			case GF_SG_EVENT_IN:
+				gf_bs_write_u8(bs, GF_SG_SCRIPT_TYPE_EVENT_IN);
+				break;
+			case GF_SG_EVENT_OUT:
+				gf_bs_write_u8(bs, GF_SG_SCRIPT_TYPE_EVENT_OUT);
+				break;
+			default:
+				gf_bs_write_u8(bs, GF_SG_SCRIPT_TYPE_FIELD);
+				break;
+			}
+			gf_bs_write_u8(bs, sf->fieldType);
+			smc_write_string(bs, sf->name);
+		}
+	}
+
+	count = gf_node_get_field_count(node);
+	for (i=0; i<count; i++) {
+		e = gf_node_get_field(node, i, &info);
+		if (e) return e;
+		if ((info.eventType==GF_SG_EVENT_IN) || (info.eventType==GF_SG_EVENT_OUT)) continue;
+
+		if (tag==TAG_ProtoNode) {
+			GF_ProtoField *pf = (GF_ProtoField *)gf_list_get(((GF_ProtoInstance *)node)->fields, i);
+			gf_bs_write_u8(bs, pf ? pf->has_been_accessed : 0);
+		}
+		/*bitwrapper buffers may hold binary data*/
+		else if ((tag==TAG_MPEG4_BitWrapper) && (info.far_ptr == &((M_BitWrapper *)node)->buffer)) {
+			M_BitWrapper *bw = (M_BitWrapper *)node;
+			u32 len = bw->buffer.buffer ? bw->buffer_len : 0;
+			gf_bs_write_u32(bs, len);
+			if (len) {
+				gf_bs_write_data(bs, bw->buffer.buffer, len);
+				continue;
+			}
+		}
+		e = smc_write_field(cw, info.fieldType, info.far_ptr);
+		if (e) return e;
+	}
+	return GF_OK;
+}
+
+static GF_Err smc_write_node_ref(SMCacheWriter *cw, GF_Node *node)
+{
+	u32 idx = smc_find_node(cw, node);
+	if (!idx) return GF_NOT_SUPPORTED;
+	gf_bs_write_u32(cw->bs, idx-1);
+	return GF_OK;
+}
+
+static GF_Err smc_write_routes(SMCacheWriter *cw, GF_SceneGraph *sg, GF_Proto *proto)
+{
+	u32 i, count, nb_routes;
+	GF_Route *r;
+	GF_Err e;
+	GF_BitStream *bs = cw->bs;
+	GF_List *routes = gf_list_new();
+
+	count = gf_list_count(sg->Routes);
+	for (i=0; i<count; i++) {
+		r = (GF_Route *)gf_list_get(sg->Routes, i);
+		if (r->graph != sg) continue;
+		if (r->IS_route) {
+			GF_FieldInfo info;
+			GF_ProtoFieldInterface *pf;
+			if (!proto) continue;
+			if (r->ToNode) {
+				gf_list_add(routes, r);
+				continue;
+			}
+			/*eventOut half of an exposedField IS, recreated with its eventIn counterpart*/
+			pf = (GF_ProtoFieldInterface *)gf_list_get(proto->proto_fields, r->ToField.fieldIndex);
+			if (!r->FromNode || !pf) continue;
+			if ((pf->EventType==GF_SG_EVENT_EXPOSED_FIELD)
+				&& (gf_node_get_field(r->FromNode, r->FromField.fieldIndex, &info)==GF_OK)
+				&& (info.eventType==GF_SG_EVENT_EXPOSED_FIELD)
+			)
+				continue;
+		}
+		gf_list_add(routes, r);
+	}
+
+	e = GF_OK;
+	nb_routes = gf_list_count(routes);
+	gf_bs_write_u32(bs, nb_routes);
+	for (i=0; i<nb_routes; i++) {
+		r = (GF_Route *)gf_list_get(routes, i);
+		if (r->IS_route) {
+			gf_bs_write_u8(bs, SM_CACHE_ROUTE_IS);
+			if (r->ToNode) {
+				gf_bs_write_u32(bs, r->FromField.fieldIndex);
+				e = smc_write_node_ref(cw, r->ToNode);
+				gf_bs_write_u32(bs, r->ToField.fieldIndex);
+			} else {
+				gf_bs_write_u32(bs, r->ToField.fieldIndex);
+				e = smc_write_node_ref(cw, r->FromNode);
+				gf_bs_write_u32(bs, r->FromField.fieldIndex);
+			}
+		} else {
+			if (!r->FromNode || !r->ToNode) {
+				e = GF_NOT_SUPPORTED;
+				break;
+			}
+			gf_bs_write_u8(bs, SM_CACHE_ROUTE);
+			gf_bs_write_u32(bs, r->ID);
+			smc_write_string(bs, r->name);
+			e = smc_write_node_ref(cw, r->FromNode);
+			if (e) break;
+			gf_bs_write_u32(bs, r->FromField.fieldIndex);
+			e = smc_write_node_ref(cw, r->ToNode);
+			gf_bs_write_u32(bs, r->ToField.fieldIndex);
+		}
+		if (e) break;
+	}
+	gf_list_del(routes);
+	return e;
+}
+
+static GF_Err smc_write_proto_list(SMCacheWriter *cw, GF_List *protos)
+{
+	GF_Err e;
+	u32 i, count = gf_list_count(protos);
+	gf_bs_write_u32(cw->bs, count);
+	for (i=0; i<count; i++) {
+		e = smc_write_proto(cw, (GF_Proto *)gf_list_get(protos, i));
+		if (e) return e;
+	}
+	return GF_OK;
+}
+
+static GF_Err smc_write_proto(SMCacheWriter *cw, GF_Proto *proto)
+{
+	u32 i, count;
+	s32 idx;
+	GF_Err e;
+	GF_BitStream *bs = cw->bs;
+
+	idx = gf_list_find(cw->protos, proto);
+	if (idx>=0) {
+		gf_bs_write_u8(bs, SM_CACHE_USE);
+		gf_bs_write_u32(bs, idx);
+		return GF_OK;
+	}
+	idx = gf_list_find(cw->graphs, proto->parent_graph);
+	if (idx<0) return GF_NOT_SUPPORTED;
+	if (gf_list_count(proto->sub_graph->unregistered_protos)) return GF_NOT_SUPPORTED;
+
+	gf_list_add(cw->protos, proto);
+	gf_list_add(cw->graphs, proto->sub_graph);
+
+	gf_bs_write_u8(bs, SM_CACHE_DEF);
+	gf_bs_write_u32(bs, idx);
+	gf_bs_write_u32(bs, proto->ID);
+	smc_write_string(bs, proto->Name);
+	gf_bs_write_u8(bs, (gf_list_find(proto->parent_graph->protos, proto)<0) ? 1 : 0);
+	e = smc_write_field(cw, GF_SG_VRML_MFURL, &proto->ExternProto);
+	if (e) return e;
+
+	count = gf_list_count(proto->proto_fields);
+	gf_bs_write_u32(bs, count);
+	for (i=0; i<count; i++) {
+		GF_ProtoFieldInterface *pf = (GF_ProtoFieldInterface *)gf_list_get(proto->proto_fields, i);
+		gf_bs_write_u8(bs, pf->EventType);
+		gf_bs_write_u8(bs, pf->FieldType);
+		smc_write_string(bs, pf->FieldName);
+
+		if ((pf->EventType==GF_SG_EVENT_FIELD) || (pf->EventType==GF_SG_EVENT_EXPOSED_FIELD)) {
+			if (pf->FieldType==GF_SG_VRML_SFNODE) e = smc_write_node(cw, pf->def_sfnode_value);
+			else if (pf->FieldType==GF_SG_VRML_MFNODE) e = smc_write_node_list(cw, pf->def_mfnode_value);
+			else e = smc_write_field(cw, pf->FieldType, pf->def_value);
+			if (e) return e;
+		}
+		/*BIFS coding info*/
+		gf_bs_write_u32(bs, pf->QP_Type);
+		gf_bs_write_u32(bs, pf->hasMinMax);
+		gf_bs_write_u32(bs, pf->NumBits);
+		gf_bs_write_u32(bs, pf->Anim_Type);
+		if (pf->QP_Type && pf->hasMinMax) {
+			/*min/max are stored as SFInt32 or SFFloat, both 32 bits*/
+			gf_bs_write_u8(bs, pf->qp_min_value ? 1 : 0);
+			if (pf->qp_min_value) gf_bs_write_data(bs, pf->qp_min_value, 4);
+			gf_bs_write_u8(bs, pf->qp_max_value ? 1 : 0);
+			if (pf->qp_max_value) gf_bs_write_data(bs, pf->qp_max_value, 4);
+		}
+	}
+
+	e = smc_write_proto_list(cw, proto->sub_graph->protos);
+	if (e) return e;
+
+	count = gf_list_count(proto->node_code);
+	gf_bs_write_u32(bs, count);
+	for (i=0; i<count; i++) {
+		e = smc_write_node(cw, (GF_Node *)gf_list_get(proto->node_code, i));
+		if (e) return e;
+	}
+	return smc_write_routes(cw, proto->sub_graph, proto);
+}
+
+static GF_Err smc_write_command(SMCacheWriter *cw, GF_Command *com)
+{
+	u32 i, count;
+	s32 idx;
+	GF_Err e;
+	GF_ChildNodeItem *child;
+	GF_BitStream *bs = cw->bs;
+
+	if (com->tag >= GF_SG_LAST_BIFS_COMMAND) return GF_NOT_SUPPORTED;
+	idx = -1;
+	if (com->in_scene) {
+		idx = gf_list_find(cw->graphs, com->in_scene);
+		if (idx<0) return GF_NOT_SUPPORTED;
+	}
+	gf_bs_write_u32(bs, (u32) idx);
+	gf_bs_write_u32(bs, com->tag);
+
+	e = smc_write_proto_list(cw, com->new_proto_list);
+	if (e) return e;
+	e = smc_write_node(cw, com->node);
+	if (e) return e;
+
+	gf_bs_write_u32(bs, com->RouteID);
+	gf_bs_write_u32(bs, com->del_proto_list_size);
+	gf_bs_write_u8(bs, com->del_proto_list ? 1 : 0);
+	if (com->del_proto_list) {
+		for (i=0; i<com->del_proto_list_size; i++) gf_bs_write_u32(bs, com->del_proto_list[i]);
+	}
+	smc_write_string(bs, com->def_name);
+	gf_bs_write_u32(bs, com->fromNodeID);
+	gf_bs_write_u32(bs, com->fromFieldIndex);
+	gf_bs_write_u32(bs, com->toNodeID);
+	gf_bs_write_u32(bs, com->toFieldIndex);
+	gf_bs_write_u8(bs, com->aggregated);
+	gf_bs_write_u8(bs, com->never_apply);
+	gf_bs_write_u8(bs, com->unresolved);
+	smc_write_string(bs, com->unres_name);
+
+	count = gf_list_count(com->command_fields);
+	gf_bs_write_u32(bs, count);
+	for (i=0; i<count; i++) {
+		GF_CommandField *inf = (GF_CommandField *)gf_list_get(com->command_fields, i);
+		gf_bs_write_u32(bs, inf->fieldIndex);
+		gf_bs_write_u32(bs, inf->fieldType);
+		gf_bs_write_u32(bs, (u32) inf->pos);
+		e = smc_write_node(cw, inf->new_node);
+		if (e) return e;
+		gf_bs_write_u32(bs, gf_node_list_get_count(inf->node_list));
+		child = inf->node_list;
+		while (child) {
+			e = smc_write_node(cw, child->node);
+			if (e) return e;
+			child = child->next;
+		}
+		if (!inf->field_ptr) {
+			gf_bs_write_u8(bs, 0);
+		} else if (inf->field_ptr == &inf->new_node) {
+			gf_bs_write_u8(bs, 1);
+		} else if (inf->field_ptr == &inf->node_list) {
+			gf_bs_write_u8(bs, 2);
+		} else {
+			gf_bs_write_u8(bs, 3);
+			e = smc_write_field(cw, inf->fieldType, inf->field_ptr);
+			if (e) return e;
+		}
+	}
+	return GF_OK;
+}
+
+static GF_Err smc_write_internal_desc(GF_BitStream *bs, GF_Descriptor *desc)
+{
+	u32 i, count;
+	if (!desc) {
+		gf_bs_write_u8(bs, 0);
+		return GF_OK;
+	}
+	switch (desc->tag) {
+	case GF_ODF_MUXINFO_TAG:
+	{
+		GF_MuxInfo *mux = (GF_MuxInfo *)desc;
+		gf_bs_write_u8(bs, desc->tag);
+		smc_write_string(bs, mux->file_name);
+		gf_bs_write_u32(bs, mux->GroupID);
+		smc_write_string(bs, mux->streamFormat);
+		gf_bs_write_u32(bs, (u32) mux->startTime);
+		gf_bs_write_u32(bs, mux->duration);
+		smc_write_string(bs, mux->textNode);
+		smc_write_string(bs, mux->fontNode);
+		gf_bs_write_double(bs, mux->frame_rate);
+		gf_bs_write_u32(bs, mux->import_flags);
+		gf_bs_write_u8(bs, mux->delete_file);
+		gf_bs_write_u32(bs, mux->carousel_period_plus_one);
+		gf_bs_write_u16(bs, mux->aggregate_on_esid);
+	}
+		return GF_OK;
+	case GF_ODF_BIFS_CFG_TAG:
+	{
+		GF_BIFSConfig *cfg = (GF_BIFSConfig *)desc;
+		gf_bs_write_u8(bs, desc->tag);
+		gf_bs_write_u32(bs, cfg->version);
+		gf_bs_write_u16(bs, cfg->nodeIDbits);
+		gf_bs_write_u16(bs, cfg->routeIDbits);
+		gf_bs_write_u16(bs, cfg->protoIDbits);
+		gf_bs_write_u8(bs, cfg->pixelMetrics);
+		gf_bs_write_u16(bs, cfg->pixelWidth);
+		gf_bs_write_u16(bs, cfg->pixelHeight);
+		gf_bs_write_u8(bs, cfg->randomAccess);
+		gf_bs_write_u8(bs, cfg->useNames);
+		count = gf_list_count(cfg->elementaryMasks);
+		gf_bs_write_u32(bs, count);
+		for (i=0; i<count; i++) {
+			GF_ElementaryMask *em = (GF_ElementaryMask *)gf_list_get(cfg->elementaryMasks, i);
+			gf_bs_write_u32(bs, em->node_id);
+			smc_write_string(bs, em->node_name);
+		}
+	}
+		return GF_OK;
+	case GF_ODF_UI_CFG_TAG:
+	{
+		GF_UIConfig *cfg = (GF_UIConfig *)desc;
+		gf_bs_write_u8(bs, desc->tag);
+		smc_write_string(bs, cfg->deviceName);
+		gf_bs_write_u8(bs, cfg->termChar);
+		gf_bs_write_u8(bs, cfg->delChar);
+		gf_bs_write_u32(bs, cfg->ui_data ? cfg->ui_data_length : 0);
+		if (cfg->ui_data && cfg->ui_data_length) gf_bs_write_data(bs, cfg->ui_data, cfg->ui_data_length);
+	}
+		return GF_OK;
+	default:
+		return GF_NOT_SUPPORTED;
+	}
+}
+
+static void smc_get_od_esds(GF_Descriptor *desc, GF_List *esds)
+{
+	u32 i;
+	GF_ESD *esd;
+	if (!desc) return;
+	if ((desc->tag!=GF_ODF_OD_TAG) && (desc->tag!=GF_ODF_IOD_TAG)) return;
+	i=0;
+	while ((esd = (GF_ESD *)gf_list_enum(((GF_ObjectDescriptor *)desc)->ESDescriptors, &i))) {
+		gf_list_add(esds, esd);
+	}
+}
+
+static void smc_get_od_com_esds(GF_ODCom *com, GF_List *esds)
+{
+	u32 i;
+	GF_Descriptor *desc;
+	switch (com->tag) {
+	case GF_ODF_OD_UPDATE_TAG:
+		i=0;
+		while ((desc = (GF_Descriptor *)gf_list_enum(((GF_ODUpdate *)com)->objectDescriptors, &i))) {
+			smc_get_od_esds(desc, esds);
+		}
+		break;
+	case GF_ODF_ESD_UPDATE_TAG:
+		i=0;
+		while ((desc = (GF_Descriptor *)gf_list_enum(((GF_ESDUpdate *)com)->ESDescriptors, &i))) {
+			gf_list_add(esds, desc);
+		}
+		break;
+	}
+}
+
+/*writes an OD command or descriptor: GPAC internal descriptors are not handled by the OD codec, they are
+written after the regular OD data together with the complete SL config of each ESD*/
+static GF_Err smc_write_od(SMCacheWriter *cw, GF_ODCom *com, GF_Descriptor *desc)
+{
+	u32 i, j, count, nb_ext;
+	GF_Err e;
+	GF_ESD *esd;
+	GF_Descriptor **dsis;
+	GF_BitStream *bs = cw->bs;
+	GF_List *esds = gf_list_new();
+
+	if (com) smc_get_od_com_esds(com, esds);
+	else smc_get_od_esds(desc, esds);
+
+	count = gf_list_count(esds);
+	dsis = (GF_Descriptor **)gf_malloc(sizeof(GF_Descriptor *) * (count+1));
+	for (i=0; i<count; i++) {
+		esd = (GF_ESD *)gf_list_get(esds, i);
+		dsis[i] = NULL;
+		if (esd->decoderConfig && esd->decoderConfig->decoderSpecificInfo
+			&& SM_CACHE_INTERNAL_DESC(esd->decoderConfig->decoderSpecificInfo->tag)) {
+			dsis[i] = (GF_Descriptor *) esd->decoderConfig->decoderSpecificInfo;
+			esd->decoderConfig->decoderSpecificInfo = NULL;
+		}
+	}
+	if (com) e = gf_odf_write_command(bs, com);
+	else e = gf_odf_write_descriptor(bs, desc);
+	gf_bs_align(bs);
+
+	for (i=0; i<count; i++) {
+		esd = (GF_ESD *)gf_list_get(esds, i);
+		if (dsis[i]) esd->decoderConfig->decoderSpecificInfo = (GF_DefaultDescriptor *) dsis[i];
+	}
+
+	for (i=0; i<count && !e; i++) {
+		GF_SLConfig *sl;
+		esd = (GF_ESD *)gf_list_get(esds, i);
+		sl = esd->slConfig;
+		gf_bs_write_u8(bs, sl ? 1 : 0);
+		if (sl) {
+			gf_bs_write_u8(bs, sl->predefined);
+			gf_bs_write_u8(bs, sl->useAccessUnitStartFlag);
+			gf_bs_write_u8(bs, sl->useAccessUnitEndFlag);
+			gf_bs_write_u8(bs, sl->useRandomAccessPointFlag);
+			gf_bs_write_u8(bs, sl->hasRandomAccessUnitsOnlyFlag);
+			gf_bs_write_u8(bs, sl->usePaddingFlag);
+			gf_bs_write_u8(bs, sl->useTimestampsFlag);
+			gf_bs_write_u8(bs, sl->useIdleFlag);
+			gf_bs_write_u8(bs, sl->durationFlag);
+			gf_bs_write_u32(bs, sl->timestampResolution);
+			gf_bs_write_u32(bs, sl->OCRResolution);
+			gf_bs_write_u8(bs, sl->timestampLength);
+			gf_bs_write_u8(bs, sl->OCRLength);
+			gf_bs_write_u8(bs, sl->AULength);
+			gf_bs_write_u8(bs, sl->instantBitrateLength);
+			gf_bs_write_u8(bs, sl->degradationPriorityLength);
+			gf_bs_write_u8(bs, sl->AUSeqNumLength);
+			gf_bs_write_u8(bs, sl->packetSeqNumLength);
+			gf_bs_write_u32(bs, sl->timeScale);
+			gf_bs_write_u16(bs, sl->AUDuration);
+			gf_bs_write_u16(bs, sl->CUDuration);
+			gf_bs_write_u64(bs, sl->startDTS);
+			gf_bs_write_u64(bs, sl->startCTS);
+			gf_bs_write_u8(bs, sl->no_dts_signaling);
+		}
+		e = smc_write_internal_desc(bs, dsis[i]);
+		if (e) break;
+
+		nb_ext = 0;
+		for (j=0; j<gf_list_count(esd->extensionDescriptors); j++) {
+			GF_Descriptor *ext = (GF_Descriptor *)gf_list_get(esd->extensionDescriptors, j);
+			if (SM_CACHE_INTERNAL_DESC(ext->tag)) nb_ext++;
+		}
+		gf_bs_write_u32(bs, nb_ext);
+		for (j=0; j<gf_list_count(esd->extensionDescriptors); j++) {
+			GF_Descriptor *ext = (GF_Descriptor *)gf_list_get(esd->extensionDescriptors, j);
+			if (!SM_CACHE_INTERNAL_DESC(ext->tag)) continue;
+			gf_bs_write_u32(bs, j);
+			e = smc_write_internal_desc(bs, ext);
+			if (e) break;
+		}
+	}
+	gf_free(dsis);
+	gf_list_del(esds);
+	return e;
+}
+
+static GF_Err smc_write_context(SMCacheWriter *cw)
+{
+	u32 i, j, count, nb_aus, nb_com;
+	GF_Err e;
+	GF_StreamContext *sc;
+	GF_AUContext *au;
+	GF_BitStream *bs = cw->bs;
+	GF_SceneManager *ctx = cw->ctx;
+	GF_SceneGraph *sg = ctx->scene_graph;
+	const u32 endian_check = 0x01020304;
+
+	gf_bs_write_u32(bs, SM_CACHE_MAGIC);
+	gf_bs_write_u32(bs, SM_CACHE_VERSION);
+	smc_write_string(bs, GPAC_VERSION);
+	gf_bs_write_u32(bs, TAG_LastImplementedMPEG4);
+#ifndef GPAC_DISABLE_X3D
+	gf_bs_write_u32(bs, TAG_LastImplementedX3D);
+#else
+	gf_bs_write_u32(bs, 0);
+#endif
+	gf_bs_write_u8(bs, sizeof(Fixed));
+	gf_bs_write_data(bs, (char *) &endian_check, 4);
+
+	gf_bs_write_u32(bs, ctx->scene_width);
+	gf_bs_write_u32(bs, ctx->scene_height);
+	gf_bs_write_u8(bs, ctx->is_pixel_metrics);
+	gf_bs_write_u32(bs, ctx->max_node_id);
+	gf_bs_write_u32(bs, ctx->max_route_id);
+	gf_bs_write_u32(bs, ctx->max_proto_id);
+	gf_bs_write_u32(bs, sg->width);
+	gf_bs_write_u32(bs, sg->height);
+	gf_bs_write_u8(bs, sg->usePixelMetrics);
+	gf_bs_write_u32(bs, sg->max_defined_route_id);
+
+	/*graph-level protos and root (VRML/X3D files)*/
+	e = smc_write_proto_list(cw, sg->protos);
+	if (e) return e;
+	e = smc_write_node(cw, sg->RootNode);
+	if (e) return e;
+
+	gf_bs_write_u8(bs, ctx->root_od ? 1 : 0);
+	if (ctx->root_od) {
+		e = smc_write_od(cw, NULL, (GF_Descriptor *) ctx->root_od);
+		if (e) return e;
+	}
+
+	count = gf_list_count(ctx->streams);
+	gf_bs_write_u32(bs, count);
+	for (i=0; i<count; i++) {
+		sc = (GF_StreamContext *)gf_list_get(ctx->streams, i);
+		gf_bs_write_u16(bs, sc->ESID);
+		smc_write_string(bs, sc->name);
+		gf_bs_write_u8(bs, sc->streamType);
+		gf_bs_write_u8(bs, sc->objectType);
+		gf_bs_write_u32(bs, sc->timeScale);
+		gf_bs_write_u8(bs, sc->in_root_od);
+		gf_bs_write_u32(bs, sc->dec_cfg ? sc->dec_cfg_len : 0);
+		if (sc->dec_cfg && sc->dec_cfg_len) gf_bs_write_data(bs, sc->dec_cfg, sc->dec_cfg_len);
+		gf_bs_write_u64(bs, sc->imp_exp_time);
+		gf_bs_write_u16(bs, sc->aggregate_on_esid);
+		gf_bs_write_u32(bs, sc->carousel_period);
+		gf_bs_write_u8(bs, sc->disable_aggregation);
+
+		nb_aus = gf_list_count(sc->AUs);
+		gf_bs_write_u32(bs, nb_aus);
+		for (j=0; j<gf_list_count(sc->AUs); j++) {
+			u32 k;
+			au = (GF_AUContext *)gf_list_get(sc->AUs, j);
+			nb_com = gf_list_count(au->commands);
+			if (nb_com && (sc->streamType!=GF_STREAM_OD) && (sc->streamType!=GF_STREAM_SCENE)) return GF_NOT_SUPPORTED;
+
+			gf_bs_write_u64(bs, au->timing);
+			gf_bs_write_double(bs, au->timing_sec);
+			gf_bs_write_u32(bs, au->flags);
+			gf_bs_write_u32(bs, nb_com);
+			for (k=0; k<nb_com; k++) {
+				if (sc->streamType==GF_STREAM_OD) {
+					e = smc_write_od(cw, (GF_ODCom *)gf_list_get(au->commands, k), NULL);
+				} else {
+					e = smc_write_command(cw, (GF_Command *)gf_list_get(au->commands, k));
+				}
+				if (e) return e;
+			}
+		}
+	}
+	return smc_write_routes(cw, sg, NULL);
+}
+
+GF_EXPORT
+GF_Err gf_sm_save_context_cache(GF_SceneManager *ctx, const char *cache_file)
+{
+	GF_Err e;
+	SMCacheWriter cw;
+	char *data;
+	u32 size;
+	char szTmp[GF_MAX_PATH];
+	FILE *f;
+
+	if (!ctx || !ctx->scene_graph || !cache_file) return GF_BAD_PARAM;
+
+	memset(&cw, 0, sizeof(SMCacheWriter));
+	cw.ctx = ctx;
+	cw.bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	cw.hash_size = 1024;
+	cw.node_keys = (GF_Node **)gf_malloc(sizeof(GF_Node *)*cw.hash_size);
+	memset(cw.node_keys, 0, sizeof(GF_Node *)*cw.hash_size);
+	cw.node_idx = (u32 *)gf_malloc(sizeof(u32)*cw.hash_size);
+	cw.protos = gf_list_new();
+	cw.graphs = gf_list_new();
+	gf_list_add(cw.graphs, ctx->scene_graph);
+
+	e = smc_write_context(&cw);
+
+	gf_free(cw.node_keys);
+	gf_free(cw.node_idx);
+	gf_list_del(cw.protos);
+	gf_list_del(cw.graphs);
+	if (e) {
+		gf_bs_del(cw.bs);
+		return e;
+	}
+	data = NULL;
+	gf_bs_get_content(cw.bs, &data, &size);
+	gf_bs_del(cw.bs);
+
+	/*write to a temp file first so that concurrent loaders never see a partial cache*/
+	if (strlen(cache_file) + 20 > GF_MAX_PATH) {
+		gf_free(data);
+		return GF_BAD_PARAM;
+	}
+	sprintf(szTmp, "%s_%08X.tmp", cache_file, gf_sys_clock() ^ (u32) (size_t) &cw);
+	f = gf_f64_open(szTmp, "wb");
+	if (!f) {
+		gf_free(data);
+		return GF_IO_ERR;
+	}
+	e = (fwrite(data, 1, size, f) == size) ? GF_OK : GF_IO_ERR;
+	fclose(f);
+	gf_free(data);
+
+	if (!e && rename(szTmp, cache_file)) {
+		/*rename does not replace existing files on all platforms*/
+		gf_delete_file(cache_file);
+		if (rename(szTmp, cache_file)) e = GF_IO_ERR;
+	}
+	if (e) gf_delete_file(szTmp);
+	else GF_LOG(GF_LOG_INFO, GF_LOG_SCENE, ("[SceneCache] Context cached in %s (%d bytes)\n", cache_file, size));
+	return e;
+}
+
+
+/*
+		reader
+*/
+
+static GF_Err smc_read_string(SMCacheReader *cr, char **out)
+{
+	u32 len = gf_bs_read_u32(cr->bs);
+	*out = NULL;
+	if (!len) return GF_OK;
+	if (len-1 > gf_bs_available(cr->bs)) return GF_NON_COMPLIANT_BITSTREAM;
+	*out = (char *)gf_malloc(sizeof(char)*len);
+	if (len>1) gf_bs_read_data(cr->bs, *out, len-1);
+	(*out)[len-1] = 0;
+	return GF_OK;
+}
+
+static GF_Err smc_read_node(SMCacheReader *cr, GF_Node *parent, GF_Node **out);
+static GF_Err smc_read_command(SMCacheReader *cr, GF_Command **out);
+static GF_Err smc_read_proto(SMCacheReader *cr, GF_Proto **out);
+
+static GF_Err smc_read_node_list(SMCacheReader *cr, GF_Node *parent, GF_ChildNodeItem **list)
+{
+	GF_Err e;
+	GF_Node *n;
+	GF_ChildNodeItem *last = NULL;
+	u32 count = gf_bs_read_u32(cr->bs);
+	while (count) {
+		e = smc_read_node(cr, parent, &n);
+		if (n) gf_node_list_add_child_last(list, n, &last);
+		if (e) return e;
+		count--;
+	}
+	return GF_OK;
+}
+
+/*check there is enough data left before allocating - sizes computed from counts read in the file must be given in 64 bits so that they cannot wrap*/
+#define SMC_CHECK_SIZE(_size)	if ((u64) (_size) > gf_bs_available(cr->bs)) return GF_NON_COMPLIANT_BITSTREAM;
+
+static GF_Err smc_read_attr_ref(SMCacheReader *cr, SFAttrRef *ar)
+{
+	u32 idx = gf_bs_read_u32(cr->bs);
+	ar->node = NULL;
+	ar->fieldIndex = gf_bs_read_u32(cr->bs);
+	if (!idx) return GF_OK;
+	if (idx > cr->nb_nodes) return GF_NON_COMPLIANT_BITSTREAM;
+	ar->node = cr->nodes[idx-1];
+	return GF_OK;
+}
+
+static GF_Err smc_read_field(SMCacheReader *cr, u32 fieldType, void *ptr, GF_Node *parent)
+{
+	u32 i, size, count;
+	GF_Err e;
+	GF_BitStream *bs = cr->bs;
+
+	size = smc_pod_size(fieldType);
+	if (size) {
+		gf_bs_read_data(bs, (char *) ptr, size);
+		return GF_OK;
+	}
+	if (!gf_sg_vrml_is_sf_field(fieldType)) {
+		size = smc_pod_size(gf_sg_vrml_get_sf_type(fieldType));
+		if (size) {
+			GenMFField *mf = (GenMFField *)ptr;
+			count = gf_bs_read_u32(bs);
+			SMC_CHECK_SIZE((u64) count*size)
+			gf_sg_vrml_mf_reset(ptr, fieldType);
+			e = gf_sg_vrml_mf_alloc(ptr, fieldType, count);
+			if (e) return e;
+			if (count) gf_bs_read_data(bs, mf->array, count*size);
+			return GF_OK;
+		}
+	}
+
+	switch (fieldType) {
+	case GF_SG_VRML_SFSTRING:
+		if (((SFString *)ptr)->buffer) gf_free(((SFString *)ptr)->buffer);
+		return smc_read_string(cr, &((SFString *)ptr)->buffer);
+	case GF_SG_VRML_SFURL:
+		if (((SFURL *)ptr)->url) gf_free(((SFURL *)ptr)->url);
+		((SFURL *)ptr)->OD_ID = gf_bs_read_u32(bs);
+		return smc_read_string(cr, &((SFURL *)ptr)->url);
+	case GF_SG_VRML_SFSCRIPT:
+		if (((SFScript *)ptr)->script_text) gf_free(((SFScript *)ptr)->script_text);
+		return smc_read_string(cr, &((SFScript *)ptr)->script_text);
+	case GF_SG_VRML_SFIMAGE:
+	{
+		SFImage *img = (SFImage *)ptr;
+		if (img->pixels) gf_free(img->pixels);
+		img->pixels = NULL;
+		img->width = gf_bs_read_u32(bs);
+		img->height = gf_bs_read_u32(bs);
+		img->numComponents = gf_bs_read_u8(bs);
+		size = gf_bs_read_u32(bs);
+		SMC_CHECK_SIZE(size)
+		if (size) {
+			img->pixels = (unsigned char *)gf_malloc(sizeof(char)*size);
+			gf_bs_read_data(bs, (char *) img->pixels, size);
+		}
+	}
+		return GF_OK;
+	case GF_SG_VRML_SFCOMMANDBUFFER:
+	{
+		SFCommandBuffer *cb = (SFCommandBuffer *)ptr;
+		if (cb->buffer) gf_free(cb->buffer);
+		cb->buffer = NULL;
+		cb->bufferSize = gf_bs_read_u32(bs);
+		SMC_CHECK_SIZE(cb->bufferSize)
+		if (cb->bufferSize) {
+			cb->buffer = (unsigned char *)gf_malloc(sizeof(char)*cb->bufferSize);
+			gf_bs_read_data(bs, (char *) cb->buffer, cb->bufferSize);
+		}
+		if (!cb->commandList) cb->commandList = gf_list_new();
+		while (gf_list_count(cb->commandList)) {
+			GF_Command *com = (GF_Command *)gf_list_last(cb->commandList);
+			gf_list_rem_last(cb->commandList);
+			gf_sg_command_del(com);
+		}
+		count = gf_bs_read_u32(bs);
+		for (i=0; i<count; i++) {
+			GF_Command *com;
+			e = smc_read_command(cr, &com);
+			if (com) gf_list_add(cb->commandList, com);
+			if (e) return e;
+		}
+	}
+		return GF_OK;
+	case GF_SG_VRML_SFNODE:
+		return smc_read_node(cr, parent, (GF_Node **)ptr);
+	case GF_SG_VRML_MFNODE:
+		return smc_read_node_list(cr, parent, (GF_ChildNodeItem **)ptr);
+	case GF_SG_VRML_SFATTRREF:
+		return smc_read_attr_ref(cr, (SFAttrRef *)ptr);
+	case GF_SG_VRML_MFATTRREF:
+		count = gf_bs_read_u32(bs);
+		SMC_CHECK_SIZE((u64) count*8)
+		gf_sg_vrml_mf_reset(ptr, fieldType);
+		e = gf_sg_vrml_mf_alloc(ptr, fieldType, count);
+		if (e) return e;
+		for (i=0; i<count; i++) {
+			e = smc_read_attr_ref(cr, &((MFAttrRef *)ptr)->vals[i]);
+			if (e) return e;
+		}
+		return GF_OK;
+	case GF_SG_VRML_MFSTRING:
+	case GF_SG_VRML_MFURL:
+	case GF_SG_VRML_MFSCRIPT:
+		count = gf_bs_read_u32(bs);
+		SMC_CHECK_SIZE((u64) count*4)
+		gf_sg_vrml_mf_reset(ptr, fieldType);
+		e = gf_sg_vrml_mf_alloc(ptr, fieldType, count);
+		if (e) return e;
+		for (i=0; i<count; i++) {
+			if (fieldType==GF_SG_VRML_MFSTRING) {
+				e = smc_read_string(cr, &((MFString *)ptr)->vals[i]);
+			} else if (fieldType==GF_SG_VRML_MFURL) {
+				((MFURL *)ptr)->vals[i].OD_ID = gf_bs_read_u32(bs);
+				e = smc_read_string(cr, &((MFURL *)ptr)->vals[i].url);
+			} else {
+				e = smc_read_string(cr, &((MFScript *)ptr)->vals[i].script_text);
+			}
+			if (e) return e;
+		}
+		return GF_OK;
+	default:
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+}
+
+static GF_Err smc_get_node_ref(SMCacheReader *cr, GF_Node **node)
+{
+	u32 idx = gf_bs_read_u32(cr->bs);
+	*node = NULL;
+	if (idx >= cr->nb_nodes) return GF_NON_COMPLIANT_BITSTREAM;
+	*node = cr->nodes[idx];
+	return GF_OK;
+}
+
+static GF_Err smc_read_node(SMCacheReader *cr, GF_Node *parent, GF_Node **out)
+{
+	u32 i, count, tag, ID;
+	u8 type;
+	GF_Err e;
+	GF_SceneGraph *sg;
+	GF_Node *node;
+	GF_FieldInfo info;
+	GF_BitStream *bs = cr->bs;
+
+	*out = NULL;
+	type = gf_bs_read_u8(bs);
+	if (type==SM_CACHE_NULL) return GF_OK;
+	if (type==SM_CACHE_USE) {
+		e = smc_get_node_ref(cr, &node);
+		if (e) return e;
+		gf_node_register(node, parent);
+		*out = node;
+		return GF_OK;
+	}
+	if (type!=SM_CACHE_DEF) return GF_NON_COMPLIANT_BITSTREAM;
+
+	sg = (GF_SceneGraph *)gf_list_get(cr->graphs, gf_bs_read_u32(bs));
+	if (!sg) return GF_NON_COMPLIANT_BITSTREAM;
+	tag = gf_bs_read_u32(bs);
+	if (tag==TAG_ProtoNode) {
+		GF_Proto *proto = (GF_Proto *)gf_list_get(cr->protos, gf_bs_read_u32(bs));
+		if (!proto) return GF_NON_COMPLIANT_BITSTREAM;
+		node = gf_sg_proto_create_instance(sg, proto);
+	} else {
+		if ((tag<GF_NODE_RANGE_FIRST_MPEG4) || (tag>GF_NODE_RANGE_LAST_VRML)) return GF_NON_COMPLIANT_BITSTREAM;
+		node = gf_node_new(sg, tag);
+	}
+	if (!node) return GF_NON_COMPLIANT_BITSTREAM;
+
+	if (cr->nb_nodes == cr->nodes_alloc) {
+		cr->nodes_alloc = cr->nodes_alloc ? 2*cr->nodes_alloc : 1024;
+		cr->nodes = (GF_Node **)gf_realloc(cr->nodes, sizeof(GF_Node *)*cr->nodes_alloc);
+	}
+	cr->nodes[cr->nb_nodes] = node;
+	cr->nb_nodes++;
+	gf_node_register(node, parent);
+	*out = node;
+
+	ID = gf_bs_read_u32(bs);
+	if (ID) {
+		char *name;
+		e = smc_read_string(cr, &name);
+		if (e) return e;
+		gf_node_set_id(node, ID, name);
+		if (name) gf_free(name);
+	}
+
+	if (smc_is_script(tag)) {
+		count = gf_bs_read_u32(bs);
+		for (i=0; i<count; i++) {
+			char *name;
+			u32 eventType = gf_bs_read_u8(bs);
+			u32 fieldType = gf_bs_read_u8(bs);
+			e = smc_read_string(cr, &name);
+			if (e) return e;
+			gf_sg_script_field_new(node, eventType, fieldType, name);
+			if (name) gf_free(name);
+		}
+	}
+
+	count = gf_node_get_field_count(node);
+	for (i=0; i<count; i++) {
+		e = gf_node_get_field(node, i, &info);
+		if (e) return e;
+		if ((info.eventType==GF_SG_EVENT_IN) || (info.eventType==GF_SG_EVENT_OUT)) continue;
+
+		if (tag==TAG_ProtoNode) {
+			GF_ProtoField *pf = (GF_ProtoField *)gf_list_get(((GF_ProtoInstance *)node)->fields, i);
+			u8 accessed = gf_bs_read_u8(bs);
+			if (pf) pf->has_been_accessed = accessed;
+		}
+		else if ((tag==TAG_MPEG4_BitWrapper) && (info.far_ptr == &((M_BitWrapper *)node)->buffer)) {
+			M_BitWrapper *bw = (M_BitWrapper *)node;
+			bw->buffer_len = gf_bs_read_u32(bs);
+			if (bw->buffer_len) {
+				SMC_CHECK_SIZE(bw->buffer_len)
+				if (bw->buffer.buffer) gf_free(bw->buffer.buffer);
+				bw->buffer.buffer = (char *)gf_malloc(sizeof(char)*bw->buffer_len);
+				gf_bs_read_data(bs, bw->buffer.buffer, bw->buffer_len);
+				continue;
+			}
+		}
+		e = smc_read_field(cr, info.fieldType, info.far_ptr, node);
+		if (e) return e;
+	}
+
+	/*same as the text loaders: nodes are initialized once their fields are set, except in proto code*/
+	if ((tag!=TAG_ProtoNode) && (sg==cr->ctx->scene_graph)) gf_node_init(node);
+	return GF_OK;
+}
+
+static GF_Err smc_read_routes(SMCacheReader *cr, GF_SceneGraph *sg, GF_Proto *proto)
+{
+	u32 i, count, ID, fromField, toField;
+	GF_Err e;
+	GF_Node *from, *to;
+	GF_Route *r;
+	char *name;
+	GF_BitStream *bs = cr->bs;
+
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		u8 type = gf_bs_read_u8(bs);
+		if (type==SM_CACHE_ROUTE_IS) {
+			if (!proto) return GF_NON_COMPLIANT_BITSTREAM;
+			fromField = gf_bs_read_u32(bs);
+			e = smc_get_node_ref(cr, &to);
+			if (e) return e;
+			toField = gf_bs_read_u32(bs);
+			e = gf_sg_proto_field_set_ised(proto, fromField, to, toField);
+			if (e) return e;
+		} else if (type==SM_CACHE_ROUTE) {
+			ID = gf_bs_read_u32(bs);
+			e = smc_read_string(cr, &name);
+			if (e) return e;
+			e = smc_get_node_ref(cr, &from);
+			fromField = gf_bs_read_u32(bs);
+			if (!e) e = smc_get_node_ref(cr, &to);
+			toField = gf_bs_read_u32(bs);
+			r = e ? NULL : gf_sg_route_new(sg, from, fromField, to, toField);
+			if (r && ID) gf_sg_route_set_id(r, ID);
+			if (r && name) gf_sg_route_set_name(r, name);
+			if (name) gf_free(name);
+			if (!r) return e ? e : GF_NON_COMPLIANT_BITSTREAM;
+		} else {
+			return GF_NON_COMPLIANT_BITSTREAM;
+		}
+	}
+	return GF_OK;
+}
+
+static GF_Err smc_read_proto_list(SMCacheReader *cr, GF_List *protos)
+{
+	GF_Err e;
+	GF_Proto *proto;
+	u32 count = gf_bs_read_u32(cr->bs);
+	while (count) {
+		e = smc_read_proto(cr, &proto);
+		if (e) return e;
+		if (protos && (gf_list_find(protos, proto)<0)) gf_list_add(protos, proto);
+		count--;
+	}
+	return GF_OK;
+}
+
+static GF_Err smc_read_proto(SMCacheReader *cr, GF_Proto **out)
+{
+	u32 i, count, ID;
+	u8 type, unregistered;
+	GF_Err e;
+	char *name;
+	GF_SceneGraph *sg;
+	GF_Proto *proto;
+	GF_BitStream *bs = cr->bs;
+
+	*out = NULL;
+	type = gf_bs_read_u8(bs);
+	if (type==SM_CACHE_USE) {
+		*out = (GF_Proto *)gf_list_get(cr->protos, gf_bs_read_u32(bs));
+		return *out ? GF_OK : GF_NON_COMPLIANT_BITSTREAM;
+	}
+	if (type!=SM_CACHE_DEF) return GF_NON_COMPLIANT_BITSTREAM;
+
+	sg = (GF_SceneGraph *)gf_list_get(cr->graphs, gf_bs_read_u32(bs));
+	if (!sg) return GF_NON_COMPLIANT_BITSTREAM;
+	ID = gf_bs_read_u32(bs);
+	e = smc_read_string(cr, &name);
+	if (e) return e;
+	unregistered = gf_bs_read_u8(bs);
+	proto = gf_sg_proto_new(sg, ID, name, unregistered);
+	if (name) gf_free(name);
+	if (!proto) return GF_NON_COMPLIANT_BITSTREAM;
+
+	gf_list_add(cr->protos, proto);
+	gf_list_add(cr->graphs, proto->sub_graph);
+	*out = proto;
+
+	e = smc_read_field(cr, GF_SG_VRML_MFURL, &proto->ExternProto, NULL);
+	if (e) return e;
+
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		u32 QP_Type, hasMinMax, NumBits, Anim_Type;
+		GF_ProtoFieldInterface *pf;
+		u32 eventType = gf_bs_read_u8(bs);
+		u32 fieldType = gf_bs_read_u8(bs);
+		e = smc_read_string(cr, &name);
+		if (e) return e;
+		pf = gf_sg_proto_field_new(proto, fieldType, eventType, name);
+		if (name) gf_free(name);
+		if (!pf) return GF_NON_COMPLIANT_BITSTREAM;
+
+		if ((eventType==GF_SG_EVENT_FIELD) || (eventType==GF_SG_EVENT_EXPOSED_FIELD)) {
+			if (fieldType==GF_SG_VRML_SFNODE) e = smc_read_node(cr, NULL, &pf->def_sfnode_value);
+			else if (fieldType==GF_SG_VRML_MFNODE) e = smc_read_node_list(cr, NULL, &pf->def_mfnode_value);
+			else e = smc_read_field(cr, fieldType, pf->def_value, NULL);
+			if (e) return e;
+		}
+		QP_Type = gf_bs_read_u32(bs);
+		hasMinMax = gf_bs_read_u32(bs);
+		NumBits = gf_bs_read_u32(bs);
+		Anim_Type = gf_bs_read_u32(bs);
+		if (QP_Type) {
+			char qp_min[4], qp_max[4];
+			Bool has_min, has_max;
+			has_min = has_max = 0;
+			if (hasMinMax) {
+				has_min = gf_bs_read_u8(bs);
+				if (has_min) gf_bs_read_data(bs, qp_min, 4);
+				has_max = gf_bs_read_u8(bs);
+				if (has_max) gf_bs_read_data(bs, qp_max, 4);
+			}
+			gf_bifs_proto_field_set_aq_info(pf, QP_Type, hasMinMax,
+				(gf_sg_vrml_get_sf_type(fieldType)==GF_SG_VRML_SFINT32) ? GF_SG_VRML_SFINT32 : GF_SG_VRML_SFFLOAT,
+				has_min ? qp_min : NULL, has_max ? qp_max : NULL, NumBits);
+		}
+		pf->QP_Type = QP_Type;
+		pf->hasMinMax = hasMinMax;
+		pf->NumBits = NumBits;
+		pf->Anim_Type = Anim_Type;
+	}
+
+	e = smc_read_proto_list(cr, NULL);
+	if (e) return e;
+
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		GF_Node *n;
+		e = smc_read_node(cr, NULL, &n);
+		if (n) gf_sg_proto_add_node_code(proto, n);
+		if (e) return e;
+	}
+	return smc_read_routes(cr, proto->sub_graph, proto);
+}
+
+static GF_Err smc_read_command(SMCacheReader *cr, GF_Command **out)
+{
+	u32 i, count, tag, idx;
+	GF_Err e;
+	GF_SceneGraph *sg;
+	GF_Command *com;
+	GF_BitStream *bs = cr->bs;
+
+	*out = NULL;
+	idx = gf_bs_read_u32(bs);
+	sg = NULL;
+	if (idx != (u32) -1) {
+		sg = (GF_SceneGraph *)gf_list_get(cr->graphs, idx);
+		if (!sg) return GF_NON_COMPLIANT_BITSTREAM;
+	}
+	tag = gf_bs_read_u32(bs);
+	if (!tag || (tag >= GF_SG_LAST_BIFS_COMMAND)) return GF_NON_COMPLIANT_BITSTREAM;
+	com = gf_sg_command_new(sg, tag);
+	*out = com;
+
+	e = smc_read_proto_list(cr, com->new_proto_list);
+	if (e) return e;
+	e = smc_read_node(cr, NULL, &com->node);
+	if (e) return e;
+
+	com->RouteID = gf_bs_read_u32(bs);
+	com->del_proto_list_size = gf_bs_read_u32(bs);
+	if (gf_bs_read_u8(bs)) {
+		SMC_CHECK_SIZE((u64) 4*com->del_proto_list_size)
+		com->del_proto_list = (u32 *)gf_malloc(sizeof(u32) * (com->del_proto_list_size+1));
+		for (i=0; i<com->del_proto_list_size; i++) com->del_proto_list[i] = gf_bs_read_u32(bs);
+	}
+	e = smc_read_string(cr, &com->def_name);
+	if (e) return e;
+	com->fromNodeID = gf_bs_read_u32(bs);
+	com->fromFieldIndex = gf_bs_read_u32(bs);
+	com->toNodeID = gf_bs_read_u32(bs);
+	com->toFieldIndex = gf_bs_read_u32(bs);
+	com->aggregated = gf_bs_read_u8(bs);
+	com->never_apply = gf_bs_read_u8(bs);
+	com->unresolved = gf_bs_read_u8(bs);
+	e = smc_read_string(cr, &com->unres_name);
+	if (e) return e;
+
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		GF_CommandField *inf = gf_sg_command_field_new(com);
+		inf->fieldIndex = gf_bs_read_u32(bs);
+		inf->fieldType = gf_bs_read_u32(bs);
+		inf->pos = (s32) gf_bs_read_u32(bs);
+		e = smc_read_node(cr, NULL, &inf->new_node);
+		if (e) return e;
+		e = smc_read_node_list(cr, NULL, &inf->node_list);
+		if (e) return e;
+		switch (gf_bs_read_u8(bs)) {
+		case 0:
+			break;
+		case 1:
+			inf->field_ptr = &inf->new_node;
+			break;
+		case 2:
+			inf->field_ptr = &inf->node_list;
+			break;
+		case 3:
+			if ((inf->fieldType==GF_SG_VRML_SFNODE) || (inf->fieldType==GF_SG_VRML_MFNODE)) return GF_NON_COMPLIANT_BITSTREAM;
+			inf->field_ptr = gf_sg_vrml_field_pointer_new(inf->fieldType);
+			if (!inf->field_ptr) return GF_NON_COMPLIANT_BITSTREAM;
+			e = smc_read_field(cr, inf->fieldType, inf->field_ptr, NULL);
+			if (e) return e;
+			break;
+		default:
+			return GF_NON_COMPLIANT_BITSTREAM;
+		}
+	}
+	return GF_OK;
+}
+
+static GF_Err smc_read_internal_desc(SMCacheReader *cr, GF_Descriptor **out)
+{
+	GF_Err e;
+	u32 i, count;
+	GF_BitStream *bs = cr->bs;
+	u8 tag = gf_bs_read_u8(bs);
+
+	*out = NULL;
+	switch (tag) {
+	case 0:
+		return GF_OK;
+	case GF_ODF_MUXINFO_TAG:
+	{
+		GF_MuxInfo *mux = (GF_MuxInfo *)gf_odf_desc_new(GF_ODF_MUXINFO_TAG);
+		*out = (GF_Descriptor *) mux;
+		e = smc_read_string(cr, &mux->file_name);
+		if (e) return e;
+		mux->GroupID = gf_bs_read_u32(bs);
+		e = smc_read_string(cr, &mux->streamFormat);
+		if (e) return e;
+		mux->startTime = (s32) gf_bs_read_u32(bs);
+		mux->duration = gf_bs_read_u32(bs);
+		e = smc_read_string(cr, &mux->textNode);
+		if (e) return e;
+		e = smc_read_string(cr, &mux->fontNode);
+		if (e) return e;
+		mux->frame_rate = gf_bs_read_double(bs);
+		mux->import_flags = gf_bs_read_u32(bs);
+		mux->delete_file = gf_bs_read_u8(bs);
+		mux->carousel_period_plus_one = gf_bs_read_u32(bs);
+		mux->aggregate_on_esid = gf_bs_read_u16(bs);
+	}
+		return GF_OK;
+	case GF_ODF_BIFS_CFG_TAG:
+	{
+		GF_BIFSConfig *cfg = (GF_BIFSConfig *)gf_odf_desc_new(GF_ODF_BIFS_CFG_TAG);
+		*out = (GF_Descriptor *) cfg;
+		cfg->version = gf_bs_read_u32(bs);
+		cfg->nodeIDbits = gf_bs_read_u16(bs);
+		cfg->routeIDbits = gf_bs_read_u16(bs);
+		cfg->protoIDbits = gf_bs_read_u16(bs);
+		cfg->pixelMetrics = gf_bs_read_u8(bs);
+		cfg->pixelWidth = gf_bs_read_u16(bs);
+		cfg->pixelHeight = gf_bs_read_u16(bs);
+		cfg->randomAccess = gf_bs_read_u8(bs);
+		cfg->useNames = gf_bs_read_u8(bs);
+		count = gf_bs_read_u32(bs);
+		if (count) cfg->elementaryMasks = gf_list_new();
+		for (i=0; i<count; i++) {
+			GF_ElementaryMask *em = (GF_ElementaryMask *)gf_odf_desc_new(GF_ODF_ELEM_MASK_TAG);
+			gf_list_add(cfg->elementaryMasks, em);
+			em->node_id = gf_bs_read_u32(bs);
+			e = smc_read_string(cr, &em->node_name);
+			if (e) return e;
+		}
+	}
+		return GF_OK;
+	case GF_ODF_UI_CFG_TAG:
+	{
+		GF_UIConfig *cfg = (GF_UIConfig *)gf_odf_desc_new(GF_ODF_UI_CFG_TAG);
+		*out = (GF_Descriptor *) cfg;
+		e = smc_read_string(cr, &cfg->deviceName);
+		if (e) return e;
+		cfg->termChar = gf_bs_read_u8(bs);
+		cfg->delChar = gf_bs_read_u8(bs);
+		cfg->ui_data_length = gf_bs_read_u32(bs);
+		if (cfg->ui_data_length) {
+			SMC_CHECK_SIZE(cfg->ui_data_length)
+			cfg->ui_data = (char *)gf_malloc(sizeof(char)*cfg->ui_data_length);
+			gf_bs_read_data(bs, cfg->ui_data, cfg->ui_data_length);
+		}
+	}
+		return GF_OK;
+	default:
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+}
+
+static GF_Err smc_read_od(SMCacheReader *cr, GF_ODCom **com, GF_Descriptor **desc)
+{
+	u32 i, j, count, nb_ext, size;
+	GF_Err e;
+	GF_ESD *esd;
+	GF_List *esds;
+	GF_BitStream *bs = cr->bs;
+
+	esds = gf_list_new();
+	if (com) {
+		e = gf_odf_parse_command(bs, com, &size);
+		if (!e) smc_get_od_com_esds(*com, esds);
+	} else {
+		e = gf_odf_parse_descriptor(bs, desc, &size);
+		if (!e) smc_get_od_esds(*desc, esds);
+	}
+	gf_bs_align(bs);
+
+	count = gf_list_count(esds);
+	for (i=0; i<count && !e; i++) {
+		GF_Descriptor *dsi;
+		esd = (GF_ESD *)gf_list_get(esds, i);
+		if (gf_bs_read_u8(bs)) {
+			GF_SLConfig *sl;
+			if (!esd->slConfig) esd->slConfig = (GF_SLConfig *) gf_odf_desc_new(GF_ODF_SLC_TAG);
+			sl = esd->slConfig;
+			sl->predefined = gf_bs_read_u8(bs);
+			sl->useAccessUnitStartFlag = gf_bs_read_u8(bs);
+			sl->useAccessUnitEndFlag = gf_bs_read_u8(bs);
+			sl->useRandomAccessPointFlag = gf_bs_read_u8(bs);
+			sl->hasRandomAccessUnitsOnlyFlag = gf_bs_read_u8(bs);
+			sl->usePaddingFlag = gf_bs_read_u8(bs);
+			sl->useTimestampsFlag = gf_bs_read_u8(bs);
+			sl->useIdleFlag = gf_bs_read_u8(bs);
+			sl->durationFlag = gf_bs_read_u8(bs);
+			sl->timestampResolution = gf_bs_read_u32(bs);
+			sl->OCRResolution = gf_bs_read_u32(bs);
+			sl->timestampLength = gf_bs_read_u8(bs);
+			sl->OCRLength = gf_bs_read_u8(bs);
+			sl->AULength = gf_bs_read_u8(bs);
+			sl->instantBitrateLength = gf_bs_read_u8(bs);
+			sl->degradationPriorityLength = gf_bs_read_u8(bs);
+			sl->AUSeqNumLength = gf_bs_read_u8(bs);
+			sl->packetSeqNumLength = gf_bs_read_u8(bs);
+			sl->timeScale = gf_bs_read_u32(bs);
+			sl->AUDuration = gf_bs_read_u16(bs);
+			sl->CUDuration = gf_bs_read_u16(bs);
+			sl->startDTS = gf_bs_read_u64(bs);
+			sl->startCTS = gf_bs_read_u64(bs);
+			sl->no_dts_signaling = gf_bs_read_u8(bs);
+		}
+		e = smc_read_internal_desc(cr, &dsi);
+		if (dsi) {
+			if (esd->decoderConfig && !esd->decoderConfig->decoderSpecificInfo) {
+				esd->decoderConfig->decoderSpecificInfo = (GF_DefaultDescriptor *) dsi;
+			} else {
+				gf_odf_desc_del(dsi);
+				if (!e) e = GF_NON_COMPLIANT_BITSTREAM;
+			}
+		}
+		if (e) break;
+
+		nb_ext = gf_bs_read_u32(bs);
+		for (j=0; j<nb_ext; j++) {
+			GF_Descriptor *ext;
+			u32 pos = gf_bs_read_u32(bs);
+			e = smc_read_internal_desc(cr, &ext);
+			if (ext) {
+				if (pos > gf_list_count(esd->extensionDescriptors)) pos = gf_list_count(esd->extensionDescriptors);
+				gf_list_insert(esd->extensionDescriptors, ext, pos);
+			}
+			if (e) break;
+		}
+	}
+	gf_list_del(esds);
+	return e;
+}
+
+static GF_Err smc_read_context(SMCacheReader *cr)
+{
+	u32 i, j, k, count, nb_aus, nb_com;
+	u32 endian_check;
+	GF_Err e;
+	char *str;
+	GF_StreamContext *sc;
+	GF_AUContext *au;
+	GF_BitStream *bs = cr->bs;
+	GF_SceneManager *ctx = cr->ctx;
+	GF_SceneGraph *sg = ctx->scene_graph;
+
+	if (gf_bs_read_u32(bs) != SM_CACHE_MAGIC) return GF_NON_COMPLIANT_BITSTREAM;
+	if (gf_bs_read_u32(bs) != SM_CACHE_VERSION) return GF_NOT_SUPPORTED;
+	e = smc_read_string(cr, &str);
+	if (e) return e;
+	e = (str && !strcmp(str, GPAC_VERSION)) ? GF_OK : GF_NOT_SUPPORTED;
+	if (str) gf_free(str);
+	if (e) return e;
+	if (gf_bs_read_u32(bs) != TAG_LastImplementedMPEG4) return GF_NOT_SUPPORTED;
+#ifndef GPAC_DISABLE_X3D
+	if (gf_bs_read_u32(bs) != TAG_LastImplementedX3D) return GF_NOT_SUPPORTED;
+#else
+	if (gf_bs_read_u32(bs)) return GF_NOT_SUPPORTED;
+#endif
+	if (gf_bs_read_u8(bs) != sizeof(Fixed)) return GF_NOT_SUPPORTED;
+	gf_bs_read_data(bs, (char *) &endian_check, 4);
+	if (endian_check != 0x01020304) return GF_NOT_SUPPORTED;
+
+	ctx->scene_width = gf_bs_read_u32(bs);
+	ctx->scene_height = gf_bs_read_u32(bs);
+	ctx->is_pixel_metrics = gf_bs_read_u8(bs);
+	ctx->max_node_id = gf_bs_read_u32(bs);
+	ctx->max_route_id = gf_bs_read_u32(bs);
+	ctx->max_proto_id = gf_bs_read_u32(bs);
+	sg->width = gf_bs_read_u32(bs);
+	sg->height = gf_bs_read_u32(bs);
+	sg->usePixelMetrics = gf_bs_read_u8(bs);
+	sg->max_defined_route_id = gf_bs_read_u32(bs);
+
+	e = smc_read_proto_list(cr, NULL);
+	if (e) return e;
+	e = smc_read_node(cr, NULL, &sg->RootNode);
+	if (e) return e;
+
+	if (gf_bs_read_u8(bs)) {
+		e = smc_read_od(cr, NULL, (GF_Descriptor **) &ctx->root_od);
+		if (e) return e;
+	}
+
+	count = gf_bs_read_u32(bs);
+	for (i=0; i<count; i++) {
+		GF_SAFEALLOC(sc, GF_StreamContext);
+		sc->AUs = gf_list_new();
+		gf_list_add(ctx->streams, sc);
+
+		sc->ESID = gf_bs_read_u16(bs);
+		e = smc_read_string(cr, &sc->name);
+		if (e) return e;
+		sc->streamType = gf_bs_read_u8(bs);
+		sc->objectType = gf_bs_read_u8(bs);
+		sc->timeScale = gf_bs_read_u32(bs);
+		sc->in_root_od = gf_bs_read_u8(bs);
+		sc->dec_cfg_len = gf_bs_read_u32(bs);
+		if (sc->dec_cfg_len) {
+			SMC_CHECK_SIZE(sc->dec_cfg_len)
+			sc->dec_cfg = (char *)gf_malloc(sizeof(char)*sc->dec_cfg_len);
+			gf_bs_read_data(bs, sc->dec_cfg, sc->dec_cfg_len);
+		}
+		sc->imp_exp_time = gf_bs_read_u64(bs);
+		sc->aggregate_on_esid = gf_bs_read_u16(bs);
+		sc->carousel_period = gf_bs_read_u32(bs);
+		sc->disable_aggregation = gf_bs_read_u8(bs);
+
+		nb_aus = gf_bs_read_u32(bs);
+		for (j=0; j<nb_aus; j++) {
+			GF_SAFEALLOC(au, GF_AUContext);
+			au->commands = gf_list_new();
+			au->owner = sc;
+			gf_list_add(sc->AUs, au);
+
+			au->timing = gf_bs_read_u64(bs);
+			au->timing_sec = gf_bs_read_double(bs);
+			au->flags = gf_bs_read_u32(bs);
+			nb_com = gf_bs_read_u32(bs);
+			if (nb_com && (sc->streamType!=GF_STREAM_OD) && (sc->streamType!=GF_STREAM_SCENE)) return GF_NON_COMPLIANT_BITSTREAM;
+			for (k=0; k<nb_com; k++) {
+				if (sc->streamType==GF_STREAM_OD) {
+					GF_ODCom *odcom = NULL;
+					e = smc_read_od(cr, &odcom, NULL);
+					if (odcom) gf_list_add(au->commands, odcom);
+				} else {
+					GF_Command *com;
+					e = smc_read_command(cr, &com);
+					if (com) gf_list_add(au->commands, com);
+				}
+				if (e) return e;
+			}
+			if (!gf_bs_available(bs)) return GF_NON_COMPLIANT_BITSTREAM;
+		}
+	}
+	e = smc_read_routes(cr, sg, NULL);
+	if (e) return e;
+	return gf_bs_available(bs) ? GF_NON_COMPLIANT_BITSTREAM : GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_sm_load_context_cache(GF_SceneManager *ctx, const char *cache_file)
+{
+	GF_Err e;
+	SMCacheReader cr;
+	FILE *f;
+	u64 size;
+	char *data;
+
+	if (!ctx || !ctx->scene_graph || !cache_file) return GF_BAD_PARAM;
+	/*the context must be empty*/
+	if (gf_list_count(ctx->streams) || ctx->root_od || ctx->scene_graph->RootNode) return GF_BAD_PARAM;
+
+	f = gf_f64_open(cache_file, "rb");
+	if (!f) return GF_URL_ERROR;
+	gf_f64_seek(f, 0, SEEK_END);
+	size = gf_f64_tell(f);
+	gf_f64_seek(f, 0, SEEK_SET);
+	if (!size || (size > 0xFFFFFFFFUL)) {
+		fclose(f);
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+	data = (char *)gf_malloc(sizeof(char) * (size_t) size);
+	if (!data) {
+		fclose(f);
+		return GF_OUT_OF_MEM;
+	}
+	if (fread(data, 1, (size_t) size, f) != size) {
+		fclose(f);
+		gf_free(data);
+		return GF_IO_ERR;
+	}
+	fclose(f);
+
+	memset(&cr, 0, sizeof(SMCacheReader));
+	cr.ctx = ctx;
+	cr.bs = gf_bs_new(data, size, GF_BITSTREAM_READ);
+	cr.protos = gf_list_new();
+	cr.graphs = gf_list_new();
+	gf_list_add(cr.graphs, ctx->scene_graph);
+
+	e = smc_read_context(&cr);
+
+	gf_bs_del(cr.bs);
+	gf_free(data);
+	if (cr.nodes) gf_free(cr.nodes);
+	gf_list_del(cr.protos);
+	gf_list_del(cr.graphs);
+
+	if (e) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_SCENE, ("[SceneCache] Cannot load context cache %s: %s\n", cache_file, gf_error_to_string(e)));
+		/*discard whatever was loaded*/
+		while (gf_list_count(ctx->streams)) {
+			gf_sm_stream_del(ctx, (GF_StreamContext *)gf_list_get(ctx->streams, 0));
+		}
+		if (ctx->root_od) gf_odf_desc_del((GF_Descriptor *) ctx->root_od);
+		ctx->root_od = NULL;
+		gf_sg_reset(ctx->scene_graph);
+		ctx->scene_width = ctx->scene_height = 0;
+		ctx->is_pixel_metrics = 0;
+		ctx->max_node_id = ctx->max_route_id = ctx->max_proto_id = 0;
+	}
+	return e;
+}
+
+/*the cache name is the SHA-1 of the source content, its name and the loader settings, so that any change
+in the source or in the way it is loaded selects another cache file*/
+char *gf_sm_get_context_cache_name(GF_SceneLoader *load)
+{
+	u32 i, val;
+	u8 hash[20];
+	char szName[GF_MAX_PATH], *cache_dir;
+	GF_SHA1Context *sha;
+
+	if (!load->fileName) return NULL;
+	if (gf_sha1_file(load->fileName, hash)) return NULL;
+
+	sha = gf_sha1_starts();
+	gf_sha1_update(sha, hash, 20);
+	gf_sha1_update(sha, (u8 *) load->fileName, (u32) strlen(load->fileName));
+	val = load->type;
+	gf_sha1_update(sha, (u8 *) &val, 4);
+	val = load->flags;
+	gf_sha1_update(sha, (u8 *) &val, 4);
+	val = load->force_es_id;
+	gf_sha1_update(sha, (u8 *) &val, 4);
+	val = SM_CACHE_VERSION;
+	gf_sha1_update(sha, (u8 *) &val, 4);
+	gf_sha1_finish(sha, hash);
+
+	cache_dir = gf_get_default_cache_directory();
+	if (!cache_dir) return NULL;
+	if (strlen(cache_dir) + 60 > GF_MAX_PATH) {
+		gf_free(cache_dir);
+		return NULL;
+	}
+	sprintf(szName, "%s%cgpac_scene_", cache_dir, GF_PATH_SEPARATOR);
+	gf_free(cache_dir);
+	for (i=0; i<20; i++) {
+		char szHex[3];
+		sprintf(szHex, "%02x", hash[i]);
+		strcat(szName, szHex);
+	}
+	strcat(szName, ".gsc");
+	return gf_strdup(szName);
+}
+
+#else
+
+GF_EXPORT
+GF_Err gf_sm_save_context_cache(GF_SceneManager *ctx, const char *cache_file)
+{
+	return GF_NOT_SUPPORTED;
+}
+
+GF_EXPORT
+GF_Err gf_sm_load_context_cache(GF_SceneManager *ctx, const char *cache_file)
+{
+	return GF_NOT_SUPPORTED;
+}
+
+char *gf_sm_get_context_cache_name(GF_SceneLoader *load)
+{
+	return NULL;
+}
+
+#endif /*GPAC_DISABLE_VRML*/
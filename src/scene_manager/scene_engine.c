@@ -45,6 +45,9 @@
 
 #include <time.h>
 
+/*memory used to cache encoded BIFS nodes between updates*/
+#define SENG_BIFS_NODE_CACHE_SIZE	0x800000
+
 
 struct __tag_scene_engine
 {
@@ -67,8 +70,90 @@ struct __tag_scene_engine
 	Bool embed_resources;    
     Bool dump_rap;
     Bool first_dims_sent;
+
+	/*per-stream state of the last aggregation and encoded RAP (SengRAPCache)*/
+	GF_List *rap_cache;
+
+	/*output buffer reused for all encoded AUs - data passed to the callbacks points to it*/
+	char *au_buffer;
+	u32 au_buffer_alloc;
+	/*buffer reused for DIMS dumps*/
+	char *dims_buffer;
+	u32 dims_buffer_alloc;
 };
 
+typedef struct
+{
+	u16 ESID;
+	/*state of the stream right after the last aggregation, used to detect new commands*/
+	Bool aggregated;
+	GF_AUContext *au;
+	u32 nb_aus, nb_commands;
+	/*carousel AU and command count the RAP was encoded from - GF_SM_AU_MODIFIED is left set by the
+	aggregation (and consumed by gf_seng_encode_context only) so it cannot be used to validate the RAP*/
+	GF_AUContext *rap_au;
+	u32 rap_nb_commands;
+	/*encoded RAP AU for this aggregation, NULL if not encoded yet*/
+	char *data;
+	u32 size, alloc;
+	u64 timing;
+} SengRAPCache;
+
+static SengRAPCache *seng_get_rap_cache(GF_SceneEngine *seng, u16 ESID, Bool create)
+{
+	SengRAPCache *rap;
+	u32 i=0;
+	if (!seng->rap_cache) {
+		if (!create) return NULL;
+		seng->rap_cache = gf_list_new();
+	}
+	while ((rap = (SengRAPCache *)gf_list_enum(seng->rap_cache, &i))) {
+		if (rap->ESID==ESID) return rap;
+	}
+	if (!create) return NULL;
+	GF_SAFEALLOC(rap, SengRAPCache);
+	rap->ESID = ESID;
+	gf_list_add(seng->rap_cache, rap);
+	return rap;
+}
+
+static void seng_reset_rap_cache(SengRAPCache *rap)
+{
+	if (rap->data) gf_free(rap->data);
+	rap->data = NULL;
+	rap->size = rap->alloc = 0;
+	rap->aggregated = 0;
+	rap->rap_au = NULL;
+}
+
+/*the AU just encoded in the engine buffer becomes the RAP of the stream: buffers are swapped rather than copied*/
+static void seng_keep_rap(GF_SceneEngine *seng, SengRAPCache *rap, GF_AUContext *au, u32 size)
+{
+	char *data = rap->data;
+	u32 alloc = rap->alloc;
+	rap->data = seng->au_buffer;
+	rap->alloc = seng->au_buffer_alloc;
+	rap->size = size;
+	rap->timing = au->timing;
+	rap->rap_au = au;
+	rap->rap_nb_commands = gf_list_count(au->commands);
+	seng->au_buffer = data;
+	seng->au_buffer_alloc = alloc;
+}
+
+static void seng_del_rap_cache(GF_SceneEngine *seng)
+{
+	if (!seng->rap_cache) return;
+	while (gf_list_count(seng->rap_cache)) {
+		SengRAPCache *rap = (SengRAPCache *)gf_list_last(seng->rap_cache);
+		gf_list_rem_last(seng->rap_cache);
+		seng_reset_rap_cache(rap);
+		gf_free(rap);
+	}
+	gf_list_del(seng->rap_cache);
+	seng->rap_cache = NULL;
+}
+
 #ifndef GPAC_DISABLE_BIFS_ENC
 static GF_Err gf_sm_setup_bifsenc(GF_SceneEngine *seng, GF_StreamContext *sc, GF_ESD *esd)
 {
@@ -80,8 +165,11 @@ static GF_Err gf_sm_setup_bifsenc(GF_SceneEngine *seng, GF_StreamContext *sc, GF
 
 	if (!esd->decoderConfig || (esd->decoderConfig->streamType != GF_STREAM_SCENE)) return GF_BAD_PARAM;
 
-	if (!seng->bifsenc)
+	if (!seng->bifsenc) {
 		seng->bifsenc = gf_bifs_encoder_new(seng->ctx->scene_graph);
+		/*the same scene is encoded again at each RAP, only re-encode modified nodes*/
+		gf_bifs_encoder_set_node_cache(seng->bifsenc, SENG_BIFS_NODE_CACHE_SIZE);
+	}
 
 	delete_bcfg = 0;
 	/*inputctx is not properly setup, do it*/
@@ -280,13 +368,15 @@ GF_Err gf_seng_enable_aggregation(GF_SceneEngine *seng, u16 ESID, u16 onESID)
 	if (!sc) return GF_STREAM_NOT_FOUND;
 
 	sc->aggregate_on_esid = onESID;
+	/*aggregation targets changed, previous RAPs are no longer valid*/
+	seng_del_rap_cache(seng);
 	return GF_OK;
 }
 
 /* Set to 1 if you want every dump with a timed file name */
 //#define DUMP_DIMS_LOG_WITH_TIME
 
-static GF_Err gf_seng_encode_dims_au(GF_SceneEngine *seng, u16 ESID, GF_List *commands, char **data, u32 *size)
+static GF_Err gf_seng_encode_dims_au(GF_SceneEngine *seng, u16 ESID, GF_List *commands, u32 *size)
 {
 #ifndef GPAC_DISABLE_SCENE_DUMP
 	GF_SceneDumper *dumper = NULL;
@@ -296,17 +386,16 @@ static GF_Err gf_seng_encode_dims_au(GF_SceneEngine *seng, u16 ESID, GF_List *co
 	char file_name[4096];
 	FILE *file = NULL;
 	u64 fsize;
-	char *buffer = NULL;
-	GF_BitStream *bs = NULL;
 	u8 dims_header;
 	Bool compress_dims;
 #ifdef DUMP_DIMS_LOG_WITH_TIME
 	u32 do_dump_with_time = 1;
 #endif
-	u32 buffer_len;
+	u32 buffer_len, hdr_size;
 	char *cache_dir, *dump_name;
 
-	if (!data) return GF_BAD_PARAM;
+	if (!size) return GF_BAD_PARAM;
+	*size = 0;
 
 	e = GF_OK;
 
@@ -397,9 +486,12 @@ start:
 	}
 
 	/* First, read the dump in a buffer */
-	buffer = gf_malloc((size_t)fsize * sizeof(char));
+	if (seng->dims_buffer_alloc < fsize) {
+		seng->dims_buffer_alloc = (u32) fsize;
+		seng->dims_buffer = gf_realloc(seng->dims_buffer, sizeof(char) * seng->dims_buffer_alloc);
+	}
 	gf_f64_seek(file, 0, SEEK_SET);
-	fsize = fread(buffer, sizeof(char), (size_t)fsize, file);
+	fsize = fread(seng->dims_buffer, sizeof(char), (size_t)fsize, file);
 	fclose(file);
     file = NULL;
 
@@ -418,10 +510,14 @@ start:
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[SceneEngine] Sending DIMS data - sizes: raw (%d)", buffer_len)); 
 	if (compress_dims) {
 #ifndef GPAC_DISABLE_ZLIB
+		u32 alloc = seng->dims_buffer_alloc;
 		dims_header |= GF_DIMS_UNIT_C;
-		e = gf_gz_compress_payload(&buffer, buffer_len, &buffer_len);
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("/ compressed (%d)", buffer_len)); 
+		/*compressed data is written back in the dump buffer, reallocated if larger*/
+		e = gf_gz_compress_payload(&seng->dims_buffer, buffer_len, &alloc);
 		if (e) goto exit;
+		buffer_len = alloc;
+		if (seng->dims_buffer_alloc < buffer_len) seng->dims_buffer_alloc = buffer_len;
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("/ compressed (%d)", buffer_len)); 
 #else
 		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("Error: your version of GPAC was compile with no libz support. Abort."));
 		e = GF_NOT_SUPPORTED;
@@ -430,33 +526,35 @@ start:
 	}
     GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("\n")); 
 
-	/* Then,  prepare the DIMS data using a bitstream instead of direct manipulation for endianness
-           The new bitstream size should be:
+	/* Then, prepare the DIMS data in the engine output buffer. Its size is:
 		the size of the (compressed) data 
 		+ 1 bytes for the header
 		+ 2 bytes for the size
 		+ 4 bytes if the size is greater than 65535
 	 */
-	bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE); 
+	hdr_size = (buffer_len > 65535) ? 7 : 3;
+	if (seng->au_buffer_alloc < buffer_len + hdr_size) {
+		seng->au_buffer_alloc = buffer_len + hdr_size;
+		seng->au_buffer = gf_realloc(seng->au_buffer, sizeof(char) * seng->au_buffer_alloc);
+	}
 	if (buffer_len > 65535) {
 		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[SceneEngine] Warning: DIMS Unit size too big !!!\n")); 
-		gf_bs_write_u16(bs, 0); /* internal GPAC hack to indicate that the size is larger than 65535 */
-		gf_bs_write_u32(bs, buffer_len+1);
+		/* internal GPAC hack to indicate that the size is larger than 65535 */
+		seng->au_buffer[0] = seng->au_buffer[1] = 0;
+		seng->au_buffer[2] = ((buffer_len+1) >> 24) & 0xFF;
+		seng->au_buffer[3] = ((buffer_len+1) >> 16) & 0xFF;
+		seng->au_buffer[4] = ((buffer_len+1) >> 8) & 0xFF;
+		seng->au_buffer[5] = (buffer_len+1) & 0xFF;
 	} else {
-		gf_bs_write_u16(bs, buffer_len+1);
+		seng->au_buffer[0] = ((buffer_len+1) >> 8) & 0xFF;
+		seng->au_buffer[1] = (buffer_len+1) & 0xFF;
 	}
-	gf_bs_write_u8(bs, dims_header);
-	gf_bs_write_data(bs, buffer, buffer_len);
-
-	gf_free(buffer);
-	buffer = NULL;
-
-	gf_bs_get_content(bs, data, size);
-	gf_bs_del(bs);
+	seng->au_buffer[hdr_size-1] = dims_header;
+	memcpy(seng->au_buffer + hdr_size, seng->dims_buffer, buffer_len);
+	*size = buffer_len + hdr_size;
 
 exit:
 	if (!seng->dump_path) gf_free(cache_dir);
-	if (buffer) gf_free(buffer);
 	if (file) fclose(file);
 	return e;
 }
@@ -523,12 +621,44 @@ static Bool gf_sm_check_for_modif(GF_SceneEngine *seng, GF_AUContext *au)
 	return modified;
 }
 
+/*encodes the commands in the engine output buffer: @data is not allocated and is only valid until the next encoding*/
+static GF_Err gf_sm_live_encode_au(GF_SceneEngine *seng, GF_StreamContext *sc, u16 ESID, GF_List *commands, char **data, u32 *size)
+{
+	GF_Err e = GF_OK;
+	*data = NULL;
+	*size = 0;
+	switch (sc->objectType) {
+#ifndef GPAC_DISABLE_BIFS_ENC
+	case GPAC_OTI_SCENE_BIFS:
+	case GPAC_OTI_SCENE_BIFS_V2:
+		e = gf_bifs_encode_au_buffer(seng->bifsenc, ESID, commands, &seng->au_buffer, &seng->au_buffer_alloc, size);
+		break;
+#endif
+
+#ifndef GPAC_DISABLE_LASER
+	case GPAC_OTI_SCENE_LASER:
+		e = gf_laser_encode_au_buffer(seng->lsrenc, ESID, commands, 0, &seng->au_buffer, &seng->au_buffer_alloc, size);
+		break;
+#endif
+	case GPAC_OTI_SCENE_DIMS:
+		e = gf_seng_encode_dims_au(seng, ESID, commands, size);
+		break;
+
+	default:
+		GF_LOG(GF_LOG_ERROR, GF_LOG_SCENE, ("Cannot encode AU for Scene OTI %x\n", sc->objectType));
+		break;
+	}
+	if (*size) *data = seng->au_buffer;
+	return e;
+}
+
 static GF_Err gf_sm_live_encode_scene_au(GF_SceneEngine *seng, gf_seng_callback callback, Bool from_start)
 {
 	GF_Err e;
 	u32	i, j, size, count, nb_streams;
 	char *data;
 	GF_AUContext *au;
+	SengRAPCache *rap;
 
 	if (!callback) return GF_BAD_PARAM;
 
@@ -548,42 +678,128 @@ static GF_Err gf_sm_live_encode_scene_au(GF_SceneEngine *seng, gf_seng_callback
 			/*in case using XMT*/
 			if (au->timing_sec) au->timing = (u64) (au->timing_sec * sc->timeScale);
 
-			if (from_start && !j && !gf_sm_check_for_modif(seng, au)) continue;
-
-			switch (sc->objectType) {
-#ifndef GPAC_DISABLE_BIFS_ENC
-			case GPAC_OTI_SCENE_BIFS:
-			case GPAC_OTI_SCENE_BIFS_V2:
-				e = gf_bifs_encode_au(seng->bifsenc, sc->ESID, au->commands, &data, &size);
-				break;
-#endif
-
-#ifndef GPAC_DISABLE_LASER
-			case GPAC_OTI_SCENE_LASER:
-				e = gf_laser_encode_au(seng->lsrenc, sc->ESID, au->commands, 0, &data, &size);
-				break;
-#endif
-			case GPAC_OTI_SCENE_DIMS:
-                e = gf_seng_encode_dims_au(seng, sc->ESID, au->commands, &data, &size);
-				break;
+			rap = NULL;
+			if (from_start && !j) {
+				if (!gf_sm_check_for_modif(seng, au)) continue;
+				rap = seng_get_rap_cache(seng, sc->ESID, 1);
+			}
 
-			default:
-				GF_LOG(GF_LOG_ERROR, GF_LOG_SCENE, ("Cannot encode AU for Scene OTI %x\n", sc->objectType));
-				break;
+			e = gf_sm_live_encode_au(seng, sc, sc->ESID, au->commands, &data, &size);
+
+			/*keep the RAP so that carousels don't need to re-encode it*/
+			if (rap) {
+				if (!e) {
+					seng_keep_rap(seng, rap, au, size);
+					data = size ? rap->data : NULL;
+				} else {
+					if (rap->data) gf_free(rap->data);
+					rap->data = NULL;
+					rap->size = rap->alloc = 0;
+					rap->rap_au = NULL;
+				}
 			}
 			callback(seng->calling_object, sc->ESID, data, size, au->timing);
-			gf_free(data);
-			data = NULL;
 			if (e) break;
 		}
 	}
 	return e;
 }
 
+static Bool seng_stream_has_new_commands(GF_SceneEngine *seng, GF_StreamContext *sc)
+{
+	GF_AUContext *au;
+	SengRAPCache *rap = seng_get_rap_cache(seng, sc->ESID, 0);
+	if (!rap || !rap->aggregated) return 1;
+	if (gf_list_count(sc->AUs) != rap->nb_aus) return 1;
+	au = (GF_AUContext *)gf_list_get(sc->AUs, 0);
+	if (au != rap->au) return 1;
+	if (au && (gf_list_count(au->commands) != rap->nb_commands)) return 1;
+	return 0;
+}
+
 GF_EXPORT
 GF_Err gf_seng_aggregate_context(GF_SceneEngine *seng, u16 ESID)
 {
-	return gf_sm_aggregate(seng->ctx, ESID);
+	GF_Err e;
+	GF_StreamContext *sc;
+	SengRAPCache *rap;
+	Bool has_new_commands = 0;
+	u32 i=0;
+
+	while ((sc = (GF_StreamContext*)gf_list_enum(seng->ctx->streams, &i))) {
+		if (ESID && (sc->ESID!=ESID)) continue;
+		if (seng_stream_has_new_commands(seng, sc)) {
+			has_new_commands = 1;
+			break;
+		}
+	}
+	/*nothing changed since last aggregation, keep the current RAP*/
+	if (!has_new_commands) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_SCENE, ("[SceneEngine] No new commands since last aggregation - reusing RAP\n"));
+		return GF_OK;
+	}
+
+	e = gf_sm_aggregate(seng->ctx, ESID);
+
+	/*aggregation may modify the carousel of other streams, so invalidate all RAPs but
+	only remember the aggregated state for the streams we aggregated*/
+	i=0;
+	while ((sc = (GF_StreamContext*)gf_list_enum(seng->ctx->streams, &i))) {
+		GF_AUContext *au;
+		rap = seng_get_rap_cache(seng, sc->ESID, 1);
+		seng_reset_rap_cache(rap);
+		if (e || (ESID && (sc->ESID!=ESID))) continue;
+
+		au = (GF_AUContext *)gf_list_get(sc->AUs, 0);
+		rap->aggregated = 1;
+		rap->nb_aus = gf_list_count(sc->AUs);
+		rap->au = au;
+		rap->nb_commands = au ? gf_list_count(au->commands) : 0;
+	}
+	return e;
+}
+
+GF_EXPORT
+GF_Err gf_seng_send_rap(GF_SceneEngine *seng, u16 ESID, gf_seng_callback callback)
+{
+	GF_Err e;
+	GF_StreamContext *sc;
+	u32 i=0;
+
+	if (!seng || !callback) return GF_BAD_PARAM;
+
+	while ((sc = (GF_StreamContext*)gf_list_enum(seng->ctx->streams, &i))) {
+		GF_AUContext *au;
+		SengRAPCache *rap;
+		Bool cached;
+		u32 now;
+		if (sc->streamType != GF_STREAM_SCENE) continue;
+		if (ESID && (sc->ESID!=ESID)) continue;
+		au = (GF_AUContext *)gf_list_get(sc->AUs, 0);
+		if (!au) continue;
+
+		now = gf_sys_clock();
+		rap = seng_get_rap_cache(seng, sc->ESID, 1);
+		/*carousel AU replaced or commands concatenated in it since the RAP was encoded*/
+		if (rap->data && ((rap->rap_au != au) || (rap->rap_nb_commands != gf_list_count(au->commands)))) {
+			gf_free(rap->data);
+			rap->data = NULL;
+			rap->size = rap->alloc = 0;
+		}
+		cached = rap->data ? 1 : 0;
+		if (!cached) {
+			char *data;
+			u32 size;
+			/*in case using XMT*/
+			if (au->timing_sec) au->timing = (u64) (au->timing_sec * sc->timeScale);
+			e = gf_sm_live_encode_au(seng, sc, sc->ESID, au->commands, &data, &size);
+			if (e) return e;
+			seng_keep_rap(seng, rap, au, size);
+		}
+		callback(seng->calling_object, sc->ESID, rap->size ? rap->data : NULL, rap->size, rap->timing);
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_SCENE, ("[SceneEngine] RAP for ES %d (%d bytes) %s in %d ms\n", sc->ESID, rap->size, cached ? "sent from cache" : "encoded", gf_sys_clock() - now));
+	}
+	return GF_OK;
 }
 
 GF_EXPORT
@@ -728,31 +944,8 @@ GF_Err gf_seng_encode_from_commands(GF_SceneEngine *seng, u16 ESID, Bool disable
         gf_list_add(new_au->commands, com);
     }
 
-    data = NULL;
-	size = 0;
-
-    switch(sc->objectType) {
-#ifndef GPAC_DISABLE_BIFS_ENC
-		case GPAC_OTI_SCENE_BIFS:
-		case GPAC_OTI_SCENE_BIFS_V2:
-			e = gf_bifs_encode_au(seng->bifsenc, ESID, new_au->commands, &data, &size);
-			break;
-#endif
-
-#ifndef GPAC_DISABLE_LASER
-		case GPAC_OTI_SCENE_LASER:
-			e = gf_laser_encode_au(seng->lsrenc, ESID, new_au->commands, 0, &data, &size);
-			break;
-#endif
-		case GPAC_OTI_SCENE_DIMS:
-            e = gf_seng_encode_dims_au(seng, ESID, new_au->commands, &data, &size);
-			break;
-		default:
-			GF_LOG(GF_LOG_ERROR, GF_LOG_SCENE, ("Cannot encode commands for Scene OTI %x\n", sc->objectType));
-			break;
-    }
+	e = gf_sm_live_encode_au(seng, sc, ESID, new_au->commands, &data, &size);
     callback(seng->calling_object, ESID, data, size, 0);
-	gf_free(data);
 	return e;
 }
 
@@ -808,11 +1001,16 @@ exit:
 GF_EXPORT
 GF_Err gf_seng_encode_context(GF_SceneEngine *seng, gf_seng_callback callback)
 {
+	GF_Err e;
+	u32 now;
 	if (!seng) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_SCENE, ("[SceneEngine] Cannot encode context. No seng provided\n"));
 		return GF_BAD_PARAM;
 	}
-	return gf_sm_live_encode_scene_au(seng, callback, 1);
+	now = gf_sys_clock();
+	e = gf_sm_live_encode_scene_au(seng, callback, 1);
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_SCENE, ("[SceneEngine] Context encoded in %d ms\n", gf_sys_clock() - now));
+	return e;
 } 
 
 GF_EXPORT
@@ -826,6 +1024,10 @@ void gf_seng_terminate(GF_SceneEngine *seng)
 	if (seng->lsrenc) gf_laser_encoder_del(seng->lsrenc);
 #endif
 
+	seng_del_rap_cache(seng);
+	if (seng->au_buffer) gf_free(seng->au_buffer);
+	if (seng->dims_buffer) gf_free(seng->dims_buffer);
+
 	gf_sm_load_done(&seng->loader);
 
 	if (seng->owns_context) {
@@ -932,6 +1134,8 @@ GF_SceneEngine *gf_seng_init(void *calling_object, char * inputContext, u32 load
 	/*since we're encoding in BIFS we must get MPEG-4 nodes only*/
 	seng->loader.flags = GF_SM_LOAD_MPEG4_STRICT;
 	if (embed_resources) seng->loader.flags |= GF_SM_LOAD_EMBEDS_RES;
+	/*live sessions are often restarted on the same scene, reuse the parsed context when possible*/
+	else seng->loader.flags |= GF_SM_LOAD_CONTEXT_CACHE;
 
 	seng->loader.fileName = inputContext;
 	e = gf_sm_load_init(&(seng->loader));
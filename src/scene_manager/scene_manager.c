@@ -593,6 +593,8 @@ GF_Err gf_sm_load_init_swf(GF_SceneLoader *load);
 GF_Err gf_sm_load_init_qt(GF_SceneLoader *load);
 #endif
 
+char *gf_sm_get_context_cache_name(GF_SceneLoader *load);
+
 
 
 GF_EXPORT
@@ -607,6 +609,36 @@ GF_Err gf_sm_load_string(GF_SceneLoader *load, const char *str, Bool do_clean)
 }
 
 
+/*checks for a context cache of the file to load - returns 1 if the context was loaded from the cache*/
+static Bool gf_sm_load_from_cache(GF_SceneLoader *load)
+{
+	GF_Err e;
+	if (!(load->flags & GF_SM_LOAD_CONTEXT_CACHE) || !load->ctx || !load->fileName) return 0;
+	if (load->flags & (GF_SM_LOAD_CONTEXT_READY | GF_SM_LOAD_FOR_PLAYBACK | GF_SM_LOAD_EMBEDS_RES)) return 0;
+	if (gf_list_count(load->ctx->streams) || load->ctx->root_od) return 0;
+
+	switch (load->type) {
+	case GF_SM_LOAD_BT: 
+	case GF_SM_LOAD_VRML:
+	case GF_SM_LOAD_X3DV:
+	case GF_SM_LOAD_XMTA:
+	case GF_SM_LOAD_X3D:
+		break;
+	default:
+		return 0;
+	}
+	load->cache_name = gf_sm_get_context_cache_name(load);
+	if (!load->cache_name) return 0;
+
+	e = gf_sm_load_context_cache(load->ctx, load->cache_name);
+	if (e) return 0;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_PARSER, ("[Scene Manager] %s loaded from context cache %s\n", load->fileName, load->cache_name));
+	gf_free(load->cache_name);
+	load->cache_name = NULL;
+	return 1;
+}
+
 /*initializes the context loader*/
 GF_EXPORT
 GF_Err gf_sm_load_init(GF_SceneLoader *load)
@@ -667,6 +699,12 @@ GF_Err gf_sm_load_init(GF_SceneLoader *load)
 
 	if (!load->scene_graph) load->scene_graph = load->ctx->scene_graph;
 
+	if (gf_sm_load_from_cache(load)) {
+		/*the file is entirely loaded, only setup the loader for later string parsing as done after a regular run*/
+		load->fileName = NULL;
+		load->from_cache = 1;
+	}
+
 	switch (load->type) {
 #ifndef GPAC_DISABLE_LOADER_BT
 	case GF_SM_LOAD_BT: 
@@ -718,13 +756,31 @@ GF_EXPORT
 void gf_sm_load_done(GF_SceneLoader *load)
 {
 	if (load->done) load->done(load);
+	if (load->cache_name) gf_free(load->cache_name);
+	load->cache_name = NULL;
 }
 
 GF_EXPORT
 GF_Err gf_sm_load_run(GF_SceneLoader *load)
 {
-	if (load->process) return load->process(load);
-	return GF_OK;
+	GF_Err e = GF_OK;
+	if (load->from_cache) {
+		load->from_cache = 0;
+		return GF_OK;
+	}
+	if (load->process) e = load->process(load);
+
+	if (load->cache_name) {
+		if (!e) {
+			GF_Err c_e = gf_sm_save_context_cache(load->ctx, load->cache_name);
+			if (c_e) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_PARSER, ("[Scene Manager] Context not cached: %s\n", gf_error_to_string(c_e)));
+			}
+		}
+		gf_free(load->cache_name);
+		load->cache_name = NULL;
+	}
+	return e;
 }
 
 GF_EXPORT
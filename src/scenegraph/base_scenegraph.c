@@ -300,6 +300,7 @@ void gf_sg_reset(GF_SceneGraph *sg)
 	if (!sg) return;
 
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_SCENE, ("[SceneGraph] Reseting scene graph\n"));
+	sg->in_reset = 1;
 #if 0
 	/*inlined graph, remove any of this graph nodes from the parent graph*/
 	if (!sg->pOwningProto && sg->parent_scene) {
@@ -497,6 +498,7 @@ restart:
 #ifdef GF_SELF_REPLACE_ENABLE
 	sg->graph_has_been_reset = 1;
 #endif
+	sg->in_reset = 0;
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_SCENE, ("[SceneGraph] Scene graph has been reset\n"));
 }
 
@@ -716,12 +718,31 @@ GF_Err gf_node_unregister(GF_Node *pNode, GF_Node *parentNode)
 	return GF_OK;
 }
 
+/*returns the root graph holding the modification counter, or NULL if modifications are not tracked*/
+static GF_SceneGraph *node_modif_graph(GF_Node *node)
+{
+	GF_SceneGraph *sg = node->sgprivate->scenegraph;
+	if (!sg) return NULL;
+	while (1) {
+		/*the graph or one of its parents is being destroyed*/
+		if (sg->in_reset) return NULL;
+		if (!sg->parent_scene) break;
+		sg = sg->parent_scene;
+	}
+	return sg->track_node_modifs ? sg : NULL;
+}
+
 GF_EXPORT
 GF_Err gf_node_register(GF_Node *node, GF_Node *parentNode)
 {
 	if (!node) return GF_OK;
 
 	node->sgprivate->num_instances ++;
+	/*a new node never gets the count of a destroyed one*/
+	if (!node->sgprivate->modif_count) {
+		GF_SceneGraph *sg = node_modif_graph(node);
+		if (sg) node->sgprivate->modif_count = ++sg->node_modif_count;
+	}
 	/*parent may be NULL (top node and proto)*/
 	if (parentNode) {
 		if (!node->sgprivate->parents) {
@@ -974,6 +995,33 @@ static GFINLINE void insert_node_def(GF_SceneGraph *sg, GF_Node *def, u32 ID, co
 
 
 
+static void set_modif_count(GF_Node *node, u32 count)
+{
+	GF_ParentList *nlist;
+	/*already visited through another parent*/
+	if (node->sgprivate->modif_count == count) return;
+	node->sgprivate->modif_count = count;
+
+	nlist = node->sgprivate->parents;
+	while (nlist) {
+		set_modif_count(nlist->node, count);
+		nlist = nlist->next;
+	}
+#ifndef GPAC_DISABLE_VRML
+	/*propagate to the proto instance owning the graph*/
+	if (!node->sgprivate->parents && node->sgprivate->scenegraph && node->sgprivate->scenegraph->pOwningProto) {
+		GF_Node *the_node = (GF_Node *) node->sgprivate->scenegraph->pOwningProto;
+		if (the_node != node) set_modif_count(the_node, count);
+	}
+#endif
+}
+
+static void node_modified(GF_Node *node)
+{
+	GF_SceneGraph *sg = node_modif_graph(node);
+	if (sg) set_modif_count(node, ++sg->node_modif_count);
+}
+
 GF_EXPORT
 GF_Err gf_node_set_id(GF_Node *p, u32 ID, const char *name)
 {
@@ -998,6 +1046,7 @@ GF_Err gf_node_set_id(GF_Node *p, u32 ID, const char *name)
 		insert_node_def(pSG, p, ID, _name);
 		gf_free(_name);
 	}
+	node_modified(p);
 	return GF_OK;
 }
 
@@ -1017,6 +1066,7 @@ GF_Err gf_node_remove_id(GF_Node *p)
 	if (p->sgprivate->flags & GF_NODE_IS_DEF) {
 		remove_node_id(pSG, p);
 		p->sgprivate->flags &= ~GF_NODE_IS_DEF;
+		node_modified(p);
 		return GF_OK;
 	} 
 	return GF_BAD_PARAM;
@@ -1201,6 +1251,12 @@ void gf_node_setup(GF_Node *p, u32 tag)
 	p->sgprivate->flags = GF_SG_NODE_DIRTY;
 }
 
+GF_EXPORT
+u32 gf_node_get_modification_count(GF_Node *node)
+{
+	return node ? node->sgprivate->modif_count : 0;
+}
+
 GF_Node *gf_sg_new_base_node()
 {
 	GF_Node *newnode = (GF_Node *)gf_malloc(sizeof(GF_Node));
@@ -1722,6 +1778,8 @@ void gf_node_changed_internal(GF_Node *node, GF_FieldInfo *field, Bool notify_sc
 	sg = node->sgprivate->scenegraph;
 	assert(sg);
 
+	node_modified(node);
+
 #ifndef GPAC_DISABLE_VRML
 	/*signal changes in node to JS for MFFields*/
 	if (field && notify_scripts && (node->sgprivate->flags & GF_NODE_HAS_BINDING) && !gf_sg_vrml_is_sf_field(field->fieldType) ) {
@@ -440,7 +440,7 @@ static void Channel_DispatchAU(GF_Channel *ch, u32 duration)
 	au->next = NULL;
 	ch->buffer = NULL;
 
-	if (ch->len + ch->media_padding_bytes != ch->allocSize) {
+	if (ch->len + ch->media_padding_bytes > ch->allocSize) {
 		au->data = (char*)gf_realloc(au->data, sizeof(char) * (au->dataLength + ch->media_padding_bytes));
 	}
 	if (ch->media_padding_bytes) memset(au->data + au->dataLength, 0, sizeof(char)*ch->media_padding_bytes);
@@ -1219,6 +1219,21 @@ void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *paylo
 		else return;
 	}
 
+	/*complete AU given by the service, use its buffer as is*/
+	if (NewAU && EndAU && ch->au_to_adopt && (payload == ch->au_to_adopt) && !ch->ipmp_tool) {
+		assert(!ch->buffer);
+		ch->buffer = ch->au_to_adopt;
+		ch->allocSize = ch->au_to_adopt_size;
+		ch->len = payload_size;
+		ch->au_to_adopt = NULL;
+		if (hdr.paddingFlag && ch->esd->slConfig->usePaddingFlag) ch->padingBits = hdr.paddingBits;
+
+		gf_es_lock(ch, 1);
+		Channel_DispatchAU(ch, hdr.au_duration);
+		gf_es_lock(ch, 0);
+		return;
+	}
+
 	/*Write the Packet payload to the buffer*/
 	if (NewAU) {
 		/*we should NEVER have a bitstream at this stage*/
@@ -1293,6 +1308,18 @@ void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *paylo
 }
 
 
+void gf_es_receive_sl_au(GF_ClientService *serv, GF_Channel *ch, char *au, u32 au_size, u32 alloc_size, GF_SLHeader *header, GF_Err reception_status)
+{
+	ch->au_to_adopt = au;
+	ch->au_to_adopt_size = alloc_size;
+	gf_es_receive_sl_packet(serv, ch, au, au_size, header, reception_status);
+	/*AU data was not used as is*/
+	if (ch->au_to_adopt) {
+		gf_free(ch->au_to_adopt);
+		ch->au_to_adopt = NULL;
+	}
+}
+
 /*notification of End of stream on this channel*/
 void gf_es_on_eos(GF_Channel *ch)
 {
@@ -259,6 +259,19 @@ static void term_on_slp_received(void *user_priv, GF_ClientService *service, LPN
 	gf_es_receive_sl_packet(service, ch, data, data_size, hdr, reception_status);
 }
 
+static void term_on_sl_au_received(void *user_priv, GF_ClientService *service, LPNETCHANNEL netch, char *au, u32 au_size, u32 alloc_size, GF_SLHeader *hdr, GF_Err reception_status)
+{
+	GF_Channel *ch;
+	GF_Terminal *term = (GF_Terminal *) user_priv;
+
+	ch = gf_term_get_channel(service, netch);
+	if (!term || !ch) {
+		gf_free(au);
+		return;
+	}
+	gf_es_receive_sl_au(service, ch, au, au_size, alloc_size, hdr, reception_status);
+}
+
 static Bool is_same_od(GF_ObjectDescriptor *od1, GF_ObjectDescriptor *od2)
 {
 	GF_ESD *esd1, *esd2;
@@ -989,6 +1002,13 @@ void gf_term_on_sl_packet(GF_ClientService *service, LPNETCHANNEL ns, char *data
 	term_on_slp_received(service->term, service, ns, data, data_size, hdr, reception_status);
 }
 
+GF_EXPORT
+void gf_term_on_sl_au(GF_ClientService *service, LPNETCHANNEL ns, char *au, u32 au_size, u32 alloc_size, GF_SLHeader *hdr, GF_Err reception_status)
+{
+	assert(service);
+	term_on_sl_au_received(service->term, service, ns, au, au_size, alloc_size, hdr, reception_status);
+}
+
 GF_EXPORT
 void gf_term_add_media(GF_ClientService *service, GF_Descriptor *media_desc, Bool no_scene_check)
 {
@@ -823,6 +823,32 @@ GF_Err gf_term_step_clocks(GF_Terminal * term, u32 ms_diff)
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_term_step_frame(GF_Terminal *term, u32 ms_diff)
+{
+	GF_Err e;
+	u32 frame_number, start;
+	if (!term || !(term->flags & GF_TERM_NO_COMPOSITOR_THREAD)) return GF_BAD_PARAM;
+	frame_number = term->compositor->frame_number;
+	e = gf_term_step_clocks(term, ms_diff);
+	if (e) return e;
+	/*decode and compose until the step is done - paused decoders may request a new step when 
+	outputing a frame, stop as soon as one frame has been drawn. Give up if no frame is drawn
+	within the network data timeout*/
+	start = gf_sys_clock();
+	while (term->compositor->step_mode) {
+		e = gf_term_process_flush(term);
+		if (e) return e;
+		if (term->compositor->frame_number != frame_number) break;
+		if (gf_sys_clock() - start > term->net_data_timeout) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_MEDIA, ("[Terminal] No frame drawn after %d ms, aborting frame step\n", term->net_data_timeout));
+			term->compositor->step_mode = 0;
+			return GF_IP_NETWORK_EMPTY;
+		}
+	}
+	return GF_OK;
+}
+
 GF_EXPORT
 void gf_term_connect_from_time(GF_Terminal * term, const char *URL, u64 startTime, Bool pause_at_first_frame)
 {
@@ -27,6 +27,12 @@
 
 /*the default size for new streams allocation...*/
 #define BS_MEM_BLOCK_ALLOC_SIZE		250
+/*first allocation of memory files, doubled as needed*/
+#define BS_MEM_FILE_ALLOC_SIZE		0x10000
+
+/*read granularity and polling period (ms) for streamed sources*/
+#define BS_STREAM_READ_SIZE		0x10000
+#define BS_STREAM_POLL_TIME		10
 
 /*private types*/
 enum
@@ -34,7 +40,9 @@ enum
 	GF_BITSTREAM_FILE_READ = GF_BITSTREAM_WRITE + 1,
 	GF_BITSTREAM_FILE_WRITE,
 	/*private mode if we own the buffer*/
-	GF_BITSTREAM_WRITE_DYN
+	GF_BITSTREAM_WRITE_DYN,
+	/*growable buffer with file semantics: size is the amount of data written*/
+	GF_BITSTREAM_MEM_FILE
 };
 
 struct __tag_bitstream
@@ -61,6 +69,20 @@ struct __tag_bitstream
 
 	char *buffer_io;
 	u32 buffer_io_size, buffer_written;
+
+	/*read window for file streams: the file is positioned at the end of the window*/
+	char *cache_read;
+	u32 cache_read_alloc, cache_read_size, cache_read_pos;
+
+	/*streamed sources (pipes, files being written): forward-only reads through the read window, size is the amount of data read so far*/
+	Bool is_stream, stream_eos, stream_seekable;
+	u32 stream_idle_timeout;
+
+	/*opaque value attached by the bitstream user*/
+	u64 cookie;
+
+	/*allocated size of memory files*/
+	u64 mem_alloc;
 };
 
 
@@ -142,12 +164,68 @@ GF_BitStream *gf_bs_from_file(FILE *f, u32 mode)
 	return tmp;
 }
 
+GF_EXPORT
+GF_BitStream *gf_bs_from_stream(FILE *f, u32 window_size, u32 idle_timeout)
+{
+	GF_BitStream *tmp;
+	if (!f || (window_size < 4*BS_STREAM_READ_SIZE)) return NULL;
+
+	tmp = (GF_BitStream *)gf_malloc(sizeof(GF_BitStream));
+	if (!tmp) return NULL;
+	memset(tmp, 0, sizeof(GF_BitStream));
+	tmp->bsmode = GF_BITSTREAM_FILE_READ;
+	tmp->nbBits = 8;
+	tmp->stream = f;
+	tmp->cache_read = (char *) gf_malloc(sizeof(char) * window_size);
+	if (!tmp->cache_read) {
+		gf_free(tmp);
+		return NULL;
+	}
+	tmp->cache_read_alloc = window_size;
+	tmp->is_stream = 1;
+	tmp->stream_idle_timeout = idle_timeout;
+	/*pipes cannot be positioned, and reaching their end means the writer is done*/
+	tmp->stream_seekable = (gf_f64_tell(f) != (u64) -1) ? 1 : 0;
+	return tmp;
+}
+
+GF_EXPORT
+GF_BitStream *gf_bs_new_mem_file()
+{
+	GF_BitStream *tmp = (GF_BitStream *)gf_malloc(sizeof(GF_BitStream));
+	if (!tmp) return NULL;
+	memset(tmp, 0, sizeof(GF_BitStream));
+	tmp->bsmode = GF_BITSTREAM_MEM_FILE;
+	return tmp;
+}
+
+/*memory files: makes sure size bytes can be stored, growing the buffer geometrically*/
+static Bool bs_mem_file_alloc(GF_BitStream *bs, u64 size)
+{
+	u64 new_alloc;
+	if (size <= bs->mem_alloc) return 1;
+	if (size > 0xFFFFFFFF) return 0;
+
+	new_alloc = bs->mem_alloc ? bs->mem_alloc : BS_MEM_FILE_ALLOC_SIZE;
+	while (new_alloc < size) new_alloc *= 2;
+	if (new_alloc > 0xFFFFFFFF) new_alloc = 0xFFFFFFFF;
+
+	bs->original = (char*)gf_realloc(bs->original, (u32) new_alloc);
+	if (!bs->original) {
+		bs->mem_alloc = bs->size = bs->position = 0;
+		return 0;
+	}
+	bs->mem_alloc = new_alloc;
+	return 1;
+}
+
 static void bs_flush_cache(GF_BitStream *bs)
 {
 	if (bs->buffer_written) {
 		u32 nb_write = fwrite(bs->buffer_io, 1, bs->buffer_written, bs->stream);
-		bs->size += nb_write;
 		bs->position += nb_write;
+		/*the cache may have overwritten data after a seek*/
+		if (bs->position > bs->size) bs->size = bs->position;
 		bs->buffer_written = 0;
 	}
 }
@@ -175,14 +253,105 @@ u32 gf_bs_get_output_buffering(GF_BitStream *bs)
 	return bs ? bs->buffer_io_size : 0;
 }
 
+GF_EXPORT
+void gf_bs_flush(GF_BitStream *bs)
+{
+	if (!bs || !bs->stream || (bs->bsmode != GF_BITSTREAM_FILE_WRITE)) return;
+
+	if (bs->buffer_io)
+		bs_flush_cache(bs);
+	fflush(bs->stream);
+}
+
+/*drops the read window and moves the file back to the bitstream position*/
+static void bs_reset_read_cache(GF_BitStream *bs)
+{
+	if (bs->cache_read_size && !bs->is_stream) 
+		gf_f64_seek(bs->stream, bs->position, SEEK_SET);
+	bs->cache_read_size = bs->cache_read_pos = 0;
+}
+
+/*streamed sources: reads until nb_bytes are available after the current position or the source is over. Once the window is full,
+it slides forward keeping half of it behind the current position for backward seeks. Returns the number of bytes available*/
+static u32 bs_stream_refill(GF_BitStream *bs, u32 nb_bytes)
+{
+	u32 read, to_read, idle = 0;
+	u32 keep = bs->cache_read_alloc / 2;
+
+	while (!bs->stream_eos && (bs->cache_read_size - bs->cache_read_pos < nb_bytes)) {
+		if ((bs->cache_read_size + BS_STREAM_READ_SIZE > bs->cache_read_alloc) && (bs->cache_read_pos > keep)) {
+			u32 drop = bs->cache_read_pos - keep;
+			memmove(bs->cache_read, bs->cache_read + drop, bs->cache_read_size - drop);
+			bs->cache_read_size -= drop;
+			bs->cache_read_pos -= drop;
+		}
+		to_read = bs->cache_read_alloc - bs->cache_read_size;
+		if (!to_read) break;
+		if (to_read > BS_STREAM_READ_SIZE) to_read = BS_STREAM_READ_SIZE;
+
+		read = (u32) fread(bs->cache_read + bs->cache_read_size, 1, to_read, bs->stream);
+		bs->cache_read_size += read;
+		if (read) {
+			idle = 0;
+			continue;
+		}
+		/*no more data: files being written are polled until idle for too long*/
+		if (!bs->stream_seekable || (idle >= bs->stream_idle_timeout)) {
+			bs->stream_eos = 1;
+			break;
+		}
+		clearerr(bs->stream);
+		gf_sleep(BS_STREAM_POLL_TIME);
+		idle += BS_STREAM_POLL_TIME;
+	}
+	bs->size = bs->position - bs->cache_read_pos + bs->cache_read_size;
+	return bs->cache_read_size - bs->cache_read_pos;
+}
+
+static u32 bs_fill_read_cache(GF_BitStream *bs)
+{
+	if (bs->is_stream) return bs_stream_refill(bs, BS_STREAM_READ_SIZE);
+	bs->cache_read_size = (u32) fread(bs->cache_read, 1, bs->cache_read_alloc, bs->stream);
+	bs->cache_read_pos = 0;
+	return bs->cache_read_size;
+}
+
+GF_EXPORT
+GF_Err gf_bs_set_input_buffering(GF_BitStream *bs, u32 size)
+{
+	if (!bs->stream) return GF_OK;
+	if (bs->bsmode != GF_BITSTREAM_FILE_READ) return GF_OK;
+	/*the window of streamed sources is set at creation*/
+	if (bs->is_stream) return GF_OK;
+
+	bs_reset_read_cache(bs);
+	if (!size) {
+		if (bs->cache_read) gf_free(bs->cache_read);
+		bs->cache_read = NULL;
+		bs->cache_read_alloc = 0;
+		return GF_OK;
+	}
+	bs->cache_read = gf_realloc(bs->cache_read, size);
+	if (!bs->cache_read) {
+		bs->cache_read_alloc = 0;
+		return GF_OUT_OF_MEM;
+	}
+	bs->cache_read_alloc = size;
+	return GF_OK;
+}
+
 GF_EXPORT
 void gf_bs_del(GF_BitStream *bs)
 {
 	if (!bs) return;
 	/*if we are in dynamic mode (alloc done by the bitstream), free the buffer if still present*/
-	if ((bs->bsmode == GF_BITSTREAM_WRITE_DYN) && bs->original) gf_free(bs->original);
+	if (((bs->bsmode == GF_BITSTREAM_WRITE_DYN) || (bs->bsmode == GF_BITSTREAM_MEM_FILE)) && bs->original) gf_free(bs->original);
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
+	if (bs->cache_read) {
+		bs_reset_read_cache(bs);
+		gf_free(bs->cache_read);
+	}
 	gf_free(bs);
 }
 
@@ -210,9 +379,25 @@ static u8 BS_ReadByte(GF_BitStream *bs)
 		}
 		return (u32) bs->original[bs->position++];
 	}
+	if (bs->bsmode == GF_BITSTREAM_MEM_FILE) {
+		if (bs->position >= bs->size) {
+			if (bs->EndOfStream) bs->EndOfStream(bs->par);
+			return 0;
+		}
+		return (u8) bs->original[bs->position++];
+	}
 	if (bs->buffer_io) 
 		bs_flush_cache(bs);
 
+	if (bs->cache_read) {
+		if ((bs->cache_read_pos < bs->cache_read_size) || bs_fill_read_cache(bs)) {
+			bs->position++;
+			return (u8) bs->cache_read[bs->cache_read_pos++];
+		}
+		if (bs->EndOfStream) bs->EndOfStream(bs->par);
+		return 0;
+	}
+
 	/*we are in FILE mode, test for end of file*/
 	if (!feof(bs->stream)) {
 		bs->position++;
@@ -222,12 +407,11 @@ static u8 BS_ReadByte(GF_BitStream *bs)
 	return 0;
 }
 
-#define NO_OPTS
+/*in read mode, current holds the last fetched byte and nbBits the number of its bits already consumed*/
+static const u32 bits_mask[] = {0x0, 0x1, 0x3, 0x7, 0xF, 0x1F, 0x3F, 0x7F, 0xFF};
 
-#ifndef NO_OPTS
-static u32 bit_mask[] = {0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1};
-static u32 bits_mask[] = {0x0, 0x1, 0x3, 0x7, 0xF, 0x1F, 0x3F, 0x7F};
-#endif
+/*true if nb_bytes whole bytes can be fetched straight from the memory buffer*/
+#define BS_MEM_AVAILABLE(_bs, _nb_bytes)	( ((_bs)->bsmode == GF_BITSTREAM_READ) && ((_bs)->position + (_nb_bytes) <= (_bs)->size) )
 
 GF_EXPORT
 u8 gf_bs_read_bit(GF_BitStream *bs)
@@ -236,38 +420,46 @@ u8 gf_bs_read_bit(GF_BitStream *bs)
 		bs->current = BS_ReadByte(bs);
 	 	bs->nbBits = 0;
 	}
-#ifdef NO_OPTS
-	{
-		s32 ret;
-		bs->current <<= 1;
-		bs->nbBits++;
-		ret = (bs->current & 0x100) >> 8;
-		return (u8) ret;
-	}
-#else
-	return (u8) (bs->current & bit_mask[bs->nbBits++]) ? 1 : 0;
-#endif
-
+	bs->nbBits++;
+	return (u8) ((bs->current >> (8 - bs->nbBits)) & 1);
 }
 
 GF_EXPORT
 u32 gf_bs_read_int(GF_BitStream *bs, u32 nBits)
 {
-	u32 ret;
+	u64 cache;
+	u32 nb_bytes, left;
 
-#ifndef NO_OPTS
+	/*all bits in the current byte*/
 	if (nBits + bs->nbBits <= 8) {
 		bs->nbBits += nBits;
-        ret = (bs->current >> (8 - bs->nbBits) ) & bits_mask[nBits];
-		return ret;
+		return (bs->current >> (8 - bs->nbBits) ) & bits_mask[nBits];
 	}
-#endif
-	ret = 0;
-	while (nBits-- > 0) {
-		ret <<= 1;
-		ret |= gf_bs_read_bit(bs);
+	/*remaining bits of the current byte*/
+	left = 8 - bs->nbBits;
+	cache = bs->current & bits_mask[left];
+	nBits -= left;
+	nb_bytes = (nBits + 7) >> 3;
+
+	/*memory mode: load all needed bytes at once in the cache*/
+	if (BS_MEM_AVAILABLE(bs, nb_bytes)) {
+		const u8 *ptr = (const u8 *) bs->original + bs->position;
+		u32 i;
+		for (i=0; i<nb_bytes; i++) cache = (cache<<8) | ptr[i];
+		bs->position += nb_bytes;
+		bs->current = ptr[nb_bytes-1];
+	} else {
+		/*byte per byte, handling end of stream*/
+		u32 i;
+		for (i=0; i<nb_bytes; i++) {
+			bs->current = BS_ReadByte(bs);
+			cache = (cache<<8) | bs->current;
+		}
 	}
-	return ret;
+	/*bits of the last byte not consumed*/
+	left = (nb_bytes<<3) - nBits;
+	bs->nbBits = 8 - left;
+	return (u32) (cache >> left);
 }
 
 GF_EXPORT
@@ -282,6 +474,11 @@ u32 gf_bs_read_u16(GF_BitStream *bs)
 {
 	u32 ret;
 	assert(bs->nbBits==8);
+	if (BS_MEM_AVAILABLE(bs, 2)) {
+		const u8 *ptr = (const u8 *) bs->original + bs->position;
+		bs->position += 2;
+		return ((u32) ptr[0] << 8) | ptr[1];
+	}
 	ret = BS_ReadByte(bs); ret<<=8;
 	ret |= BS_ReadByte(bs);
 	return ret;
@@ -293,6 +490,11 @@ u32 gf_bs_read_u24(GF_BitStream *bs)
 {
 	u32 ret;
 	assert(bs->nbBits==8);
+	if (BS_MEM_AVAILABLE(bs, 3)) {
+		const u8 *ptr = (const u8 *) bs->original + bs->position;
+		bs->position += 3;
+		return ((u32) ptr[0] << 16) | ((u32) ptr[1] << 8) | ptr[2];
+	}
 	ret = BS_ReadByte(bs); ret<<=8;
 	ret |= BS_ReadByte(bs); ret<<=8;
 	ret |= BS_ReadByte(bs);
@@ -304,6 +506,11 @@ u32 gf_bs_read_u32(GF_BitStream *bs)
 {
 	u32 ret;
 	assert(bs->nbBits==8);
+	if (BS_MEM_AVAILABLE(bs, 4)) {
+		const u8 *ptr = (const u8 *) bs->original + bs->position;
+		bs->position += 4;
+		return ((u32) ptr[0] << 24) | ((u32) ptr[1] << 16) | ((u32) ptr[2] << 8) | ptr[3];
+	}
 	ret = BS_ReadByte(bs); ret<<=8;
 	ret |= BS_ReadByte(bs); ret<<=8;
 	ret |= BS_ReadByte(bs); ret<<=8;
@@ -328,10 +535,12 @@ u64 gf_bs_read_long_int(GF_BitStream *bs, u32 nBits)
 		gf_bs_read_long_int(bs, nBits-64);
 		ret = gf_bs_read_long_int(bs, 64);
 	} else {
-		while (nBits-- > 0) {
-			ret <<= 1;
-			ret |= gf_bs_read_bit(bs);
+		if (nBits>32) {
+			ret = gf_bs_read_int(bs, nBits-32);
+			ret <<= 32;
+			nBits = 32;
 		}
+		ret |= gf_bs_read_int(bs, nBits);
 	}
 	return ret;
 }
@@ -341,16 +550,10 @@ GF_EXPORT
 Float gf_bs_read_float(GF_BitStream *bs)
 {	
 	char buf [4] = "\0\0\0";
-#ifdef NO_OPTS
-	s32 i;
-	for (i = 0; i < 32; i++)
-		buf[3-i/8] |= gf_bs_read_bit(bs) << (7 - i%8);
-#else
 	buf[3] = gf_bs_read_int(bs, 8);
 	buf[2] = gf_bs_read_int(bs, 8);
 	buf[1] = gf_bs_read_int(bs, 8);
 	buf[0] = gf_bs_read_int(bs, 8);
-#endif
 	return (* (Float *) buf);
 }
 
@@ -359,8 +562,8 @@ Double gf_bs_read_double(GF_BitStream *bs)
 {
 	char buf [8] = "\0\0\0\0\0\0\0";
 	s32 i;
-	for (i = 0; i < 64; i++)
-		buf[7-i/8] |= gf_bs_read_bit(bs) << (7 - i%8);
+	for (i = 0; i < 8; i++)
+		buf[7-i] = gf_bs_read_int(bs, 8);
 	return (* (Double *) buf);
 }
 
@@ -369,11 +572,13 @@ u32 gf_bs_read_data(GF_BitStream *bs, char *data, u32 nbBytes)
 {
 	u64 orig = bs->position;
 
-	if (bs->position+nbBytes > bs->size) return 0;
+	/*streamed sources are read as far as possible*/
+	if ((bs->position+nbBytes > bs->size) && !bs->is_stream) return 0;
 
 	if (BS_IsAlign(bs)) {
 		switch (bs->bsmode) {
 		case GF_BITSTREAM_READ:
+		case GF_BITSTREAM_MEM_FILE:
 			memcpy(data, bs->original + bs->position, nbBytes);
 			bs->position += nbBytes;
 			return nbBytes;
@@ -381,6 +586,28 @@ u32 gf_bs_read_data(GF_BitStream *bs, char *data, u32 nbBytes)
 		case GF_BITSTREAM_FILE_WRITE:
 			if (bs->buffer_io) 
 				bs_flush_cache(bs);
+			if (bs->cache_read) {
+				u32 done = 0;
+				while (done < nbBytes) {
+					u32 to_copy = bs->cache_read_size - bs->cache_read_pos;
+					if (!to_copy) {
+						/*large reads go straight to the user buffer, the file being at the end of the window*/
+						if ((nbBytes - done >= bs->cache_read_alloc) && !bs->is_stream) {
+							bs->cache_read_size = bs->cache_read_pos = 0;
+							done += (u32) fread(data + done, 1, nbBytes - done, bs->stream);
+							break;
+						}
+						if (!bs_fill_read_cache(bs)) break;
+						continue;
+					}
+					if (to_copy > nbBytes - done) to_copy = nbBytes - done;
+					memcpy(data + done, bs->cache_read + bs->cache_read_pos, to_copy);
+					bs->cache_read_pos += to_copy;
+					done += to_copy;
+				}
+				bs->position += done;
+				return done;
+			}
 			nbBytes = fread(data, 1, nbBytes, bs->stream);
 			bs->position += nbBytes;
 			return nbBytes;
@@ -402,6 +629,14 @@ static void BS_WriteByte(GF_BitStream *bs, u8 val)
 {
 	/*we don't allow write on READ buffers*/
 	if ( (bs->bsmode == GF_BITSTREAM_READ) || (bs->bsmode == GF_BITSTREAM_FILE_READ) ) return;
+
+	if (bs->bsmode == GF_BITSTREAM_MEM_FILE) {
+		if (!bs_mem_file_alloc(bs, bs->position + 1)) return;
+		bs->original[bs->position] = val;
+		bs->position++;
+		if (bs->position > bs->size) bs->size = bs->position;
+		return;
+	}
 	if (!bs->original && !bs->stream) return;
 
 	/*we are in MEM mode*/
@@ -544,13 +779,29 @@ u32 gf_bs_write_byte(GF_BitStream *bs, u8 byte, u32 repeat_count)
 		memset(bs->original + bs->position, byte, repeat_count);
 		bs->position += repeat_count;
 		return repeat_count;
-	case GF_BITSTREAM_FILE_READ:
-	case GF_BITSTREAM_FILE_WRITE:
-
-		if (gf_fwrite(&byte, 1, repeat_count, bs->stream) != repeat_count) return 0;
-		if (bs->size == bs->position) bs->size += repeat_count;
+	case GF_BITSTREAM_MEM_FILE:
+		if (!bs_mem_file_alloc(bs, bs->position + repeat_count)) 
+			return 0;
+		memset(bs->original + bs->position, byte, repeat_count);
 		bs->position += repeat_count;
+		if (bs->position > bs->size) bs->size = bs->position;
 		return repeat_count;
+	case GF_BITSTREAM_FILE_READ:
+	case GF_BITSTREAM_FILE_WRITE:
+	{
+		char buf[4096];
+		u32 count = 0;
+		memset(buf, byte, MIN(repeat_count, sizeof(buf)));
+		while (count<repeat_count) {
+			u32 to_write = MIN(repeat_count - count, sizeof(buf));
+			u32 written = (u32) gf_fwrite(buf, 1, to_write, bs->stream);
+			count += written;
+			if (written != to_write) break;
+		}
+		bs->position += count;
+		if (bs->position > bs->size) bs->size = bs->position;
+		return count;
+	}
 	default:
 		return 0;
 	}
@@ -616,6 +867,13 @@ u32 gf_bs_write_data(GF_BitStream *bs, const char *data, u32 nbBytes)
 			memcpy(bs->original + bs->position, data, nbBytes);
 			bs->position += nbBytes;
 			return nbBytes;
+		case GF_BITSTREAM_MEM_FILE:
+			if (!bs_mem_file_alloc(bs, bs->position + nbBytes)) 
+				return 0;
+			memcpy(bs->original + bs->position, data, nbBytes);
+			bs->position += nbBytes;
+			if (bs->position > bs->size) bs->size = bs->position;
+			return nbBytes;
 		case GF_BITSTREAM_FILE_READ:
 		case GF_BITSTREAM_FILE_WRITE:
 			if (bs->buffer_io) {
@@ -679,14 +937,19 @@ u64 gf_bs_available(GF_BitStream *bs)
 		return (u64) -1;
 
 	/*we are in MEM mode*/
-	if (bs->bsmode == GF_BITSTREAM_READ) {
+	if ((bs->bsmode == GF_BITSTREAM_READ) || (bs->bsmode == GF_BITSTREAM_MEM_FILE)) {
 		if ((s64)bs->size - (s64)bs->position < 0)
 			return 0;
 		else
 			return (bs->size - bs->position);
 	}
 	/*FILE READ: assume size hasn't changed, otherwise the user shall call gf_bs_get_refreshed_size*/
-	if (bs->bsmode==GF_BITSTREAM_FILE_READ) return (bs->size - bs->position);
+	if (bs->bsmode==GF_BITSTREAM_FILE_READ) {
+		/*streamed sources: keep some data ahead so that 0 always means the end of the stream*/
+		if (bs->is_stream && (bs->size - bs->position < BS_STREAM_READ_SIZE)) 
+			bs_stream_refill(bs, BS_STREAM_READ_SIZE);
+		return (bs->size - bs->position);
+	}
 
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
@@ -722,6 +985,16 @@ static s32 BS_CutBuffer(GF_BitStream *bs)
 GF_EXPORT
 void gf_bs_get_content(GF_BitStream *bs, char **output, u32 *outSize)
 {
+	/*memory file: hand over the buffer and start over*/
+	if (bs->bsmode == GF_BITSTREAM_MEM_FILE) {
+		gf_bs_align(bs);
+		*output = bs->size ? bs->original : NULL;
+		*outSize = (u32) bs->size;
+		if (!bs->size && bs->original) gf_free(bs->original);
+		bs->original = NULL;
+		bs->size = bs->position = bs->mem_alloc = 0;
+		return;
+	}
 	/*only in WRITE MEM mode*/
 	if (bs->bsmode != GF_BITSTREAM_WRITE_DYN) return;
 	if (!bs->position && !bs->nbBits) {
@@ -741,6 +1014,63 @@ void gf_bs_get_content(GF_BitStream *bs, char **output, u32 *outSize)
 	bs->position = 0;
 }
 
+GF_EXPORT
+void gf_bs_get_content_no_truncate(GF_BitStream *bs, char **output, u32 *outSize, u32 *alloc_size)
+{
+	if (!alloc_size) {
+		gf_bs_get_content(bs, output, outSize);
+		return;
+	}
+	/*only in WRITE MEM mode*/
+	if (bs->bsmode != GF_BITSTREAM_WRITE_DYN) return;
+	gf_bs_align(bs);
+	*output = bs->original;
+	*outSize = (u32) bs->position;
+	*alloc_size = (u32) bs->size;
+	bs->original = NULL;
+	bs->size = 0;
+	bs->position = 0;
+}
+
+GF_EXPORT
+GF_Err gf_bs_reassign_buffer(GF_BitStream *bs, const char *buffer, u64 size)
+{
+	if (!bs) return GF_BAD_PARAM;
+	switch (bs->bsmode) {
+	case GF_BITSTREAM_READ:
+	case GF_BITSTREAM_WRITE:
+		if (!buffer) return GF_BAD_PARAM;
+		bs->original = (char*)buffer;
+		bs->size = size;
+		break;
+	case GF_BITSTREAM_WRITE_DYN:
+		/*we own the new buffer*/
+		if (buffer && (buffer != bs->original)) {
+			if (bs->original) gf_free(bs->original);
+			bs->original = (char*)buffer;
+			bs->size = size;
+		}
+		if (!bs->original || !bs->size) {
+			if (bs->original) gf_free(bs->original);
+			bs->size = BS_MEM_BLOCK_ALLOC_SIZE;
+			bs->original = (char *) gf_malloc(sizeof(char) * ((u32) bs->size));
+			if (!bs->original) {
+				bs->size = 0;
+				return GF_OUT_OF_MEM;
+			}
+		}
+		break;
+	default:
+		return GF_BAD_PARAM;
+	}
+	bs->position = 0;
+	bs->current = 0;
+	bs->nbBits = (bs->bsmode == GF_BITSTREAM_READ) ? 8 : 0;
+	return GF_OK;
+}
+
+static GF_Err BS_SeekIntern(GF_BitStream *bs, u64 offset);
+
 /*	Skip nbytes. 
 	Align
 	If READ (MEM or FILE) mode, just read n times 8 bit
@@ -755,10 +1085,16 @@ void gf_bs_skip_bytes(GF_BitStream *bs, u64 nbBytes)
 	
 	/*special case for file skipping...*/
 	if ((bs->bsmode == GF_BITSTREAM_FILE_WRITE) || (bs->bsmode == GF_BITSTREAM_FILE_READ)) {
+		if (bs->cache_read) {
+			BS_SeekIntern(bs, bs->position + nbBytes);
+			return;
+		}
 		if (bs->buffer_io)
 			bs_flush_cache(bs);
 		gf_f64_seek(bs->stream, nbBytes, SEEK_CUR);
 		bs->position += nbBytes;
+		/*skipped data written to the file by other means*/
+		if ((bs->bsmode == GF_BITSTREAM_FILE_WRITE) && (bs->position > bs->size)) bs->size = bs->position;
 		return;
 	}
 
@@ -795,6 +1131,13 @@ void gf_bs_rewind_bits(GF_BitStream *bs, u64 nbBits)
 static GF_Err BS_SeekIntern(GF_BitStream *bs, u64 offset)
 {
 	u32 i;
+	if (bs->bsmode == GF_BITSTREAM_MEM_FILE) {
+		if (offset > bs->size) return GF_BAD_PARAM;
+		bs->position = offset;
+		bs->current = 0;
+		bs->nbBits = 0;
+		return GF_OK;
+	}
 	/*if mem, do it */
 	if ((bs->bsmode == GF_BITSTREAM_READ) || (bs->bsmode == GF_BITSTREAM_WRITE) || (bs->bsmode == GF_BITSTREAM_WRITE_DYN)) {
 		if (offset > 0xFFFFFFFF) return GF_IO_ERR;
@@ -817,6 +1160,32 @@ static GF_Err BS_SeekIntern(GF_BitStream *bs, u64 offset)
 	if (bs->buffer_io)
 		bs_flush_cache(bs);
 
+	if (bs->cache_read) {
+		u64 win_start = bs->position - bs->cache_read_pos;
+		/*streamed sources: consume data until the target enters the window*/
+		if (bs->is_stream && (offset > win_start + bs->cache_read_size)) {
+			while (offset > bs->size) {
+				bs->position = bs->size;
+				bs->cache_read_pos = bs->cache_read_size;
+				if (!bs_stream_refill(bs, BS_STREAM_READ_SIZE)) return GF_EOS;
+			}
+			win_start = bs->position - bs->cache_read_pos;
+		}
+		/*seek inside the read window*/
+		if ((offset >= win_start) && (offset <= win_start + bs->cache_read_size)) {
+			bs->cache_read_pos = (u32) (offset - win_start);
+			bs->position = offset;
+			bs->current = 0;
+			bs->nbBits = 8;
+			return GF_OK;
+		}
+		if (bs->is_stream) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CORE, ("[BS] Cannot seek back to "LLU" in streamed source, oldest buffered data is at "LLU"\n", offset, win_start));
+			return GF_IO_ERR;
+		}
+		bs->cache_read_size = bs->cache_read_pos = 0;
+	}
+
 	gf_f64_seek(bs->stream, offset, SEEK_SET);
 
 	bs->position = offset;
@@ -830,8 +1199,12 @@ static GF_Err BS_SeekIntern(GF_BitStream *bs, u64 offset)
 GF_EXPORT
 GF_Err gf_bs_seek(GF_BitStream *bs, u64 offset)
 {
+	/*size does not account for cached data*/
+	if (bs->buffer_io)
+		bs_flush_cache(bs);
+
 	/*warning: we allow offset = bs->size for WRITE buffers*/
-	if (offset > bs->size) return GF_BAD_PARAM;
+	if ((offset > bs->size) && !bs->is_stream) return GF_BAD_PARAM;
 
 	gf_bs_align(bs);
 	return BS_SeekIntern(bs, offset);
@@ -847,6 +1220,24 @@ u32 gf_bs_peek_bits(GF_BitStream *bs, u32 numBits, u32 byte_offset)
 	if ( (bs->bsmode != GF_BITSTREAM_READ) && (bs->bsmode != GF_BITSTREAM_FILE_READ)) return 0;
 	if (!numBits || (bs->size < bs->position + byte_offset)) return 0;
 
+	/*memory mode: read directly from the buffer without moving*/
+	if ((bs->bsmode == GF_BITSTREAM_READ) && (numBits<=32)) {
+		u64 cache = 0;
+		u32 nb_avail = 0;
+		const u8 *ptr = (const u8 *) bs->original + bs->position + byte_offset;
+		const u8 *end = (const u8 *) bs->original + bs->size;
+		if (!byte_offset) {
+			nb_avail = 8 - bs->nbBits;
+			cache = bs->current & bits_mask[nb_avail];
+		}
+		while ((nb_avail < numBits) && (ptr < end)) {
+			cache = (cache<<8) | *ptr++;
+			nb_avail += 8;
+		}
+		if (nb_avail >= numBits)
+			return (u32) (cache >> (nb_avail - numBits));
+	}
+
 	/*store our state*/
 	curPos = bs->position;
 	curBits = bs->nbBits;
@@ -871,9 +1262,11 @@ u64 gf_bs_get_refreshed_size(GF_BitStream *bs)
 	switch (bs->bsmode) {
 	case GF_BITSTREAM_READ:
 	case GF_BITSTREAM_WRITE:
+	case GF_BITSTREAM_MEM_FILE:
 		return bs->size;
 
 	default:
+		if (bs->is_stream) return bs->size;
 		if (bs->buffer_io)
 			bs_flush_cache(bs);
 		offset = gf_f64_tell(bs->stream);
@@ -978,6 +1371,8 @@ u32 gf_bs_read_vluimsbf5(GF_BitStream *bs)
 GF_EXPORT
 void gf_bs_truncate(GF_BitStream *bs)
 {
+	if (bs->buffer_io)
+		bs_flush_cache(bs);
 	bs->size = bs->position;
 	if (bs->stream) return;
 }
@@ -1003,4 +1398,51 @@ GF_Err gf_bs_transfer(GF_BitStream *dst, GF_BitStream *src)
 	gf_free(data);
 	if (written<data_len) return GF_IO_ERR;
 	return GF_OK;
-}
\ No newline at end of file
+}
+
+static u8 bs_get_written_byte(GF_BitStream *bs, u32 idx)
+{
+	if (idx < bs->position) return (u8) bs->original[idx];
+	/*pending bits of the current byte*/
+	if ((idx == bs->position) && bs->nbBits) return (u8) (bs->current << (8 - bs->nbBits));
+	return 0;
+}
+
+GF_EXPORT
+GF_Err gf_bs_copy_bits(GF_BitStream *bs, u32 bit_offset, u32 nb_bits, char *output)
+{
+	u32 i, nb_bytes, idx, shift;
+	if (!bs || !output) return GF_BAD_PARAM;
+	if ((bs->bsmode != GF_BITSTREAM_WRITE) && (bs->bsmode != GF_BITSTREAM_WRITE_DYN)) return GF_BAD_PARAM;
+	if ((u64) bit_offset + nb_bits > bs->position*8 + bs->nbBits) return GF_BAD_PARAM;
+
+	nb_bytes = (nb_bits+7) / 8;
+	idx = bit_offset / 8;
+	shift = bit_offset % 8;
+	if (!shift && (idx + nb_bytes <= bs->position)) {
+		memcpy(output, bs->original + idx, nb_bytes);
+	} else {
+		for (i=0; i<nb_bytes; i++) {
+			u8 val = bs_get_written_byte(bs, idx+i) << shift;
+			if (shift) val |= bs_get_written_byte(bs, idx+i+1) >> (8 - shift);
+			output[i] = (char) val;
+		}
+	}
+	/*clear unused bits*/
+	if (nb_bits % 8) output[nb_bytes-1] &= (char) (0xFF << (8 - nb_bits % 8));
+	return GF_OK;
+}
+
+GF_EXPORT
+u64 gf_bs_set_cookie(GF_BitStream *bs, u64 cookie)
+{
+	u64 res = bs->cookie;
+	bs->cookie = cookie;
+	return res;
+}
+
+GF_EXPORT
+u64 gf_bs_get_cookie(GF_BitStream *bs)
+{
+	return bs->cookie;
+}
@@ -407,6 +407,20 @@ const char *gf_cfg_get_key_name(GF_Config *iniFile, const char *secName, u32 key
 	return NULL;
 }
 
+GF_EXPORT
+const char *gf_cfg_get_key_value(GF_Config *iniFile, const char *secName, u32 keyIndex)
+{
+	u32 i = 0;
+	IniSection *sec;
+	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i) ) ) {
+		if (!strcmp(secName, sec->section_name)) {
+			IniKey *key = (IniKey *) gf_list_get(sec->keys, keyIndex);
+			return key ? key->value : NULL;
+		}
+	}
+	return NULL;
+}
+
 GF_EXPORT
 void gf_cfg_del_section(GF_Config *iniFile, const char *secName)
 {
@@ -483,8 +497,9 @@ const char *gf_cfg_get_sub_key(GF_Config *iniFile, const char *secName, const ch
 GF_EXPORT
 GF_Err gf_cfg_set_filename(GF_Config *iniFile, const char * fileName)
 {
-	if (!fileName) return GF_OK;
 	if (iniFile->fileName) gf_free(iniFile->fileName);
+	iniFile->fileName = NULL;
+	if (!fileName) return GF_OK;
 	iniFile->fileName = gf_strdup(fileName);
 	return iniFile->fileName ? GF_OK : GF_OUT_OF_MEM;
 }
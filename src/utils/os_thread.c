@@ -746,3 +746,13 @@ Bool gf_sema_wait_for(GF_Semaphore *sm, u32 TimeOut)
 #endif
 }
 
+GF_EXPORT
+void gf_th_memory_barrier()
+{
+#if defined(WIN32) && defined(MemoryBarrier)
+	MemoryBarrier();
+#elif defined(__GNUC__)
+	__sync_synchronize();
+#endif
+	/*otherwise rely on the function call not being reordered by the compiler*/
+}